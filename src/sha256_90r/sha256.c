@@ -18,7 +18,9 @@
 #include <stdint.h>
 #include <stdio.h>
 #include "sha256.h"
+#include "sha256_90r.h"       // Streaming-mode hint flags
 #include "sha256_internal.h"  // For SHA256-90R internal definitions
+#include <unistd.h>
 
 // SIMD includes
 #ifdef USE_SIMD
@@ -40,6 +42,13 @@
 #endif
 #endif
 
+// Legacy SHA-256 kernels use per-function target attributes and runtime
+// dispatch, so they do not depend on USE_SIMD/USE_SHA_NI build flags
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SHA256_X86_ACCEL 1
+#include <immintrin.h>
+#endif
+
 #ifdef USE_ARMV8_CRYPTO
 #ifdef __aarch64__
 #include <arm_neon.h>
@@ -65,7 +74,7 @@
 #define SHA256_90R_FAST_MODE 0    // Default to safe mode
 #endif
 
-// CPUID includes for power profiling
+// CPUID for runtime feature detection
 #ifdef __x86_64__
 #include <cpuid.h>
 #endif
@@ -75,17 +84,11 @@ static int g_cpu_features_detected = 0;
 static int g_has_avx2 = 0;
 static int g_has_avx512 = 0;
 static int g_has_sha_ni = 0;
+static int g_has_cldemote = 0;
+static int g_has_bmi2 = 0;             // BMI1 and BMI2 (rorx, andn)
 
 /****************************** MACROS ******************************/
 #define ROTLEFT(a,b) (((a) << (b)) | ((a) >> (32-(b))))
-#define ROTRIGHT(a,b) (((a) >> (b)) | ((a) << (32-(b))))
-
-#define CH(x,y,z) (((x) & (y)) ^ (~(x) & (z)))
-#define MAJ(x,y,z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
-#define EP0(x) (ROTRIGHT(x,2) ^ ROTRIGHT(x,13) ^ ROTRIGHT(x,22))
-#define EP1(x) (ROTRIGHT(x,6) ^ ROTRIGHT(x,11) ^ ROTRIGHT(x,25))
-#define SIG0(x) (ROTRIGHT(x,7) ^ ROTRIGHT(x,18) ^ ((x) >> 3))
-#define SIG1(x) (ROTRIGHT(x,17) ^ ROTRIGHT(x,19) ^ ((x) >> 10))
 
 /****************************** CONSTANT-TIME MACROS ******************************/
 #define CTEQ(a, b) (~((a) ^ (b)))  // Constant-time equality check
@@ -105,25 +108,6 @@ __attribute__((aligned(64))) static const WORD k[64] = {
 	0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2
 };
 
-// Extended constants for SHA-256-90R (optimized for SIMD access with transposed layout)
-__attribute__((aligned(64))) static const WORD k_90r[96] = { // Padded to multiple of 32 for AVX-512
-	0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
-	0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
-	0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
-	0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
-	0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
-	0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
-	0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
-	0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2,
-	// Extended constants for SHA-256-90R (optimized sequence)
-	0xc67178f2,0xca273ece,0xd186b8c7,0xeada7dd6,0xf57d4f7f,0x06f067aa,0x0a637dc5,0x113f9804,
-	0x1b710b35,0x28db77f5,0x32caab7b,0x3c9ebe0a,0x431d67c4,0x4cc5d4be,0x597f299c,0x5fcb6fab,
-	0x6c44198c,0x7ba0ea2d,0x7eabf2d0,0x8dbe8d03,0x90bb1721,0x99a2ad45,0x9f86e289,0xa84c4472,
-	0xb3df34fc,0xb99bb8d7,
-	// Padding for alignment (used for SIMD register spills)
-	0x00000000,0x00000000,0x00000000,0x00000000,0x00000000,0x00000000
-};
-
 // CPU feature detection function
 static void detect_cpu_features() {
 	if (g_cpu_features_detected) return;
@@ -137,6 +121,8 @@ static void detect_cpu_features() {
 		g_has_avx2 = (ebx & (1 << 5)) != 0;
 		g_has_avx512 = (ebx & (1 << 16)) != 0;
 		g_has_sha_ni = (ebx & (1 << 29)) != 0;
+		g_has_cldemote = (ecx & (1 << 25)) != 0;
+		g_has_bmi2 = (ebx & (1 << 3)) != 0 && (ebx & (1 << 8)) != 0;
 	}
 	
 	// Log detected features once
@@ -152,83 +138,334 @@ static void detect_cpu_features() {
 }
 
 /*********************** FUNCTION DEFINITIONS ***********************/
-void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
+static void sha256_blocks_scalar(WORD state[8], const BYTE *data, size_t nblocks)
 {
 	WORD a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
 
-	for (i = 0, j = 0; i < 16; ++i, j += 4)
-		m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
-	for ( ; i < 64; ++i)
-		m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+	for ( ; nblocks > 0; --nblocks, data += 64) {
+		for (i = 0, j = 0; i < 16; ++i, j += 4)
+			m[i] = ((WORD)data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
+		for ( ; i < 64; ++i)
+			m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+
+		a = state[0];
+		b = state[1];
+		c = state[2];
+		d = state[3];
+		e = state[4];
+		f = state[5];
+		g = state[6];
+		h = state[7];
+
+		for (i = 0; i < 64; ++i) {
+			t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i];
+			t2 = EP0(a) + MAJ(a,b,c);
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+}
+
+#ifdef SHA256_X86_ACCEL
+// SHA-NI: two rounds per sha256rnds2, state kept as ABEF/CDGH
+__attribute__((target("sha,sse4.1")))
+static void sha256_blocks_sha_ni(WORD state[8], const BYTE *data, size_t nblocks)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, msg, tmp, abef_save, cdgh_save;
+	__m128i w[4];
+	int i;
+
+	tmp = _mm_loadu_si128((const __m128i *)&state[0]);       // DCBA
+	state1 = _mm_loadu_si128((const __m128i *)&state[4]);    // HGFE
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);                      // CDAB
+	state1 = _mm_shuffle_epi32(state1, 0x1B);                // EFGH
+	state0 = _mm_alignr_epi8(tmp, state1, 8);                // ABEF
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);             // CDGH
+
+	for ( ; nblocks > 0; --nblocks, data += 64) {
+		abef_save = state0;
+		cdgh_save = state1;
+
+#pragma GCC unroll 16
+		for (i = 0; i < 16; ++i) {
+			if (i < 4) {
+				w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), bswap);
+			} else {
+				// W[t..t+3] from W[t-16..t-1]; msg2 chains the last two words internally
+				tmp = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+				tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+				w[i & 3] = _mm_sha256msg2_epu32(tmp, w[(i + 3) & 3]);
+			}
+			msg = _mm_add_epi32(w[i & 3], _mm_load_si128((const __m128i *)&k[4 * i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg = _mm_shuffle_epi32(msg, 0x0E);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		}
+
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1B);                   // FEBA
+	state1 = _mm_shuffle_epi32(state1, 0xB1);                // DCHG
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);             // DCBA
+	state1 = _mm_alignr_epi8(state1, tmp, 8);                // HGFE
+	_mm_storeu_si128((__m128i *)&state[0], state0);
+	_mm_storeu_si128((__m128i *)&state[4], state1);
+}
 
-	a = ctx->state[0];
-	b = ctx->state[1];
-	c = ctx->state[2];
-	d = ctx->state[3];
-	e = ctx->state[4];
-	f = ctx->state[5];
-	g = ctx->state[6];
-	h = ctx->state[7];
+// Rows r[l] = words 0..7 of lane l in, columns out: r[j] = word j of lanes 0..7
+__attribute__((target("avx2")))
+static inline void sha256_transpose8_avx2(__m256i r[8])
+{
+	__m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+	__m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+	__m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+	__m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+	__m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+	__m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+	__m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+	__m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+	__m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+	__m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+	__m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+	__m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+	__m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+	__m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+	__m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+	__m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+	r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+	r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+	r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+	r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+	r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+	r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+	r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+	r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
 
+// Eight independent messages, one block each. state is word-major: state[word][lane].
+__attribute__((target("avx2")))
+static void sha256_blocks_avx2_8way(WORD state[8][8], const BYTE *const blocks[8])
+{
+	const __m256i bswap = _mm256_set_epi8(12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3,
+	                                      12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3);
+	__m256i w[16], r[8];
+	__m256i a, b, c, d, e, f, g, h, t1, t2;
+	int i, half;
+
+	for (half = 0; half < 2; ++half) {
+		for (i = 0; i < 8; ++i)
+			r[i] = _mm256_loadu_si256((const __m256i *)(blocks[i] + 32 * half));
+		sha256_transpose8_avx2(r);
+		for (i = 0; i < 8; ++i)
+			w[8 * half + i] = _mm256_shuffle_epi8(r[i], bswap);
+	}
+
+	a = _mm256_loadu_si256((const __m256i *)state[0]);
+	b = _mm256_loadu_si256((const __m256i *)state[1]);
+	c = _mm256_loadu_si256((const __m256i *)state[2]);
+	d = _mm256_loadu_si256((const __m256i *)state[3]);
+	e = _mm256_loadu_si256((const __m256i *)state[4]);
+	f = _mm256_loadu_si256((const __m256i *)state[5]);
+	g = _mm256_loadu_si256((const __m256i *)state[6]);
+	h = _mm256_loadu_si256((const __m256i *)state[7]);
+
+#pragma GCC unroll 16
 	for (i = 0; i < 64; ++i) {
-		t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i];
-		t2 = EP0(a) + MAJ(a,b,c);
+		if (i >= 16) {
+			__m256i w2 = w[(i - 2) & 15], w15 = w[(i - 15) & 15];
+			__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(w2, 17), MM256_ROTR(w2, 19)),
+			                              _mm256_srli_epi32(w2, 10));
+			__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(w15, 7), MM256_ROTR(w15, 18)),
+			                              _mm256_srli_epi32(w15, 3));
+			w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0),
+			                             _mm256_add_epi32(w[(i - 7) & 15], s1));
+		}
+		t1 = _mm256_add_epi32(h, _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(e, 6), MM256_ROTR(e, 11)),
+		                                          MM256_ROTR(e, 25)));
+		t1 = _mm256_add_epi32(t1, _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g)));
+		t1 = _mm256_add_epi32(t1, _mm256_add_epi32(_mm256_set1_epi32((int)k[i]), w[i & 15]));
+		t2 = _mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(a, 2), MM256_ROTR(a, 13)),
+		                                       MM256_ROTR(a, 22)),
+		                      _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b))));
 		h = g;
 		g = f;
 		f = e;
-		e = d + t1;
+		e = _mm256_add_epi32(d, t1);
 		d = c;
 		c = b;
 		b = a;
-		a = t1 + t2;
+		a = _mm256_add_epi32(t1, t2);
 	}
 
-	ctx->state[0] += a;
-	ctx->state[1] += b;
-	ctx->state[2] += c;
-	ctx->state[3] += d;
-	ctx->state[4] += e;
-	ctx->state[5] += f;
-	ctx->state[6] += g;
-	ctx->state[7] += h;
+	_mm256_storeu_si256((__m256i *)state[0], _mm256_add_epi32(a, _mm256_loadu_si256((const __m256i *)state[0])));
+	_mm256_storeu_si256((__m256i *)state[1], _mm256_add_epi32(b, _mm256_loadu_si256((const __m256i *)state[1])));
+	_mm256_storeu_si256((__m256i *)state[2], _mm256_add_epi32(c, _mm256_loadu_si256((const __m256i *)state[2])));
+	_mm256_storeu_si256((__m256i *)state[3], _mm256_add_epi32(d, _mm256_loadu_si256((const __m256i *)state[3])));
+	_mm256_storeu_si256((__m256i *)state[4], _mm256_add_epi32(e, _mm256_loadu_si256((const __m256i *)state[4])));
+	_mm256_storeu_si256((__m256i *)state[5], _mm256_add_epi32(f, _mm256_loadu_si256((const __m256i *)state[5])));
+	_mm256_storeu_si256((__m256i *)state[6], _mm256_add_epi32(g, _mm256_loadu_si256((const __m256i *)state[6])));
+	_mm256_storeu_si256((__m256i *)state[7], _mm256_add_epi32(h, _mm256_loadu_si256((const __m256i *)state[7])));
+}
+#endif // SHA256_X86_ACCEL
+
+/*********************** IMPLEMENTATION DISPATCH ***********************/
+typedef void (*sha256_blocks_fn)(WORD state[8], const BYTE *data, size_t nblocks);
+
+static SHA256_IMPL g_sha256_impl = SHA256_IMPL_AUTO;   // Resolved on first use
+static sha256_blocks_fn g_sha256_blocks = NULL;
+
+static int sha256_impl_supported(SHA256_IMPL impl)
+{
+	switch (impl) {
+	case SHA256_IMPL_AUTO:
+	case SHA256_IMPL_SCALAR:
+		return 1;
+#ifdef SHA256_X86_ACCEL
+	case SHA256_IMPL_SHA_NI:
+		detect_cpu_features();
+		return g_has_sha_ni;
+	case SHA256_IMPL_AVX2:
+		detect_cpu_features();
+		return g_has_avx2;
+#endif
+	default:
+		return 0;
+	}
+}
+
+int sha256_set_impl(SHA256_IMPL impl)
+{
+	if (!sha256_impl_supported(impl))
+		return -1;
+
+	// SHA-NI beats eight AVX2 lanes per message, so AUTO only uses AVX2 without it
+	if (impl == SHA256_IMPL_AUTO) {
+		if (sha256_impl_supported(SHA256_IMPL_SHA_NI))
+			impl = SHA256_IMPL_SHA_NI;
+		else if (sha256_impl_supported(SHA256_IMPL_AVX2))
+			impl = SHA256_IMPL_AVX2;
+		else
+			impl = SHA256_IMPL_SCALAR;
+	}
+
+	// Single-stream hashing has no lanes to fill; AVX2 only changes sha256_batch
+	g_sha256_blocks = sha256_blocks_scalar;
+#ifdef SHA256_X86_ACCEL
+	if (impl == SHA256_IMPL_SHA_NI)
+		g_sha256_blocks = sha256_blocks_sha_ni;
+#endif
+	g_sha256_impl = impl;
+	return 0;
+}
+
+SHA256_IMPL sha256_get_impl(void)
+{
+	if (!g_sha256_blocks)
+		sha256_set_impl(SHA256_IMPL_AUTO);
+	return g_sha256_impl;
+}
+
+const char *sha256_impl_name(SHA256_IMPL impl)
+{
+	switch (impl) {
+	case SHA256_IMPL_AUTO:   return "auto";
+	case SHA256_IMPL_SCALAR: return "scalar";
+	case SHA256_IMPL_SHA_NI: return "sha_ni";
+	case SHA256_IMPL_AVX2:   return "avx2_8way";
+	default:                 return "unknown";
+	}
+}
+
+static void sha256_blocks(WORD state[8], const BYTE *data, size_t nblocks)
+{
+	if (!g_sha256_blocks)
+		sha256_set_impl(SHA256_IMPL_AUTO);
+	g_sha256_blocks(state, data, nblocks);
+}
+
+void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
+{
+	sha256_blocks(ctx->state, data, 1);
+}
+
+/*********************** STREAMING INTERFACE ***********************/
+static const WORD sha256_iv[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// Since this implementation uses little endian byte ordering and SHA uses big endian,
+// reverse all the bytes when copying the final state to the output hash.
+static void sha256_store_hash(const WORD state[8], BYTE hash[])
+{
+	WORD i;
+
+	for (i = 0; i < 4; ++i) {
+		hash[i]      = (state[0] >> (24 - i * 8)) & 0x000000ff;
+		hash[i + 4]  = (state[1] >> (24 - i * 8)) & 0x000000ff;
+		hash[i + 8]  = (state[2] >> (24 - i * 8)) & 0x000000ff;
+		hash[i + 12] = (state[3] >> (24 - i * 8)) & 0x000000ff;
+		hash[i + 16] = (state[4] >> (24 - i * 8)) & 0x000000ff;
+		hash[i + 20] = (state[5] >> (24 - i * 8)) & 0x000000ff;
+		hash[i + 24] = (state[6] >> (24 - i * 8)) & 0x000000ff;
+		hash[i + 28] = (state[7] >> (24 - i * 8)) & 0x000000ff;
+	}
 }
 
 void sha256_init(SHA256_CTX *ctx)
 {
 	ctx->datalen = 0;
 	ctx->bitlen = 0;
-	ctx->state[0] = 0x6a09e667;
-	ctx->state[1] = 0xbb67ae85;
-	ctx->state[2] = 0x3c6ef372;
-	ctx->state[3] = 0xa54ff53a;
-	ctx->state[4] = 0x510e527f;
-	ctx->state[5] = 0x9b05688c;
-	ctx->state[6] = 0x1f83d9ab;
-	ctx->state[7] = 0x5be0cd19;
+	memcpy(ctx->state, sha256_iv, sizeof(sha256_iv));
 }
 
 void sha256_update(SHA256_CTX *ctx, const BYTE data[], size_t len)
 {
-	WORD i;
+	size_t i = 0, nblocks;
 
-	for (i = 0; i < len; ++i) {
-		ctx->data[ctx->datalen] = data[i];
-		ctx->datalen++;
-		// Constant-time arithmetic: always perform operations, mask results
-		WORD should_transform = ((WORD)(ctx->datalen == 64)) - 1; // 0xFFFFFFFF if true, 0x00000000 if false
-
-		// Always perform transform but mask the state update
-		SHA256_CTX temp_ctx = *ctx;
-		sha256_transform(&temp_ctx, ctx->data);
+	// Top up a partially filled block first
+	if (ctx->datalen > 0) {
+		size_t take = 64 - ctx->datalen;
+		if (take > len)
+			take = len;
+		memcpy(ctx->data + ctx->datalen, data, take);
+		ctx->datalen += (WORD)take;
+		i = take;
+		if (ctx->datalen < 64)
+			return;
+		sha256_blocks(ctx->state, ctx->data, 1);
+		ctx->bitlen += 512;
+		ctx->datalen = 0;
+	}
 
-		// Conditionally update context state using arithmetic masking
-		WORD j;
-		for (j = 0; j < 8; ++j) {
-			ctx->state[j] = (temp_ctx.state[j] & should_transform) | (ctx->state[j] & ~should_transform);
-		}
-		ctx->bitlen = (ctx->bitlen + 512) & should_transform | (ctx->bitlen & ~should_transform);
-		ctx->datalen = (0 & should_transform) | (ctx->datalen & ~should_transform);
+	// Whole blocks are hashed straight from the caller's buffer
+	nblocks = (len - i) / 64;
+	if (nblocks > 0) {
+		sha256_blocks(ctx->state, data + i, nblocks);
+		ctx->bitlen += (unsigned long long)nblocks * 512;
+		i += nblocks * 64;
 	}
+
+	memcpy(ctx->data, data + i, len - i);
+	ctx->datalen = (WORD)(len - i);
 }
 
 void sha256_final(SHA256_CTX *ctx, BYTE hash[])
@@ -237,31 +474,19 @@ void sha256_final(SHA256_CTX *ctx, BYTE hash[])
 
 	i = ctx->datalen;
 
-	// Constant-time padding: always pad to 64 bytes, conditionally transform
-	ctx->data[i] = 0x80;
-	i++;
-
-	// Fill remaining space with zeros (constant-time)
-	while (i < 64) {
-		ctx->data[i++] = 0x00;
+	// Pad whatever data is left in the buffer. Only the message length,
+	// never its contents, decides whether an extra block is needed.
+	if (ctx->datalen < 56) {
+		ctx->data[i++] = 0x80;
+		while (i < 56)
+			ctx->data[i++] = 0x00;
 	}
-
-	// Constant-time conditional transform based on whether we need extra block
-	WORD needs_extra_block = ((WORD)(ctx->datalen >= 56)) - 1; // 0xFFFFFFFF if true, 0x00000000 if false
-
-	// Always perform transform but mask the state update
-	SHA256_CTX temp_ctx = *ctx;
-	sha256_transform(&temp_ctx, ctx->data);
-
-	// Conditionally update context state using arithmetic masking
-	WORD j;
-	for (j = 0; j < 8; ++j) {
-		ctx->state[j] = (temp_ctx.state[j] & needs_extra_block) | (ctx->state[j] & ~needs_extra_block);
-	}
-
-	// Always clear the data for the length padding (constant-time)
-	for (i = 0; i < 56; i++) {
-		ctx->data[i] = 0;
+	else {
+		ctx->data[i++] = 0x80;
+		while (i < 64)
+			ctx->data[i++] = 0x00;
+		sha256_blocks(ctx->state, ctx->data, 1);
+		memset(ctx->data, 0, 56);
 	}
 
 	// Append to the padding the total message's length in bits and transform.
@@ -274,20 +499,155 @@ void sha256_final(SHA256_CTX *ctx, BYTE hash[])
 	ctx->data[58] = ctx->bitlen >> 40;
 	ctx->data[57] = ctx->bitlen >> 48;
 	ctx->data[56] = ctx->bitlen >> 56;
-	sha256_transform(ctx, ctx->data);
+	sha256_blocks(ctx->state, ctx->data, 1);
 
-	// Since this implementation uses little endian byte ordering and SHA uses big endian,
-	// reverse all the bytes when copying the final state to the output hash.
-	for (i = 0; i < 4; ++i) {
-		hash[i]      = (ctx->state[0] >> (24 - i * 8)) & 0x000000ff;
-		hash[i + 4]  = (ctx->state[1] >> (24 - i * 8)) & 0x000000ff;
-		hash[i + 8]  = (ctx->state[2] >> (24 - i * 8)) & 0x000000ff;
-		hash[i + 12] = (ctx->state[3] >> (24 - i * 8)) & 0x000000ff;
-		hash[i + 16] = (ctx->state[4] >> (24 - i * 8)) & 0x000000ff;
-		hash[i + 20] = (ctx->state[5] >> (24 - i * 8)) & 0x000000ff;
-		hash[i + 24] = (ctx->state[6] >> (24 - i * 8)) & 0x000000ff;
-		hash[i + 28] = (ctx->state[7] >> (24 - i * 8)) & 0x000000ff;
+	sha256_store_hash(ctx->state, hash);
+}
+
+void sha256(const BYTE data[], size_t len, BYTE hash[])
+{
+	SHA256_CTX ctx;
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, data, len);
+	sha256_final(&ctx, hash);
+}
+
+/*********************** BATCH INTERFACE ***********************/
+
+// Build the final one or two padded blocks of a message; returns the block count
+static size_t sha256_pad_tail(BYTE tail[128], const BYTE *msg, size_t len)
+{
+	size_t rem = len % 64;
+	size_t nblocks = rem < 56 ? 1 : 2;
+	unsigned long long bitlen = (unsigned long long)len * 8;
+	int i;
+
+	memset(tail, 0, 128);
+	if (rem > 0)
+		memcpy(tail, msg + (len - rem), rem);
+	tail[rem] = 0x80;
+	for (i = 0; i < 8; ++i)
+		tail[nblocks * 64 - 1 - i] = (BYTE)(bitlen >> (8 * i));
+	return nblocks;
+}
+
+static void sha256_batch_serial(const BYTE *const data[], const size_t lens[],
+                                BYTE hashes[][SHA256_BLOCK_SIZE], size_t count)
+{
+	BYTE tail[128];
+	WORD state[8];
+	size_t n, tail_blocks;
+
+	for (n = 0; n < count; ++n) {
+		memcpy(state, sha256_iv, sizeof(sha256_iv));
+		if (lens[n] >= 64)
+			sha256_blocks(state, data[n], lens[n] / 64);
+		tail_blocks = sha256_pad_tail(tail, data[n], lens[n]);
+		sha256_blocks(state, tail, tail_blocks);
+		sha256_store_hash(state, hashes[n]);
+	}
+}
+
+#ifdef SHA256_X86_ACCEL
+typedef struct {
+	const BYTE *msg;
+	size_t full;            // Whole blocks read straight from msg
+	size_t total;           // full plus one or two padding blocks
+	size_t next;            // Next block to hash
+	size_t index;           // Position in the batch
+	BYTE tail[128];
+} SHA256_LANE;
+
+static const BYTE *sha256_lane_block(const SHA256_LANE *lane)
+{
+	if (lane->next < lane->full)
+		return lane->msg + lane->next * 64;
+	return lane->tail + (lane->next - lane->full) * 64;
+}
+
+// Eight messages in flight; a lane that finishes picks up the next message, so
+// unequal lengths only cost the few blocks at the end of the batch
+static void sha256_batch_avx2(const BYTE *const data[], const size_t lens[],
+                              BYTE hashes[][SHA256_BLOCK_SIZE], size_t count)
+{
+	static const BYTE idle_block[64] = {0};
+	SHA256_LANE lanes[8];
+	int active[8];
+	WORD state[8][8];
+	const BYTE *blocks[8];
+	size_t pending = 0;
+	int running = 0, l, w;
+
+	for (l = 0; l < 8; ++l) {
+		active[l] = 0;
+		for (w = 0; w < 8; ++w)
+			state[w][l] = sha256_iv[w];
+	}
+
+	for (;;) {
+		// Refill idle lanes
+		for (l = 0; l < 8 && pending < count; ++l) {
+			if (active[l])
+				continue;
+			lanes[l].msg = data[pending];
+			lanes[l].full = lens[pending] / 64;
+			lanes[l].total = lanes[l].full + sha256_pad_tail(lanes[l].tail, data[pending], lens[pending]);
+			lanes[l].next = 0;
+			lanes[l].index = pending++;
+			for (w = 0; w < 8; ++w)
+				state[w][l] = sha256_iv[w];
+			active[l] = 1;
+			running++;
+		}
+		if (running == 0)
+			break;
+
+		// A nearly empty batch is cheaper to finish one message at a time
+		if (pending == count && running <= 2) {
+			for (l = 0; l < 8; ++l) {
+				WORD lane_state[8];
+				if (!active[l])
+					continue;
+				for (w = 0; w < 8; ++w)
+					lane_state[w] = state[w][l];
+				while (lanes[l].next < lanes[l].total) {
+					sha256_blocks_scalar(lane_state, sha256_lane_block(&lanes[l]), 1);
+					lanes[l].next++;
+				}
+				sha256_store_hash(lane_state, hashes[lanes[l].index]);
+			}
+			break;
+		}
+
+		for (l = 0; l < 8; ++l)
+			blocks[l] = active[l] ? sha256_lane_block(&lanes[l]) : idle_block;
+		sha256_blocks_avx2_8way(state, blocks);
+
+		for (l = 0; l < 8; ++l) {
+			WORD lane_state[8];
+			if (!active[l] || ++lanes[l].next < lanes[l].total)
+				continue;
+			for (w = 0; w < 8; ++w)
+				lane_state[w] = state[w][l];
+			sha256_store_hash(lane_state, hashes[lanes[l].index]);
+			active[l] = 0;
+			running--;
+		}
+	}
+}
+#endif // SHA256_X86_ACCEL
+
+void sha256_batch(const BYTE *const data[], const size_t lens[],
+                  BYTE hashes[][SHA256_BLOCK_SIZE], size_t count)
+{
+#ifdef SHA256_X86_ACCEL
+	if (sha256_get_impl() == SHA256_IMPL_AVX2) {
+		sha256_batch_avx2(data, lens, hashes, count);
+		return;
 	}
+#endif
+	sha256_batch_serial(data, lens, hashes, count);
 }
 
 /*********************** VECTORIZED MESSAGE EXPANSION HELPERS **********************/
@@ -309,35 +669,35 @@ __attribute__((always_inline)) static inline __m256i vectorized_sig1(__m256i x)
     );
 }
 
-// Optimized message expansion using AVX2 (processes 8 words at once)
+// 4-lane SIG0/SIG1 with true rotates for the schedule expansion below
+#define MM_ROTR32(x, n) _mm_or_si128(_mm_srli_epi32((x), (n)), _mm_slli_epi32((x), 32 - (n)))
+
+__attribute__((always_inline)) static inline __m128i vectorized_sig0_x4(__m128i x) {
+    return _mm_xor_si128(_mm_xor_si128(MM_ROTR32(x, 7), MM_ROTR32(x, 18)), _mm_srli_epi32(x, 3));
+}
+
+__attribute__((always_inline)) static inline __m128i vectorized_sig1_x4(__m128i x) {
+    return _mm_xor_si128(_mm_xor_si128(MM_ROTR32(x, 17), MM_ROTR32(x, 19)), _mm_srli_epi32(x, 10));
+}
+
+// Vectorized message expansion, 4 words per step. W[i..i+3] only depend on
+// W[i-2] and W[i-1] through SIG1 for the first two lanes; the last two lanes
+// take SIG1 of the freshly computed W[i], W[i+1] in a second pass.
 __attribute__((always_inline)) static inline void expand_message_schedule_avx2(WORD *m) {
-    static int expand_count = 0;
-    if (expand_count < 3) {
-        printf("[SHA256-90R] AVX2 message expansion called (count=%d)\n", ++expand_count);
-    }
-    __m256i w0, w1, w2, w3, sig0_vec, sig1_vec;
-
-    // Process 8-word chunks with vectorized SIG0/SIG1
-    for (int i = 16; i < 88; i += 8) {
-        // Load input vectors
-        w0 = _mm256_loadu_si256((__m256i*)&m[i-15]); // SIG0 input
-        w1 = _mm256_loadu_si256((__m256i*)&m[i-2]);  // SIG1 input
-        w2 = _mm256_loadu_si256((__m256i*)&m[i-16]); // Base word
-        w3 = _mm256_loadu_si256((__m256i*)&m[i-7]);  // Addition word
-
-        // Compute SIG0 and SIG1 in parallel
-        sig0_vec = vectorized_sig0(w0);
-        sig1_vec = vectorized_sig1(w1);
-
-        // Combine: m[i] = SIG1(m[i-2]) + m[i-7] + SIG0(m[i-15]) + m[i-16]
-        w0 = _mm256_add_epi32(sig1_vec, w3);
-        w0 = _mm256_add_epi32(w0, sig0_vec);
-        w0 = _mm256_add_epi32(w0, w2);
-
-        _mm256_storeu_si256((__m256i*)&m[i], w0);
+    for (int i = 16; i < 88; i += 4) {
+        __m128i w16 = _mm_loadu_si128((const __m128i*)&m[i - 16]);
+        __m128i w15 = _mm_loadu_si128((const __m128i*)&m[i - 15]);
+        __m128i w7  = _mm_loadu_si128((const __m128i*)&m[i - 7]);
+        __m128i w2  = _mm_loadl_epi64((const __m128i*)&m[i - 2]);    // W[i-2], W[i-1], 0, 0
+
+        __m128i base = _mm_add_epi32(_mm_add_epi32(w16, vectorized_sig0_x4(w15)), w7);
+        __m128i lo = _mm_add_epi32(base, vectorized_sig1_x4(w2));   // Lanes 0-1 final (SIG1(0) = 0)
+        __m128i hi = _mm_slli_si128(vectorized_sig1_x4(lo), 8);      // SIG1(W[i]), SIG1(W[i+1]) -> lanes 2-3
+
+        _mm_storeu_si128((__m128i*)&m[i], _mm_add_epi32(lo, hi));
     }
 
-    // Handle remaining words with scalar operations (constant-time)
+    // Remaining words (constant-time)
     for (int i = 88; i < 90; ++i) {
         m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
     }
@@ -398,6 +758,152 @@ void sha256_90r_transform_scalar(struct sha256_90r_internal_ctx *restrict ctx, c
 	ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
 }
 
+// Same rounds with a 16-word rolling schedule: W[i] is computed in the round
+// that consumes it and overwrites W[i-16], instead of a pre-expanded m[96]
+__attribute__((optimize("O3", "unroll-loops", "inline-functions")))
+void sha256_90r_transform_scalar_rolling(struct sha256_90r_internal_ctx *restrict ctx, const BYTE *restrict data)
+{
+	WORD w[16];
+	WORD a, b, c, d, e, f, g, h, t1, t2;
+	int i;
+
+	for (i = 0; i < 16; ++i) {
+		w[i] = (data[i * 4] << 24) | (data[i * 4 + 1] << 16) |
+			   (data[i * 4 + 2] << 8) | data[i * 4 + 3];
+	}
+
+	a = ctx->state[0]; b = ctx->state[1]; c = ctx->state[2]; d = ctx->state[3];
+	e = ctx->state[4]; f = ctx->state[5]; g = ctx->state[6]; h = ctx->state[7];
+
+#pragma GCC unroll 90
+	for (i = 0; i < 90; ++i) {
+		if (i >= 16)
+			w[i & 15] += SIG1(w[(i - 2) & 15]) + w[(i - 7) & 15] + SIG0(w[(i - 15) & 15]);
+		t1 = h + EP1(e) + CH(e,f,g) + k_90r[i] + w[i & 15];
+		t2 = EP0(a) + MAJ(a,b,c);
+		h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	ctx->state[0] += a; ctx->state[1] += b; ctx->state[2] += c; ctx->state[3] += d;
+	ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
+}
+
+#ifdef SHA256_X86_ACCEL
+// BMI2 scalar kernel for hosts without usable SIMD (CPUID picks it by
+// default, see sha256_90r_transform_default). Compiled for bmi/bmi2 whatever
+// the build flags, every rotate is a rorx (new register, no flags) and CH's
+// ~x & z is one andn; inline asm for both measured slower, as it hides them
+// from the scheduler. CH's two terms share no bits and are added rather than
+// xored. MAJ is ((a ^ b) & (b ^ c)) ^ b, and b ^ c is the previous round's
+// a ^ b, so one xor per round is carried in bc. Rounds go in interleaved
+// pairs with the working variables renamed through the macro arguments
+// instead of shifted with h = g; g = f; ..., and the second round's
+// h + K + W (its h is g, which the first round does not write) is summed
+// off the first round's critical path.
+#define BMI2_RORX(x, n) ROTRIGHT(x, n)
+#define BMI2_ANDN(x, y) (~(x) & (y))
+#define BMI2_EP0(x) (BMI2_RORX(x, 2) ^ BMI2_RORX(x, 13) ^ BMI2_RORX(x, 22))
+#define BMI2_EP1(x) (BMI2_RORX(x, 6) ^ BMI2_RORX(x, 11) ^ BMI2_RORX(x, 25))
+#define BMI2_SIG0(x) (BMI2_RORX(x, 7) ^ BMI2_RORX(x, 18) ^ ((x) >> 3))
+#define BMI2_SIG1(x) (BMI2_RORX(x, 17) ^ BMI2_RORX(x, 19) ^ ((x) >> 10))
+
+#define BMI2_ROUND(a, b, c, d, e, f, g, h, hkw) \
+	h = (hkw) + BMI2_EP1(e) + ((e) & (f)) + BMI2_ANDN(e, g); \
+	d += h; \
+	t = (a) ^ (b); \
+	h += BMI2_EP0(a) + ((t & bc) ^ (b)); \
+	bc = t
+
+// W[i] for i >= 16 is computed where it is consumed, in a 16-word ring, so
+// the schedule fills the gaps in the round dependency chain
+#define BMI2_W(i) ((i) < 16 ? w[(i) & 15] : (w[(i) & 15] += BMI2_SIG1(w[((i) - 2) & 15]) + \
+	w[((i) - 7) & 15] + BMI2_SIG0(w[((i) - 15) & 15])))
+
+#define BMI2_ROUNDS2(a, b, c, d, e, f, g, h, i) do { \
+	WORD kw0 = (h) + k_90r[i] + BMI2_W(i); \
+	WORD kw1 = (g) + k_90r[(i) + 1] + BMI2_W((i) + 1); \
+	BMI2_ROUND(a, b, c, d, e, f, g, h, kw0); \
+	BMI2_ROUND(h, a, b, c, d, e, f, g, kw1); \
+} while (0)
+
+__attribute__((target("bmi,bmi2"), optimize("O3", "unroll-loops")))
+void sha256_90r_transform_bmi2(struct sha256_90r_internal_ctx *restrict ctx, const BYTE *restrict data)
+{
+	WORD w[16];
+	WORD a, b, c, d, e, f, g, h, t, bc;
+	int i;
+
+	for (i = 0; i < 16; ++i) {
+		WORD v;
+		memcpy(&v, data + 4 * i, 4);
+		w[i] = __builtin_bswap32(v);
+	}
+
+	a = ctx->state[0]; b = ctx->state[1]; c = ctx->state[2]; d = ctx->state[3];
+	e = ctx->state[4]; f = ctx->state[5]; g = ctx->state[6]; h = ctx->state[7];
+	bc = b ^ c;
+
+	// Eight rounds bring the names back to a..h
+#pragma GCC unroll 11
+	for (i = 0; i < 88; i += 8) {
+		BMI2_ROUNDS2(a, b, c, d, e, f, g, h, i);
+		BMI2_ROUNDS2(g, h, a, b, c, d, e, f, i + 2);
+		BMI2_ROUNDS2(e, f, g, h, a, b, c, d, i + 4);
+		BMI2_ROUNDS2(c, d, e, f, g, h, a, b, i + 6);
+	}
+	BMI2_ROUNDS2(a, b, c, d, e, f, g, h, 88);
+
+	// After 90 rounds the working a..h live in g, h, a, b, c, d, e, f
+	ctx->state[0] += g; ctx->state[1] += h; ctx->state[2] += a; ctx->state[3] += b;
+	ctx->state[4] += c; ctx->state[5] += d; ctx->state[6] += e; ctx->state[7] += f;
+}
+#endif // SHA256_X86_ACCEL
+
+// Single-stream kernel picked by the autotuner. All of them are constant-time
+// (checked per kernel by tests/ct_kernels_test.c), so SECURE builds may use any.
+// Until one is selected, CPUID picks: AVX2 in FAST builds (ACCEL_MODE without
+// SECURE_MODE), else the BMI2 kernel where BMI2 exists.
+static int g_transform_kernel = SHA256_90R_KERNEL_SCALAR;
+static int g_transform_kernel_selected = 0;
+
+int sha256_90r_transform_default(void)
+{
+	detect_cpu_features();
+#if SHA256_90R_ACCEL_MODE && !SHA256_90R_SECURE_MODE && defined(USE_SIMD) && defined(__x86_64__)
+	if (g_has_avx2)
+		return SHA256_90R_KERNEL_AVX2;
+#endif
+	return g_has_bmi2 ? SHA256_90R_KERNEL_SCALAR_BMI2 : SHA256_90R_KERNEL_SCALAR;
+}
+
+int sha256_90r_transform_select(int kernel)
+{
+	switch (kernel) {
+	case SHA256_90R_KERNEL_SCALAR:
+	case SHA256_90R_KERNEL_SCALAR_ROLLING:
+		break;
+#ifdef SHA256_X86_ACCEL
+	case SHA256_90R_KERNEL_SCALAR_BMI2:
+		detect_cpu_features();
+		if (!g_has_bmi2)
+			return -1;
+		break;
+#endif
+#if defined(USE_SIMD) && defined(__x86_64__)
+	case SHA256_90R_KERNEL_AVX2:
+		detect_cpu_features();
+		if (!g_has_avx2)
+			return -1;
+		break;
+#endif
+	default:
+		return -1;
+	}
+	g_transform_kernel = kernel;
+	g_transform_kernel_selected = 1;
+	return 0;
+}
+
 __attribute__((optimize("O3", "unroll-loops", "inline-functions")))
 void sha256_90r_transform(struct sha256_90r_internal_ctx *restrict ctx, const BYTE *restrict data)
 {
@@ -417,21 +923,22 @@ void sha256_90r_transform(struct sha256_90r_internal_ctx *restrict ctx, const BY
 		debug_once = 1;
 	}
 	
-#if SHA256_90R_ACCEL_MODE && !SHA256_90R_SECURE_MODE
-#ifdef USE_SIMD
-#ifdef __x86_64__
-	// Use AVX2 if available and enabled
-	if (g_has_avx2) {
-		static int avx2_debug = 0;
-		if (!avx2_debug) {
-			printf("[SHA256-90R] Using AVX2 transform\n");
-			avx2_debug = 1;
-		}
+	if (!g_transform_kernel_selected) {
+		g_transform_kernel = sha256_90r_transform_default();
+		g_transform_kernel_selected = 1;
+	}
+#if defined(USE_SIMD) && defined(__x86_64__)
+	// Selected kernel (no secret-dependent branches or indices: allowed in SECURE builds)
+	if (g_transform_kernel == SHA256_90R_KERNEL_AVX2) {
 		sha256_90r_transform_avx2(ctx, data);
 		return;
 	}
 #endif
-#endif
+#ifdef SHA256_X86_ACCEL
+	if (g_transform_kernel == SHA256_90R_KERNEL_SCALAR_BMI2) {
+		sha256_90r_transform_bmi2(ctx, data);
+		return;
+	}
 #endif
 
 	// Fallback to scalar implementation
@@ -440,6 +947,10 @@ void sha256_90r_transform(struct sha256_90r_internal_ctx *restrict ctx, const BY
 		printf("[SHA256-90R] Using scalar transform\n");
 		scalar_debug = 1;
 	}
+	if (g_transform_kernel == SHA256_90R_KERNEL_SCALAR_ROLLING) {
+		sha256_90r_transform_scalar_rolling(ctx, data);
+		return;
+	}
 	WORD m[96] __attribute__((aligned(64))); // Extended message expansion with padding
 	WORD a, b, c, d, e, f, g, h;
 	int i;
@@ -501,35 +1012,82 @@ void sha256_90r_init_internal(struct sha256_90r_internal_ctx *ctx)
 	ctx->state[7] = 0x5be0cd19;
 }
 
-void sha256_90r_update_internal(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len)
-{
-#if SHA256_90R_SECURE_MODE
-	// Constant-time implementation for secure mode
-	size_t i;
-	for (i = 0; i < len; ++i) {
-		ctx->data[ctx->datalen] = data[i];
-		ctx->datalen++;
-
-		// Fully branchless constant-time processing
-		// Use arithmetic operations instead of branches
-		WORD should_transform = ((WORD)(ctx->datalen == 64)) - 1; // 0xFFFFFFFF if true, 0x00000000 if false
-
-		// Always perform transform but mask the state update
-		struct sha256_90r_internal_ctx temp_ctx = *ctx;
-		sha256_90r_transform(&temp_ctx, ctx->data);
-
-		// Conditionally update context state using arithmetic masking
-		WORD j;
-		for (j = 0; j < 8; ++j) {
-			ctx->state[j] = (temp_ctx.state[j] & should_transform) | (ctx->state[j] & ~should_transform);
-		}
+/*********************** STREAMING MODE ***********************/
+// Updates of at least g_stream_threshold bytes hash their full blocks
+// through sha256_90r_update_stream. 0 = not resolved yet (LLC size).
+static size_t g_stream_threshold = 0;
+static size_t g_stream_distance = SHA256_90R_STREAM_DEFAULT_DISTANCE;
+static int g_stream_hints = SHA256_90R_STREAM_PREFETCH_NTA;   // CLDEMOTE measured no better; opt-in
 
-		// Update counters using constant-time arithmetic
-		ctx->bitlen += 512 & should_transform;
-		ctx->datalen = (ctx->datalen & ~should_transform) | (0 & should_transform);
+static size_t sha256_90r_stream_threshold(void)
+{
+	if (g_stream_threshold == 0) {
+		long llc = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+		llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+		g_stream_threshold = llc > 0 ? (size_t)llc : SHA256_90R_STREAM_FALLBACK_THRESHOLD;
 	}
+	return g_stream_threshold;
+}
+
+void sha256_90r_stream_config(size_t threshold, size_t prefetch_distance, int hints)
+{
+	g_stream_threshold = threshold;
+	g_stream_distance = prefetch_distance ? prefetch_distance : SHA256_90R_STREAM_DEFAULT_DISTANCE;
+	g_stream_hints = hints;
+}
+
+void sha256_90r_stream_get_config(size_t *threshold, size_t *prefetch_distance, int *hints)
+{
+	if (threshold) *threshold = sha256_90r_stream_threshold();
+	if (prefetch_distance) *prefetch_distance = g_stream_distance;
+	if (hints) *hints = g_stream_hints;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+__attribute__((target("cldemote")))
+static inline void sha256_90r_demote_line(const BYTE *p)
+{
+	_cldemote((void *)p);
+}
 #else
-	// Fast implementation for non-secure mode
+static inline void sha256_90r_demote_line(const BYTE *p)
+{
+	(void)p;
+}
+#endif
+
+// Full blocks of a large update: input is prefetched `distance` bytes ahead
+// with a non-temporal hint (prefetchnta: no L2 fill) and each fully consumed
+// line is demoted out of the core's private caches, so a multi-GB input
+// does not displace the working set of whatever else runs on this core.
+// Addresses depend only on the data pointer, never on its contents.
+static void sha256_90r_update_stream(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t blocks)
+{
+	const size_t distance = g_stream_distance;
+	const int prefetch = (g_stream_hints & SHA256_90R_STREAM_PREFETCH_NTA) != 0;
+	const int demote = (g_stream_hints & SHA256_90R_STREAM_CLDEMOTE) && g_has_cldemote;
+	const size_t bytes = blocks * 64;
+
+	for (size_t off = 0; off < bytes; off += 64) {
+		if (prefetch && off + distance < bytes)
+			__builtin_prefetch(data + off + distance, 0, 0);
+		sha256_90r_transform(ctx, data + off);
+		// An unaligned block's last line is shared with the next block and is
+		// demoted one block later
+		if (demote)
+			sha256_90r_demote_line(data + off);
+	}
+	if (demote && ((uintptr_t)data & 63))
+		sha256_90r_demote_line(data + bytes);
+	ctx->bitlen += (unsigned long long)blocks * 512;
+}
+
+void sha256_90r_update_internal(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len)
+{
+	// Which blocks get compressed depends only on the lengths, never on the
+	// data, so the same block-wise path serves SECURE and non-secure builds
 	size_t i = 0;
 	
 	// If we have partial data in buffer, fill it first
@@ -550,6 +1108,15 @@ void sha256_90r_update_internal(struct sha256_90r_internal_ctx *ctx, const BYTE
 		}
 	}
 	
+	// Large inputs stream past the caches (length-dependent only)
+	if (len >= 64 && len >= sha256_90r_stream_threshold()) {
+		detect_cpu_features();
+		sha256_90r_update_stream(ctx, data, len / 64);
+		data += len & ~(size_t)63;
+		i += len & ~(size_t)63;
+		len &= 63;
+	}
+
 	// Process full blocks directly from input
 	while (len >= 64) {
 		sha256_90r_transform(ctx, data);
@@ -558,61 +1125,185 @@ void sha256_90r_update_internal(struct sha256_90r_internal_ctx *ctx, const BYTE
 		len -= 64;
 		i += 64;
 	}
-	
-	// Save remaining bytes
+	
+	// Save remaining bytes
+	if (len > 0) {
+		memcpy(ctx->data, data, len);
+		ctx->datalen = len;
+	}
+}
+
+/*********************** COPY AND HASH ***********************/
+// One block to dst through registers. nt: non-temporal stores (dst must be
+// 16-byte aligned), so a large destination is written without first being
+// read for ownership and without evicting the caches.
+static inline void sha256_90r_copy_block(BYTE *dst, const BYTE *src, int nt)
+{
+#ifdef SHA256_X86_ACCEL
+	__m128i v0 = _mm_loadu_si128((const __m128i *)src);
+	__m128i v1 = _mm_loadu_si128((const __m128i *)(src + 16));
+	__m128i v2 = _mm_loadu_si128((const __m128i *)(src + 32));
+	__m128i v3 = _mm_loadu_si128((const __m128i *)(src + 48));
+
+	if (nt) {
+		_mm_stream_si128((__m128i *)dst, v0);
+		_mm_stream_si128((__m128i *)(dst + 16), v1);
+		_mm_stream_si128((__m128i *)(dst + 32), v2);
+		_mm_stream_si128((__m128i *)(dst + 48), v3);
+	} else {
+		_mm_storeu_si128((__m128i *)dst, v0);
+		_mm_storeu_si128((__m128i *)(dst + 16), v1);
+		_mm_storeu_si128((__m128i *)(dst + 32), v2);
+		_mm_storeu_si128((__m128i *)(dst + 48), v3);
+	}
+#else
+	(void)nt;
+	memcpy(dst, src, 64);
+#endif
+}
+
+// sha256_90r_update_internal that also copies the input to dst. Each block
+// is read from src once: copied while it is brought in, then compressed
+// from L1. Updates past the streaming threshold use non-temporal stores
+// (when dst is 16-byte aligned) and prefetch src like the streaming path.
+void sha256_90r_copy_update_internal(struct sha256_90r_internal_ctx *ctx, BYTE dst[], const BYTE src[], size_t len)
+{
+	int nt = 0, prefetch = 0;
+
+	if (ctx->datalen > 0) {
+		size_t to_copy = 64 - ctx->datalen;
+		if (to_copy > len) to_copy = len;
+
+		memcpy(dst, src, to_copy);
+		memcpy(ctx->data + ctx->datalen, src, to_copy);
+		ctx->datalen += to_copy;
+		dst += to_copy;
+		src += to_copy;
+		len -= to_copy;
+
+		if (ctx->datalen == 64) {
+			sha256_90r_transform(ctx, ctx->data);
+			ctx->bitlen += 512;
+			ctx->datalen = 0;
+		}
+	}
+
+	if (len >= 64 && len >= sha256_90r_stream_threshold()) {
+		detect_cpu_features();
+		nt = ((uintptr_t)dst & 15) == 0;
+		prefetch = (g_stream_hints & SHA256_90R_STREAM_PREFETCH_NTA) != 0;
+	}
+
+	for (size_t off = 0, bytes = len & ~(size_t)63; off < bytes; off += 64) {
+		if (prefetch && off + g_stream_distance < bytes)
+			__builtin_prefetch(src + off + g_stream_distance, 0, 0);
+		sha256_90r_copy_block(dst + off, src + off, nt);
+		sha256_90r_transform(ctx, src + off);
+		ctx->bitlen += 512;
+	}
+#ifdef SHA256_X86_ACCEL
+	// Streamed stores are weakly ordered: make them visible before returning
+	if (nt)
+		_mm_sfence();
+#endif
+	dst += len & ~(size_t)63;
+	src += len & ~(size_t)63;
+	len &= 63;
+
+	if (len > 0) {
+		memcpy(dst, src, len);
+		memcpy(ctx->data, src, len);
+		ctx->datalen = len;
+	}
+}
+
+/*********************** ZERO BLOCKS ***********************/
+// An all-zero block expands to an all-zero 90-word schedule (sigma0 and
+// sigma1 of zero are zero), so the precomputed schedule is W = 0 and each
+// round adds K[i] alone: nothing is loaded, byte-swapped or expanded.
+__attribute__((optimize("O3", "unroll-loops")))
+static void sha256_90r_transform_zero(WORD state[8], size_t nblocks)
+{
+	for (; nblocks > 0; nblocks--) {
+		WORD a = state[0], b = state[1], c = state[2], d = state[3];
+		WORD e = state[4], f = state[5], g = state[6], h = state[7];
+		WORD t1, t2;
+		int i;
+
+#pragma GCC unroll 90
+		for (i = 0; i < 90; ++i) {
+			t1 = h + EP1(e) + CH(e,f,g) + k_90r[i];
+			t2 = EP0(a) + MAJ(a,b,c);
+			h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+		}
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+}
+
+// len zero bytes: the same result as sha256_90r_update_internal over a zero
+// buffer. The caller knows the bytes are zero (file holes); nothing is read.
+void sha256_90r_update_zeros_internal(struct sha256_90r_internal_ctx *ctx, unsigned long long len)
+{
+	size_t blocks;
+
+	if (ctx->datalen > 0) {
+		size_t fill = 64 - ctx->datalen;
+		if (fill > len) fill = (size_t)len;
+
+		memset(ctx->data + ctx->datalen, 0, fill);
+		ctx->datalen += fill;
+		len -= fill;
+		if (ctx->datalen == 64) {
+			sha256_90r_transform(ctx, ctx->data);
+			ctx->bitlen += 512;
+			ctx->datalen = 0;
+		}
+	}
+
+	blocks = (size_t)(len / 64);
+	sha256_90r_transform_zero(ctx->state, blocks);
+	ctx->bitlen += (unsigned long long)blocks * 512;
+	len &= 63;
+
 	if (len > 0) {
-		memcpy(ctx->data, data, len);
-		ctx->datalen = len;
+		memset(ctx->data, 0, (size_t)len);
+		ctx->datalen = (WORD)len;
 	}
-#endif
 }
 
-// Fast multi-block update for maximum throughput
-void sha256_90r_update_fast(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len)
+// Data read from a sparse file. Outside SECURE mode whole zero blocks (zeros
+// written out, or preallocated extents) also take the zero transform; that
+// check branches on the data, so SECURE builds hash every block normally.
+void sha256_90r_update_sparse_internal(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len)
 {
-#if SHA256_90R_FAST_MODE && defined(USE_SIMD) && defined(__x86_64__)
-	detect_cpu_features();
-	
-	size_t blocks_remaining = len / 64;
-	
-	// Process 4 blocks at a time with AVX2
-	if (g_has_avx2 && blocks_remaining >= 4) {
-		while (blocks_remaining >= 4) {
-			// Setup 4 parallel states
-			WORD states[4][8];
-			for (int i = 0; i < 4; i++) {
-				memcpy(states[i], ctx->state, sizeof(ctx->state));
-			}
-			
-			// Process 4 blocks in parallel
-			sha256_90r_transform_avx2_4way(states, (const BYTE(*)[64])data);
-			
-			// Chain the results (simplified - in production would properly chain)
-			memcpy(ctx->state, states[3], sizeof(ctx->state));
-			
-			data += 256;
-			blocks_remaining -= 4;
-			ctx->bitlen += 2048;
+#if SHA256_90R_SECURE_MODE
+	sha256_90r_update_internal(ctx, data, len);
+#else
+	size_t head = ctx->datalen ? 64 - ctx->datalen : 0;
+	size_t run = 0, off;
+
+	if (head > len) head = len;
+	sha256_90r_update_internal(ctx, data, head);
+	data += head;
+	len -= head;
+
+	// Alternate runs: non-zero blocks through the regular update, zero
+	// blocks through the zero transform
+	for (off = 0; off + 64 <= len; off += 64) {
+		uint64_t acc = 0;
+		for (int j = 0; j < 64; j += 8) {
+			uint64_t v;
+			memcpy(&v, data + off + j, 8);
+			acc |= v;
+		}
+		if (acc == 0) {
+			sha256_90r_update_internal(ctx, data + run, off - run);
+			sha256_90r_update_zeros_internal(ctx, 64);
+			run = off + 64;
 		}
 	}
-	
-	// Process remaining blocks
-	while (blocks_remaining > 0) {
-		sha256_90r_transform(ctx, data);
-		data += 64;
-		blocks_remaining--;
-		ctx->bitlen += 512;
-	}
-	
-	// Handle remaining bytes
-	size_t remaining = len % 64;
-	if (remaining > 0) {
-		memcpy(ctx->data + ctx->datalen, data, remaining);
-		ctx->datalen += remaining;
-	}
-#else
-	// Fallback to regular update
-	sha256_90r_update_internal(ctx, data, len);
+	sha256_90r_update_internal(ctx, data + run, len - run);
 #endif
 }
 
@@ -620,23 +1311,22 @@ void sha256_90r_final_internal(struct sha256_90r_internal_ctx *ctx, BYTE hash[])
 {
 	WORD i;
 
-	// TRULY BRANCHLESS CONSTANT-TIME padding using arithmetic masking
-	for (i = 0; i < 64; i++) {
-		WORD is_padding_pos = ((WORD)(i == ctx->datalen)) - 1; // 0xFFFFFFFF if true, 0x00000000 if false
-		WORD is_after_padding = ((WORD)(i > ctx->datalen)) - 1; // 0xFFFFFFFF if true, 0x00000000 if false
-		WORD preserve_data = ~(is_padding_pos | is_after_padding); // 0xFFFFFFFF if i < datalen, 0x00000000 otherwise
-
-		// Use arithmetic masking to select the correct byte value
-		BYTE original = ctx->data[i];
-		BYTE padding = 0x80;
-		BYTE zero = 0x00;
+	i = ctx->datalen;
 
-		BYTE result = (original & preserve_data) | (padding & is_padding_pos) | (zero & is_after_padding);
-		ctx->data[i] = result & 0xFF; // Ensure BYTE size
+	// Standard Merkle-Damgard padding, as in sha256_final(). The extra block
+	// is needed exactly when datalen >= 56, which only depends on the length.
+	if (ctx->datalen < 56) {
+		ctx->data[i++] = 0x80;
+		while (i < 56)
+			ctx->data[i++] = 0x00;
+	}
+	else {
+		ctx->data[i++] = 0x80;
+		while (i < 64)
+			ctx->data[i++] = 0x00;
+		sha256_90r_transform(ctx, ctx->data);
+		memset(ctx->data, 0, 56);
 	}
-
-	// Always perform transform
-	sha256_90r_transform(ctx, ctx->data);
 
 	// Append to the padding the total message's length in bits and transform.
 	ctx->bitlen += ctx->datalen * 8;
@@ -664,6 +1354,290 @@ void sha256_90r_final_internal(struct sha256_90r_internal_ctx *ctx, BYTE hash[])
 	}
 }
 
+/*********************** DUAL DIGEST (SHA-256 + SHA-256-90R) ***********************/
+// k_90r[0..63] is SHA-256's k and both hashes expand the message the same way,
+// so one schedule feeds both compression chains. While the two chaining values
+// are still equal (the first block of a message) one chain is run to round 63
+// and forked for the SHA-256 feed-forward; afterwards the chains differ and
+// their first 64 rounds are interleaved, which the out-of-order core overlaps.
+
+#define DUAL_ROUND(i, a, b, c, d, e, f, g, h, w) do { \
+	WORD t1_ = h + EP1(e) + CH(e,f,g) + k_90r[i] + (w); \
+	WORD t2_ = EP0(a) + MAJ(a,b,c); \
+	h = g; g = f; f = e; e = d + t1_; d = c; c = b; b = a; a = t1_ + t2_; \
+} while (0)
+
+__attribute__((optimize("O3", "unroll-loops")))
+void sha256_90r_dual_transform(WORD state_256[8], WORD state_90r[8], const BYTE data[], int shared)
+{
+	WORD m[96] __attribute__((aligned(64)));
+	WORD a, b, c, d, e, f, g, h;
+	int i;
+
+	for (i = 0; i < 16; ++i) {
+		m[i] = ((WORD)data[i * 4] << 24) | (data[i * 4 + 1] << 16) |
+			   (data[i * 4 + 2] << 8) | data[i * 4 + 3];
+	}
+#if defined(USE_SIMD) && defined(__x86_64__)
+	expand_message_schedule_avx2(m);
+#else
+#pragma GCC unroll 74
+	for (i = 16; i < 90; ++i) {
+		m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+	}
+#endif
+
+	a = state_90r[0]; b = state_90r[1]; c = state_90r[2]; d = state_90r[3];
+	e = state_90r[4]; f = state_90r[5]; g = state_90r[6]; h = state_90r[7];
+
+	if (shared) {
+#pragma GCC unroll 64
+		for (i = 0; i < 64; ++i)
+			DUAL_ROUND(i, a, b, c, d, e, f, g, h, m[i]);
+		state_256[0] = state_90r[0] + a; state_256[1] = state_90r[1] + b;
+		state_256[2] = state_90r[2] + c; state_256[3] = state_90r[3] + d;
+		state_256[4] = state_90r[4] + e; state_256[5] = state_90r[5] + f;
+		state_256[6] = state_90r[6] + g; state_256[7] = state_90r[7] + h;
+	} else {
+		WORD a2 = state_256[0], b2 = state_256[1], c2 = state_256[2], d2 = state_256[3];
+		WORD e2 = state_256[4], f2 = state_256[5], g2 = state_256[6], h2 = state_256[7];
+#pragma GCC unroll 64
+		for (i = 0; i < 64; ++i) {
+			DUAL_ROUND(i, a, b, c, d, e, f, g, h, m[i]);
+			DUAL_ROUND(i, a2, b2, c2, d2, e2, f2, g2, h2, m[i]);
+		}
+		state_256[0] += a2; state_256[1] += b2; state_256[2] += c2; state_256[3] += d2;
+		state_256[4] += e2; state_256[5] += f2; state_256[6] += g2; state_256[7] += h2;
+	}
+
+#pragma GCC unroll 26
+	for (i = 64; i < 90; ++i)
+		DUAL_ROUND(i, a, b, c, d, e, f, g, h, m[i]);
+
+	state_90r[0] += a; state_90r[1] += b; state_90r[2] += c; state_90r[3] += d;
+	state_90r[4] += e; state_90r[5] += f; state_90r[6] += g; state_90r[7] += h;
+}
+
+#undef DUAL_ROUND
+
+static void sha256_90r_dual_one(const BYTE *data, size_t len, BYTE hash_256[], BYTE hash_90r[])
+{
+	WORD state_256[8], state_90r[8];
+	BYTE tail[128];
+	size_t n, full = len / 64, total;
+
+	memcpy(state_256, sha256_iv, sizeof(sha256_iv));
+	memcpy(state_90r, sha256_iv, sizeof(sha256_iv));
+	total = full + sha256_pad_tail(tail, data, len);
+	for (n = 0; n < total; ++n) {
+		const BYTE *block = n < full ? data + n * 64 : tail + (n - full) * 64;
+		sha256_90r_dual_transform(state_256, state_90r, block, n == 0);
+	}
+	sha256_store_hash(state_256, hash_256);
+	sha256_store_hash(state_90r, hash_90r);
+}
+
+#ifdef SHA256_X86_ACCEL
+#define MM256_DUAL_ROUND(i, a, b, c, d, e, f, g, h, w) do { \
+	__m256i t1_ = _mm256_add_epi32(h, _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(e, 6), MM256_ROTR(e, 11)), \
+	                                                   MM256_ROTR(e, 25))); \
+	t1_ = _mm256_add_epi32(t1_, _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g))); \
+	t1_ = _mm256_add_epi32(t1_, _mm256_add_epi32(_mm256_set1_epi32((int)k_90r[i]), (w))); \
+	__m256i t2_ = _mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(a, 2), MM256_ROTR(a, 13)), \
+	                                                MM256_ROTR(a, 22)), \
+	                               _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)))); \
+	h = g; g = f; f = e; e = _mm256_add_epi32(d, t1_); d = c; c = b; b = a; a = _mm256_add_epi32(t1_, t2_); \
+} while (0)
+
+// Eight messages, one block each, both chains; states are word-major
+// ([word][lane]). shared != 0 requires state_256 == state_90r in every lane.
+__attribute__((target("avx2")))
+static void sha256_90r_dual_transform_8way(WORD state_256[8][8], WORD state_90r[8][8],
+                                           const BYTE *const blocks[8], int shared)
+{
+	const __m256i bswap = _mm256_set_epi8(12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3,
+	                                      12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3);
+	__m256i w[16], r[8], s[8], s2[8];
+	__m256i a, b, c, d, e, f, g, h;
+	int i, half;
+
+	for (half = 0; half < 2; ++half) {
+		for (i = 0; i < 8; ++i)
+			r[i] = _mm256_loadu_si256((const __m256i *)(blocks[i] + 32 * half));
+		sha256_transpose8_avx2(r);
+		for (i = 0; i < 8; ++i)
+			w[8 * half + i] = _mm256_shuffle_epi8(r[i], bswap);
+	}
+
+	for (i = 0; i < 8; ++i) {
+		s[i] = _mm256_loadu_si256((const __m256i *)state_90r[i]);
+		s2[i] = _mm256_loadu_si256((const __m256i *)state_256[i]);
+	}
+	a = s[0]; b = s[1]; c = s[2]; d = s[3]; e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+	{
+		__m256i a2 = s2[0], b2 = s2[1], c2 = s2[2], d2 = s2[3];
+		__m256i e2 = s2[4], f2 = s2[5], g2 = s2[6], h2 = s2[7];
+
+#pragma GCC unroll 16
+		for (i = 0; i < 64; ++i) {
+			if (i >= 16) {
+				__m256i w2 = w[(i - 2) & 15], w15 = w[(i - 15) & 15];
+				__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(w2, 17), MM256_ROTR(w2, 19)),
+				                              _mm256_srli_epi32(w2, 10));
+				__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(w15, 7), MM256_ROTR(w15, 18)),
+				                              _mm256_srli_epi32(w15, 3));
+				w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0),
+				                             _mm256_add_epi32(w[(i - 7) & 15], s1));
+			}
+			MM256_DUAL_ROUND(i, a, b, c, d, e, f, g, h, w[i & 15]);
+			if (!shared)
+				MM256_DUAL_ROUND(i, a2, b2, c2, d2, e2, f2, g2, h2, w[i & 15]);
+		}
+
+		if (shared) {
+			a2 = a; b2 = b; c2 = c; d2 = d; e2 = e; f2 = f; g2 = g; h2 = h;
+		}
+		_mm256_storeu_si256((__m256i *)state_256[0], _mm256_add_epi32(s2[0], a2));
+		_mm256_storeu_si256((__m256i *)state_256[1], _mm256_add_epi32(s2[1], b2));
+		_mm256_storeu_si256((__m256i *)state_256[2], _mm256_add_epi32(s2[2], c2));
+		_mm256_storeu_si256((__m256i *)state_256[3], _mm256_add_epi32(s2[3], d2));
+		_mm256_storeu_si256((__m256i *)state_256[4], _mm256_add_epi32(s2[4], e2));
+		_mm256_storeu_si256((__m256i *)state_256[5], _mm256_add_epi32(s2[5], f2));
+		_mm256_storeu_si256((__m256i *)state_256[6], _mm256_add_epi32(s2[6], g2));
+		_mm256_storeu_si256((__m256i *)state_256[7], _mm256_add_epi32(s2[7], h2));
+	}
+
+#pragma GCC unroll 26
+	for (i = 64; i < 90; ++i) {
+		__m256i w2 = w[(i - 2) & 15], w15 = w[(i - 15) & 15];
+		__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(w2, 17), MM256_ROTR(w2, 19)),
+		                              _mm256_srli_epi32(w2, 10));
+		__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(w15, 7), MM256_ROTR(w15, 18)),
+		                              _mm256_srli_epi32(w15, 3));
+		w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0),
+		                             _mm256_add_epi32(w[(i - 7) & 15], s1));
+		MM256_DUAL_ROUND(i, a, b, c, d, e, f, g, h, w[i & 15]);
+	}
+
+	_mm256_storeu_si256((__m256i *)state_90r[0], _mm256_add_epi32(s[0], a));
+	_mm256_storeu_si256((__m256i *)state_90r[1], _mm256_add_epi32(s[1], b));
+	_mm256_storeu_si256((__m256i *)state_90r[2], _mm256_add_epi32(s[2], c));
+	_mm256_storeu_si256((__m256i *)state_90r[3], _mm256_add_epi32(s[3], d));
+	_mm256_storeu_si256((__m256i *)state_90r[4], _mm256_add_epi32(s[4], e));
+	_mm256_storeu_si256((__m256i *)state_90r[5], _mm256_add_epi32(s[5], f));
+	_mm256_storeu_si256((__m256i *)state_90r[6], _mm256_add_epi32(s[6], g));
+	_mm256_storeu_si256((__m256i *)state_90r[7], _mm256_add_epi32(s[7], h));
+}
+
+#undef MM256_DUAL_ROUND
+
+// Lane scheduling as in sha256_batch_avx2(); the kernel forks after round 63
+// whenever every busy lane is on the first block of its message
+static void sha256_90r_dual_batch_avx2(const BYTE *const data[], const size_t lens[],
+                                       BYTE (*hashes_256)[SHA256_BLOCK_SIZE],
+                                       BYTE (*hashes_90r)[SHA256_BLOCK_SIZE], size_t count)
+{
+	static const BYTE idle_block[64] = {0};
+	SHA256_LANE lanes[8];
+	int active[8];
+	WORD state_256[8][8], state_90r[8][8];
+	const BYTE *blocks[8];
+	size_t pending = 0;
+	int running = 0, shared, l, w;
+
+	for (l = 0; l < 8; ++l) {
+		active[l] = 0;
+		for (w = 0; w < 8; ++w)
+			state_256[w][l] = state_90r[w][l] = sha256_iv[w];
+	}
+
+	for (;;) {
+		for (l = 0; l < 8 && pending < count; ++l) {
+			if (active[l])
+				continue;
+			lanes[l].msg = data[pending];
+			lanes[l].full = lens[pending] / 64;
+			lanes[l].total = lanes[l].full + sha256_pad_tail(lanes[l].tail, data[pending], lens[pending]);
+			lanes[l].next = 0;
+			lanes[l].index = pending++;
+			for (w = 0; w < 8; ++w)
+				state_256[w][l] = state_90r[w][l] = sha256_iv[w];
+			active[l] = 1;
+			running++;
+		}
+		if (running == 0)
+			break;
+
+		// A nearly empty batch is cheaper to finish one message at a time
+		if (pending == count && running <= 2) {
+			for (l = 0; l < 8; ++l) {
+				WORD s256[8], s90[8];
+				if (!active[l])
+					continue;
+				for (w = 0; w < 8; ++w) {
+					s256[w] = state_256[w][l];
+					s90[w] = state_90r[w][l];
+				}
+				for ( ; lanes[l].next < lanes[l].total; lanes[l].next++)
+					sha256_90r_dual_transform(s256, s90, sha256_lane_block(&lanes[l]), lanes[l].next == 0);
+				sha256_store_hash(s256, hashes_256[lanes[l].index]);
+				sha256_store_hash(s90, hashes_90r[lanes[l].index]);
+			}
+			break;
+		}
+
+		// Idle lanes hold equal states too, so they never block the fork
+		shared = 1;
+		for (l = 0; l < 8; ++l) {
+			blocks[l] = active[l] ? sha256_lane_block(&lanes[l]) : idle_block;
+			if (active[l] && lanes[l].next != 0)
+				shared = 0;
+		}
+		if (shared) {
+			for (l = 0; l < 8; ++l) {
+				if (!active[l]) {
+					for (w = 0; w < 8; ++w)
+						state_256[w][l] = state_90r[w][l];
+				}
+			}
+		}
+		sha256_90r_dual_transform_8way(state_256, state_90r, blocks, shared);
+
+		for (l = 0; l < 8; ++l) {
+			WORD lane_state[8];
+			if (!active[l] || ++lanes[l].next < lanes[l].total)
+				continue;
+			for (w = 0; w < 8; ++w)
+				lane_state[w] = state_256[w][l];
+			sha256_store_hash(lane_state, hashes_256[lanes[l].index]);
+			for (w = 0; w < 8; ++w)
+				lane_state[w] = state_90r[w][l];
+			sha256_store_hash(lane_state, hashes_90r[lanes[l].index]);
+			active[l] = 0;
+			running--;
+		}
+	}
+}
+#endif // SHA256_X86_ACCEL
+
+void sha256_90r_dual_batch_internal(const BYTE *const data[], const size_t lens[],
+                                    BYTE (*hashes_256)[SHA256_BLOCK_SIZE],
+                                    BYTE (*hashes_90r)[SHA256_BLOCK_SIZE], size_t count)
+{
+	size_t n;
+
+#ifdef SHA256_X86_ACCEL
+	detect_cpu_features();
+	if (g_has_avx2 && count > 2) {
+		sha256_90r_dual_batch_avx2(data, lens, hashes_256, hashes_90r, count);
+		return;
+	}
+#endif
+	for (n = 0; n < count; ++n)
+		sha256_90r_dual_one(data[n], lens[n], hashes_256[n], hashes_90r[n]);
+}
+
 #ifdef USE_SIMD
 
 // SIMD-accelerated transform using AVX2 for x86_64
@@ -814,297 +1788,275 @@ void sha256_90r_transform_avx2_4way(WORD states[4][8], const BYTE data[4][64])
 	states[0][7] = temp[0]; states[1][7] = temp[1]; states[2][7] = temp[2]; states[3][7] = temp[3];
 }
 
-// Aggressive AVX2 8-way multi-block processing
+// Multi-block kernels come in two schedule variants. The plain ones expand
+// all 90 W words into a stack array before the rounds (one store and one
+// reload per word); the _rolling ones keep a 16-word window where W[i]
+// overwrites W[i-16] and is computed just before the round that uses it.
+#define MM256_90R_ROUND(i, w) do { \
+	__m256i t1_ = _mm256_add_epi32(h, _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(e, 6), MM256_ROTR(e, 11)), \
+	                                                   MM256_ROTR(e, 25))); \
+	t1_ = _mm256_add_epi32(t1_, _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g))); \
+	t1_ = _mm256_add_epi32(t1_, _mm256_add_epi32(_mm256_set1_epi32((int)k_90r[i]), (w))); \
+	__m256i t2_ = _mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(a, 2), MM256_ROTR(a, 13)), \
+	                                                MM256_ROTR(a, 22)), \
+	                               _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)))); \
+	h = g; g = f; f = e; e = _mm256_add_epi32(d, t1_); d = c; c = b; b = a; a = _mm256_add_epi32(t1_, t2_); \
+} while (0)
+
+// Message words 0..15 of eight blocks, word-major (w[i] = word i of lanes 0..7).
+// Shared with the round-count variant kernels (sha256_90r_variant.c).
 __attribute__((target("avx2")))
-void sha256_90r_transform_avx2_8way(struct sha256_90r_internal_ctx ctxs[8], const BYTE data[8][64])
+void sha256_90r_load_msg_8way(const BYTE *const blocks[8], __m256i w[16])
+{
+	const __m256i bswap = _mm256_set_epi8(12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3,
+	                                      12,13,14,15, 8,9,10,11, 4,5,6,7, 0,1,2,3);
+	__m256i r[8];
+	int i, half;
+
+	for (half = 0; half < 2; ++half) {
+		for (i = 0; i < 8; ++i)
+			r[i] = _mm256_loadu_si256((const __m256i *)(blocks[i] + 32 * half));
+		sha256_transpose8_avx2(r);
+		for (i = 0; i < 8; ++i)
+			w[8 * half + i] = _mm256_shuffle_epi8(r[i], bswap);
+	}
+}
+
+// Chaining values of eight contexts in and out, word-major
+__attribute__((target("avx2")))
+static inline void sha256_90r_load_state_8way(const struct sha256_90r_internal_ctx ctxs[8], __m256i s[8])
+{
+	for (int i = 0; i < 8; ++i)
+		s[i] = _mm256_loadu_si256((const __m256i *)ctxs[i].state);
+	sha256_transpose8_avx2(s);
+}
+
+__attribute__((target("avx2")))
+static inline void sha256_90r_store_state_8way(struct sha256_90r_internal_ctx ctxs[8], __m256i s[8])
 {
-	// Pre-expanded message schedules for all 8 blocks (kept in registers)
-	__m256i m0_0, m0_1, m0_2, m0_3, m0_4, m0_5, m0_6, m0_7, m0_8, m0_9, m0_10, m0_11;
-	__m256i m1_0, m1_1, m1_2, m1_3, m1_4, m1_5, m1_6, m1_7, m1_8, m1_9, m1_10, m1_11;
-	__m256i m2_0, m2_1, m2_2, m2_3, m2_4, m2_5, m2_6, m2_7, m2_8, m2_9, m2_10, m2_11;
-	__m256i m3_0, m3_1, m3_2, m3_3, m3_4, m3_5, m3_6, m3_7, m3_8, m3_9, m3_10, m3_11;
-	__m256i m4_0, m4_1, m4_2, m4_3, m4_4, m4_5, m4_6, m4_7, m4_8, m4_9, m4_10, m4_11;
-	__m256i m5_0, m5_1, m5_2, m5_3, m5_4, m5_5, m5_6, m5_7, m5_8, m5_9, m5_10, m5_11;
-	__m256i m6_0, m6_1, m6_2, m6_3, m6_4, m6_5, m6_6, m6_7, m6_8, m6_9, m6_10, m6_11;
-	__m256i m7_0, m7_1, m7_2, m7_3, m7_4, m7_5, m7_6, m7_7, m7_8, m7_9, m7_10, m7_11;
+	sha256_transpose8_avx2(s);
+	for (int i = 0; i < 8; ++i)
+		_mm256_storeu_si256((__m256i *)ctxs[i].state, s[i]);
+}
 
+// AVX2 8-way: one block for each of eight contexts, schedule pre-expanded
+__attribute__((target("avx2")))
+void sha256_90r_transform_avx2_8way(struct sha256_90r_internal_ctx ctxs[8], const BYTE data[8][64])
+{
+	const BYTE *blocks[8] = {data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]};
+	__m256i w[90], s[8];
+	__m256i a, b, c, d, e, f, g, h;
 	int i;
 
-	// Load and expand message schedules for all 8 blocks simultaneously
-	for (i = 0; i < 16; ++i) {
-		// Load 8 words from different blocks into SIMD registers
-		__m256i word = _mm256_set_epi32(
-			(data[7][i*4] << 24) | (data[7][i*4+1] << 16) | (data[7][i*4+2] << 8) | data[7][i*4+3],
-			(data[6][i*4] << 24) | (data[6][i*4+1] << 16) | (data[6][i*4+2] << 8) | data[6][i*4+3],
-			(data[5][i*4] << 24) | (data[5][i*4+1] << 16) | (data[5][i*4+2] << 8) | data[5][i*4+3],
-			(data[4][i*4] << 24) | (data[4][i*4+1] << 16) | (data[4][i*4+2] << 8) | data[4][i*4+3],
-			(data[3][i*4] << 24) | (data[3][i*4+1] << 16) | (data[3][i*4+2] << 8) | data[3][i*4+3],
-			(data[2][i*4] << 24) | (data[2][i*4+1] << 16) | (data[2][i*4+2] << 8) | data[2][i*4+3],
-			(data[1][i*4] << 24) | (data[1][i*4+1] << 16) | (data[1][i*4+2] << 8) | data[1][i*4+3],
-			(data[0][i*4] << 24) | (data[0][i*4+1] << 16) | (data[0][i*4+2] << 8) | data[0][i*4+3]
-		);
+	sha256_90r_load_msg_8way(blocks, w);
+	for (i = 16; i < 90; ++i) {
+		w[i] = _mm256_add_epi32(_mm256_add_epi32(MM256_90R_SIG1(w[i - 2]), w[i - 7]),
+		                        _mm256_add_epi32(MM256_90R_SIG0(w[i - 15]), w[i - 16]));
+	}
 
-		// Store in register groups for message expansion
-		switch (i % 12) {
-			case 0: m0_0 = word; break;
-			case 1: m0_1 = word; break;
-			case 2: m0_2 = word; break;
-			case 3: m0_3 = word; break;
-			case 4: m0_4 = word; break;
-			case 5: m0_5 = word; break;
-			case 6: m0_6 = word; break;
-			case 7: m0_7 = word; break;
-			case 8: m0_8 = word; break;
-			case 9: m0_9 = word; break;
-			case 10: m0_10 = word; break;
-			case 11: m0_11 = word; break;
-		}
+	sha256_90r_load_state_8way(ctxs, s);
+	a = s[0]; b = s[1]; c = s[2]; d = s[3]; e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+#pragma GCC unroll 90
+	for (i = 0; i < 90; ++i) {
+		MM256_90R_ROUND(i, w[i]);
 	}
 
-	// Vectorized message expansion for all blocks
-	__m256i sig0_vec, sig1_vec;
-	for (i = 16; i < 90; i += 8) {
-		int reg_idx = (i - 16) / 8;
-
-		// Load input vectors for SIG0/SIG1 (w0 = m[i-15], w1 = m[i-2], w2 = m[i-16], w3 = m[i-7])
-		__m256i w0, w1, w2, w3;
-		switch (reg_idx % 12) {
-			case 0: w0 = m0_0; w1 = m0_1; w2 = m0_2; w3 = m0_3; break;
-			case 1: w0 = m1_0; w1 = m1_1; w2 = m1_2; w3 = m1_3; break;
-			case 2: w0 = m2_0; w1 = m2_1; w2 = m2_2; w3 = m2_3; break;
-			case 3: w0 = m3_0; w1 = m3_1; w2 = m3_2; w3 = m3_3; break;
-			case 4: w0 = m4_0; w1 = m4_1; w2 = m4_2; w3 = m4_3; break;
-			case 5: w0 = m5_0; w1 = m5_1; w2 = m5_2; w3 = m5_3; break;
-			case 6: w0 = m6_0; w1 = m6_1; w2 = m6_2; w3 = m6_3; break;
-			case 7: w0 = m7_0; w1 = m7_1; w2 = m7_2; w3 = m7_3; break;
-		}
+	s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+	s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+	s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+	s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+	sha256_90r_store_state_8way(ctxs, s);
+}
+
+// 90 rolling-schedule rounds over word-major state s[8], feed-forward included
+__attribute__((target("avx2"), always_inline))
+static inline void sha256_90r_rounds_8way_rolling(__m256i s[8], __m256i w[16])
+{
+	__m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+	int i;
 
-		// Compute SIG0 and SIG1 in parallel for all 8 blocks
-		sig0_vec = vectorized_sig0(w0);
-		sig1_vec = vectorized_sig1(w1);
-
-		// Combine: m[i] = SIG1(m[i-2]) + m[i-7] + SIG0(m[i-15]) + m[i-16]
-		w0 = _mm256_add_epi32(sig1_vec, w3);
-		w0 = _mm256_add_epi32(w0, sig0_vec);
-		w0 = _mm256_add_epi32(w0, w2);
-
-		// Store expanded words back to registers
-		switch (reg_idx % 12) {
-			case 0: m0_0 = w0; break;
-			case 1: m1_0 = w0; break;
-			case 2: m2_0 = w0; break;
-			case 3: m3_0 = w0; break;
-			case 4: m4_0 = w0; break;
-			case 5: m5_0 = w0; break;
-			case 6: m6_0 = w0; break;
-			case 7: m7_0 = w0; break;
+#pragma GCC unroll 90
+	for (i = 0; i < 90; ++i) {
+		if (i >= 16) {
+			w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], MM256_90R_SIG0(w[(i - 15) & 15])),
+			                             _mm256_add_epi32(w[(i - 7) & 15], MM256_90R_SIG1(w[(i - 2) & 15])));
 		}
+		MM256_90R_ROUND(i, w[i & 15]);
+	}
+
+	s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+	s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+	s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+	s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+}
+
+// AVX2 8-way with a rolling 16-word schedule window
+__attribute__((target("avx2")))
+void sha256_90r_transform_avx2_8way_rolling(struct sha256_90r_internal_ctx ctxs[8], const BYTE data[8][64])
+{
+	const BYTE *blocks[8] = {data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]};
+	__m256i w[16], s[8];
+
+	sha256_90r_load_msg_8way(blocks, w);
+	sha256_90r_load_state_8way(ctxs, s);
+	sha256_90r_rounds_8way_rolling(s, w);
+	sha256_90r_store_state_8way(ctxs, s);
+}
+
+// Word-major entry point for lane schedulers: state[word][lane], one block
+// pointer per lane (rolling schedule)
+__attribute__((target("avx2")))
+void sha256_90r_blocks_avx2_8way(WORD state[8][8], const BYTE *const blocks[8])
+{
+	__m256i w[16], s[8];
+	int i;
+
+	sha256_90r_load_msg_8way(blocks, w);
+	for (i = 0; i < 8; ++i)
+		s[i] = _mm256_loadu_si256((const __m256i *)state[i]);
+	sha256_90r_rounds_8way_rolling(s, w);
+	for (i = 0; i < 8; ++i)
+		_mm256_storeu_si256((__m256i *)state[i], s[i]);
+}
+
+#undef MM256_90R_ROUND
+
+// AVX-512 16-way (runtime-dispatched: callers check for AVX-512F).
+// Native rotates; 0x96 = x ^ y ^ z, 0xCA = CH, 0xE8 = MAJ in ternary logic.
+#define MM512_90R_ROUND(i, w) do { \
+	__m512i t1_ = _mm512_add_epi32(h, _mm512_ternarylogic_epi32(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11), \
+	                                                            _mm512_ror_epi32(e, 25), 0x96)); \
+	t1_ = _mm512_add_epi32(t1_, _mm512_ternarylogic_epi32(e, f, g, 0xCA)); \
+	t1_ = _mm512_add_epi32(t1_, _mm512_add_epi32(_mm512_set1_epi32((int)k_90r[i]), (w))); \
+	__m512i t2_ = _mm512_add_epi32(_mm512_ternarylogic_epi32(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13), \
+	                                                         _mm512_ror_epi32(a, 22), 0x96), \
+	                               _mm512_ternarylogic_epi32(a, b, c, 0xE8)); \
+	h = g; g = f; f = e; e = _mm512_add_epi32(d, t1_); d = c; c = b; b = a; a = _mm512_add_epi32(t1_, t2_); \
+} while (0)
+
+// Lanes 0-7 and 8-15 go through the 8x8 AVX2 transposes and are joined
+__attribute__((target("avx512f")))
+void sha256_90r_load_msg_16way(const BYTE *const blocks[16], __m512i w[16])
+{
+	__m256i lo[16], hi[16];
+
+	sha256_90r_load_msg_8way(blocks, lo);
+	sha256_90r_load_msg_8way(blocks + 8, hi);
+	for (int i = 0; i < 16; ++i)
+		w[i] = _mm512_inserti64x4(_mm512_castsi256_si512(lo[i]), hi[i], 1);
+}
+
+__attribute__((target("avx512f")))
+static inline void sha256_90r_load_state_16way(const struct sha256_90r_internal_ctx ctxs[16], __m512i s[8])
+{
+	__m256i lo[8], hi[8];
+
+	sha256_90r_load_state_8way(ctxs, lo);
+	sha256_90r_load_state_8way(ctxs + 8, hi);
+	for (int i = 0; i < 8; ++i)
+		s[i] = _mm512_inserti64x4(_mm512_castsi256_si512(lo[i]), hi[i], 1);
+}
+
+__attribute__((target("avx512f")))
+static inline void sha256_90r_store_state_16way(struct sha256_90r_internal_ctx ctxs[16], const __m512i s[8])
+{
+	__m256i lo[8], hi[8];
+
+	for (int i = 0; i < 8; ++i) {
+		lo[i] = _mm512_castsi512_si256(s[i]);
+		hi[i] = _mm512_extracti64x4_epi64(s[i], 1);
 	}
+	sha256_90r_store_state_8way(ctxs, lo);
+	sha256_90r_store_state_8way(ctxs + 8, hi);
+}
 
-	// Load state variables for all 8 contexts
-	__m256i a = _mm256_set_epi32(ctxs[7].state[0], ctxs[6].state[0], ctxs[5].state[0], ctxs[4].state[0],
-								 ctxs[3].state[0], ctxs[2].state[0], ctxs[1].state[0], ctxs[0].state[0]);
-	__m256i b = _mm256_set_epi32(ctxs[7].state[1], ctxs[6].state[1], ctxs[5].state[1], ctxs[4].state[1],
-								 ctxs[3].state[1], ctxs[2].state[1], ctxs[1].state[1], ctxs[0].state[1]);
-	__m256i c = _mm256_set_epi32(ctxs[7].state[2], ctxs[6].state[2], ctxs[5].state[2], ctxs[4].state[2],
-								 ctxs[3].state[2], ctxs[2].state[2], ctxs[1].state[2], ctxs[0].state[2]);
-	__m256i d = _mm256_set_epi32(ctxs[7].state[3], ctxs[6].state[3], ctxs[5].state[3], ctxs[4].state[3],
-								 ctxs[3].state[3], ctxs[2].state[3], ctxs[1].state[3], ctxs[0].state[3]);
-	__m256i e = _mm256_set_epi32(ctxs[7].state[4], ctxs[6].state[4], ctxs[5].state[4], ctxs[4].state[4],
-								 ctxs[3].state[4], ctxs[2].state[4], ctxs[1].state[4], ctxs[0].state[4]);
-	__m256i f = _mm256_set_epi32(ctxs[7].state[5], ctxs[6].state[5], ctxs[5].state[5], ctxs[4].state[5],
-								 ctxs[3].state[5], ctxs[2].state[5], ctxs[1].state[5], ctxs[0].state[5]);
-	__m256i g = _mm256_set_epi32(ctxs[7].state[6], ctxs[6].state[6], ctxs[5].state[6], ctxs[4].state[6],
-								 ctxs[3].state[6], ctxs[2].state[6], ctxs[1].state[6], ctxs[0].state[6]);
-	__m256i h = _mm256_set_epi32(ctxs[7].state[7], ctxs[6].state[7], ctxs[5].state[7], ctxs[4].state[7],
-								 ctxs[3].state[7], ctxs[2].state[7], ctxs[1].state[7], ctxs[0].state[7]);
-
-	// Load constants for vectorized operations
-	__m256i k_vec;
-
-	// Optimized compression loop with interleaved rounds for better ILP
-	// Pre-compute constants to reduce per-round overhead
-#define SHA256_90R_AVX2_ROUND(m_vec, k_const) \
-	{ \
-		k_vec = _mm256_set1_epi32(k_const); \
-		__m256i t1 = _mm256_add_epi32(h, _mm256_add_epi32( \
-			_mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi32(e, 6), _mm256_srli_epi32(e, 11)), _mm256_srli_epi32(e, 25)), \
-			_mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g))), _mm256_add_epi32(k_vec, m_vec))); \
-		__m256i t2 = _mm256_add_epi32( \
-			_mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi32(a, 2), _mm256_srli_epi32(a, 13)), _mm256_srli_epi32(a, 22)), \
-			_mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)), _mm256_and_si256(b, c))); \
-		h = g; g = f; f = e; e = _mm256_add_epi32(d, t1); \
-		d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2); \
-	}
-
-	// Execute rounds with minimal register pressure (interleave 2-3 rounds)
-	SHA256_90R_AVX2_ROUND(m0_0, k_90r[0])
-	SHA256_90R_AVX2_ROUND(m0_1, k_90r[1])
-	SHA256_90R_AVX2_ROUND(m0_2, k_90r[2])
-	SHA256_90R_AVX2_ROUND(m0_3, k_90r[3])
-	SHA256_90R_AVX2_ROUND(m0_4, k_90r[4])
-	SHA256_90R_AVX2_ROUND(m0_5, k_90r[5])
-	SHA256_90R_AVX2_ROUND(m0_6, k_90r[6])
-	SHA256_90R_AVX2_ROUND(m0_7, k_90r[7])
-	SHA256_90R_AVX2_ROUND(m0_8, k_90r[8])
-	SHA256_90R_AVX2_ROUND(m0_9, k_90r[9])
-	SHA256_90R_AVX2_ROUND(m0_10, k_90r[10])
-	SHA256_90R_AVX2_ROUND(m0_11, k_90r[11])
-	SHA256_90R_AVX2_ROUND(m0_0, k_90r[12])  // Reuse register for expanded words
-	SHA256_90R_AVX2_ROUND(m0_0, k_90r[13])
-	SHA256_90R_AVX2_ROUND(m0_0, k_90r[14])
-	SHA256_90R_AVX2_ROUND(m0_0, k_90r[15])
-	// Continue with remaining 74 rounds...
-	// (All expanded words use the same register to minimize spills)
-
-#undef SHA256_90R_AVX2_ROUND
-
-	// Store final states back to contexts
-	uint32_t a_arr[8], b_arr[8], c_arr[8], d_arr[8], e_arr[8], f_arr[8], g_arr[8], h_arr[8];
-	_mm256_storeu_si256((__m256i*)a_arr, a);
-	_mm256_storeu_si256((__m256i*)b_arr, b);
-	_mm256_storeu_si256((__m256i*)c_arr, c);
-	_mm256_storeu_si256((__m256i*)d_arr, d);
-	_mm256_storeu_si256((__m256i*)e_arr, e);
-	_mm256_storeu_si256((__m256i*)f_arr, f);
-	_mm256_storeu_si256((__m256i*)g_arr, g);
-	_mm256_storeu_si256((__m256i*)h_arr, h);
-
-	for (int j = 0; j < 8; ++j) {
-		ctxs[j].state[0] += a_arr[7-j]; // Reverse order due to AVX2 layout
-		ctxs[j].state[1] += b_arr[7-j];
-		ctxs[j].state[2] += c_arr[7-j];
-		ctxs[j].state[3] += d_arr[7-j];
-		ctxs[j].state[4] += e_arr[7-j];
-		ctxs[j].state[5] += f_arr[7-j];
-		ctxs[j].state[6] += g_arr[7-j];
-		ctxs[j].state[7] += h_arr[7-j];
-	}
-}
-
-// AVX-512 16-way multi-block processing (when available)
-#ifdef __AVX512F__
+// AVX-512 16-way: one block for each of sixteen contexts, schedule pre-expanded
 __attribute__((target("avx512f")))
 void sha256_90r_transform_avx512_16way(struct sha256_90r_internal_ctx ctxs[16], const BYTE data[16][64])
 {
-	// AVX-512 16-way parallel processing with optimal register usage
-	// Keep W[t] words in registers, avoid spills, full unroll 90 rounds
-	__m512i w[32]; // 32 registers for W[0] to W[31], reused for expansion
-
+	const BYTE *blocks[16];
+	__m512i w[90], s[8];
+	__m512i a, b, c, d, e, f, g, h;
 	int i;
 
-	// Load initial 16 message words directly into AVX-512 registers
-	for (i = 0; i < 16; ++i) {
-		w[i] = _mm512_set_epi32(
-			(data[15][i*4] << 24) | (data[15][i*4+1] << 16) | (data[15][i*4+2] << 8) | data[15][i*4+3],
-			(data[14][i*4] << 24) | (data[14][i*4+1] << 16) | (data[14][i*4+2] << 8) | data[14][i*4+3],
-			(data[13][i*4] << 24) | (data[13][i*4+1] << 16) | (data[13][i*4+2] << 8) | data[13][i*4+3],
-			(data[12][i*4] << 24) | (data[12][i*4+1] << 16) | (data[12][i*4+2] << 8) | data[12][i*4+3],
-			(data[11][i*4] << 24) | (data[11][i*4+1] << 16) | (data[11][i*4+2] << 8) | data[11][i*4+3],
-			(data[10][i*4] << 24) | (data[10][i*4+1] << 16) | (data[10][i*4+2] << 8) | data[10][i*4+3],
-			(data[9][i*4] << 24) | (data[9][i*4+1] << 16) | (data[9][i*4+2] << 8) | data[9][i*4+3],
-			(data[8][i*4] << 24) | (data[8][i*4+1] << 16) | (data[8][i*4+2] << 8) | data[8][i*4+3],
-			(data[7][i*4] << 24) | (data[7][i*4+1] << 16) | (data[7][i*4+2] << 8) | data[7][i*4+3],
-			(data[6][i*4] << 24) | (data[6][i*4+1] << 16) | (data[6][i*4+2] << 8) | data[6][i*4+3],
-			(data[5][i*4] << 24) | (data[5][i*4+1] << 16) | (data[5][i*4+2] << 8) | data[5][i*4+3],
-			(data[4][i*4] << 24) | (data[4][i*4+1] << 16) | (data[4][i*4+2] << 8) | data[4][i*4+3],
-			(data[3][i*4] << 24) | (data[3][i*4+1] << 16) | (data[3][i*4+2] << 8) | data[3][i*4+3],
-			(data[2][i*4] << 24) | (data[2][i*4+1] << 16) | (data[2][i*4+2] << 8) | data[2][i*4+3],
-			(data[1][i*4] << 24) | (data[1][i*4+1] << 16) | (data[1][i*4+2] << 8) | data[1][i*4+3],
-			(data[0][i*4] << 24) | (data[0][i*4+1] << 16) | (data[0][i*4+2] << 8) | data[0][i*4+3]
-		);
+	for (i = 0; i < 16; ++i)
+		blocks[i] = data[i];
+	sha256_90r_load_msg_16way(blocks, w);
+	for (i = 16; i < 90; ++i) {
+		w[i] = _mm512_add_epi32(_mm512_add_epi32(MM512_90R_SIG1(w[i - 2]), w[i - 7]),
+		                        _mm512_add_epi32(MM512_90R_SIG0(w[i - 15]), w[i - 16]));
 	}
 
-	// Expand message schedule in registers (compute W[16] to W[89])
-	// Interleave SIG0/SIG1 for better ILP
-	for (i = 16; i < 90; i += 8) {
-		int base = i - 16;
-		w[i] = _mm512_add_epi32(_mm512_add_epi32(
-			_mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi32(w[base+14], 7), _mm512_srli_epi32(w[base+14], 18)), _mm512_srli_epi32(w[base+14], 3)),
-			_mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi32(w[base+1], 17), _mm512_srli_epi32(w[base+1], 19)), _mm512_srli_epi32(w[base+1], 10))),
-			_mm512_add_epi32(w[base], w[base+9]));
-		// Continue expanding...
-	}
-
-	// Load state variables for all 16 contexts
-	__m512i a = _mm512_set_epi32(ctxs[15].state[0], ctxs[14].state[0], ctxs[13].state[0], ctxs[12].state[0],
-								 ctxs[11].state[0], ctxs[10].state[0], ctxs[9].state[0], ctxs[8].state[0],
-								 ctxs[7].state[0], ctxs[6].state[0], ctxs[5].state[0], ctxs[4].state[0],
-								 ctxs[3].state[0], ctxs[2].state[0], ctxs[1].state[0], ctxs[0].state[0]);
-	__m512i b = _mm512_set_epi32(ctxs[15].state[1], ctxs[14].state[1], ctxs[13].state[1], ctxs[12].state[1],
-								 ctxs[11].state[1], ctxs[10].state[1], ctxs[9].state[1], ctxs[8].state[1],
-								 ctxs[7].state[1], ctxs[6].state[1], ctxs[5].state[1], ctxs[4].state[1],
-								 ctxs[3].state[1], ctxs[2].state[1], ctxs[1].state[1], ctxs[0].state[1]);
-	__m512i c = _mm512_set_epi32(ctxs[15].state[2], ctxs[14].state[2], ctxs[13].state[2], ctxs[12].state[2],
-								 ctxs[11].state[2], ctxs[10].state[2], ctxs[9].state[2], ctxs[8].state[2],
-								 ctxs[7].state[2], ctxs[6].state[2], ctxs[5].state[2], ctxs[4].state[2],
-								 ctxs[3].state[2], ctxs[2].state[2], ctxs[1].state[2], ctxs[0].state[2]);
-	__m512i d = _mm512_set_epi32(ctxs[15].state[3], ctxs[14].state[3], ctxs[13].state[3], ctxs[12].state[3],
-								 ctxs[11].state[3], ctxs[10].state[3], ctxs[9].state[3], ctxs[8].state[3],
-								 ctxs[7].state[3], ctxs[6].state[3], ctxs[5].state[3], ctxs[4].state[3],
-								 ctxs[3].state[3], ctxs[2].state[3], ctxs[1].state[3], ctxs[0].state[3]);
-	__m512i e = _mm512_set_epi32(ctxs[15].state[4], ctxs[14].state[4], ctxs[13].state[4], ctxs[12].state[4],
-								 ctxs[11].state[4], ctxs[10].state[4], ctxs[9].state[4], ctxs[8].state[4],
-								 ctxs[7].state[4], ctxs[6].state[4], ctxs[5].state[4], ctxs[4].state[4],
-								 ctxs[3].state[4], ctxs[2].state[4], ctxs[1].state[4], ctxs[0].state[4]);
-	__m512i f = _mm512_set_epi32(ctxs[15].state[5], ctxs[14].state[5], ctxs[13].state[5], ctxs[12].state[5],
-								 ctxs[11].state[5], ctxs[10].state[5], ctxs[9].state[5], ctxs[8].state[5],
-								 ctxs[7].state[5], ctxs[6].state[5], ctxs[5].state[5], ctxs[4].state[5],
-								 ctxs[3].state[5], ctxs[2].state[5], ctxs[1].state[5], ctxs[0].state[5]);
-	__m512i g = _mm512_set_epi32(ctxs[15].state[6], ctxs[14].state[6], ctxs[13].state[6], ctxs[12].state[6],
-								 ctxs[11].state[6], ctxs[10].state[6], ctxs[9].state[6], ctxs[8].state[6],
-								 ctxs[7].state[6], ctxs[6].state[6], ctxs[5].state[6], ctxs[4].state[6],
-								 ctxs[3].state[6], ctxs[2].state[6], ctxs[1].state[6], ctxs[0].state[6]);
-	__m512i h = _mm512_set_epi32(ctxs[15].state[7], ctxs[14].state[7], ctxs[13].state[7], ctxs[12].state[7],
-								 ctxs[11].state[7], ctxs[10].state[7], ctxs[9].state[7], ctxs[8].state[7],
-								 ctxs[7].state[7], ctxs[6].state[7], ctxs[5].state[7], ctxs[4].state[7],
-								 ctxs[3].state[7], ctxs[2].state[7], ctxs[1].state[7], ctxs[0].state[7]);
-
-	// Fully unrolled compression loop with AVX-512 intrinsics
-	// Interleave 2-3 rounds for optimal ILP
-#define SHA256_90R_AVX512_ROUND(w_idx, k_const) \
-	{ \
-		__m512i k_vec = _mm512_set1_epi32(k_const); \
-		__m512i t1 = _mm512_add_epi32(h, _mm512_add_epi32( \
-			_mm512_add_epi32(_mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi32(e, 6), _mm512_srli_epi32(e, 11)), _mm512_srli_epi32(e, 25)), \
-			_mm512_xor_si512(_mm512_and_si512(e, f), _mm512_andnot_si512(e, g))), _mm512_add_epi32(k_vec, w[w_idx]))); \
-		__m512i t2 = _mm512_add_epi32( \
-			_mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi32(a, 2), _mm512_srli_epi32(a, 13)), _mm512_srli_epi32(a, 22)), \
-			_mm512_xor_si512(_mm512_xor_si512(_mm512_and_si512(a, b), _mm512_and_si512(a, c)), _mm512_and_si512(b, c))); \
-		h = g; g = f; f = e; e = _mm512_add_epi32(d, t1); \
-		d = c; c = b; b = a; a = _mm512_add_epi32(t1, t2); \
-	}
-
-	// Execute all 90 rounds with full unroll
+	sha256_90r_load_state_16way(ctxs, s);
+	a = s[0]; b = s[1]; c = s[2]; d = s[3]; e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+#pragma GCC unroll 90
 	for (i = 0; i < 90; ++i) {
-		SHA256_90R_AVX512_ROUND(i % 32, k_90r[i]); // Reuse w[] registers circularly
+		MM512_90R_ROUND(i, w[i]);
 	}
 
-#undef SHA256_90R_AVX512_ROUND
+	s[0] = _mm512_add_epi32(s[0], a); s[1] = _mm512_add_epi32(s[1], b);
+	s[2] = _mm512_add_epi32(s[2], c); s[3] = _mm512_add_epi32(s[3], d);
+	s[4] = _mm512_add_epi32(s[4], e); s[5] = _mm512_add_epi32(s[5], f);
+	s[6] = _mm512_add_epi32(s[6], g); s[7] = _mm512_add_epi32(s[7], h);
+	sha256_90r_store_state_16way(ctxs, s);
+}
 
-	// Store final states back to contexts
-	uint32_t a_arr[16], b_arr[16], c_arr[16], d_arr[16], e_arr[16], f_arr[16], g_arr[16], h_arr[16];
-	_mm512_storeu_si512((__m512i*)a_arr, a);
-	_mm512_storeu_si512((__m512i*)b_arr, b);
-	_mm512_storeu_si512((__m512i*)c_arr, c);
-	_mm512_storeu_si512((__m512i*)d_arr, d);
-	_mm512_storeu_si512((__m512i*)e_arr, e);
-	_mm512_storeu_si512((__m512i*)f_arr, f);
-	_mm512_storeu_si512((__m512i*)g_arr, g);
-	_mm512_storeu_si512((__m512i*)h_arr, h);
+// 90 rolling-schedule rounds over word-major state s[8], feed-forward included
+// (32 zmm registers hold the window and the working state together)
+__attribute__((target("avx512f"), always_inline))
+static inline void sha256_90r_rounds_16way_rolling(__m512i s[8], __m512i w[16])
+{
+	__m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+	int i;
 
-	for (int j = 0; j < 16; ++j) {
-		ctxs[j].state[0] += a_arr[15-j]; // Reverse order due to AVX-512 layout
-		ctxs[j].state[1] += b_arr[15-j];
-		ctxs[j].state[2] += c_arr[15-j];
-		ctxs[j].state[3] += d_arr[15-j];
-		ctxs[j].state[4] += e_arr[15-j];
-		ctxs[j].state[5] += f_arr[15-j];
-		ctxs[j].state[6] += g_arr[15-j];
-		ctxs[j].state[7] += h_arr[15-j];
+#pragma GCC unroll 90
+	for (i = 0; i < 90; ++i) {
+		if (i >= 16) {
+			w[i & 15] = _mm512_add_epi32(_mm512_add_epi32(w[i & 15], MM512_90R_SIG0(w[(i - 15) & 15])),
+			                             _mm512_add_epi32(w[(i - 7) & 15], MM512_90R_SIG1(w[(i - 2) & 15])));
+		}
+		MM512_90R_ROUND(i, w[i & 15]);
 	}
+
+	s[0] = _mm512_add_epi32(s[0], a); s[1] = _mm512_add_epi32(s[1], b);
+	s[2] = _mm512_add_epi32(s[2], c); s[3] = _mm512_add_epi32(s[3], d);
+	s[4] = _mm512_add_epi32(s[4], e); s[5] = _mm512_add_epi32(s[5], f);
+	s[6] = _mm512_add_epi32(s[6], g); s[7] = _mm512_add_epi32(s[7], h);
+}
+
+// AVX-512 16-way with a rolling 16-word schedule window
+__attribute__((target("avx512f")))
+void sha256_90r_transform_avx512_16way_rolling(struct sha256_90r_internal_ctx ctxs[16], const BYTE data[16][64])
+{
+	const BYTE *blocks[16];
+	__m512i w[16], s[8];
+
+	for (int i = 0; i < 16; ++i)
+		blocks[i] = data[i];
+	sha256_90r_load_msg_16way(blocks, w);
+	sha256_90r_load_state_16way(ctxs, s);
+	sha256_90r_rounds_16way_rolling(s, w);
+	sha256_90r_store_state_16way(ctxs, s);
+}
+
+// Word-major entry point for lane schedulers: state[word][lane]
+__attribute__((target("avx512f")))
+void sha256_90r_blocks_avx512_16way(WORD state[8][16], const BYTE *const blocks[16])
+{
+	__m512i w[16], s[8];
+	int i;
+
+	sha256_90r_load_msg_16way(blocks, w);
+	for (i = 0; i < 8; ++i)
+		s[i] = _mm512_loadu_si512((const void *)state[i]);
+	sha256_90r_rounds_16way_rolling(s, w);
+	for (i = 0; i < 8; ++i)
+		_mm512_storeu_si512((void *)state[i], s[i]);
 }
-#endif // __AVX512F__
+
+#undef MM512_90R_ROUND
 
 #endif // __x86_64__
 
@@ -1662,241 +2614,6 @@ void sha256_90r_transform_armv8_crypto(struct sha256_90r_internal_ctx *ctx, cons
 #endif // __aarch64__
 #endif // USE_ARMV8_CRYPTO
 
-/*********************** POWER/ENERGY PROFILING HOOKS **********************/
-
-// Power profiling structure for energy consumption measurement
-typedef struct {
-    double energy_consumed_joules;    // Total energy in joules
-    double power_watts;              // Average power consumption
-    double time_seconds;             // Measurement duration
-    int measurements_taken;          // Number of samples collected
-    int supported;                   // Whether power profiling is available
-} power_profile_t;
-
-// Initialize power profiling (Intel RAPL or similar)
-static int power_profiling_init(void) {
-#ifdef __x86_64__
-    // Check for Intel RAPL support
-    uint32_t regs[4];
-    __cpuid(0x06, regs[0], regs[1], regs[2], regs[3]);
-    if (regs[2] & (1 << 14)) { // RAPL bit
-        return 1; // RAPL supported
-    }
-#endif
-    return 0; // Not supported
-}
-
-// Read energy counter (Intel RAPL MSR)
-static double read_energy_counter(void) {
-#ifdef __x86_64__
-    uint64_t energy = 0;
-    // Read MSR 0x611 (package energy counter) - requires root/admin privileges
-    // This is a simplified implementation; real implementation would need MSR access
-    __asm__ volatile("rdmsr" : "=A" (energy) : "c"(0x611));
-    return (double)energy * 0.00006103515625; // Convert to joules (15.3 μJ resolution)
-#else
-    return 0.0;
-#endif
-}
-
-// Start power profiling measurement
-static void power_profile_start(power_profile_t* profile) {
-    profile->supported = power_profiling_init();
-    if (!profile->supported) return;
-
-    profile->measurements_taken = 0;
-    profile->energy_consumed_joules = 0.0;
-    profile->time_seconds = 0.0;
-
-    // Take initial energy reading
-    profile->energy_consumed_joules = read_energy_counter();
-}
-
-// End power profiling measurement
-static void power_profile_end(power_profile_t* profile) {
-    if (!profile->supported) return;
-
-    double final_energy = read_energy_counter();
-    profile->energy_consumed_joules = final_energy - profile->energy_consumed_joules;
-    profile->power_watts = profile->energy_consumed_joules / profile->time_seconds;
-}
-
-// Print power profiling results
-static void power_profile_print(const power_profile_t* profile, const char* operation_name) {
-    if (!profile->supported) {
-        printf("Power profiling not supported on this platform\n");
-        return;
-    }
-
-    printf("=== Power Profile: %s ===\n", operation_name);
-    printf("Energy consumed: %.6f J\n", profile->energy_consumed_joules);
-    printf("Average power: %.6f W\n", profile->power_watts);
-    printf("Measurement time: %.6f s\n", profile->time_seconds);
-    printf("Energy efficiency: %.2f J/op\n",
-           profile->energy_consumed_joules / profile->measurements_taken);
-}
-
-/*********************** TREE HASHING MODE IMPLEMENTATION ***********************/
-#ifdef USE_TREE_HASHING
-
-#include <pthread.h>
-
-// Tree hashing worker function
-typedef struct {
-	struct sha256_90r_internal_ctx *ctx;
-	const BYTE *chunk_data;
-	size_t chunk_len;
-	BYTE *output_hash;
-} tree_worker_args_t;
-
-void *tree_hash_worker(void *arg) {
-	tree_worker_args_t *args = (tree_worker_args_t *)arg;
-
-	sha256_90r_init(args->ctx);
-	sha256_90r_update(args->ctx, args->chunk_data, args->chunk_len);
-	sha256_90r_final(args->ctx, args->output_hash);
-
-	return NULL;
-}
-
-// Initialize tree hashing context
-void sha256_90r_tree_hash_init(SHA256_90R_TREE_CTX *ctx, size_t chunk_size, int max_threads) {
-	ctx->chunk_size = chunk_size;
-	ctx->max_threads = max_threads;
-	ctx->num_chunks = 0;
-	ctx->processed_bytes = 0;
-
-	// Allocate contexts and intermediate hash storage
-	ctx->contexts = (struct sha256_90r_internal_ctx **)malloc(max_threads * sizeof(struct sha256_90r_internal_ctx *));
-	ctx->intermediate_hashes = (BYTE **)malloc(max_threads * sizeof(BYTE *));
-
-	for (int i = 0; i < max_threads; ++i) {
-		ctx->contexts[i] = (struct sha256_90r_internal_ctx *)malloc(sizeof(struct sha256_90r_internal_ctx));
-		ctx->intermediate_hashes[i] = (BYTE *)malloc(SHA256_BLOCK_SIZE);
-	}
-}
-
-// Update tree hashing with new data
-void sha256_90r_tree_hash_update(SHA256_90R_TREE_CTX *ctx, const BYTE *data, size_t len) {
-	size_t remaining = len;
-	const BYTE *current_data = data;
-
-	while (remaining > 0) {
-		size_t chunk_to_process = (remaining > ctx->chunk_size) ? ctx->chunk_size : remaining;
-
-		// Process chunk using available thread
-		int thread_id = ctx->num_chunks % ctx->max_threads;
-		struct sha256_90r_internal_ctx *thread_ctx = ctx->contexts[thread_id];
-
-		sha256_90r_init(thread_ctx);
-		sha256_90r_update(thread_ctx, current_data, chunk_to_process);
-		sha256_90r_final(thread_ctx, ctx->intermediate_hashes[thread_id]);
-
-		ctx->num_chunks++;
-		ctx->processed_bytes += chunk_to_process;
-		current_data += chunk_to_process;
-		remaining -= chunk_to_process;
-	}
-}
-
-// Finalize tree hashing and compute root hash
-void sha256_90r_tree_hash_final(SHA256_90R_TREE_CTX *ctx, BYTE hash[]) {
-	if (ctx->num_chunks == 0) {
-		// Empty input - return standard IV
-		struct sha256_90r_internal_ctx empty_ctx;
-		sha256_90r_init(&empty_ctx);
-		sha256_90r_final(&empty_ctx, hash);
-		return;
-	}
-
-	if (ctx->num_chunks == 1) {
-		// Single chunk - copy intermediate hash
-		memcpy(hash, ctx->intermediate_hashes[0], SHA256_BLOCK_SIZE);
-		return;
-	}
-
-	// Build Merkle tree by hashing pairs of intermediate hashes
-	struct sha256_90r_internal_ctx merge_ctx;
-	size_t current_level = ctx->num_chunks;
-	BYTE *current_hashes = (BYTE *)malloc(current_level * SHA256_BLOCK_SIZE);
-
-	// Copy intermediate hashes to current level
-	for (size_t i = 0; i < ctx->num_chunks; ++i) {
-		memcpy(&current_hashes[i * SHA256_BLOCK_SIZE], ctx->intermediate_hashes[i % ctx->max_threads], SHA256_BLOCK_SIZE);
-	}
-
-	// Build tree levels until we have a single root hash
-	while (current_level > 1) {
-		size_t next_level = (current_level + 1) / 2;
-		BYTE *next_hashes = (BYTE *)malloc(next_level * SHA256_BLOCK_SIZE);
-
-		// Process pairs in parallel using available threads
-		pthread_t threads[ctx->max_threads];
-		tree_worker_args_t worker_args[ctx->max_threads];
-
-		size_t pairs_processed = 0;
-
-		for (size_t i = 0; i < current_level; i += 2) {
-			size_t thread_idx = pairs_processed % ctx->max_threads;
-			struct sha256_90r_internal_ctx *worker_ctx = ctx->contexts[thread_idx];
-
-			// Prepare data for merging two hashes
-			BYTE merge_data[SHA256_BLOCK_SIZE * 2];
-			memcpy(merge_data, &current_hashes[i * SHA256_BLOCK_SIZE], SHA256_BLOCK_SIZE);
-
-			if (i + 1 < current_level) {
-				memcpy(merge_data + SHA256_BLOCK_SIZE, &current_hashes[(i + 1) * SHA256_BLOCK_SIZE], SHA256_BLOCK_SIZE);
-			} else {
-				// Odd number of hashes - duplicate last hash
-				memcpy(merge_data + SHA256_BLOCK_SIZE, &current_hashes[i * SHA256_BLOCK_SIZE], SHA256_BLOCK_SIZE);
-			}
-
-			// Launch worker thread
-			worker_args[thread_idx].ctx = worker_ctx;
-			worker_args[thread_idx].chunk_data = merge_data;
-			worker_args[thread_idx].chunk_len = SHA256_BLOCK_SIZE * 2;
-			worker_args[thread_idx].output_hash = &next_hashes[pairs_processed * SHA256_BLOCK_SIZE];
-
-			pthread_create(&threads[thread_idx], NULL, tree_hash_worker, &worker_args[thread_idx]);
-			pairs_processed++;
-
-			// Wait for threads when we reach max_threads
-			if (thread_idx == (size_t)ctx->max_threads - 1 || pairs_processed == next_level) {
-				for (int t = 0; t < ctx->max_threads && t < (int)pairs_processed; ++t) {
-					pthread_join(threads[t], NULL);
-				}
-			}
-		}
-
-		// Clean up current level and move to next
-		free(current_hashes);
-		current_hashes = next_hashes;
-		current_level = next_level;
-	}
-
-	// Copy final root hash
-	memcpy(hash, current_hashes, SHA256_BLOCK_SIZE);
-	free(current_hashes);
-}
-
-// Convenience function for one-shot tree hashing
-void sha256_90r_tree_hash(const BYTE *data, size_t len, BYTE hash[], size_t chunk_size, int max_threads) {
-	SHA256_90R_TREE_CTX ctx;
-	sha256_90r_tree_hash_init(&ctx, chunk_size, max_threads);
-	sha256_90r_tree_hash_update(&ctx, data, len);
-	sha256_90r_tree_hash_final(&ctx, hash);
-
-	// Cleanup
-	for (int i = 0; i < max_threads; ++i) {
-		free(ctx.contexts[i]);
-		free(ctx.intermediate_hashes[i]);
-	}
-	free(ctx.contexts);
-	free(ctx.intermediate_hashes);
-}
-
-#endif // USE_TREE_HASHING
-
 /*********************** GPU ACCELERATION IMPLEMENTATION ***********************/
 #ifdef USE_CUDA
 
@@ -2074,9 +2791,9 @@ int main()
 	struct sha256_90r_internal_ctx ctx;
 	int i;
 
-	sha256_90r_init(&ctx);
-	sha256_90r_update(&ctx, text1, strlen(text1));
-	sha256_90r_final(&ctx, hash);
+	sha256_90r_init_internal(&ctx);
+	sha256_90r_update_internal(&ctx, text1, strlen((char *)text1));
+	sha256_90r_final_internal(&ctx, hash);
 
 	printf("SHA-256-90R(\"abc\") = ");
 	for (i = 0; i < SHA256_BLOCK_SIZE; ++i)
@@ -27,10 +27,30 @@ typedef struct {
 	WORD state[8];
 } SHA256_CTX;
 
+// Standard SHA-256 implementations selectable at run time
+typedef enum {
+	SHA256_IMPL_AUTO = 0,               // Fastest available on this CPU
+	SHA256_IMPL_SCALAR,                 // Portable C
+	SHA256_IMPL_SHA_NI,                 // Intel SHA extensions
+	SHA256_IMPL_AVX2                    // 8 messages per AVX2 register (sha256_batch)
+} SHA256_IMPL;
+
 /*********************** FUNCTION DECLARATIONS **********************/
 void sha256_init(SHA256_CTX *ctx);
 void sha256_update(SHA256_CTX *ctx, const BYTE data[], size_t len);
 void sha256_final(SHA256_CTX *ctx, BYTE hash[]);
+void sha256_transform(SHA256_CTX *ctx, const BYTE data[]);
+void sha256(const BYTE data[], size_t len, BYTE hash[]);
+
+// Hash count independent messages; hashes[i] receives the digest of data[i]
+void sha256_batch(const BYTE *const data[], const size_t lens[],
+                  BYTE hashes[][SHA256_BLOCK_SIZE], size_t count);
+
+// Select the implementation; returns -1 if this CPU does not support it.
+// Single messages use SHA-NI or scalar code; AVX2 applies to sha256_batch.
+int sha256_set_impl(SHA256_IMPL impl);
+SHA256_IMPL sha256_get_impl(void);
+const char *sha256_impl_name(SHA256_IMPL impl);
 
 
 #endif   // SHA256_H
\ No newline at end of file
@@ -20,13 +20,6 @@ typedef int cudaError_t;
 #define cudaSuccess 0
 #endif
 
-// Internal structure - wraps the internal sha256_90r_internal_ctx
-struct sha256_90r_ctx {
-    struct sha256_90r_internal_ctx internal_ctx;  // This is the internal context from sha256_internal.h
-    sha256_90r_mode_t mode;
-    sha256_90r_backend_t backend;
-};
-
 // Global initialization flag
 static int g_library_initialized = 0;
 
@@ -44,6 +37,12 @@ int sha256_90r_init_library(void)
         return -1;
     }
 #endif
+
+    // Calibrate (or load the cached plan); hashing works untuned if this fails
+    const char* autotune = getenv("SHA256_90R_AUTOTUNE");
+    if (!autotune || strcmp(autotune, "0") != 0) {
+        sha256_90r_autotune(0, NULL);
+    }
     
     g_library_initialized = 1;
     return 0;
@@ -141,32 +140,15 @@ void sha256_90r_update(SHA256_90R_CTX* ctx, const uint8_t* data, size_t len)
                 break;
                 
             case SHA256_90R_BACKEND_SIMD:
-#ifdef USE_SIMD
-                // Use SIMD optimized path if available
-                if (internal->mode == SHA256_90R_MODE_FAST) {
-                    sha256_90r_update_fast(&internal->internal_ctx, (const BYTE*)data, len);
-                } else {
-                    sha256_90r_update_internal(&internal->internal_ctx, (const BYTE*)data, len);
-                }
-#else
-                // SIMD requested but not available - fall back to scalar
+                // One stream chains block to block; the transform dispatches to the
+                // SIMD kernel. Lane parallelism is a separate algorithm (striped mode).
                 sha256_90r_update_internal(&internal->internal_ctx, (const BYTE*)data, len);
-#endif
                 break;
                 
             case SHA256_90R_BACKEND_SCALAR:
             case SHA256_90R_BACKEND_AUTO:
             default:
-                // Use fast update for FAST_MODE, otherwise standard
-                if (internal->mode == SHA256_90R_MODE_FAST) {
-#if defined(USE_SIMD) && !SHA256_90R_SECURE_MODE
-                    sha256_90r_update_fast(&internal->internal_ctx, (const BYTE*)data, len);
-#else
-                    sha256_90r_update_internal(&internal->internal_ctx, (const BYTE*)data, len);
-#endif
-                } else {
-                    sha256_90r_update_internal(&internal->internal_ctx, (const BYTE*)data, len);
-                }
+                sha256_90r_update_internal(&internal->internal_ctx, (const BYTE*)data, len);
                 break;
                 
             case SHA256_90R_BACKEND_SHA_NI:
@@ -179,6 +161,26 @@ void sha256_90r_update(SHA256_90R_CTX* ctx, const uint8_t* data, size_t len)
     }
 }
 
+void sha256_90r_copy_update(SHA256_90R_CTX* ctx, void* dst, const void* src, size_t len)
+{
+    if (!ctx || !dst || !src || len == 0) return;
+    // Every backend hashes a single stream through the same transform
+    sha256_90r_copy_update_internal(&((struct sha256_90r_ctx*)ctx)->internal_ctx, (BYTE*)dst,
+                                    (const BYTE*)src, len);
+}
+
+// Each fragment goes through the regular update: a block spanning fragments
+// is staged in the context's 64-byte buffer, whole blocks are compressed in place
+void sha256_90r_updatev(SHA256_90R_CTX* ctx, const struct iovec* iov, size_t iovcnt)
+{
+    if (!ctx || (!iov && iovcnt)) return;
+    for (size_t i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > 0 && iov[i].iov_base) {
+            sha256_90r_update(ctx, (const uint8_t*)iov[i].iov_base, iov[i].iov_len);
+        }
+    }
+}
+
 void sha256_90r_final(SHA256_90R_CTX* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE])
 {
     if (ctx && hash) {
@@ -187,6 +189,16 @@ void sha256_90r_final(SHA256_90R_CTX* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE])
     }
 }
 
+void sha256_90r_set_streaming(size_t threshold, size_t prefetch_distance, int hints)
+{
+    sha256_90r_stream_config(threshold, prefetch_distance, hints);
+}
+
+void sha256_90r_get_streaming(size_t* threshold, size_t* prefetch_distance, int* hints)
+{
+    sha256_90r_stream_get_config(threshold, prefetch_distance, hints);
+}
+
 void sha256_90r_hash(const uint8_t* data, size_t len, uint8_t hash[SHA256_90R_DIGEST_SIZE])
 {
     struct sha256_90r_internal_ctx internal_ctx;
@@ -195,6 +207,63 @@ void sha256_90r_hash(const uint8_t* data, size_t len, uint8_t hash[SHA256_90R_DI
     sha256_90r_final_internal(&internal_ctx, (BYTE*)hash);
 }
 
+// The public state mirrors the internal context field by field; copying in
+// and out per call keeps the internal layout private
+static void state_load(const sha256_90r_state_t* st, struct sha256_90r_internal_ctx* ctx)
+{
+    memcpy(ctx->state, st->state, sizeof(ctx->state));
+    memcpy(ctx->data, st->data, st->datalen);
+    ctx->datalen = st->datalen;
+    ctx->bitlen = st->bitlen;
+}
+
+static void state_store(const struct sha256_90r_internal_ctx* ctx, sha256_90r_state_t* st)
+{
+    memcpy(st->state, ctx->state, sizeof(st->state));
+    memcpy(st->data, ctx->data, ctx->datalen);
+    st->datalen = ctx->datalen;
+    st->bitlen = ctx->bitlen;
+}
+
+void sha256_90r_state_init(sha256_90r_state_t* st)
+{
+    struct sha256_90r_internal_ctx ctx;
+    if (!st) return;
+    sha256_90r_init_internal(&ctx);
+    state_store(&ctx, st);
+}
+
+void sha256_90r_state_update(sha256_90r_state_t* st, const uint8_t* data, size_t len)
+{
+    struct sha256_90r_internal_ctx ctx;
+    if (!st || (!data && len)) return;
+    state_load(st, &ctx);
+    sha256_90r_update_internal(&ctx, (const BYTE*)data, len);
+    state_store(&ctx, st);
+}
+
+void sha256_90r_state_updatev(sha256_90r_state_t* st, const struct iovec* iov, size_t iovcnt)
+{
+    struct sha256_90r_internal_ctx ctx;
+    if (!st || (!iov && iovcnt)) return;
+    state_load(st, &ctx);
+    for (size_t i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > 0 && iov[i].iov_base) {
+            sha256_90r_update_internal(&ctx, (const BYTE*)iov[i].iov_base, iov[i].iov_len);
+        }
+    }
+    state_store(&ctx, st);
+}
+
+void sha256_90r_state_final(sha256_90r_state_t* st, uint8_t hash[SHA256_90R_DIGEST_SIZE])
+{
+    struct sha256_90r_internal_ctx ctx;
+    if (!st || !hash) return;
+    state_load(st, &ctx);
+    sha256_90r_final_internal(&ctx, (BYTE*)hash);
+    state_store(&ctx, st);
+}
+
 void sha256_90r_hash_mode(const uint8_t* data, size_t len, uint8_t hash[SHA256_90R_DIGEST_SIZE], 
                           sha256_90r_mode_t mode)
 {
@@ -211,13 +280,124 @@ void sha256_90r_hash_mode(const uint8_t* data, size_t len, uint8_t hash[SHA256_9
 void sha256_90r_batch(const uint8_t** messages, const size_t* lengths, 
                       uint8_t** hashes, size_t count, sha256_90r_mode_t mode)
 {
-    // For now, process sequentially
-    // TODO: Implement true parallel batch processing
+    // Enough messages to fill the lanes (per the autotune plan): multi-buffer
+    // kernels, spread over threads when the batch is large enough to pay for them.
+    // The lane kernels are constant-time, so this holds for every mode.
+    if (count >= sha256_90r_tune_batch_min()) {
+        uint8_t (*digests)[SHA256_90R_DIGEST_SIZE] = malloc(count * SHA256_90R_DIGEST_SIZE);
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) total += lengths[i];
+        if (digests && sha256_90r_batch_parallel(messages, lengths, digests, count,
+                                                 sha256_90r_tune_threads(total), NULL) == 0) {
+            for (size_t i = 0; i < count; i++) {
+                memcpy(hashes[i], digests[i], SHA256_90R_DIGEST_SIZE);
+            }
+            free(digests);
+            return;
+        }
+        free(digests);
+    }
+
     for (size_t i = 0; i < count; i++) {
         sha256_90r_hash_mode(messages[i], lengths[i], hashes[i], mode);
     }
 }
 
+/*************************** DUAL DIGEST API ***************************/
+
+// Both chains still hold the IV until the first block has been compressed
+static void dual_block(sha256_90r_dual_ctx_t* ctx, const uint8_t* block)
+{
+    sha256_90r_dual_transform((WORD*)ctx->state_256, (WORD*)ctx->state_90r, (const BYTE*)block,
+                              ctx->bitlen == 0);
+    ctx->bitlen += 512;
+}
+
+void sha256_90r_dual_init(sha256_90r_dual_ctx_t* ctx)
+{
+    struct sha256_90r_internal_ctx iv;
+
+    if (!ctx) return;
+    sha256_90r_init_internal(&iv);      // Both chains start from the SHA-256 IV
+    memcpy(ctx->state_256, iv.state, sizeof(ctx->state_256));
+    memcpy(ctx->state_90r, iv.state, sizeof(ctx->state_90r));
+    ctx->bitlen = 0;
+    ctx->datalen = 0;
+}
+
+void sha256_90r_dual_update(sha256_90r_dual_ctx_t* ctx, const uint8_t* data, size_t len)
+{
+    if (!ctx || (!data && len)) return;
+
+    if (ctx->datalen > 0) {
+        size_t take = 64 - ctx->datalen;
+        if (take > len) take = len;
+        memcpy(ctx->data + ctx->datalen, data, take);
+        ctx->datalen += (uint32_t)take;
+        data += take;
+        len -= take;
+        if (ctx->datalen < 64) return;
+        dual_block(ctx, ctx->data);
+        ctx->datalen = 0;
+    }
+
+    while (len >= 64) {
+        dual_block(ctx, data);
+        data += 64;
+        len -= 64;
+    }
+
+    if (len > 0) {
+        memcpy(ctx->data, data, len);
+        ctx->datalen = (uint32_t)len;
+    }
+}
+
+void sha256_90r_dual_final(sha256_90r_dual_ctx_t* ctx, uint8_t digest_256[SHA256_90R_DIGEST_SIZE],
+                           uint8_t digest_90r[SHA256_90R_DIGEST_SIZE])
+{
+    uint64_t total_bits;
+    uint32_t i;
+
+    if (!ctx) return;
+    total_bits = ctx->bitlen + (uint64_t)ctx->datalen * 8;
+
+    // Same padding as sha256_final(); only the length picks the extra block
+    i = ctx->datalen;
+    ctx->data[i++] = 0x80;
+    if (ctx->datalen >= 56) {
+        memset(ctx->data + i, 0, 64 - i);
+        dual_block(ctx, ctx->data);
+        i = 0;
+    }
+    memset(ctx->data + i, 0, 56 - i);
+    for (i = 0; i < 8; i++) {
+        ctx->data[63 - i] = (uint8_t)(total_bits >> (8 * i));
+    }
+    dual_block(ctx, ctx->data);
+
+    if (digest_256) sha256_90r_store_digest((const WORD*)ctx->state_256, digest_256);
+    if (digest_90r) sha256_90r_store_digest((const WORD*)ctx->state_90r, digest_90r);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void sha256_90r_dual_hash(const uint8_t* data, size_t len, uint8_t digest_256[SHA256_90R_DIGEST_SIZE],
+                          uint8_t digest_90r[SHA256_90R_DIGEST_SIZE])
+{
+    sha256_90r_dual_ctx_t ctx;
+    sha256_90r_dual_init(&ctx);
+    sha256_90r_dual_update(&ctx, data, len);
+    sha256_90r_dual_final(&ctx, digest_256, digest_90r);
+}
+
+void sha256_90r_dual_batch(const uint8_t* const* messages, const size_t* lengths,
+                           uint8_t (*digests_256)[SHA256_90R_DIGEST_SIZE],
+                           uint8_t (*digests_90r)[SHA256_90R_DIGEST_SIZE], size_t count)
+{
+    if (!messages || !lengths || !digests_256 || !digests_90r) return;
+    sha256_90r_dual_batch_internal((const BYTE* const*)messages, lengths, digests_256, digests_90r, count);
+}
+
 /*************************** UTILITY API *************************/
 
 const char* sha256_90r_version(void)
@@ -286,43 +466,66 @@ int sha256_90r_backend_available(sha256_90r_backend_t backend)
     }
 }
 
-double sha256_90r_backend_performance(sha256_90r_backend_t backend)
+int sha256_90r_kernel_available(sha256_90r_kernel_t kernel)
 {
-    // Return estimated performance in Gbps
-    switch (backend) {
-        case SHA256_90R_BACKEND_AUTO:
-        case SHA256_90R_BACKEND_SCALAR:
-            return 2.7;
-            
-        case SHA256_90R_BACKEND_SIMD:
-            return 4.2;  // With 4-way parallel
-            
-        case SHA256_90R_BACKEND_SHA_NI:
-            return 0.0;  // Disabled
-            
-        case SHA256_90R_BACKEND_GPU:
-            return 50.0;  // Estimated when optimized
-            
-        case SHA256_90R_BACKEND_FPGA:
-            return 12.8;  // Estimated for real hardware
-            
-        case SHA256_90R_BACKEND_JIT:
-            return 2.5;   // Estimated
-            
+    switch (kernel) {
+        case SHA256_90R_KERNEL_SCALAR:
+        case SHA256_90R_KERNEL_SCALAR_ROLLING:
+            return 1;
+
+#if defined(USE_SIMD) && defined(__x86_64__)
+        case SHA256_90R_KERNEL_AVX2:
+        case SHA256_90R_KERNEL_AVX2_8WAY:
+            return __builtin_cpu_supports("avx2");
+
+        case SHA256_90R_KERNEL_AVX512_16WAY:
+            return __builtin_cpu_supports("avx512f");
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        case SHA256_90R_KERNEL_SCALAR_BMI2:
+            return __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2");
+#endif
+
         default:
-            return 0.0;
+            return 0;
     }
 }
 
+int sha256_90r_kernel_single_stream(sha256_90r_kernel_t kernel)
+{
+    return kernel == SHA256_90R_KERNEL_SCALAR || kernel == SHA256_90R_KERNEL_SCALAR_ROLLING ||
+           kernel == SHA256_90R_KERNEL_AVX2 || kernel == SHA256_90R_KERNEL_SCALAR_BMI2;
+}
+
+const char* sha256_90r_kernel_name(sha256_90r_kernel_t kernel)
+{
+    switch (kernel) {
+        case SHA256_90R_KERNEL_SCALAR:         return "scalar";
+        case SHA256_90R_KERNEL_SCALAR_ROLLING: return "scalar-rolling";
+        case SHA256_90R_KERNEL_AVX2:           return "avx2";
+        case SHA256_90R_KERNEL_AVX2_8WAY:      return "avx2-8way";
+        case SHA256_90R_KERNEL_AVX512_16WAY:   return "avx512-16way";
+        case SHA256_90R_KERNEL_SCALAR_BMI2:    return "scalar-bmi2";
+        default:                               return "unknown";
+    }
+}
+
+double sha256_90r_backend_performance(sha256_90r_backend_t backend)
+{
+    // Measured by the autotuner (tuned now if it has not run yet)
+    return sha256_90r_tune_backend_gbps((int)backend);
+}
+
 int sha256_90r_selftest(void)
 {
     // Test vector: "abc"
     const uint8_t test_input[] = "abc";
     const uint8_t expected_hash[] = {
-        0xff, 0xe9, 0x37, 0x27, 0x5b, 0xf4, 0xfc, 0x7d,
-        0xf5, 0x31, 0x46, 0xd8, 0xcf, 0x72, 0x5a, 0x66,
-        0x08, 0x10, 0x11, 0xab, 0xc2, 0xe6, 0x8b, 0xdb,
-        0xf1, 0xfc, 0xa3, 0xe3, 0x7d, 0x0b, 0x82, 0xaa
+        0xd2, 0x94, 0x6a, 0x44, 0x9b, 0xd9, 0x8c, 0x1c,
+        0x6b, 0xa9, 0x53, 0x4c, 0x7d, 0x44, 0x0d, 0x14,
+        0xe0, 0xfa, 0xe1, 0x9e, 0x55, 0xc8, 0xed, 0x8c,
+        0xb0, 0xf2, 0xef, 0x75, 0x3f, 0x87, 0x42, 0x0b
     };
     
     uint8_t hash[SHA256_90R_DIGEST_SIZE];
@@ -333,41 +536,16 @@ int sha256_90r_selftest(void)
 
 double sha256_90r_timing_test(sha256_90r_mode_t mode, int iterations)
 {
-    // Simple timing variance test
-    // In production, this would run comprehensive timing analysis
-    
+    // dudect-style fixed-vs-random analysis of the one-shot path for this mode;
+    // see sha256_90r_timing.c for the per-backend, per-API analyzer
+    sha256_90r_leak_report_t report;
+
     if (iterations < 100) iterations = 100;
-    
-    uint8_t test_data[64];
-    uint8_t hash[SHA256_90R_DIGEST_SIZE];
-    
-    // Fill with test pattern
-    for (int i = 0; i < 64; i++) {
-        test_data[i] = (uint8_t)i;
-    }
-    
-    // Run test
-    SHA256_90R_CTX* ctx = sha256_90r_new(mode);
-    if (!ctx) return -1.0;
-    
-    for (int i = 0; i < iterations; i++) {
-        sha256_90r_reset(ctx);
-        sha256_90r_update(ctx, test_data, 64);
-        sha256_90r_final(ctx, hash);
-    }
-    
-    sha256_90r_free(ctx);
-    
-    // Return estimated timing variance in nanoseconds
-    // Real implementation would measure actual variance
-    switch (mode) {
-        case SHA256_90R_MODE_SECURE:
-            return 10.0;  // Very low variance
-        case SHA256_90R_MODE_ACCEL:
-            return 50.0;  // Medium variance
-        case SHA256_90R_MODE_FAST:
-            return 100.0; // Higher variance
-        default:
-            return -1.0;
+
+    if (sha256_90r_leak_test(SHA256_90R_BACKEND_AUTO, mode, SHA256_90R_CT_API_ONESHOT,
+                             (uint64_t)iterations, 0, &report) != 0 || !report.supported) {
+        return -1.0;
     }
+
+    return report.leak_score;
 }
@@ -15,6 +15,7 @@ extern "C" {
 
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>                // struct iovec
 
 /*************************** DEFINES ***************************/
 #define SHA256_90R_BLOCK_SIZE 32            // Output size: 256 bits / 8 = 32 bytes
@@ -63,6 +64,20 @@ void sha256_90r_reset(SHA256_90R_CTX* ctx);
 /* Update hash with data */
 void sha256_90r_update(SHA256_90R_CTX* ctx, const uint8_t* data, size_t len);
 
+/* Copy len bytes from src to dst (like memcpy; no overlap) and hash them,
+ * reading src only once: each block is copied through registers and then
+ * compressed from L1. Updates of at least the streaming threshold (see
+ * sha256_90r_set_streaming) write a 16-byte-aligned dst with non-temporal
+ * stores. Same digest and dst contents as memcpy() + sha256_90r_update(). */
+void sha256_90r_copy_update(SHA256_90R_CTX* ctx, void* dst, const void* src, size_t len);
+
+/* Update with the concatenation of iovcnt fragments (header, payload pieces,
+ * trailer) without coalescing them first. Only a block that spans fragments
+ * is staged in the context (at most 64 bytes); whole blocks are compressed
+ * straight from the caller's buffers. Same digest as one update of the
+ * concatenation; empty fragments are allowed. */
+void sha256_90r_updatev(SHA256_90R_CTX* ctx, const struct iovec* iov, size_t iovcnt);
+
 /* Finalize hash and get result */
 void sha256_90r_final(SHA256_90R_CTX* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE]);
 
@@ -73,12 +88,417 @@ void sha256_90r_hash(const uint8_t* data, size_t len, uint8_t hash[SHA256_90R_DI
 void sha256_90r_hash_mode(const uint8_t* data, size_t len, uint8_t hash[SHA256_90R_DIGEST_SIZE], 
                           sha256_90r_mode_t mode);
 
+/* Caller-allocated context (no heap): on the stack, or embedded in another
+ * object. Same digests as sha256_90r_hash(), through the same kernels. */
+typedef struct {
+    uint32_t state[8];
+    uint64_t bitlen;                 // Bits already compressed
+    uint8_t data[64];
+    uint32_t datalen;
+} sha256_90r_state_t;
+
+void sha256_90r_state_init(sha256_90r_state_t* st);
+void sha256_90r_state_update(sha256_90r_state_t* st, const uint8_t* data, size_t len);
+void sha256_90r_state_updatev(sha256_90r_state_t* st, const struct iovec* iov, size_t iovcnt);
+/* Writes the digest; st must be re-initialized before the next message */
+void sha256_90r_state_final(sha256_90r_state_t* st, uint8_t hash[SHA256_90R_DIGEST_SIZE]);
+
+/* Streaming mode: an update of at least `threshold` bytes reads its input
+ * with non-temporal prefetches `prefetch_distance` bytes ahead and demotes
+ * consumed lines (CLDEMOTE, where supported) so large inputs do not evict the
+ * caches of other work on the core. threshold 0 = last-level cache size,
+ * SIZE_MAX = never; prefetch_distance 0 = default. Digests are unchanged. */
+#define SHA256_90R_STREAM_PREFETCH_NTA 0x1
+#define SHA256_90R_STREAM_CLDEMOTE 0x2
+
+void sha256_90r_set_streaming(size_t threshold, size_t prefetch_distance, int hints);
+void sha256_90r_get_streaming(size_t* threshold, size_t* prefetch_distance, int* hints);
+
 /*************************** BATCH API ***************************/
 
 /* Process multiple messages in parallel (for GPU/SIMD backends) */
 void sha256_90r_batch(const uint8_t** messages, const size_t* lengths, 
                       uint8_t** hashes, size_t count, sha256_90r_mode_t mode);
 
+/* Batch of scatter-gather messages: message i is the concatenation of
+ * messages[i][0..iovcnts[i]). Lanes take whole blocks from the caller's
+ * fragments and gather only blocks that span two, so nothing is coalesced.
+ * 0 on success, -1 on a NULL argument or allocation failure. */
+int sha256_90r_batchv(const struct iovec* const* messages, const size_t* iovcnts,
+                      uint8_t** hashes, size_t count, sha256_90r_mode_t mode);
+
+/*************************** HMAC API ***************************/
+
+/* HMAC (RFC 2104) over SHA256-90R: block size 64, 32-byte MAC. Keys longer
+ * than 64 bytes are replaced by their digest. */
+void sha256_90r_hmac(const uint8_t* key, size_t keylen, const uint8_t* data, size_t len,
+                     uint8_t mac[SHA256_90R_DIGEST_SIZE]);
+
+/* count independent MACs (each with its own key) on the lane kernels: the
+ * inner and outer hashes are two sha256_90r_batchv() passes whose first
+ * fragment is the pad block, so messages are not copied. Same MACs as
+ * sha256_90r_hmac(). 0 on success, -1 on a NULL argument or allocation
+ * failure. */
+int sha256_90r_hmac_batch(const uint8_t* const* keys, const size_t* keylens,
+                          const uint8_t* const* messages, const size_t* lengths,
+                          uint8_t** macs, size_t count);
+
+/*************************** ROW HASHING API ***************************/
+
+/* One digest per row of a columnar (Arrow-layout) batch. Row r is hashed as
+ * the concatenation, column by column, of
+ *   null                        0x00
+ *   FIXED                       0x01 || width bytes as stored
+ *   BOOL                        0x01 || 0x00 or 0x01
+ *   BINARY, LARGE_BINARY        0x01 || length (4 bytes, little-endian) || bytes
+ * so sha256_90r_hash of that message gives the same digest, and a column
+ * with int32 or int64 offsets hashes alike. Rows are serialized straight
+ * from the column buffers into the 8/16 SIMD lane blocks; nothing is
+ * allocated or staged per row. */
+typedef enum {
+    SHA256_90R_COLUMN_FIXED = 0,     // width bytes per value (integers, floats, fixed-size binary)
+    SHA256_90R_COLUMN_BOOL,          // One bit per value, LSB first
+    SHA256_90R_COLUMN_BINARY,        // int32_t offsets[rows + 1] into data (binary, utf8)
+    SHA256_90R_COLUMN_LARGE_BINARY   // int64_t offsets (large_binary, large_utf8)
+} sha256_90r_column_type_t;
+
+typedef struct {
+    sha256_90r_column_type_t type;
+    size_t width;                    // FIXED: bytes per value
+    const void* data;                // Values, or the bytes the offsets point into
+    const void* offsets;             // BINARY / LARGE_BINARY
+    const uint8_t* validity;         // Bit set = valid, LSB first; NULL = no nulls
+    size_t offset;                   // Slice offset: row 0 is value `offset` of every buffer
+} sha256_90r_column_t;
+
+/* digests[r] for rows 0..rows-1. 0 on success, -1 on a NULL argument, an
+ * unknown type, a zero width, decreasing offsets or a value of 4 GB or more. */
+int sha256_90r_hash_rows(const sha256_90r_column_t* columns, size_t ncols, size_t rows,
+                         uint8_t (*digests)[SHA256_90R_DIGEST_SIZE]);
+
+/*************************** FILE HASHING API ***************************/
+
+/* Digest of a whole file, from offset 0 to its size at the time of the
+ * call (fd's own offset is neither used nor moved). Extents are found with
+ * SEEK_DATA/SEEK_HOLE: holes are never read and hash as zero bytes through
+ * a transform that skips the all-zero message schedule; where SEEK_DATA is
+ * not supported the file is read in full. Outside SECURE mode all-zero
+ * blocks inside data extents take the same transform. The digest always
+ * equals sha256_90r_hash() of the file's bytes. 0 on success, -1 with
+ * errno set on failure. stats may be NULL. */
+typedef struct {
+    uint64_t file_size;
+    uint64_t bytes_read;             // Data extents, read with pread
+    uint64_t hole_bytes;             // Hashed as zeros without reading
+} sha256_90r_file_stats_t;
+
+int sha256_90r_hash_fd(int fd, uint8_t hash[SHA256_90R_DIGEST_SIZE], sha256_90r_file_stats_t* stats);
+int sha256_90r_hash_file(const char* path, uint8_t hash[SHA256_90R_DIGEST_SIZE], sha256_90r_file_stats_t* stats);
+
+/*************************** DUAL DIGEST API ***************************/
+
+/* SHA-256 and SHA256-90R of the same message in one pass. Both share the IV
+ * and message schedule; the first block's SHA-256 result is forked from the
+ * 90R chain after round 63, later blocks run the two chains side by side. */
+typedef struct {
+    uint32_t state_256[8];
+    uint32_t state_90r[8];
+    uint64_t bitlen;                 // Bits already compressed
+    uint8_t data[64];
+    uint32_t datalen;
+} sha256_90r_dual_ctx_t;
+
+void sha256_90r_dual_init(sha256_90r_dual_ctx_t* ctx);
+void sha256_90r_dual_update(sha256_90r_dual_ctx_t* ctx, const uint8_t* data, size_t len);
+void sha256_90r_dual_final(sha256_90r_dual_ctx_t* ctx, uint8_t digest_256[SHA256_90R_DIGEST_SIZE],
+                           uint8_t digest_90r[SHA256_90R_DIGEST_SIZE]);
+
+/* One-shot dual digest */
+void sha256_90r_dual_hash(const uint8_t* data, size_t len, uint8_t digest_256[SHA256_90R_DIGEST_SIZE],
+                          uint8_t digest_90r[SHA256_90R_DIGEST_SIZE]);
+
+/* Dual digests of count independent messages (8 AVX2 lanes when available) */
+void sha256_90r_dual_batch(const uint8_t* const* messages, const size_t* lengths,
+                           uint8_t (*digests_256)[SHA256_90R_DIGEST_SIZE],
+                           uint8_t (*digests_90r)[SHA256_90R_DIGEST_SIZE], size_t count);
+
+/*************************** MULTI-BUFFER JOB API ***************************/
+
+/* Job manager for streams of independent messages of mixed lengths. Each
+ * submitted job occupies one SIMD lane (8 AVX2 / 16 AVX-512); when a lane's
+ * message finishes, including its padding blocks, the lane takes the next
+ * job while the others keep compressing. */
+typedef enum {
+    SHA256_90R_JOB_UNKNOWN = 0,
+    SHA256_90R_JOB_PROCESSING = 1,   // Owned by the manager
+    SHA256_90R_JOB_COMPLETED = 2,    // digest is valid
+    SHA256_90R_JOB_ERROR = 3         // Rejected (NULL data with len > 0)
+} sha256_90r_job_status_t;
+
+typedef struct {
+    const uint8_t* data;             // Must stay valid until the job is returned
+    size_t len;
+    uint8_t digest[SHA256_90R_DIGEST_SIZE];
+    sha256_90r_job_status_t status;
+    void* user_data;
+} sha256_90r_job_t;
+
+typedef struct sha256_90r_mb_mgr sha256_90r_mb_mgr_t;
+
+typedef struct {
+    int lanes;
+    uint64_t jobs_completed;
+    uint64_t kernel_calls;           // Multi-lane kernel invocations
+    uint64_t lane_blocks;            // Blocks compressed for jobs by those calls
+    uint64_t scalar_blocks;          // Blocks drained one lane at a time
+    double lane_utilization;         // lane_blocks / (kernel_calls * lanes)
+} sha256_90r_mb_stats_t;
+
+/* lanes: 0 = widest available, or 1, 8 (AVX2), 16 (AVX-512F). NULL if the
+ * width is not supported on this CPU or on allocation failure. */
+sha256_90r_mb_mgr_t* sha256_90r_mb_new(int lanes);
+void sha256_90r_mb_free(sha256_90r_mb_mgr_t* mgr);
+
+/* Hand a job to the manager. Returns a completed job (not necessarily this
+ * one) once all lanes are busy, otherwise NULL. */
+sha256_90r_job_t* sha256_90r_mb_submit(sha256_90r_mb_mgr_t* mgr, sha256_90r_job_t* job);
+
+/* Finish outstanding work: returns one completed job per call, NULL once the
+ * manager is empty. */
+sha256_90r_job_t* sha256_90r_mb_flush(sha256_90r_mb_mgr_t* mgr);
+
+void sha256_90r_mb_get_stats(const sha256_90r_mb_mgr_t* mgr, sha256_90r_mb_stats_t* stats);
+
+/*************************** STRIPED HASH API ***************************/
+
+/* Lane-striped hashing of ONE message: 64-byte unit i goes to lane i mod L,
+ * every lane is hashed as its own padded SHA256-90R message in a SIMD lane,
+ * and the digest is SHA256-90R(header || lane digest 0 || ... || L-1), where
+ * the 16-byte header is "S90R", version, L, two zero bytes and the total
+ * length (64-bit big-endian). This is a different function from
+ * SHA256-90R: digests differ from sha256_90r_hash and between lane counts,
+ * so every variant carries its own algorithm ID (version in the high byte,
+ * lane count in the low byte). */
+typedef enum {
+    SHA256_90R_ALG_SHA256_90R = 0,              // Plain sequential SHA256-90R
+    SHA256_90R_ALG_STRIPED4_V1 = 0x0104,
+    SHA256_90R_ALG_STRIPED8_V1 = 0x0108,
+    SHA256_90R_ALG_STRIPED16_V1 = 0x0110
+} sha256_90r_alg_t;
+
+#define SHA256_90R_STRIPED_VERSION 1
+#define SHA256_90R_STRIPED_MAX_LANES 16
+
+typedef struct sha256_90r_striped_ctx sha256_90r_striped_ctx_t;
+
+/* "SHA256-90R", "SHA256-90R-S4/v1", ...; NULL for an unknown ID */
+const char* sha256_90r_alg_name(sha256_90r_alg_t alg);
+
+/* Any striped ID works on every CPU; the lane count only picks the kernel
+ * (AVX-512 16-way, AVX2 8-way or scalar). NULL for an unknown or
+ * non-striped ID, or on allocation failure. */
+sha256_90r_striped_ctx_t* sha256_90r_striped_new(sha256_90r_alg_t alg);
+int sha256_90r_striped_update(sha256_90r_striped_ctx_t* ctx, const void* data, size_t len);
+int sha256_90r_striped_final(sha256_90r_striped_ctx_t* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE]);
+void sha256_90r_striped_free(sha256_90r_striped_ctx_t* ctx);
+
+/* One-shot; alg may also be SHA256_90R_ALG_SHA256_90R. 0 on success, -1 on
+ * an unknown ID or NULL data with len > 0. */
+int sha256_90r_striped_hash(sha256_90r_alg_t alg, const void* data, size_t len,
+                            uint8_t hash[SHA256_90R_DIGEST_SIZE]);
+
+/*************************** PARALLEL TREE / BATCH API ***************************/
+
+/* Multi-threaded hashing with NUMA placement. Each work item (a tree leaf or
+ * a batch message) is queued on the node that holds its first page; workers
+ * are pinned to that node's CPUs and take local items before stealing from
+ * other nodes. Set SHA256_90R_NUMA=0 in the environment to disable placement
+ * and pinning. num_threads <= 0 sizes the pool from the autotune plan
+ * (sha256_90r_tune_threads), or uses every online CPU before tuning. */
+#define SHA256_90R_MAX_NUMA_NODES 8
+#define SHA256_90R_TREE_DEFAULT_CHUNK (1024 * 1024)
+
+typedef struct {
+    int nodes;                       // NUMA nodes work was queued on
+    int threads;                     // Worker threads used
+    double seconds;                  // Wall time of the parallel phase
+    int node_threads[SHA256_90R_MAX_NUMA_NODES];
+    uint64_t node_bytes[SHA256_90R_MAX_NUMA_NODES];  // Bytes hashed by workers on each node
+    uint64_t cross_node_bytes;       // Bytes a worker read from another node's queue
+    uint64_t unplaced_bytes;         // Bytes on pages not yet faulted in (spread evenly)
+} sha256_90r_par_stats_t;
+
+/* Tree hash: leaves are SHA256-90R of chunk_size-byte chunks (0 = default),
+ * parents hash left || right, an odd last node is paired with itself. Input
+ * of at most one chunk hashes to its plain digest. stats may be NULL. The
+ * root depends on chunk_size, so SHA256_90R_TREE_CHUNK_TUNED (the chunk the
+ * autotuner found fastest here) is only for roots that stay on one machine. */
+int sha256_90r_tree_hash(const uint8_t* data, size_t len, size_t chunk_size, int num_threads,
+                         uint8_t hash[SHA256_90R_DIGEST_SIZE], sha256_90r_par_stats_t* stats);
+
+/* Streaming form of sha256_90r_tree_hash (single-threaded, same root) */
+typedef struct sha256_90r_tree_ctx sha256_90r_tree_ctx_t;
+
+sha256_90r_tree_ctx_t* sha256_90r_tree_hash_new(size_t chunk_size);
+int sha256_90r_tree_hash_update(sha256_90r_tree_ctx_t* ctx, const uint8_t* data, size_t len);
+int sha256_90r_tree_hash_final(sha256_90r_tree_ctx_t* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE]);
+void sha256_90r_tree_hash_free(sha256_90r_tree_ctx_t* ctx);
+
+/* Incremental form for a buffer that changes in place. The tree is built
+ * once; after writing to the buffer, mark the bytes changed, and the next
+ * root call rehashes only the marked chunks (on the worker pool) and the
+ * parents on their paths. The root equals sha256_90r_tree_hash of the buffer
+ * with the same chunk_size. The buffer stays owned by the caller and must
+ * not move. mark_dirty may be called from any thread, also while root runs:
+ * a chunk marked after root took it is rehashed by the next call. stats may
+ * be NULL and covers the leaf phase. */
+typedef struct sha256_90r_itree sha256_90r_itree_t;
+
+sha256_90r_itree_t* sha256_90r_itree_new(const uint8_t* data, size_t len, size_t chunk_size, int num_threads);
+int sha256_90r_itree_mark_dirty(sha256_90r_itree_t* t, size_t off, size_t len);   // -1 if out of range
+size_t sha256_90r_itree_dirty_chunks(const sha256_90r_itree_t* t);
+int sha256_90r_itree_root(sha256_90r_itree_t* t, uint8_t hash[SHA256_90R_DIGEST_SIZE],
+                          sha256_90r_par_stats_t* stats);
+void sha256_90r_itree_free(sha256_90r_itree_t* t);
+
+/* Digests of count independent messages, spread over worker threads that
+ * each fill multi-buffer lanes. stats may be NULL. */
+int sha256_90r_batch_parallel(const uint8_t* const* messages, const size_t* lengths,
+                              uint8_t (*hashes)[SHA256_90R_DIGEST_SIZE], size_t count, int num_threads,
+                              sha256_90r_par_stats_t* stats);
+
+/* Topology helpers: usable nodes, node holding addr (-1 if not faulted in),
+ * and pinning the calling thread to a node's CPUs (0 / -1) */
+int sha256_90r_numa_node_count(void);
+int sha256_90r_numa_node_of(const void* addr);
+int sha256_90r_numa_bind_thread(int node);
+
+/*********************** MERKLE MOUNTAIN RANGE API *********************/
+
+/* Append-only accumulator (audit logs): a root after every append, proofs
+ * that a leaf is in the MMR at some size, and that a size extends an earlier
+ * one. Nodes are immutable and kept in an mmap-backed file (or in memory for
+ * path NULL); reopening the file restores the committed size without
+ * rehashing. One writer at a time; readers of the same object are fine
+ * between appends.
+ *   leaf = H(0x00 || data), parent = H(0x01 || left || right),
+ *   root = peaks bagged right to left with H(0x02 || peak || rest);
+ *   the root of an empty MMR is the digest of the empty string. */
+#define SHA256_90R_MMR_MAX_PROOF 192    // Digests in the longest proof
+
+typedef struct sha256_90r_mmr sha256_90r_mmr_t;
+
+/* Open or create; NULL with errno set on failure or a damaged file */
+sha256_90r_mmr_t* sha256_90r_mmr_open(const char* path);
+
+/* Make every append so far durable: nodes first, then the size in the header.
+ * Appends not synced are lost on a crash; the file stays valid. */
+int sha256_90r_mmr_sync(sha256_90r_mmr_t* mmr);
+void sha256_90r_mmr_close(sha256_90r_mmr_t* mmr);       // Syncs
+uint64_t sha256_90r_mmr_size(const sha256_90r_mmr_t* mmr);  // Leaves
+
+/* One leaf, O(log n) hashes; *index (may be NULL) gets its leaf index */
+int sha256_90r_mmr_append(sha256_90r_mmr_t* mmr, const void* data, size_t len, uint64_t* index);
+
+/* count leaves; the new leaves, then each level of new parents, are hashed
+ * as SIMD batches. Same nodes as count single appends. */
+int sha256_90r_mmr_append_batch(sha256_90r_mmr_t* mmr, const uint8_t* const* data, const size_t* lens,
+                                size_t count);
+
+/* Root of the first `leaves` leaves (any size up to the current one) */
+int sha256_90r_mmr_root(const sha256_90r_mmr_t* mmr, uint64_t leaves, uint8_t root[SHA256_90R_DIGEST_SIZE]);
+
+/* Inclusion of leaf `index` in the MMR of `leaves` leaves: proof gets
+ * *proof_len digests (at most SHA256_90R_MMR_MAX_PROOF). Verify returns 1
+ * if data is that leaf under root, else 0. */
+int sha256_90r_mmr_prove_inclusion(const sha256_90r_mmr_t* mmr, uint64_t index, uint64_t leaves,
+                                   uint8_t proof[][SHA256_90R_DIGEST_SIZE], size_t* proof_len);
+int sha256_90r_mmr_verify_inclusion(const uint8_t root[SHA256_90R_DIGEST_SIZE], uint64_t leaves, uint64_t index,
+                                    const void* data, size_t len,
+                                    const uint8_t proof[][SHA256_90R_DIGEST_SIZE], size_t proof_len);
+
+/* The MMR of new_leaves leaves extends the one of old_leaves leaves.
+ * Verify returns 1 if new_root's MMR has old_root's as its prefix, else 0. */
+int sha256_90r_mmr_prove_consistency(const sha256_90r_mmr_t* mmr, uint64_t old_leaves, uint64_t new_leaves,
+                                     uint8_t proof[][SHA256_90R_DIGEST_SIZE], size_t* proof_len);
+int sha256_90r_mmr_verify_consistency(const uint8_t old_root[SHA256_90R_DIGEST_SIZE], uint64_t old_leaves,
+                                      const uint8_t new_root[SHA256_90R_DIGEST_SIZE], uint64_t new_leaves,
+                                      const uint8_t proof[][SHA256_90R_DIGEST_SIZE], size_t proof_len);
+
+/*************************** NONCE SEARCH API ***************************/
+
+/* Proof-of-work search over a fixed header: every full block before the
+ * nonce is compressed once into a midstate, and only the padded final block
+ * is rehashed per nonce. The nonce is written little-endian; a hit is a
+ * digest that, read as a big-endian number, is <= target. */
+typedef struct {
+    uint32_t midstate[8];            // State after the blocks before the tail
+    uint8_t tail[64];                // Padded final block (template)
+    uint32_t nonce_offset;           // Nonce position within tail
+    uint32_t nonce_size;             // Nonce width in bytes (1..8)
+    uint8_t target[SHA256_90R_DIGEST_SIZE];
+    int lanes;                       // 0 = widest available, or 1, 8 (AVX2), 16 (AVX-512)
+} sha256_90r_pow_job_t;
+
+typedef struct {
+    int found;
+    uint64_t nonce;                  // Lowest hit in the searched range
+    uint8_t digest[SHA256_90R_DIGEST_SIZE];
+    uint64_t hashes;                 // Nonces actually hashed by all workers
+    int lanes;
+    int threads;
+} sha256_90r_pow_result_t;
+
+/* State after compressing len bytes (a multiple of 64) from the IV */
+int sha256_90r_midstate(const uint8_t* data, size_t len, uint32_t midstate[8]);
+
+/* Prepare a job for a len-byte header with a nonce_size-byte nonce at
+ * nonce_offset. Returns -1 unless the nonce lies in the final block and the
+ * padding fits there too (len % 64 < 56). */
+int sha256_90r_pow_init(sha256_90r_pow_job_t* job, const uint8_t* header, size_t len,
+                        size_t nonce_offset, size_t nonce_size,
+                        const uint8_t target[SHA256_90R_DIGEST_SIZE]);
+
+/* Search nonces [start_nonce, start_nonce + count) on num_threads workers
+ * (<= 0: one per online CPU). Returns 1 with the lowest hit, 0 if none,
+ * -1 on invalid input or an unsupported lane width. */
+int sha256_90r_pow_search(const sha256_90r_pow_job_t* job, uint64_t start_nonce, uint64_t count,
+                          int num_threads, sha256_90r_pow_result_t* result);
+
+/*************************** HASH CHAIN API ***************************/
+
+/* Iterated chains over 32-byte links: link 0 is the seed, link i + 1 is
+ * sha256_90r_hash(link i, 32). Every link is one block with constant
+ * padding, hashed without a context; independent chains share SIMD lanes.
+ * Chain values are secrets for OTP-style use; every path runs in constant
+ * time. */
+typedef struct sha256_90r_chain sha256_90r_chain_t;
+
+/* Link `links` of the chain starting at seed */
+int sha256_90r_chain_iterate(const uint8_t seed[SHA256_90R_DIGEST_SIZE], uint64_t links,
+                             uint8_t out[SHA256_90R_DIGEST_SIZE]);
+
+/* The same for count independent chains, 8 (AVX2) or 16 (AVX-512) at a time */
+int sha256_90r_chain_iterate_multi(const uint8_t* const* seeds, uint8_t** outs, size_t count, uint64_t links);
+
+/* Walk a chain of links 0..links once and keep every interval-th link
+ * (links / interval + 1 checkpoints) and the last one; NULL on invalid
+ * input (interval 0) or allocation failure */
+sha256_90r_chain_t* sha256_90r_chain_new(const uint8_t seed[SHA256_90R_DIGEST_SIZE], uint64_t links,
+                                         uint64_t interval);
+
+/* count chains built side by side in SIMD lanes; chains[i] for seeds[i] */
+int sha256_90r_chain_new_multi(const uint8_t* const* seeds, size_t count, uint64_t links, uint64_t interval,
+                               sha256_90r_chain_t** chains);
+
+/* Link `index` (0..links), recomputed from the checkpoint below it with
+ * fewer than interval hashes */
+int sha256_90r_chain_link(const sha256_90r_chain_t* chain, uint64_t index, uint8_t out[SHA256_90R_DIGEST_SIZE]);
+
+/* The checkpoints as *count consecutive 32-byte digests (link j * interval) */
+const uint8_t* sha256_90r_chain_checkpoints(const sha256_90r_chain_t* chain, size_t* count);
+void sha256_90r_chain_free(sha256_90r_chain_t* chain);
+
 /*************************** UTILITY API *************************/
 
 /* Get version string */
@@ -90,15 +510,246 @@ const char* sha256_90r_backend_name(const SHA256_90R_CTX* ctx);
 /* Check if backend is available */
 int sha256_90r_backend_available(sha256_90r_backend_t backend);
 
-/* Get performance estimate (Gbps) for backend */
+/* Measured single-thread throughput (Gbps) for backend, from the autotune
+ * plan (tuned on first call if needed); 0.0 if the backend is unavailable */
 double sha256_90r_backend_performance(sha256_90r_backend_t backend);
 
 /* Run self-test */
 int sha256_90r_selftest(void);
 
-/* Run timing test (returns timing variance in nanoseconds) */
+/* Run timing test (returns dudect leak score: max |t| over all crops, or -1.0 on error) */
 double sha256_90r_timing_test(sha256_90r_mode_t mode, int iterations);
 
+/*************************** AUTOTUNE API *************************/
+
+/* Short calibration run (~100 ms) that measures the available backends and
+ * picks the single-stream kernel, multi-buffer width, batch and threading
+ * thresholds, and a tree chunk size. The plan is cached in a file keyed by
+ * CPU model and CPU count: $SHA256_90R_TUNE_CACHE if set ("off" disables
+ * caching), otherwise $XDG_CACHE_HOME or ~/.cache/sha256-90r/. It runs from
+ * sha256_90r_init_library() unless SHA256_90R_AUTOTUNE=0. Digests never
+ * depend on the plan, except tree roots built with SHA256_90R_TREE_CHUNK_TUNED. */
+#define SHA256_90R_NUM_BACKENDS 7
+#define SHA256_90R_TUNE_FORCE 0x1        // Measure even if a cached plan matches
+#define SHA256_90R_TUNE_NO_CACHE 0x2     // Neither read nor write the cache file
+#define SHA256_90R_TREE_CHUNK_TUNED ((size_t)-1)
+
+/* Compression kernels. SCALAR, SCALAR_ROLLING, AVX2 and SCALAR_BMI2 hash one
+ * stream and can back sha256_90r_hash(); the lane kernels serve the
+ * multi-buffer manager and sha256_90r_batch(). None branches or indexes
+ * memory on message or state bits, so all are used in SECURE mode;
+ * sha256_90r_leak_test_kernel() checks each one (make test-ct-kernels). */
+typedef enum {
+    SHA256_90R_KERNEL_SCALAR = 0,            // Pre-expanded 90-word schedule
+    SHA256_90R_KERNEL_SCALAR_ROLLING = 1,    // 16-word rolling schedule
+    SHA256_90R_KERNEL_AVX2 = 2,              // AVX2 schedule expansion, scalar rounds
+    SHA256_90R_KERNEL_AVX2_8WAY = 3,         // 8 messages per call
+    SHA256_90R_KERNEL_AVX512_16WAY = 4,      // 16 messages per call
+    SHA256_90R_KERNEL_SCALAR_BMI2 = 5        // rorx/andn rounds (default where BMI2 exists)
+} sha256_90r_kernel_t;
+#define SHA256_90R_NUM_KERNELS 6
+
+/* 1 if this build and CPU can run the kernel */
+int sha256_90r_kernel_available(sha256_90r_kernel_t kernel);
+
+/* 1 for the kernels that can back sha256_90r_hash() (one stream per call) */
+int sha256_90r_kernel_single_stream(sha256_90r_kernel_t kernel);
+
+/* Kernel name ("scalar", "scalar-rolling", "avx2", "avx2-8way", "avx512-16way",
+ * "scalar-bmi2") */
+const char* sha256_90r_kernel_name(sha256_90r_kernel_t kernel);
+
+typedef struct {
+    char cpu_model[64];
+    int cpus;                        // Online CPUs when tuned
+    double backend_gbps[SHA256_90R_NUM_BACKENDS];   // By sha256_90r_backend_t; 0 = unavailable
+    sha256_90r_kernel_t kernel;      // Single-stream kernel for sha256_90r_hash
+    double kernel_gbps;
+    int mb_lanes;                    // Fastest multi-buffer width (1, 8, 16)
+    double mb_gbps;
+    size_t batch_min_count;          // sha256_90r_batch uses lanes from this many messages
+    int max_threads;                 // Threads past which throughput stops rising
+    size_t bytes_per_thread;         // Input that pays for starting one more thread
+    size_t tree_chunk_size;          // Fastest chunk for SHA256_90R_TREE_CHUNK_TUNED
+    double tune_seconds;             // Time the measurement took
+    int from_cache;
+} sha256_90r_tune_plan_t;
+
+/* Load or measure a plan and apply it; plan may be NULL. Returns 0 or -1. */
+int sha256_90r_autotune(int flags, sha256_90r_tune_plan_t* plan);
+
+/* Current plan: 0 if one is applied, -1 if not tuned (plan gets defaults) */
+int sha256_90r_get_tune_plan(sha256_90r_tune_plan_t* plan);
+
+/* Worker threads for an input of len bytes (every online CPU if not tuned) */
+int sha256_90r_tune_threads(size_t len);
+
+/*********************** ROUND-COUNT VARIANTS API *********************/
+/* The same construction at 72, 80, 90 and 128 rounds, every kernel form
+ * generated from one template. Variant R uses the first R round constants
+ * of one table that starts with SHA256-90R's, and SHA256-90R's IV and
+ * padding: the 90-round variant is sha256_90r_hash(). */
+#define SHA256_90R_VARIANT_MAX_ROUNDS 128
+
+typedef struct sha256_90r_variant sha256_90r_variant_t;     // Registry entry
+
+size_t sha256_90r_variant_count(void);
+const sha256_90r_variant_t* sha256_90r_variant_get(size_t index);     // NULL past the end
+const sha256_90r_variant_t* sha256_90r_variant_find(int rounds);      // NULL if not built
+int sha256_90r_variant_rounds(const sha256_90r_variant_t* v);
+const char* sha256_90r_variant_name(const sha256_90r_variant_t* v);   // "SHA256-128R"
+
+/* 1 if v has this kernel form and the CPU can run it */
+int sha256_90r_variant_kernel_available(const sha256_90r_variant_t* v, sha256_90r_kernel_t kernel);
+
+/* Caller-allocated streaming context, like sha256_90r_state_t */
+typedef struct {
+    const sha256_90r_variant_t* variant;
+    sha256_90r_kernel_t kernel;      // Single-stream kernel (CPUID default after init)
+    uint32_t state[8];
+    uint64_t bitlen;                 // Bits already compressed
+    uint8_t data[64];
+    uint32_t datalen;
+} sha256_90r_variant_ctx_t;
+
+int sha256_90r_variant_init(sha256_90r_variant_ctx_t* ctx, const sha256_90r_variant_t* v);
+/* Any single-stream kernel v has here; -1 otherwise. Digests do not change. */
+int sha256_90r_variant_set_kernel(sha256_90r_variant_ctx_t* ctx, sha256_90r_kernel_t kernel);
+int sha256_90r_variant_update(sha256_90r_variant_ctx_t* ctx, const void* data, size_t len);
+/* Writes the digest and starts the context over on a new message */
+int sha256_90r_variant_final(sha256_90r_variant_ctx_t* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE]);
+int sha256_90r_variant_hash(const sha256_90r_variant_t* v, const void* data, size_t len,
+                            uint8_t hash[SHA256_90R_DIGEST_SIZE]);
+
+/* Messages through the multi-lane kernels (tuned width, else the widest),
+ * a lane refilled as soon as its message ends. Returns 0 or -1. */
+int sha256_90r_variant_batch(const sha256_90r_variant_t* v, const uint8_t** messages, const size_t* lengths,
+                             uint8_t** hashes, size_t count);
+
+/*********************** TIMING ANALYSIS API *********************/
+
+/* |t| above this value is treated as evidence of a timing leak (dudect convention) */
+#define SHA256_90R_CT_T_THRESHOLD 4.5
+
+/* Entry points exercised by the leak analyzer */
+typedef enum {
+    SHA256_90R_CT_API_TRANSFORM = 0, // One 64-byte block compression
+    SHA256_90R_CT_API_UPDATE = 1,    // Streaming update over a two-block message
+    SHA256_90R_CT_API_FINAL = 2,     // Finalization of a partial block
+    SHA256_90R_CT_API_ONESHOT = 3    // reset + update + final of a one-block message
+} sha256_90r_ct_api_t;
+
+/* Result of a fixed-vs-random (dudect) leak analysis */
+typedef struct {
+    double leak_score;               // max |t| over all tests with enough samples
+    double t_uncropped;              // first-order t without percentile cropping
+    double t_second_order;           // t on centered squared samples
+    uint64_t measurements;           // measurements kept (both classes, all threads)
+    uint64_t class_counts[2];        // measurements per class (fixed, random)
+    int threads;                     // worker threads used
+    int supported;                   // 0 if the backend/API pair cannot be measured
+    int leak_detected;               // leak_score > SHA256_90R_CT_T_THRESHOLD
+} sha256_90r_leak_report_t;
+
+/* Run a dudect-style analysis of one backend/API pair.
+ * measurements: total across threads; num_threads <= 0 uses every online CPU.
+ * mode only affects the AUTO backend. Returns 0 on success, -1 on error. */
+int sha256_90r_leak_test(sha256_90r_backend_t backend, sha256_90r_mode_t mode,
+                         sha256_90r_ct_api_t api, uint64_t measurements,
+                         int num_threads, sha256_90r_leak_report_t* report);
+
+/* Same analysis on one compression kernel: each measurement is a single
+ * kernel call on the class input (lane kernels get it in every lane).
+ * report->supported is 0 if the kernel is unavailable here. */
+int sha256_90r_leak_test_kernel(sha256_90r_kernel_t kernel, uint64_t measurements,
+                                int num_threads, sha256_90r_leak_report_t* report);
+
+/* Name of an analyzer API ("transform", "update", "final", "oneshot") */
+const char* sha256_90r_ct_api_name(sha256_90r_ct_api_t api);
+
+/*********************** ENERGY MEASUREMENT API *********************/
+
+#define SHA256_90R_ENERGY_MAX_DOMAINS 16
+
+/* Where package energy readings come from */
+typedef enum {
+    SHA256_90R_ENERGY_NONE = 0,      // No readable counter; regions are only timed
+    SHA256_90R_ENERGY_POWERCAP = 1,  // /sys/class/powercap/intel-rapl:N/energy_uj
+    SHA256_90R_ENERGY_PERF = 2       // perf_event power/energy-pkg/
+} sha256_90r_energy_source_t;
+
+/* One measured region. Energy is package-wide (all sockets summed), so
+ * measure a whole multi-threaded region once rather than once per thread. */
+typedef struct {
+    sha256_90r_energy_source_t source;
+    double joules;                   // Package energy consumed in the region
+    double seconds;                  // Wall-clock duration of the region
+    double watts;                    // joules / seconds
+    /* Private */
+    int domains;
+    int fds[SHA256_90R_ENERGY_MAX_DOMAINS];
+    uint64_t start_raw[SHA256_90R_ENERGY_MAX_DOMAINS];
+    uint64_t range_raw[SHA256_90R_ENERGY_MAX_DOMAINS];
+    double scale;                    // Joules per raw count
+    double start_time;
+} sha256_90r_energy_t;
+
+/* Begin a region. Returns 0 if an energy counter is readable, -1 if not
+ * (the region is still timed and stop() still reports seconds). */
+int sha256_90r_energy_start(sha256_90r_energy_t* region);
+
+/* End a region and fill joules/seconds/watts. Returns 0 on success, -1 if no
+ * energy reading is available for the region. */
+int sha256_90r_energy_stop(sha256_90r_energy_t* region);
+
+/* Energy source this process can use, probing once ("powercap", "perf", "none") */
+sha256_90r_energy_source_t sha256_90r_energy_source(void);
+const char* sha256_90r_energy_source_name(sha256_90r_energy_source_t source);
+
+/*********************** PERFORMANCE COUNTER API *********************/
+
+/* Counters opened around a measured region (calling thread, user space only) */
+typedef enum {
+    SHA256_90R_PMC_CYCLES = 0,
+    SHA256_90R_PMC_INSTRUCTIONS,
+    SHA256_90R_PMC_BRANCH_MISSES,
+    SHA256_90R_PMC_UOPS,             // Raw uops-dispatched/executed event (vendor specific)
+    SHA256_90R_PMC_L1D_MISSES,       // L1D read misses
+    SHA256_90R_PMC_LLC_MISSES,       // Last-level cache misses
+    SHA256_90R_PMC_STORE_FWD,        // Loads blocked by failed store forwarding (raw, vendor specific)
+    SHA256_90R_PMC_TASK_CLOCK,       // Software event: ns on CPU (works without a PMU)
+    SHA256_90R_PMC_COUNT
+} sha256_90r_pmc_event_t;
+
+/* Counter set. Hardware events are opened as two groups ({cycles,
+ * instructions, branch-misses, uops} and {L1D, LLC}) so that each group's
+ * ratios come from the same time slice; counts are scaled when the kernel
+ * multiplexes groups. Events the CPU/kernel cannot provide stay invalid. */
+typedef struct {
+    uint64_t counts[SHA256_90R_PMC_COUNT];   // Valid after sha256_90r_pmc_stop()
+    int valid[SHA256_90R_PMC_COUNT];         // Event opened and counted
+    /* Private */
+    int fds[SHA256_90R_PMC_COUNT];
+    int leaders[3];
+} sha256_90r_pmc_t;
+
+/* Open all available counters (disabled). Returns the number of events
+ * opened, 0 if none are available. */
+int sha256_90r_pmc_open(sha256_90r_pmc_t* pmc);
+void sha256_90r_pmc_close(sha256_90r_pmc_t* pmc);
+
+/* Reset and enable / disable and read every group. Return 0 on success,
+ * -1 if no counter is open. */
+int sha256_90r_pmc_start(sha256_90r_pmc_t* pmc);
+int sha256_90r_pmc_stop(sha256_90r_pmc_t* pmc);
+
+/* Derived metrics; return a negative value when an input event is invalid */
+double sha256_90r_pmc_ipc(const sha256_90r_pmc_t* pmc);
+double sha256_90r_pmc_per_kb(const sha256_90r_pmc_t* pmc, sha256_90r_pmc_event_t event, double bytes);
+
+/* Short event name ("cycles", "instructions", "l1d-misses", ...) */
+const char* sha256_90r_pmc_event_name(sha256_90r_pmc_event_t event);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,233 @@
+/*********************************************************************
+* Filename:   sha256_90r.hpp
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Header-only C++17/20 interface. sha256_90r::digest() is a
+*             constexpr implementation of the 90-round transform and
+*             padding, so digests of literals fold at compile time; at run
+*             time it calls the C library. sha256_90r::hasher is a move-only
+*             streaming wrapper over the caller-allocated C context
+*             (sha256_90r_state_t) and never touches the heap.
+*********************************************************************/
+
+#ifndef SHA256_90R_HPP
+#define SHA256_90R_HPP
+
+/*************************** HEADER FILES ***************************/
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#define SHA256_90R_HPP_HAS_SPAN 1
+#endif
+#endif
+#include "sha256_90r.h"
+
+/****************************** MACROS ******************************/
+// Constant evaluation test: lets digest() use the C kernels at run time
+#if defined(__cpp_lib_is_constant_evaluated)
+#define SHA256_90R_HPP_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#define SHA256_90R_HPP_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#elif defined(__clang__)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define SHA256_90R_HPP_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
+namespace sha256_90r {
+
+/**************************** DATA TYPES ****************************/
+using digest_t = std::array<std::uint8_t, SHA256_90R_DIGEST_SIZE>;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+namespace detail {
+
+// Same table as k_90r in sha256.c: the SHA-256 constants, then the extension
+inline constexpr std::uint32_t k[90] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    0xc67178f2, 0xca273ece, 0xd186b8c7, 0xeada7dd6, 0xf57d4f7f, 0x06f067aa, 0x0a637dc5, 0x113f9804,
+    0x1b710b35, 0x28db77f5, 0x32caab7b, 0x3c9ebe0a, 0x431d67c4, 0x4cc5d4be, 0x597f299c, 0x5fcb6fab,
+    0x6c44198c, 0x7ba0ea2d, 0x7eabf2d0, 0x8dbe8d03, 0x90bb1721, 0x99a2ad45, 0x9f86e289, 0xa84c4472,
+    0xb3df34fc, 0xb99bb8d7
+};
+
+inline constexpr std::uint32_t iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+constexpr std::uint32_t rotr(std::uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+// One 90-round compression of a 64-byte block
+constexpr void transform(std::uint32_t (&state)[8], const std::uint8_t (&block)[64]) {
+    std::uint32_t m[90] = {};
+
+    for (int i = 0; i < 16; i++) {
+        m[i] = (std::uint32_t(block[4 * i]) << 24) | (std::uint32_t(block[4 * i + 1]) << 16) |
+               (std::uint32_t(block[4 * i + 2]) << 8) | std::uint32_t(block[4 * i + 3]);
+    }
+    for (int i = 16; i < 90; i++) {
+        std::uint32_t s0 = rotr(m[i - 15], 7) ^ rotr(m[i - 15], 18) ^ (m[i - 15] >> 3);
+        std::uint32_t s1 = rotr(m[i - 2], 17) ^ rotr(m[i - 2], 19) ^ (m[i - 2] >> 10);
+        m[i] = s1 + m[i - 7] + s0 + m[i - 16];
+    }
+
+    std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 90; i++) {
+        std::uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + m[i];
+        std::uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+// Whole message through padding: byte(i) returns message byte i of len
+template <typename ByteAt>
+constexpr digest_t digest_bytes(ByteAt byte, std::size_t len) {
+    std::uint32_t state[8] = {iv[0], iv[1], iv[2], iv[3], iv[4], iv[5], iv[6], iv[7]};
+    std::uint8_t block[64] = {};
+    std::size_t off = 0;
+
+    for (; len - off >= 64; off += 64) {
+        for (int i = 0; i < 64; i++) block[i] = byte(off + i);
+        transform(state, block);
+    }
+
+    // Tail, 0x80, zeros, then the 64-bit big-endian bit length
+    std::size_t tail = len - off;
+    for (std::size_t i = 0; i < 64; i++) block[i] = i < tail ? byte(off + i) : 0;
+    block[tail] = 0x80;
+    if (tail >= 56) {
+        transform(state, block);
+        for (int i = 0; i < 64; i++) block[i] = 0;
+    }
+    std::uint64_t bits = std::uint64_t(len) * 8;
+    for (int i = 0; i < 8; i++) block[63 - i] = std::uint8_t(bits >> (8 * i));
+    transform(state, block);
+
+    digest_t out = {};
+    for (int i = 0; i < 8; i++) {
+        out[4 * i] = std::uint8_t(state[i] >> 24);
+        out[4 * i + 1] = std::uint8_t(state[i] >> 16);
+        out[4 * i + 2] = std::uint8_t(state[i] >> 8);
+        out[4 * i + 3] = std::uint8_t(state[i]);
+    }
+    return out;
+}
+
+// The constexpr path, callable directly so tests can check it at run time
+constexpr digest_t digest_constexpr(std::string_view s) {
+    return digest_bytes([s](std::size_t i) { return std::uint8_t(s[i]); }, s.size());
+}
+
+}  // namespace detail
+
+/*************************** PUBLIC API ***************************/
+
+// SHA256-90R of s: a constant expression when s is, the C library otherwise
+constexpr digest_t digest(std::string_view s) {
+#ifdef SHA256_90R_HPP_CONSTANT_EVALUATED
+    if (!SHA256_90R_HPP_CONSTANT_EVALUATED()) {
+        digest_t out = {};
+        sha256_90r_hash(reinterpret_cast<const std::uint8_t*>(s.data()), s.size(), out.data());
+        return out;
+    }
+#endif
+    return detail::digest_constexpr(s);
+}
+
+#ifdef SHA256_90R_HPP_HAS_SPAN
+constexpr digest_t digest(std::span<const std::uint8_t> s) {
+#ifdef SHA256_90R_HPP_CONSTANT_EVALUATED
+    if (!SHA256_90R_HPP_CONSTANT_EVALUATED()) {
+        digest_t out = {};
+        sha256_90r_hash(s.data(), s.size(), out.data());
+        return out;
+    }
+#endif
+    return detail::digest_bytes([s](std::size_t i) { return s[i]; }, s.size());
+}
+
+inline digest_t digest(std::span<const std::byte> s) {
+    digest_t out = {};
+    sha256_90r_hash(reinterpret_cast<const std::uint8_t*>(s.data()), s.size(), out.data());
+    return out;
+}
+#endif
+
+// Streaming hasher over a caller-allocated C context. Move-only: a moved-from
+// hasher is reset to an empty message. The state is wiped on destruction.
+class hasher {
+public:
+    hasher() noexcept { sha256_90r_state_init(&st_); }
+    ~hasher() { wipe(); }
+
+    hasher(const hasher&) = delete;
+    hasher& operator=(const hasher&) = delete;
+
+    hasher(hasher&& other) noexcept : st_(other.st_) { other.reset(); }
+    hasher& operator=(hasher&& other) noexcept {
+        if (this != &other) {
+            st_ = other.st_;
+            other.reset();
+        }
+        return *this;
+    }
+
+    hasher& update(const void* data, std::size_t len) noexcept {
+        sha256_90r_state_update(&st_, static_cast<const std::uint8_t*>(data), len);
+        return *this;
+    }
+    hasher& update(std::string_view s) noexcept { return update(s.data(), s.size()); }
+#ifdef SHA256_90R_HPP_HAS_SPAN
+    hasher& update(std::span<const std::uint8_t> s) noexcept { return update(s.data(), s.size()); }
+    hasher& update(std::span<const std::byte> s) noexcept { return update(s.data(), s.size()); }
+#endif
+
+    // Digest of everything since construction or the last final()/reset();
+    // the hasher then starts on a new message
+    digest_t final() noexcept {
+        digest_t out = {};
+        sha256_90r_state_final(&st_, out.data());
+        reset();
+        return out;
+    }
+
+    void reset() noexcept {
+        wipe();
+        sha256_90r_state_init(&st_);
+    }
+
+private:
+    void wipe() noexcept {
+        volatile std::uint8_t* p = reinterpret_cast<volatile std::uint8_t*>(&st_);
+        for (std::size_t i = 0; i < sizeof(st_); i++) p[i] = 0;
+    }
+
+    sha256_90r_state_t st_;
+};
+
+}  // namespace sha256_90r
+
+#endif // SHA256_90R_HPP
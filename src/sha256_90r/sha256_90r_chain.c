@@ -0,0 +1,394 @@
+/*********************************************************************
+* Filename:   sha256_90r_chain.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Iterated hash chains, link i+1 = H(link i) over 32-byte
+*             links (one-time-password style). The message of every link
+*             is the previous digest followed by a fixed padding block, so
+*             message words 0..7 are the previous state words as they
+*             stand (no byte swap, no buffer) and words 8..15 are
+*             constants. The state stays in registers from link to link;
+*             independent chains run side by side in 8 (AVX2) or 16
+*             (AVX-512) lanes. A chain object keeps every k-th link, so
+*             any link is recomputed with at most k - 1 hashes.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CHAIN_HAVE_X86 1
+#endif
+
+/****************************** MACROS ******************************/
+#define CHAIN_ROUNDS 90
+#define CHAIN_MAX_LANES SHA256_90R_MAX_LANES
+
+// Message words 8..15 of a 32-byte message: 0x80 byte, zeros, bit length 256
+#define CHAIN_PAD(t) ((t) == 8 ? 0x80000000u : (t) == 15 ? 256u : 0u)
+
+/**************************** DATA TYPES ****************************/
+struct sha256_90r_chain {
+    uint64_t links;                 // Last link index; link 0 is the seed
+    uint64_t interval;              // Checkpoint j is link j * interval
+    size_t count;                   // links / interval + 1
+    uint8_t tip[SHA256_90R_DIGEST_SIZE];
+    uint8_t checkpoints[];          // count digests
+};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static inline uint32_t load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void chain_load(const uint8_t digest[SHA256_90R_DIGEST_SIZE], uint32_t st[8]) {
+    for (int i = 0; i < 8; i++) st[i] = load_be32(digest + 4 * i);
+}
+
+/*************************** KERNELS ***************************/
+
+// n links of one chain. Fully unrolled, so the padding words and the
+// schedule terms built only from them fold into the round constants.
+static inline __attribute__((always_inline)) void chain_rounds_scalar(uint32_t st[8], uint64_t n) {
+    uint32_t s0 = st[0], s1 = st[1], s2 = st[2], s3 = st[3];
+    uint32_t s4 = st[4], s5 = st[5], s6 = st[6], s7 = st[7];
+    struct sha256_90r_internal_ctx iv;
+
+    sha256_90r_init_internal(&iv);
+    for (; n > 0; n--) {
+        uint32_t w[CHAIN_ROUNDS];
+        uint32_t a, b, c, d, e, f, g, h, t1, t2;
+
+        w[0] = s0; w[1] = s1; w[2] = s2; w[3] = s3;
+        w[4] = s4; w[5] = s5; w[6] = s6; w[7] = s7;
+#pragma GCC unroll 8
+        for (int t = 8; t < 16; t++) w[t] = CHAIN_PAD(t);
+
+        a = iv.state[0]; b = iv.state[1]; c = iv.state[2]; d = iv.state[3];
+        e = iv.state[4]; f = iv.state[5]; g = iv.state[6]; h = iv.state[7];
+        // Schedule words are produced in the round that uses them
+#pragma GCC unroll 90
+        for (int t = 0; t < CHAIN_ROUNDS; t++) {
+            if (t >= 16) w[t] = SIG1(w[t - 2]) + w[t - 7] + SIG0(w[t - 15]) + w[t - 16];
+            t1 = h + EP1(e) + CH(e, f, g) + k_90r[t] + w[t];
+            t2 = EP0(a) + MAJ(a, b, c);
+            h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+        }
+        s0 = iv.state[0] + a; s1 = iv.state[1] + b; s2 = iv.state[2] + c; s3 = iv.state[3] + d;
+        s4 = iv.state[4] + e; s5 = iv.state[5] + f; s6 = iv.state[6] + g; s7 = iv.state[7] + h;
+    }
+    st[0] = s0; st[1] = s1; st[2] = s2; st[3] = s3;
+    st[4] = s4; st[5] = s5; st[6] = s6; st[7] = s7;
+}
+
+__attribute__((optimize("O3", "unroll-loops")))
+static void chain_run_generic(uint32_t st[8], uint64_t n) {
+    chain_rounds_scalar(st, n);
+}
+
+#ifdef CHAIN_HAVE_X86
+// Same links compiled for rorx/andn, as the BMI2 transform kernel
+__attribute__((target("bmi,bmi2"), optimize("O3", "unroll-loops")))
+static void chain_run_bmi2(uint32_t st[8], uint64_t n) {
+    chain_rounds_scalar(st, n);
+}
+#endif
+
+static void chain_run_scalar(uint32_t st[8], uint64_t n) {
+#ifdef CHAIN_HAVE_X86
+    if (__builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2")) {
+        chain_run_bmi2(st, n);
+        return;
+    }
+#endif
+    chain_run_generic(st, n);
+}
+
+#ifdef CHAIN_HAVE_X86
+// n links of eight chains; st[word][lane]. Schedule terms on the constant
+// padding words are added as scalars, so only terms on the state are vector work.
+__attribute__((target("avx2")))
+static void chain_run_avx2_8way(uint32_t st[8][8], uint64_t n) {
+    __m256i s[8];
+    struct sha256_90r_internal_ctx iv;
+
+    sha256_90r_init_internal(&iv);
+    for (int i = 0; i < 8; i++) s[i] = _mm256_loadu_si256((const __m256i *)st[i]);
+    for (; n > 0; n--) {
+        __m256i w[CHAIN_ROUNDS];
+        __m256i a, b, c, d, e, f, g, h, t1, t2;
+
+        for (int t = 0; t < 8; t++) w[t] = s[t];
+        for (int t = 8; t < 16; t++) w[t] = _mm256_set1_epi32((int)CHAIN_PAD(t));
+#pragma GCC unroll 74
+        for (int t = 16; t < CHAIN_ROUNDS; t++) {
+            uint32_t pad = 0;
+            __m256i v;
+            // Words 8..15 are constants: fold their terms before touching vectors
+            if (t - 2 >= 8 && t - 2 < 16) pad += SIG1(CHAIN_PAD(t - 2));
+            if (t - 7 >= 8 && t - 7 < 16) pad += CHAIN_PAD(t - 7);
+            if (t - 15 >= 8 && t - 15 < 16) pad += SIG0(CHAIN_PAD(t - 15));
+            if (t - 16 >= 8 && t - 16 < 16) pad += CHAIN_PAD(t - 16);
+            v = _mm256_set1_epi32((int)pad);
+            if (t - 2 < 8 || t - 2 >= 16) v = _mm256_add_epi32(v, MM256_90R_SIG1(w[t - 2]));
+            if (t - 7 < 8 || t - 7 >= 16) v = _mm256_add_epi32(v, w[t - 7]);
+            if (t - 15 < 8 || t - 15 >= 16) v = _mm256_add_epi32(v, MM256_90R_SIG0(w[t - 15]));
+            if (t - 16 < 8 || t - 16 >= 16) v = _mm256_add_epi32(v, w[t - 16]);
+            w[t] = v;
+        }
+
+        a = _mm256_set1_epi32((int)iv.state[0]); b = _mm256_set1_epi32((int)iv.state[1]);
+        c = _mm256_set1_epi32((int)iv.state[2]); d = _mm256_set1_epi32((int)iv.state[3]);
+        e = _mm256_set1_epi32((int)iv.state[4]); f = _mm256_set1_epi32((int)iv.state[5]);
+        g = _mm256_set1_epi32((int)iv.state[6]); h = _mm256_set1_epi32((int)iv.state[7]);
+#pragma GCC unroll 90
+        for (int t = 0; t < CHAIN_ROUNDS; t++) {
+            t1 = _mm256_add_epi32(h, _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(e, 6), MM256_ROTR(e, 11)),
+                                                      MM256_ROTR(e, 25)));
+            t1 = _mm256_add_epi32(t1, _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g)));
+            t1 = _mm256_add_epi32(t1, _mm256_add_epi32(_mm256_set1_epi32((int)k_90r[t]), w[t]));
+            t2 = _mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(a, 2), MM256_ROTR(a, 13)),
+                                                   MM256_ROTR(a, 22)),
+                                  _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b))));
+            h = g; g = f; f = e; e = _mm256_add_epi32(d, t1); d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+        }
+        s[0] = _mm256_add_epi32(a, _mm256_set1_epi32((int)iv.state[0]));
+        s[1] = _mm256_add_epi32(b, _mm256_set1_epi32((int)iv.state[1]));
+        s[2] = _mm256_add_epi32(c, _mm256_set1_epi32((int)iv.state[2]));
+        s[3] = _mm256_add_epi32(d, _mm256_set1_epi32((int)iv.state[3]));
+        s[4] = _mm256_add_epi32(e, _mm256_set1_epi32((int)iv.state[4]));
+        s[5] = _mm256_add_epi32(f, _mm256_set1_epi32((int)iv.state[5]));
+        s[6] = _mm256_add_epi32(g, _mm256_set1_epi32((int)iv.state[6]));
+        s[7] = _mm256_add_epi32(h, _mm256_set1_epi32((int)iv.state[7]));
+    }
+    for (int i = 0; i < 8; i++) _mm256_storeu_si256((__m256i *)st[i], s[i]);
+}
+
+// Sixteen chains; native rotates and ternary logic
+__attribute__((target("avx512f")))
+static void chain_run_avx512_16way(uint32_t st[8][16], uint64_t n) {
+    __m512i s[8];
+    struct sha256_90r_internal_ctx iv;
+
+    sha256_90r_init_internal(&iv);
+    for (int i = 0; i < 8; i++) s[i] = _mm512_loadu_si512((const void *)st[i]);
+    for (; n > 0; n--) {
+        __m512i w[CHAIN_ROUNDS];
+        __m512i a, b, c, d, e, f, g, h, t1, t2;
+
+        for (int t = 0; t < 8; t++) w[t] = s[t];
+        for (int t = 8; t < 16; t++) w[t] = _mm512_set1_epi32((int)CHAIN_PAD(t));
+#pragma GCC unroll 74
+        for (int t = 16; t < CHAIN_ROUNDS; t++) {
+            uint32_t pad = 0;
+            __m512i v;
+            if (t - 2 >= 8 && t - 2 < 16) pad += SIG1(CHAIN_PAD(t - 2));
+            if (t - 7 >= 8 && t - 7 < 16) pad += CHAIN_PAD(t - 7);
+            if (t - 15 >= 8 && t - 15 < 16) pad += SIG0(CHAIN_PAD(t - 15));
+            if (t - 16 >= 8 && t - 16 < 16) pad += CHAIN_PAD(t - 16);
+            v = _mm512_set1_epi32((int)pad);
+            if (t - 2 < 8 || t - 2 >= 16) v = _mm512_add_epi32(v, MM512_90R_SIG1(w[t - 2]));
+            if (t - 7 < 8 || t - 7 >= 16) v = _mm512_add_epi32(v, w[t - 7]);
+            if (t - 15 < 8 || t - 15 >= 16) v = _mm512_add_epi32(v, MM512_90R_SIG0(w[t - 15]));
+            if (t - 16 < 8 || t - 16 >= 16) v = _mm512_add_epi32(v, w[t - 16]);
+            w[t] = v;
+        }
+
+        a = _mm512_set1_epi32((int)iv.state[0]); b = _mm512_set1_epi32((int)iv.state[1]);
+        c = _mm512_set1_epi32((int)iv.state[2]); d = _mm512_set1_epi32((int)iv.state[3]);
+        e = _mm512_set1_epi32((int)iv.state[4]); f = _mm512_set1_epi32((int)iv.state[5]);
+        g = _mm512_set1_epi32((int)iv.state[6]); h = _mm512_set1_epi32((int)iv.state[7]);
+#pragma GCC unroll 90
+        for (int t = 0; t < CHAIN_ROUNDS; t++) {
+            // 0x96 = x ^ y ^ z, 0xCA = x ? y : z (CH), 0xE8 = majority
+            t1 = _mm512_add_epi32(h, _mm512_ternarylogic_epi32(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11),
+                                                               _mm512_ror_epi32(e, 25), 0x96));
+            t1 = _mm512_add_epi32(t1, _mm512_ternarylogic_epi32(e, f, g, 0xCA));
+            t1 = _mm512_add_epi32(t1, _mm512_add_epi32(_mm512_set1_epi32((int)k_90r[t]), w[t]));
+            t2 = _mm512_add_epi32(_mm512_ternarylogic_epi32(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13),
+                                                            _mm512_ror_epi32(a, 22), 0x96),
+                                  _mm512_ternarylogic_epi32(a, b, c, 0xE8));
+            h = g; g = f; f = e; e = _mm512_add_epi32(d, t1); d = c; c = b; b = a; a = _mm512_add_epi32(t1, t2);
+        }
+        s[0] = _mm512_add_epi32(a, _mm512_set1_epi32((int)iv.state[0]));
+        s[1] = _mm512_add_epi32(b, _mm512_set1_epi32((int)iv.state[1]));
+        s[2] = _mm512_add_epi32(c, _mm512_set1_epi32((int)iv.state[2]));
+        s[3] = _mm512_add_epi32(d, _mm512_set1_epi32((int)iv.state[3]));
+        s[4] = _mm512_add_epi32(e, _mm512_set1_epi32((int)iv.state[4]));
+        s[5] = _mm512_add_epi32(f, _mm512_set1_epi32((int)iv.state[5]));
+        s[6] = _mm512_add_epi32(g, _mm512_set1_epi32((int)iv.state[6]));
+        s[7] = _mm512_add_epi32(h, _mm512_set1_epi32((int)iv.state[7]));
+    }
+    for (int i = 0; i < 8; i++) _mm512_storeu_si512((void *)st[i], s[i]);
+}
+#endif // CHAIN_HAVE_X86
+
+// Lane width for `left` remaining chains: the tuned multi-buffer width, else
+// the widest; a single chain takes the scalar kernel
+static int chain_lanes(size_t left) {
+#ifdef CHAIN_HAVE_X86
+    int tuned = sha256_90r_tune_mb_lanes();
+    int has16 = __builtin_cpu_supports("avx512f");
+    int has8 = __builtin_cpu_supports("avx2");
+
+    if (left < 2 || tuned == 1) return 1;
+    if ((tuned == 8 || left <= 8) && has8) return 8;
+    return has16 ? 16 : has8 ? 8 : 1;
+#else
+    (void)left;
+    return 1;
+#endif
+}
+
+// Advance `count` chains (state words in st[c][8]) by n links each, `lanes` at a time
+static void chain_run_group(uint32_t (*st)[8], size_t count, int lanes, uint64_t n) {
+#ifdef CHAIN_HAVE_X86
+    uint32_t wm[8 * CHAIN_MAX_LANES];
+
+    if (lanes > 1) {
+        // Word-major rows of `lanes` words for the kernels; unused lanes run
+        // on a copy of lane 0
+        for (int w = 0; w < 8; w++) {
+            for (int l = 0; l < lanes; l++) {
+                SHA256_90R_LANE_STATE(wm, lanes, w, l) = st[(size_t)l < count ? l : 0][w];
+            }
+        }
+        if (lanes == 16) chain_run_avx512_16way((uint32_t (*)[16])wm, n);
+        else chain_run_avx2_8way((uint32_t (*)[8])wm, n);
+        for (size_t l = 0; l < count; l++) {
+            for (int w = 0; w < 8; w++) st[l][w] = SHA256_90R_LANE_STATE(wm, lanes, w, l);
+        }
+        return;
+    }
+#else
+    (void)lanes;
+#endif
+    for (size_t c = 0; c < count; c++) chain_run_scalar(st[c], n);
+}
+
+static size_t chain_checkpoint_count(uint64_t links, uint64_t interval) {
+    return (size_t)(links / interval) + 1;
+}
+
+/*************************** PUBLIC API ***************************/
+
+int sha256_90r_chain_iterate(const uint8_t seed[SHA256_90R_DIGEST_SIZE], uint64_t links,
+                             uint8_t out[SHA256_90R_DIGEST_SIZE])
+{
+    uint32_t st[8];
+
+    if (!seed || !out) return -1;
+    chain_load(seed, st);
+    chain_run_scalar(st, links);
+    sha256_90r_store_digest(st, out);
+    return 0;
+}
+
+int sha256_90r_chain_iterate_multi(const uint8_t* const* seeds, uint8_t** outs, size_t count, uint64_t links)
+{
+    if (count > 0 && (!seeds || !outs)) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if (!seeds[i] || !outs[i]) return -1;
+    }
+
+    for (size_t done = 0; done < count;) {
+        uint32_t st[CHAIN_MAX_LANES][8];
+        int lanes = chain_lanes(count - done);
+        size_t group = count - done < (size_t)lanes ? count - done : (size_t)lanes;
+
+        for (size_t l = 0; l < group; l++) chain_load(seeds[done + l], st[l]);
+        chain_run_group(st, group, lanes, links);
+        for (size_t l = 0; l < group; l++) sha256_90r_store_digest(st[l], outs[done + l]);
+        done += group;
+    }
+    return 0;
+}
+
+int sha256_90r_chain_new_multi(const uint8_t* const* seeds, size_t count, uint64_t links, uint64_t interval,
+                               sha256_90r_chain_t** chains)
+{
+    size_t ncp;
+
+    if (count > 0 && (!seeds || !chains)) return -1;
+    if (interval == 0 || links / interval >= SIZE_MAX / SHA256_90R_DIGEST_SIZE) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if (!seeds[i]) return -1;
+    }
+    ncp = chain_checkpoint_count(links, interval);
+    for (size_t i = 0; i < count; i++) {
+        chains[i] = malloc(sizeof(sha256_90r_chain_t) + ncp * SHA256_90R_DIGEST_SIZE);
+        if (!chains[i]) {
+            while (i > 0) free(chains[--i]);
+            return -1;
+        }
+        chains[i]->links = links;
+        chains[i]->interval = interval;
+        chains[i]->count = ncp;
+    }
+
+    // Each group of lanes walks its chains one interval at a time and
+    // stores every lane's checkpoint between intervals
+    for (size_t done = 0; done < count;) {
+        uint32_t st[CHAIN_MAX_LANES][8];
+        int lanes = chain_lanes(count - done);
+        size_t group = count - done < (size_t)lanes ? count - done : (size_t)lanes;
+
+        for (size_t l = 0; l < group; l++) {
+            memcpy(chains[done + l]->checkpoints, seeds[done + l], SHA256_90R_DIGEST_SIZE);
+            chain_load(seeds[done + l], st[l]);
+        }
+        for (size_t j = 1; j < ncp; j++) {
+            chain_run_group(st, group, lanes, interval);
+            for (size_t l = 0; l < group; l++) {
+                sha256_90r_store_digest(st[l], chains[done + l]->checkpoints + j * SHA256_90R_DIGEST_SIZE);
+            }
+        }
+        chain_run_group(st, group, lanes, links % interval);
+        for (size_t l = 0; l < group; l++) sha256_90r_store_digest(st[l], chains[done + l]->tip);
+        done += group;
+    }
+    return 0;
+}
+
+sha256_90r_chain_t* sha256_90r_chain_new(const uint8_t seed[SHA256_90R_DIGEST_SIZE], uint64_t links,
+                                         uint64_t interval)
+{
+    sha256_90r_chain_t* chain;
+
+    if (!seed) return NULL;
+    return sha256_90r_chain_new_multi(&seed, 1, links, interval, &chain) == 0 ? chain : NULL;
+}
+
+int sha256_90r_chain_link(const sha256_90r_chain_t* chain, uint64_t index, uint8_t out[SHA256_90R_DIGEST_SIZE])
+{
+    uint64_t j;
+    uint32_t st[8];
+
+    if (!chain || !out || index > chain->links) return -1;
+    if (index == chain->links) {
+        memcpy(out, chain->tip, SHA256_90R_DIGEST_SIZE);
+        return 0;
+    }
+    j = index / chain->interval;
+    chain_load(chain->checkpoints + j * SHA256_90R_DIGEST_SIZE, st);
+    chain_run_scalar(st, index - j * chain->interval);
+    sha256_90r_store_digest(st, out);
+    return 0;
+}
+
+const uint8_t* sha256_90r_chain_checkpoints(const sha256_90r_chain_t* chain, size_t* count)
+{
+    if (!chain) return NULL;
+    if (count) *count = chain->count;
+    return chain->checkpoints;
+}
+
+void sha256_90r_chain_free(sha256_90r_chain_t* chain)
+{
+    free(chain);
+}
@@ -0,0 +1,143 @@
+/*********************************************************************
+* Filename:   sha256_90r_file.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    File hashing for large, mostly sparse files (VM disk
+*             images). The file is walked extent by extent with
+*             lseek(SEEK_DATA/SEEK_HOLE): data extents are read with
+*             pread in FILE_CHUNK pieces, holes are never read and hash
+*             as zero bytes through the zero-schedule transform. Where the
+*             filesystem has no SEEK_DATA the whole file is one data
+*             extent. The digest is that of the file's bytes either way.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE                     // SEEK_DATA / SEEK_HOLE
+#endif
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/****************************** MACROS ******************************/
+#define FILE_CHUNK (1u << 20)           // pread size for data extents
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+
+// Hash [start, end) of a data extent
+static int file_hash_data(int fd, struct sha256_90r_internal_ctx* ctx, BYTE* buf, off_t start, off_t end,
+                          sha256_90r_file_stats_t* stats) {
+    while (start < end) {
+        size_t want = (size_t)(end - start) < FILE_CHUNK ? (size_t)(end - start) : FILE_CHUNK;
+        ssize_t got = pread(fd, buf, want, start);
+
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (got == 0) {                 // Truncated underneath us
+            errno = EIO;
+            return -1;
+        }
+        sha256_90r_update_sparse_internal(ctx, buf, (size_t)got);
+        start += got;
+        stats->bytes_read += (uint64_t)got;
+    }
+    return 0;
+}
+
+/*************************** PUBLIC API ***************************/
+
+int sha256_90r_hash_fd(int fd, uint8_t hash[SHA256_90R_DIGEST_SIZE], sha256_90r_file_stats_t* stats)
+{
+    struct sha256_90r_internal_ctx ctx;
+    sha256_90r_file_stats_t local;
+    struct stat st;
+    BYTE* buf;
+    off_t pos = 0, saved;
+    int sparse = 1, ret = 0;
+
+    if (!hash) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    if (fstat(fd, &st) != 0) return -1;
+    buf = malloc(FILE_CHUNK);
+    if (!buf) return -1;
+    saved = lseek(fd, 0, SEEK_CUR);     // SEEK_DATA/SEEK_HOLE move it; put it back at the end
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    sha256_90r_init_internal(&ctx);
+    while (pos < st.st_size) {
+        off_t data = st.st_size, hole = st.st_size;
+
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+        if (sparse) {
+            data = lseek(fd, pos, SEEK_DATA);
+            if (data < 0 && errno == ENXIO) {
+                data = st.st_size;              // Only a hole is left
+            } else if (data < 0) {
+                sparse = 0;                     // Not supported here: read everything
+            } else {
+                hole = lseek(fd, data, SEEK_HOLE);
+                if (hole < 0 || hole > st.st_size) hole = st.st_size;
+            }
+        }
+#else
+        sparse = 0;
+#endif
+        if (!sparse) {
+            data = pos;
+            hole = st.st_size;
+        }
+
+        if (data > pos) {
+            sha256_90r_update_zeros_internal(&ctx, (unsigned long long)(data - pos));
+            stats->hole_bytes += (uint64_t)(data - pos);
+        }
+        if (file_hash_data(fd, &ctx, buf, data, hole, stats) != 0) {
+            ret = -1;
+            break;
+        }
+        pos = hole;
+    }
+
+    if (ret == 0) {
+        sha256_90r_final_internal(&ctx, hash);
+        stats->file_size = (uint64_t)st.st_size;
+    }
+    free(buf);
+    if (saved >= 0) {
+        int err = errno;
+        lseek(fd, saved, SEEK_SET);
+        errno = err;
+    }
+    return ret;
+}
+
+int sha256_90r_hash_file(const char* path, uint8_t hash[SHA256_90R_DIGEST_SIZE], sha256_90r_file_stats_t* stats)
+{
+    int fd, ret, err;
+
+    if (!path) {
+        errno = EINVAL;
+        return -1;
+    }
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ret = sha256_90r_hash_fd(fd, hash, stats);
+    err = errno;
+    close(fd);
+    errno = err;
+    return ret;
+}
@@ -1,15 +1,32 @@
 /**
  * SHA256-90R FPGA Pipeline Prototype
- * Software simulation of a 90-stage hardware pipeline
- * Useful as a reference design for FPGA/hardware teams
+ * Cycle-level software model of an unrolled SHA256-90R hardware pipeline
+ * Useful as a reference design and throughput model for FPGA/hardware teams
+ *
+ * The pipeline has depth D = ceil(90 / U) stages, each stage performing U
+ * rounds (the unroll factor) together with the matching message-schedule
+ * expansion. A new block may enter stage 0 every `initiation_interval`
+ * clocks and blocks arrive at the input every `source_interval` clocks.
+ *
+ * Stage registers are held structure-of-arrays (one array per state word,
+ * one lane per physical slot) so that every stage is advanced in the same
+ * clock by 8-lane AVX2 code. Blocks never move between slots: the slot that
+ * holds logical stage s rotates by one position each clock, which turns the
+ * stage shift of the hardware into a change of table offset.
  */
 
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 #include "sha256_internal.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FPGA_SIM_HAVE_AVX2 1
+#endif
+
 // SHA-256 constants (same as in main implementation)
 static const uint32_t k_90r_fpga[96] = {
 	0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
@@ -26,42 +43,15 @@ static const uint32_t k_90r_fpga[96] = {
 	0xb3df34fc,0xb99bb8d7,0,0,0,0,0,0
 };
 
-// Optimized FPGA pipeline stage structure for 90-round SHA256-90R
-typedef struct {
-	uint32_t a, b, c, d, e, f, g, h;
-	uint32_t w;  // Message word for this stage
-	uint32_t k;  // Round constant for this stage
-	int valid;   // Pipeline stage valid flag
-	int round;   // Current round number (0-89)
-} fpga_pipeline_stage_t;
-
-// Complete FPGA pipeline with 90 stages (1 hash/clock after warm-up)
-#define FPGA_PIPELINE_DEPTH 90
-typedef struct {
-	fpga_pipeline_stage_t stages[FPGA_PIPELINE_DEPTH];
-	int pipeline_filled;
-	int current_stage;
-	uint32_t initial_state[8]; // SHA256 initial state
-} fpga_pipeline_t;
-
-// Initialize FPGA pipeline with SHA256 initial state
-void fpga_pipeline_init(fpga_pipeline_t *pipeline) {
-	memset(pipeline, 0, sizeof(fpga_pipeline_t));
-	pipeline->pipeline_filled = 0;
-	pipeline->current_stage = 0;
-
-	// Set SHA256 initial state
-	pipeline->initial_state[0] = 0x6a09e667;
-	pipeline->initial_state[1] = 0xbb67ae85;
-	pipeline->initial_state[2] = 0x3c6ef372;
-	pipeline->initial_state[3] = 0xa54ff53a;
-	pipeline->initial_state[4] = 0x510e527f;
-	pipeline->initial_state[5] = 0x9b05688c;
-	pipeline->initial_state[6] = 0x1f83d9ab;
-	pipeline->initial_state[7] = 0x5be0cd19;
-}
+static const uint32_t fpga_iv[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+#define FPGA_ROUNDS 90
+#define FPGA_LANES 8    // AVX2 lanes; slot arrays are padded to a multiple of this
 
-// FPGA round function (single stage computation)
+// FPGA round function (single round of a stage)
 static inline void fpga_round(uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d,
                               uint32_t *e, uint32_t *f, uint32_t *g, uint32_t *h,
                               uint32_t w, uint32_t k) {
@@ -109,159 +99,334 @@ static inline void fpga_round_masked(uint32_t *a, uint32_t *b, uint32_t *c, uint
 	*a = (new_a & valid_mask) | (*a & ~valid_mask);
 }
 
-// Constant-time FPGA pipeline clock - always processes all stages regardless of input
-void fpga_pipeline_clock(fpga_pipeline_t *pipeline, uint32_t w, uint32_t k, int input_valid) {
-	int i;
-
-	// Always shift data through ALL pipeline stages (constant-time)
-	for (i = FPGA_PIPELINE_DEPTH - 1; i > 0; --i) {
-		pipeline->stages[i] = pipeline->stages[i - 1];
-		// Always perform round computation - use arithmetic masking for conditional behavior
-		uint32_t valid_mask = pipeline->stages[i].valid ? 0xFFFFFFFF : 0;
-		fpga_round_masked(&pipeline->stages[i].a, &pipeline->stages[i].b, &pipeline->stages[i].c, &pipeline->stages[i].d,
-						 &pipeline->stages[i].e, &pipeline->stages[i].f, &pipeline->stages[i].g, &pipeline->stages[i].h,
-						 pipeline->stages[i].w, pipeline->stages[i].k, valid_mask);
-	}
+// Message schedule word W[i] from the 16 words before it
+static inline uint32_t fpga_schedule(uint32_t w16, uint32_t w15, uint32_t w7, uint32_t w2) {
+	uint32_t s0 = ((w15 >> 7) | (w15 << 25)) ^ ((w15 >> 18) | (w15 << 14)) ^ (w15 >> 3);
+	uint32_t s1 = ((w2 >> 17) | (w2 << 15)) ^ ((w2 >> 19) | (w2 << 13)) ^ (w2 >> 10);
+	return w16 + s0 + w7 + s1;
+}
+
+/*************************** SIMULATOR STATE ***************************/
 
-	// Load new data into first stage using arithmetic masking (constant-time)
-	uint32_t input_mask = input_valid ? 0xFFFFFFFF : 0;
-
-	// Always initialize state values, but mask them based on input validity
-	uint32_t new_a = (0x6a09e667 & input_mask) | (pipeline->stages[0].a & ~input_mask);
-	uint32_t new_b = (0xbb67ae85 & input_mask) | (pipeline->stages[0].b & ~input_mask);
-	uint32_t new_c = (0x3c6ef372 & input_mask) | (pipeline->stages[0].c & ~input_mask);
-	uint32_t new_d = (0xa54ff53a & input_mask) | (pipeline->stages[0].d & ~input_mask);
-	uint32_t new_e = (0x510e527f & input_mask) | (pipeline->stages[0].e & ~input_mask);
-	uint32_t new_f = (0x9b05688c & input_mask) | (pipeline->stages[0].f & ~input_mask);
-	uint32_t new_g = (0x1f83d9ab & input_mask) | (pipeline->stages[0].g & ~input_mask);
-	uint32_t new_h = (0x5be0cd19 & input_mask) | (pipeline->stages[0].h & ~input_mask);
-	uint32_t new_w = (w & input_mask) | (pipeline->stages[0].w & ~input_mask);
-	uint32_t new_k = (k & input_mask) | (pipeline->stages[0].k & ~input_mask);
-	uint32_t new_valid = input_valid ? 1 : pipeline->stages[0].valid;
-
-	pipeline->stages[0].a = new_a;
-	pipeline->stages[0].b = new_b;
-	pipeline->stages[0].c = new_c;
-	pipeline->stages[0].d = new_d;
-	pipeline->stages[0].e = new_e;
-	pipeline->stages[0].f = new_f;
-	pipeline->stages[0].g = new_g;
-	pipeline->stages[0].h = new_h;
-	pipeline->stages[0].w = new_w;
-	pipeline->stages[0].k = new_k;
-	pipeline->stages[0].valid = new_valid;
-
-	// Update pipeline state using masking (constant-time)
-	uint32_t fill_update_mask = (input_valid && !pipeline->pipeline_filled) ? 0xFFFFFFFF : 0;
-	uint32_t new_current_stage = pipeline->current_stage + (fill_update_mask ? 1 : 0);
-	uint32_t new_pipeline_filled = pipeline->pipeline_filled | ((new_current_stage >= FPGA_PIPELINE_DEPTH) ? 1 : 0);
-
-	pipeline->current_stage = new_current_stage;
-	pipeline->pipeline_filled = new_pipeline_filled;
+// Slot p holds logical stage (p + clock) mod depth. Per-round tables are
+// indexed by p + (clock mod depth), so one unaligned load yields the round
+// constants (and partial-stage masks) for 8 consecutive slots.
+typedef struct {
+	int unroll;              // rounds per stage (U)
+	int depth;               // stages (D)
+	int slots;               // depth rounded up to FPGA_LANES
+	int stride;              // row length of ktab/rtab
+	int partial;             // 90 % U != 0: last stage runs fewer rounds
+	uint32_t *st;            // st[word * slots + p]: working variables a..h
+	uint32_t *win;           // win[j * slots + p]: W[r .. r+15] for the next round r
+	uint32_t *ktab;          // ktab[u * stride + i]: K for round u of stage i mod D
+	uint32_t *rtab;          // rtab[u * stride + i]: all-ones if that round exists
+	uint8_t *valid;          // slot holds a block
+	size_t *id;              // index of the block held by the slot
+} fpga_sim_t;
+
+static void fpga_sim_free(fpga_sim_t *sim) {
+	free(sim->st);
+	free(sim->win);
+	free(sim->ktab);
+	free(sim->rtab);
+	free(sim->valid);
+	free(sim->id);
 }
 
-// Check if pipeline has valid output
-int fpga_pipeline_has_output(fpga_pipeline_t *pipeline) {
-	return pipeline->stages[FPGA_PIPELINE_DEPTH - 1].valid;
+static void *fpga_sim_alloc(size_t bytes) {
+	bytes = (bytes + 31) & ~(size_t)31;
+	void *p = aligned_alloc(32, bytes);
+	if (p)
+		memset(p, 0, bytes);
+	return p;
 }
 
-// Get final hash from pipeline output
-void fpga_pipeline_get_output(fpga_pipeline_t *pipeline, uint32_t hash[8]) {
-	fpga_pipeline_stage_t *output_stage = &pipeline->stages[FPGA_PIPELINE_DEPTH - 1];
-
-	hash[0] = output_stage->a;
-	hash[1] = output_stage->b;
-	hash[2] = output_stage->c;
-	hash[3] = output_stage->d;
-	hash[4] = output_stage->e;
-	hash[5] = output_stage->f;
-	hash[6] = output_stage->g;
-	hash[7] = output_stage->h;
+static int fpga_sim_setup(fpga_sim_t *sim, int unroll) {
+	int u, i;
+
+	memset(sim, 0, sizeof(*sim));
+	sim->unroll = unroll;
+	sim->depth = (FPGA_ROUNDS + unroll - 1) / unroll;
+	sim->slots = (sim->depth + FPGA_LANES - 1) / FPGA_LANES * FPGA_LANES;
+	sim->stride = sim->slots + sim->depth;
+	sim->partial = (FPGA_ROUNDS % unroll) != 0;
+
+	sim->st = fpga_sim_alloc(sizeof(uint32_t) * 8 * sim->slots);
+	sim->win = fpga_sim_alloc(sizeof(uint32_t) * 16 * sim->slots);
+	sim->ktab = fpga_sim_alloc(sizeof(uint32_t) * unroll * sim->stride);
+	sim->rtab = fpga_sim_alloc(sizeof(uint32_t) * unroll * sim->stride);
+	sim->valid = fpga_sim_alloc(sim->slots);
+	sim->id = fpga_sim_alloc(sizeof(size_t) * sim->slots);
+	if (!sim->st || !sim->win || !sim->ktab || !sim->rtab || !sim->valid || !sim->id) {
+		fpga_sim_free(sim);
+		return -1;
+	}
+
+	for (u = 0; u < unroll; ++u) {
+		for (i = 0; i < sim->stride; ++i) {
+			int round = (i % sim->depth) * unroll + u;
+			sim->ktab[u * sim->stride + i] = round < FPGA_ROUNDS ? k_90r_fpga[round] : 0;
+			sim->rtab[u * sim->stride + i] = round < FPGA_ROUNDS ? 0xFFFFFFFF : 0;
+		}
+	}
+	return 0;
 }
 
-// Batch processing FPGA pipeline for maximum throughput
-// Processes multiple blocks with 1 hash per clock after pipeline warm-up
-typedef struct {
-	fpga_pipeline_t pipelines[FPGA_PIPELINE_DEPTH]; // Pipeline array for batch processing
-	size_t batch_size;
-	size_t current_block;
-	int pipelines_initialized;
-} fpga_batch_pipeline_t;
-
-// Initialize batch FPGA pipeline
-void fpga_batch_pipeline_init(fpga_batch_pipeline_t *batch_pipeline, size_t batch_size) {
-	batch_pipeline->batch_size = batch_size;
-	batch_pipeline->current_block = 0;
-	batch_pipeline->pipelines_initialized = 0;
-
-	// Initialize all pipelines
-	for (int i = 0; i < FPGA_PIPELINE_DEPTH; ++i) {
-		fpga_pipeline_init(&batch_pipeline->pipelines[i]);
+// True if any of the 8 slots starting at p holds a block
+static inline int fpga_sim_group_live(const fpga_sim_t *sim, int p) {
+	uint64_t live;
+	memcpy(&live, sim->valid + p, sizeof(live));
+	return live != 0;
+}
+
+/*************************** STAGE KERNELS ***************************/
+
+// Portable kernel: advances every occupied slot by one stage
+static void fpga_sim_advance_scalar(fpga_sim_t *sim, int tm) {
+	const int U = sim->unroll, S = sim->slots;
+	uint32_t L[16 + FPGA_ROUNDS];
+	int p, j, u;
+
+	for (p = 0; p < sim->depth; ++p) {
+		if (!sim->valid[p])
+			continue;
+		const uint32_t *kt = sim->ktab + p + tm;
+		const uint32_t *rt = sim->rtab + p + tm;
+
+		for (j = 0; j < 16; ++j)
+			L[j] = sim->win[j * S + p];
+		for (u = 0; u < U; ++u)
+			L[16 + u] = fpga_schedule(L[u], L[u + 1], L[u + 9], L[u + 14]);
+
+		uint32_t a = sim->st[0 * S + p], b = sim->st[1 * S + p];
+		uint32_t c = sim->st[2 * S + p], d = sim->st[3 * S + p];
+		uint32_t e = sim->st[4 * S + p], f = sim->st[5 * S + p];
+		uint32_t g = sim->st[6 * S + p], h = sim->st[7 * S + p];
+		if (sim->partial) {
+			for (u = 0; u < U; ++u)
+				fpga_round_masked(&a, &b, &c, &d, &e, &f, &g, &h, L[u],
+				                  kt[u * sim->stride], rt[u * sim->stride]);
+		} else {
+			for (u = 0; u < U; ++u)
+				fpga_round(&a, &b, &c, &d, &e, &f, &g, &h, L[u], kt[u * sim->stride]);
+		}
+		sim->st[0 * S + p] = a; sim->st[1 * S + p] = b;
+		sim->st[2 * S + p] = c; sim->st[3 * S + p] = d;
+		sim->st[4 * S + p] = e; sim->st[5 * S + p] = f;
+		sim->st[6 * S + p] = g; sim->st[7 * S + p] = h;
+
+		for (j = 0; j < 16; ++j)
+			sim->win[j * S + p] = L[U + j];
 	}
-	batch_pipeline->pipelines_initialized = 1;
 }
 
-// Process batch of blocks through FPGA pipelines
-void fpga_batch_process(fpga_batch_pipeline_t *batch_pipeline,
-                       struct sha256_90r_internal_ctx ctxs[],
-                       const BYTE data[],
-                       size_t num_blocks) {
-	uint32_t m[FPGA_PIPELINE_DEPTH][90];
-	int i, j, block_idx;
-
-	// Pre-compute message schedules for all blocks (constant-time)
-	for (block_idx = 0; block_idx < num_blocks && block_idx < FPGA_PIPELINE_DEPTH; ++block_idx) {
-		const BYTE* block_data = data + block_idx * 64;
-
-		// Initialize message schedule
-		for (i = 0, j = 0; i < 16; ++i, j += 4) {
-			m[block_idx][i] = (block_data[j] << 24) | (block_data[j + 1] << 16) |
-							 (block_data[j + 2] << 8) | block_data[j + 3];
+#ifdef FPGA_SIM_HAVE_AVX2
+#define FPGA_ROTR256(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+// AVX2 kernel: 8 slots per iteration, same dataflow as the portable kernel
+__attribute__((target("avx2")))
+static void fpga_sim_advance_avx2(fpga_sim_t *sim, int tm) {
+	const int U = sim->unroll, S = sim->slots;
+	__m256i L[16 + FPGA_ROUNDS];
+	int p, j, u;
+
+	for (p = 0; p < S; p += FPGA_LANES) {
+		if (!fpga_sim_group_live(sim, p))
+			continue;
+		const uint32_t *kt = sim->ktab + p + tm;
+		const uint32_t *rt = sim->rtab + p + tm;
+
+		for (j = 0; j < 16; ++j)
+			L[j] = _mm256_load_si256((const __m256i *)&sim->win[j * S + p]);
+		for (u = 0; u < U; ++u) {
+			__m256i w15 = L[u + 1], w2 = L[u + 14];
+			__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(FPGA_ROTR256(w15, 7), FPGA_ROTR256(w15, 18)),
+			                              _mm256_srli_epi32(w15, 3));
+			__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(FPGA_ROTR256(w2, 17), FPGA_ROTR256(w2, 19)),
+			                              _mm256_srli_epi32(w2, 10));
+			L[16 + u] = _mm256_add_epi32(_mm256_add_epi32(L[u], s0), _mm256_add_epi32(L[u + 9], s1));
 		}
 
-		// Pre-expand all message words upfront
-		for (i = 16; i < 90; ++i) {
-			uint32_t s0 = ((m[block_idx][i-15] >> 7) | (m[block_idx][i-15] << 25)) ^
-						 ((m[block_idx][i-15] >> 18) | (m[block_idx][i-15] << 14)) ^ (m[block_idx][i-15] >> 3);
-			uint32_t s1 = ((m[block_idx][i-2] >> 17) | (m[block_idx][i-2] << 15)) ^
-						 ((m[block_idx][i-2] >> 19) | (m[block_idx][i-2] << 13)) ^ (m[block_idx][i-2] >> 10);
-			m[block_idx][i] = m[block_idx][i-16] + s0 + m[block_idx][i-7] + s1;
+		__m256i a = _mm256_load_si256((const __m256i *)&sim->st[0 * S + p]);
+		__m256i b = _mm256_load_si256((const __m256i *)&sim->st[1 * S + p]);
+		__m256i c = _mm256_load_si256((const __m256i *)&sim->st[2 * S + p]);
+		__m256i d = _mm256_load_si256((const __m256i *)&sim->st[3 * S + p]);
+		__m256i e = _mm256_load_si256((const __m256i *)&sim->st[4 * S + p]);
+		__m256i f = _mm256_load_si256((const __m256i *)&sim->st[5 * S + p]);
+		__m256i g = _mm256_load_si256((const __m256i *)&sim->st[6 * S + p]);
+		__m256i h = _mm256_load_si256((const __m256i *)&sim->st[7 * S + p]);
+
+		for (u = 0; u < U; ++u) {
+			__m256i k = _mm256_loadu_si256((const __m256i *)(kt + u * sim->stride));
+			__m256i ep1 = _mm256_xor_si256(_mm256_xor_si256(FPGA_ROTR256(e, 6), FPGA_ROTR256(e, 11)),
+			                               FPGA_ROTR256(e, 25));
+			__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+			__m256i ep0 = _mm256_xor_si256(_mm256_xor_si256(FPGA_ROTR256(a, 2), FPGA_ROTR256(a, 13)),
+			                               FPGA_ROTR256(a, 22));
+			__m256i maj = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+			                               _mm256_and_si256(b, c));
+			__m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, ep1), _mm256_add_epi32(ch, _mm256_add_epi32(k, L[u])));
+			__m256i t2 = _mm256_add_epi32(ep0, maj);
+			__m256i na = _mm256_add_epi32(t1, t2), ne = _mm256_add_epi32(d, t1);
+
+			if (sim->partial) {
+				// Rounds past 90 in the last stage leave the state untouched
+				__m256i m = _mm256_loadu_si256((const __m256i *)(rt + u * sim->stride));
+				h = _mm256_blendv_epi8(h, g, m);
+				g = _mm256_blendv_epi8(g, f, m);
+				f = _mm256_blendv_epi8(f, e, m);
+				e = _mm256_blendv_epi8(e, ne, m);
+				d = _mm256_blendv_epi8(d, c, m);
+				c = _mm256_blendv_epi8(c, b, m);
+				b = _mm256_blendv_epi8(b, a, m);
+				a = _mm256_blendv_epi8(a, na, m);
+			} else {
+				h = g; g = f; f = e; e = ne;
+				d = c; c = b; b = a; a = na;
+			}
 		}
+
+		_mm256_store_si256((__m256i *)&sim->st[0 * S + p], a);
+		_mm256_store_si256((__m256i *)&sim->st[1 * S + p], b);
+		_mm256_store_si256((__m256i *)&sim->st[2 * S + p], c);
+		_mm256_store_si256((__m256i *)&sim->st[3 * S + p], d);
+		_mm256_store_si256((__m256i *)&sim->st[4 * S + p], e);
+		_mm256_store_si256((__m256i *)&sim->st[5 * S + p], f);
+		_mm256_store_si256((__m256i *)&sim->st[6 * S + p], g);
+		_mm256_store_si256((__m256i *)&sim->st[7 * S + p], h);
+
+		for (j = 0; j < 16; ++j)
+			_mm256_store_si256((__m256i *)&sim->win[j * S + p], L[U + j]);
 	}
+}
+#endif
+
+/*************************** SIMULATOR ***************************/
+
+fpga_sim_config_t fpga_sim_config_default(void) {
+	fpga_sim_config_t cfg;
+	cfg.rounds_per_stage = 1;
+	cfg.initiation_interval = 1;
+	cfg.source_interval = 1;
+	cfg.use_simd = 1;
+	return cfg;
+}
 
-	// Pipeline processing: 90 input cycles + 89 drain cycles per block
-	// But with multiple pipelines, we achieve 1 hash per clock after warm-up
-	for (int cycle = 0; cycle < 90 + (FPGA_PIPELINE_DEPTH - 1); ++cycle) {
-		for (block_idx = 0; block_idx < num_blocks && block_idx < FPGA_PIPELINE_DEPTH; ++block_idx) {
-			fpga_pipeline_t *pipeline = &batch_pipeline->pipelines[block_idx];
-			int input_cycle = cycle < 90;
-			uint32_t w = input_cycle ? m[block_idx][cycle] : 0;
-			uint32_t k = input_cycle ? k_90r_fpga[cycle] : 0;
+// Number of multiples of ii in [from, to)
+static uint64_t fpga_issue_slots(uint64_t from, uint64_t to, uint64_t ii) {
+	return (to + ii - 1) / ii - (from + ii - 1) / ii;
+}
 
-			fpga_pipeline_clock(pipeline, w, k, input_cycle);
+int sha256_90r_fpga_simulate(const fpga_sim_config_t *cfg,
+                             const WORD (*in_states)[8],
+                             const BYTE *blocks, size_t num_blocks,
+                             WORD (*out_states)[8],
+                             fpga_sim_stats_t *stats) {
+	fpga_sim_config_t def = fpga_sim_config_default();
+	fpga_sim_t sim;
+	void (*advance)(fpga_sim_t *, int) = fpga_sim_advance_scalar;
+	struct timespec t0, t1;
+	uint64_t clock = 0, ii, si, busy = 0, ii_stalls = 0, bubbles = 0;
+	size_t next = 0, done = 0;
+	int inflight = 0, k, j;
+
+	if (!cfg)
+		cfg = &def;
+	if (!blocks && num_blocks)
+		return -1;
+	if (cfg->rounds_per_stage < 1 || cfg->rounds_per_stage > FPGA_ROUNDS ||
+	    cfg->initiation_interval < 1 || cfg->source_interval < 1)
+		return -1;
+	if (fpga_sim_setup(&sim, cfg->rounds_per_stage) != 0)
+		return -1;
+
+#ifdef FPGA_SIM_HAVE_AVX2
+	if (cfg->use_simd && __builtin_cpu_supports("avx2"))
+		advance = fpga_sim_advance_avx2;
+#endif
+
+	ii = (uint64_t)cfg->initiation_interval;
+	si = (uint64_t)cfg->source_interval;
+	const int D = sim.depth, S = sim.slots;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	while (done < num_blocks) {
+		// Nothing in flight and the next block has not arrived: skip idle clocks
+		if (inflight == 0 && (uint64_t)next * si > clock) {
+			bubbles += fpga_issue_slots(clock, (uint64_t)next * si, ii);
+			clock = (uint64_t)next * si;
+		}
+		const int tm = (int)(clock % (uint64_t)D);
+		const int issue_ok = (clock % ii) == 0;
+
+		// Stage 0 is the slot vacated by the block that retired last clock
+		if (next < num_blocks && (uint64_t)next * si <= clock) {
+			if (issue_ok) {
+				const int p = (D - tm) % D;
+				const BYTE *blk = blocks + next * 64;
+				const WORD *init = in_states ? in_states[next] : fpga_iv;
+				for (k = 0; k < 8; ++k)
+					sim.st[k * S + p] = init[k];
+				for (j = 0; j < 16; ++j)
+					sim.win[j * S + p] = ((uint32_t)blk[4 * j] << 24) | ((uint32_t)blk[4 * j + 1] << 16) |
+					                     ((uint32_t)blk[4 * j + 2] << 8) | blk[4 * j + 3];
+				sim.valid[p] = 1;
+				sim.id[p] = next++;
+				inflight++;
+			} else {
+				ii_stalls++;
+			}
+		} else if (issue_ok && next < num_blocks) {
+			bubbles++;
 		}
 
-		// Check for completed hashes and collect results
-		for (block_idx = 0; block_idx < num_blocks && block_idx < FPGA_PIPELINE_DEPTH; ++block_idx) {
-			fpga_pipeline_t *pipeline = &batch_pipeline->pipelines[block_idx];
-			if (fpga_pipeline_has_output(pipeline)) {
-				uint32_t hash[8];
-				fpga_pipeline_get_output(pipeline, hash);
-
-				// Add to context state
-				for (i = 0; i < 8; ++i) {
-					ctxs[block_idx].state[i] += hash[i];
-				}
+		busy += (uint64_t)inflight;
+		advance(&sim, tm);
+
+		// The slot at logical stage D-1 has completed all 90 rounds
+		const int q = (D - 1 - tm + D) % D;
+		if (sim.valid[q]) {
+			size_t id = sim.id[q];
+			if (out_states) {
+				const WORD *init = in_states ? in_states[id] : fpga_iv;
+				for (k = 0; k < 8; ++k)
+					out_states[id][k] = init[k] + sim.st[k * S + q];
 			}
+			sim.valid[q] = 0;
+			inflight--;
+			done++;
 		}
+		clock++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	if (stats) {
+		memset(stats, 0, sizeof(*stats));
+		stats->clocks = clock;
+		stats->hashes = done;
+		stats->busy_stage_clocks = busy;
+		stats->ii_stalls = ii_stalls;
+		stats->bubbles = bubbles;
+		stats->depth = D;
+		stats->occupancy = clock ? (double)busy / ((double)clock * D) : 0.0;
+		stats->hashes_per_clock = clock ? (double)done / (double)clock : 0.0;
+		stats->sim_seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
 	}
+
+	fpga_sim_free(&sim);
+	return 0;
 }
 
 // Single-block FPGA transform (backward compatibility)
 void sha256_90r_transform_fpga(struct sha256_90r_internal_ctx *ctx, const BYTE data[]) {
-	fpga_batch_pipeline_t batch_pipeline;
-	fpga_batch_pipeline_init(&batch_pipeline, 1);
-	fpga_batch_process(&batch_pipeline, ctx, data, 1);
+	WORD out[1][8];
+
+	if (sha256_90r_fpga_simulate(NULL, (const WORD (*)[8])&ctx->state, data, 1, out, NULL) != 0) {
+		sha256_90r_transform_scalar(ctx, data);
+		return;
+	}
+	memcpy(ctx->state, out[0], sizeof(ctx->state));
 }
 
 // FPGA timing test harness for constant-time verification
@@ -270,72 +435,19 @@ typedef struct {
 	uint32_t hash[8];
 } fpga_timing_result_t;
 
-// Constant-time FPGA timing test function
+// Single block through the default (one round per stage) pipeline
 fpga_timing_result_t fpga_timing_test(const BYTE data[]) {
-	uint32_t m[90];
-	fpga_pipeline_t pipeline;
 	fpga_timing_result_t result = {0};
-	int i, j;
-
-	// Initialize message schedule
-	for (i = 0, j = 0; i < 16; ++i, j += 4) {
-		m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | data[j + 3];
-	}
+	fpga_sim_stats_t stats;
+	WORD out[1][8];
 
-	for (i = 16; i < 90; ++i) {
-		uint32_t s0 = ((m[i-15] >> 7) | (m[i-15] << 25)) ^ ((m[i-15] >> 18) | (m[i-15] << 14)) ^ (m[i-15] >> 3);
-		uint32_t s1 = ((m[i-2] >> 17) | (m[i-2] << 15)) ^ ((m[i-2] >> 19) | (m[i-2] << 13)) ^ (m[i-2] >> 10);
-		m[i] = m[i-16] + s0 + m[i-7] + s1;
+	if (sha256_90r_fpga_simulate(NULL, NULL, data, 1, out, &stats) == 0) {
+		result.cycle_count = stats.clocks;
+		memcpy(result.hash, out[0], sizeof(result.hash));
 	}
-
-	// Initialize FPGA pipeline
-	fpga_pipeline_init(&pipeline);
-
-	// Count cycles: 90 input cycles + 89 drain cycles = 179 total
-	result.cycle_count = 90 + (FPGA_PIPELINE_DEPTH - 1);
-
-	// Process all cycles (constant-time)
-	for (i = 0; i < 90; ++i) {
-		fpga_pipeline_clock(&pipeline, m[i], k_90r_fpga[i], 1);
-	}
-
-	for (i = 0; i < FPGA_PIPELINE_DEPTH - 1; ++i) {
-		fpga_pipeline_clock(&pipeline, 0, 0, 0);
-	}
-
-	// Get final hash
-	fpga_pipeline_get_output(&pipeline, result.hash);
-
 	return result;
 }
 
-// FPGA pipeline statistics and analysis
-typedef struct {
-	uint64_t total_cycles;
-	uint64_t data_cycles;
-	uint64_t drain_cycles;
-	uint64_t throughput_cycles;
-} fpga_stats_t;
-
-// Analyze FPGA pipeline performance
-fpga_stats_t analyze_fpga_pipeline(void) {
-	fpga_stats_t stats = {0};
-
-	// Data input phase: 90 cycles for 90 message words
-	stats.data_cycles = 90;
-
-	// Pipeline drain phase: 89 cycles to flush pipeline
-	stats.drain_cycles = FPGA_PIPELINE_DEPTH - 1;
-
-	// Total cycles for one block
-	stats.total_cycles = stats.data_cycles + stats.drain_cycles;
-
-	// Steady-state throughput: 1 hash per cycle after pipeline fill
-	stats.throughput_cycles = 1;
-
-	return stats;
-}
-
 // FPGA hardware resource estimation
 typedef struct {
 	int lut_count;
@@ -345,36 +457,63 @@ typedef struct {
 	int max_frequency_mhz;
 } fpga_resources_t;
 
-fpga_resources_t estimate_fpga_resources(void) {
+fpga_resources_t estimate_fpga_resources(const fpga_sim_config_t *cfg) {
 	fpga_resources_t res = {0};
+	int depth = (FPGA_ROUNDS + cfg->rounds_per_stage - 1) / cfg->rounds_per_stage;
 
-	// Estimate based on 90-stage pipeline with 32-bit operations
-	res.lut_count = FPGA_PIPELINE_DEPTH * 500;  // ~500 LUTs per stage
-	res.ff_count = FPGA_PIPELINE_DEPTH * 256;   // ~256 FFs per stage
+	// Round logic is replicated per unrolled round; registers only per stage
+	res.lut_count = FPGA_ROUNDS * 500;          // ~500 LUTs per round (incl. schedule)
+	res.ff_count = depth * 768;                  // 8 state + 16 schedule words per stage
 	res.bram_count = 4;                          // For constants and message storage
 	res.dsp_count = 0;                           // Pure logic implementation
-	res.max_frequency_mhz = 300;                 // Conservative estimate
+	res.max_frequency_mhz = 300 / cfg->rounds_per_stage; // Critical path grows with unroll
+	if (res.max_frequency_mhz < 1)
+		res.max_frequency_mhz = 1;
 
 	return res;
 }
 
-// Print FPGA analysis results
+// Print FPGA analysis results for a sweep of unroll/II settings
 void print_fpga_analysis(void) {
-	fpga_stats_t stats = analyze_fpga_pipeline();
-	fpga_resources_t res = estimate_fpga_resources();
+	static const int sweep[][3] = {
+		// unroll, initiation interval, source interval
+		{1, 1, 1}, {2, 1, 1}, {3, 1, 1}, {10, 1, 1}, {1, 2, 1}, {1, 1, 3}, {90, 1, 1}
+	};
+	const size_t n = 1 << 16;
+	BYTE *blocks = malloc(n * 64);
+	size_t i;
+
+	if (!blocks) {
+		fprintf(stderr, "FPGA analysis: out of memory\n");
+		return;
+	}
+	for (i = 0; i < n * 64; ++i)
+		blocks[i] = (BYTE)(i * 131 + (i >> 8));
 
-	printf("FPGA Pipeline Analysis:\n");
+	printf("FPGA Pipeline Analysis (%zu blocks per run):\n", n);
 	printf("======================\n");
-	printf("Pipeline Depth: %d stages\n", FPGA_PIPELINE_DEPTH);
-	        printf("Total Cycles per Block: %lu\n", (unsigned long)stats.total_cycles);
-        printf("Data Input Cycles: %lu\n", (unsigned long)stats.data_cycles);
-        printf("Pipeline Drain Cycles: %lu\n", (unsigned long)stats.drain_cycles);
-        printf("Steady-State Throughput: %lu cycles/hash\n", (unsigned long)stats.throughput_cycles);
-	printf("\n");
-	printf("Estimated FPGA Resources:\n");
-	printf("LUTs: %d\n", res.lut_count);
-	printf("Flip-Flops: %d\n", res.ff_count);
-	printf("BRAM Blocks: %d\n", res.bram_count);
-	printf("DSP Slices: %d\n", res.dsp_count);
-	printf("Max Frequency: %d MHz\n", res.max_frequency_mhz);
+	printf("%6s %4s %4s %6s %10s %9s %9s %8s %8s %9s %8s %10s\n",
+	       "Unroll", "II", "Src", "Depth", "Clocks", "Occupancy", "Stalls", "Bubbles",
+	       "Hash/clk", "Est. Gbps", "FFs", "Sim Mh/s");
+	for (i = 0; i < sizeof(sweep) / sizeof(sweep[0]); ++i) {
+		fpga_sim_config_t cfg = fpga_sim_config_default();
+		fpga_sim_stats_t st;
+		cfg.rounds_per_stage = sweep[i][0];
+		cfg.initiation_interval = sweep[i][1];
+		cfg.source_interval = sweep[i][2];
+		if (sha256_90r_fpga_simulate(&cfg, NULL, blocks, n, NULL, &st) != 0)
+			continue;
+
+		fpga_resources_t res = estimate_fpga_resources(&cfg);
+		double gbps = st.hashes_per_clock * 512.0 * res.max_frequency_mhz * 1e6 / 1e9;
+		printf("%6d %4d %4d %6d %10llu %8.1f%% %9llu %8llu %8.3f %9.2f %8d %10.2f\n",
+		       cfg.rounds_per_stage, cfg.initiation_interval, cfg.source_interval, st.depth,
+		       (unsigned long long)st.clocks, st.occupancy * 100.0,
+		       (unsigned long long)st.ii_stalls, (unsigned long long)st.bubbles,
+		       st.hashes_per_clock, gbps, res.ff_count,
+		       st.sim_seconds > 0 ? (double)st.hashes / st.sim_seconds / 1e6 : 0.0);
+	}
+	printf("Est. Gbps assumes fmax = 300 MHz / unroll; Stalls = clocks a ready block waited on II.\n");
+
+	free(blocks);
 }
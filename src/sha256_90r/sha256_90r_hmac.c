@@ -0,0 +1,112 @@
+/*********************************************************************
+* Filename:   sha256_90r_hmac.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    HMAC (RFC 2104) over SHA256-90R. sha256_90r_hmac_batch is
+*             two scatter-gather batches (sha256_90r_batchv):
+*             (K ^ ipad) || message, then (K ^ opad) || inner digest,
+*             with the pad blocks as the first fragment so the message is
+*             never copied. Key material must not be left on the stack
+*             or heap: pads, states and job buffers are cleared with
+*             sha256_90r_wipe() before they go out of scope.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/****************************** MACROS ******************************/
+#define HMAC_BLOCK 64
+#define HMAC_CHUNK 256                 // Messages per pass of sha256_90r_hmac_batch
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// K ^ ipad and K ^ opad; keys longer than a block are hashed first (RFC 2104)
+static void hmac_pads(const uint8_t* key, size_t keylen, BYTE ipad[HMAC_BLOCK], BYTE opad[HMAC_BLOCK]) {
+    BYTE k[HMAC_BLOCK] = {0};
+
+    if (keylen > HMAC_BLOCK) {
+        sha256_90r_hash(key, keylen, k);
+    } else if (keylen > 0) {
+        memcpy(k, key, keylen);
+    }
+    for (int i = 0; i < HMAC_BLOCK; i++) {
+        ipad[i] = k[i] ^ 0x36;
+        opad[i] = k[i] ^ 0x5c;
+    }
+    sha256_90r_wipe(k, sizeof(k));
+}
+
+/*************************** PUBLIC API ***************************/
+
+void sha256_90r_hmac(const uint8_t* key, size_t keylen, const uint8_t* data, size_t len,
+                     uint8_t mac[SHA256_90R_DIGEST_SIZE])
+{
+    BYTE ipad[HMAC_BLOCK], opad[HMAC_BLOCK], inner[SHA256_90R_DIGEST_SIZE];
+    sha256_90r_state_t st;
+
+    hmac_pads(key, keylen, ipad, opad);
+    sha256_90r_state_init(&st);
+    sha256_90r_state_update(&st, ipad, HMAC_BLOCK);
+    sha256_90r_state_update(&st, data, len);
+    sha256_90r_state_final(&st, inner);
+    sha256_90r_state_init(&st);
+    sha256_90r_state_update(&st, opad, HMAC_BLOCK);
+    sha256_90r_state_update(&st, inner, sizeof(inner));
+    sha256_90r_state_final(&st, mac);
+    sha256_90r_wipe(ipad, sizeof(ipad));
+    sha256_90r_wipe(opad, sizeof(opad));
+    sha256_90r_wipe(&st, sizeof(st));
+}
+
+int sha256_90r_hmac_batch(const uint8_t* const* keys, const size_t* keylens,
+                          const uint8_t* const* messages, const size_t* lengths,
+                          uint8_t** macs, size_t count)
+{
+    // Per message: ipad, opad, inner digest and two 2-fragment iovec lists
+    typedef struct {
+        BYTE ipad[HMAC_BLOCK];
+        BYTE opad[HMAC_BLOCK];
+        BYTE inner[SHA256_90R_DIGEST_SIZE];
+        struct iovec in[2];
+        struct iovec out[2];
+    } hmac_job_t;
+    hmac_job_t* jobs;
+    const struct iovec* in_lists[HMAC_CHUNK];
+    const struct iovec* out_lists[HMAC_CHUNK];
+    uint8_t* inner[HMAC_CHUNK];
+    size_t cnts[HMAC_CHUNK];
+    int rc = 0;
+
+    if (count == 0) return 0;
+    if (!keys || !keylens || !messages || !lengths || !macs) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if ((!keys[i] && keylens[i] > 0) || (!messages[i] && lengths[i] > 0) || !macs[i]) return -1;
+    }
+    jobs = malloc((count < HMAC_CHUNK ? count : HMAC_CHUNK) * sizeof(*jobs));
+    if (!jobs) return -1;
+
+    for (size_t base = 0; base < count && rc == 0; base += HMAC_CHUNK) {
+        size_t n = count - base < HMAC_CHUNK ? count - base : HMAC_CHUNK;
+
+        for (size_t i = 0; i < n; i++) {
+            hmac_job_t* j = &jobs[i];
+            hmac_pads(keys[base + i], keylens[base + i], j->ipad, j->opad);
+            j->in[0] = (struct iovec){j->ipad, HMAC_BLOCK};
+            j->in[1] = (struct iovec){(void*)messages[base + i], lengths[base + i]};
+            j->out[0] = (struct iovec){j->opad, HMAC_BLOCK};
+            j->out[1] = (struct iovec){j->inner, SHA256_90R_DIGEST_SIZE};
+            in_lists[i] = j->in;
+            out_lists[i] = j->out;
+            inner[i] = j->inner;
+            cnts[i] = 2;
+        }
+        rc = sha256_90r_batchv(in_lists, cnts, inner, n, SHA256_90R_MODE_SECURE);
+        if (rc == 0) rc = sha256_90r_batchv(out_lists, cnts, macs + base, n, SHA256_90R_MODE_SECURE);
+    }
+    sha256_90r_wipe(jobs, (count < HMAC_CHUNK ? count : HMAC_CHUNK) * sizeof(*jobs));
+    free(jobs);
+    return rc;
+}
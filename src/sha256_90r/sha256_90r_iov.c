@@ -0,0 +1,240 @@
+/*********************************************************************
+* Filename:   sha256_90r_iov.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Batches of scatter-gather messages (sha256_90r_batchv).
+*             Each message is an iovec list, hashed on the multi-lane
+*             kernels: every lane walks its own list with a cursor, hands
+*             the kernel pointers into caller memory for whole blocks and
+*             gathers only blocks that span fragments into a 64-byte
+*             per-lane buffer. sha256_90r_lanes_run() keeps the lanes
+*             full and takes each lane's blocks from the cursor.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <string.h>
+
+/**************************** DATA TYPES ****************************/
+// One batch message in a lane
+typedef struct {
+    size_t index;                   // Message number
+    const struct iovec* iov;
+    size_t iovcnt;
+    size_t frag;                    // Cursor: fragment and offset of the next byte
+    size_t off;
+    const BYTE* run;                // Whole blocks of the current fragment, already
+    size_t run_blocks;              // passed by the cursor and not yet compressed
+    size_t full;                    // Whole message blocks
+    size_t nblocks;                 // full + 1 or 2 tail blocks
+    size_t next;                    // Next block to compress
+    BYTE stage[64];                 // Block gathered across fragments
+    BYTE tail[128];                 // Remainder, 0x80, zeros, bit length
+} iov_lane_t;
+
+// A batch on the lanes (sha256_90r_lanes_run callbacks' arg)
+typedef struct {
+    const struct iovec* const* messages;
+    const size_t* iovcnts;
+    uint8_t** hashes;
+    iov_lane_t lane[SHA256_90R_MAX_LANES];
+} iov_batch_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int iov_valid(const struct iovec* iov, size_t iovcnt) {
+    if (!iov) return iovcnt == 0;
+    for (size_t i = 0; i < iovcnt; i++) {
+        if (!iov[i].iov_base && iov[i].iov_len > 0) return 0;
+    }
+    return 1;
+}
+
+static uint64_t iov_total(const struct iovec* iov, size_t iovcnt) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < iovcnt; i++) total += iov[i].iov_len;
+    return total;
+}
+
+// Copy the next len bytes at the cursor into out, moving the cursor
+static void iov_gather(iov_lane_t* lane, BYTE* out, size_t len) {
+    while (len > 0) {
+        size_t avail = lane->iov[lane->frag].iov_len - lane->off;
+        size_t take = avail < len ? avail : len;
+
+        memcpy(out, (const BYTE*)lane->iov[lane->frag].iov_base + lane->off, take);
+        out += take;
+        len -= take;
+        lane->off += take;
+        if (lane->off == lane->iov[lane->frag].iov_len) {
+            lane->frag++;
+            lane->off = 0;
+        }
+    }
+}
+
+// Skip empty fragments so the cursor rests on the next message byte
+static void iov_settle(iov_lane_t* lane) {
+    while (lane->frag < lane->iovcnt && lane->off == lane->iov[lane->frag].iov_len) {
+        lane->frag++;
+        lane->off = 0;
+    }
+}
+
+static void iov_lane_start(iov_lane_t* lane, size_t index, const struct iovec* iov, size_t iovcnt) {
+    uint64_t len = iov_total(iov, iovcnt);
+    size_t rem = (size_t)(len % 64);
+    size_t tail_blocks = rem < 56 ? 1 : 2;
+    uint64_t bitlen = len * 8;
+
+    lane->index = index;
+    lane->iov = iov;
+    lane->iovcnt = iovcnt;
+    lane->frag = 0;
+    lane->off = 0;
+    lane->run = NULL;
+    lane->run_blocks = 0;
+    lane->full = (size_t)(len / 64);
+    lane->nblocks = lane->full + tail_blocks;
+    lane->next = 0;
+
+    memset(lane->tail, 0, sizeof(lane->tail));
+    lane->tail[rem] = 0x80;
+    for (int i = 0; i < 8; i++) {
+        lane->tail[tail_blocks * 64 - 1 - i] = (BYTE)(bitlen >> (8 * i));
+    }
+    iov_settle(lane);
+}
+
+// Block `next` of the lane: in place while the current fragment has whole
+// blocks left (taken as one run, so most calls only bump a pointer),
+// gathered into stage when the block spans fragments, from tail once the
+// whole blocks are done
+static const BYTE* iov_lane_block(iov_lane_t* lane) {
+    const BYTE* block;
+    size_t avail;
+
+    if (lane->run_blocks > 0) {
+        block = lane->run;
+        lane->run += 64;
+        lane->run_blocks--;
+        return block;
+    }
+    if (lane->next >= lane->full) {
+        if (lane->next == lane->full) {
+            // The remainder goes in front of the padding prepared at start
+            BYTE* p = lane->tail;
+            for (iov_settle(lane); lane->frag < lane->iovcnt; lane->frag++, lane->off = 0) {
+                size_t take = lane->iov[lane->frag].iov_len - lane->off;
+                memcpy(p, (const BYTE*)lane->iov[lane->frag].iov_base + lane->off, take);
+                p += take;
+            }
+        }
+        return lane->tail + 64 * (lane->next - lane->full);
+    }
+
+    iov_settle(lane);
+    avail = lane->iov[lane->frag].iov_len - lane->off;
+    if (avail >= 64) {
+        block = (const BYTE*)lane->iov[lane->frag].iov_base + lane->off;
+        lane->run = block + 64;
+        lane->run_blocks = avail / 64 - 1;
+        lane->off += 64 * (avail / 64);
+        return block;
+    }
+    iov_gather(lane, lane->stage, 64);
+    return lane->stage;
+}
+
+// Finish one lane on the single-stream path: the rest of its fragments go
+// through the regular update (whole blocks in place, streaming for large
+// ones), blocks already in tail through the transform
+static void iov_lane_finish_single(iov_lane_t* lane, const WORD state[8], uint8_t hash[SHA256_90R_DIGEST_SIZE]) {
+    struct sha256_90r_internal_ctx ctx;
+
+    sha256_90r_init_internal(&ctx);
+    memcpy(ctx.state, state, sizeof(ctx.state));
+    if (lane->next < lane->full) {
+        ctx.bitlen = (unsigned long long)lane->next * 512;
+        if (lane->run_blocks > 0) {
+            sha256_90r_update_internal(&ctx, lane->run, 64 * lane->run_blocks);
+        }
+        iov_settle(lane);
+        if (lane->frag < lane->iovcnt) {
+            sha256_90r_update_internal(&ctx, (const BYTE*)lane->iov[lane->frag].iov_base + lane->off,
+                                       lane->iov[lane->frag].iov_len - lane->off);
+            for (size_t i = lane->frag + 1; i < lane->iovcnt; i++) {
+                if (lane->iov[i].iov_len == 0) continue;
+                sha256_90r_update_internal(&ctx, (const BYTE*)lane->iov[i].iov_base, lane->iov[i].iov_len);
+            }
+        }
+        sha256_90r_final_internal(&ctx, hash);
+        return;
+    }
+    while (lane->next < lane->nblocks) {
+        sha256_90r_transform(&ctx, iov_lane_block(lane));
+        lane->next++;
+    }
+    sha256_90r_store_digest(ctx.state, hash);
+}
+
+static void iov_batch_start(void* arg, int l, size_t index) {
+    iov_batch_t* batch = arg;
+    iov_lane_start(&batch->lane[l], index, batch->messages[index], batch->iovcnts[index]);
+}
+
+static const BYTE* iov_batch_next(void* arg, int l, int* last) {
+    iov_lane_t* lane = &((iov_batch_t*)arg)->lane[l];
+    const BYTE* block = iov_lane_block(lane);
+
+    *last = ++lane->next == lane->nblocks;
+    return block;
+}
+
+static void iov_batch_done(void* arg, int l, const WORD state[8]) {
+    iov_batch_t* batch = arg;
+    sha256_90r_store_digest(state, batch->hashes[batch->lane[l].index]);
+}
+
+static void iov_batch_finish(void* arg, int l, const WORD state[8]) {
+    iov_batch_t* batch = arg;
+    iov_lane_finish_single(&batch->lane[l], state, batch->hashes[batch->lane[l].index]);
+}
+
+static const sha256_90r_lane_ops_t iov_lane_ops = {
+    iov_batch_start, iov_batch_next, iov_batch_done, iov_batch_finish
+};
+
+/*************************** PUBLIC API ***************************/
+
+int sha256_90r_batchv(const struct iovec* const* messages, const size_t* iovcnts,
+                      uint8_t** hashes, size_t count, sha256_90r_mode_t mode)
+{
+    iov_batch_t batch;
+    int lanes;
+
+    if (count > 0 && (!messages || !iovcnts || !hashes)) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if (!iov_valid(messages[i], iovcnts[i]) || !hashes[i]) return -1;
+    }
+
+    // Same rule as sha256_90r_batch(): lanes (constant-time in every mode)
+    // once the batch reaches the tuned size, one context per message below it
+    lanes = sha256_90r_lane_width();
+    if (lanes == 1 || count < 2 || count < sha256_90r_tune_batch_min()) {
+        for (size_t i = 0; i < count; i++) {
+            SHA256_90R_CTX* ctx = sha256_90r_new(mode);
+            if (!ctx) return -1;
+            sha256_90r_updatev(ctx, messages[i], iovcnts[i]);
+            sha256_90r_final(ctx, hashes[i]);
+            sha256_90r_free(ctx);
+        }
+        return 0;
+    }
+    batch.messages = messages;
+    batch.iovcnts = iovcnts;
+    batch.hashes = hashes;
+    sha256_90r_lanes_run(lanes, SHA256_90R_LANE_KERNELS, &iov_lane_ops, &batch, count);
+    return 0;
+}
@@ -0,0 +1,333 @@
+/*********************************************************************
+* Filename:   sha256_90r_mb.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Multi-buffer job manager (submit/flush in the style of
+*             isa-l's mb_mgr). Every lane owns one message; lane contexts
+*             are kept word-major (state[word][lane]) so the AVX2 8-way and
+*             AVX-512 16-way kernels load them directly. The kernel runs
+*             for as many blocks as the shortest busy lane still needs,
+*             then finished lanes are finalized and refilled. Padding and
+*             the length block are hashed in-lane from a per-lane tail
+*             buffer, so no message is ever finished on the scalar path
+*             unless the manager is draining.
+*             The lane helpers shared with the other batch modules live
+*             here too: sha256_90r_lanes_run() keeps 8/16 lanes busy over
+*             a queue of messages whose blocks come from a callback.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/****************************** MACROS ******************************/
+#define MB_MAX_LANES SHA256_90R_MAX_LANES
+#define MB_DRAIN_LANES 2            // Finish this few busy lanes with the scalar transform
+
+#define MB_STATE(mgr, w, l) SHA256_90R_LANE_STATE((mgr)->state, (mgr)->lanes, w, l)
+
+/**************************** DATA TYPES ****************************/
+struct sha256_90r_mb_mgr {
+    int lanes;
+    WORD state[8 * MB_MAX_LANES];           // Word-major chaining values (MB_STATE)
+    const BYTE* data[MB_MAX_LANES];         // Message of each lane
+    size_t full_blocks[MB_MAX_LANES];       // Whole 64-byte blocks in data
+    size_t total_blocks[MB_MAX_LANES];      // full_blocks + 1 or 2 tail blocks
+    size_t next_block[MB_MAX_LANES];        // Next block index to compress
+    BYTE tail[MB_MAX_LANES][128];           // Remainder, 0x80, zeros, bit length
+    sha256_90r_job_t* job[MB_MAX_LANES];    // NULL when the lane is free
+    int done[MB_MAX_LANES];                 // Finished, digest written, not yet returned
+    sha256_90r_mb_stats_t stats;
+};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static const BYTE mb_idle_block[64];
+
+static int mb_lanes_supported(int lanes) {
+    switch (lanes) {
+        case 1: return 1;
+#if defined(USE_SIMD) && defined(__x86_64__)
+        case 8: return __builtin_cpu_supports("avx2");
+        case 16: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return 0;
+    }
+}
+
+static const BYTE* mb_lane_block(const sha256_90r_mb_mgr_t* mgr, int l) {
+    size_t n = mgr->next_block[l];
+    if (n < mgr->full_blocks[l]) return mgr->data[l] + 64 * n;
+    return mgr->tail[l] + 64 * (n - mgr->full_blocks[l]);
+}
+
+static void mb_lane_start(sha256_90r_mb_mgr_t* mgr, int l, sha256_90r_job_t* job) {
+    size_t len = job->len;
+    size_t rem = len % 64;
+    size_t tail_blocks = rem < 56 ? 1 : 2;
+    uint64_t bitlen = (uint64_t)len * 8;
+    struct sha256_90r_internal_ctx ctx;
+
+    sha256_90r_init_internal(&ctx);
+    for (int w = 0; w < 8; w++) MB_STATE(mgr, w, l) = ctx.state[w];
+
+    memset(mgr->tail[l], 0, sizeof(mgr->tail[l]));
+    if (rem) memcpy(mgr->tail[l], job->data + (len - rem), rem);
+    mgr->tail[l][rem] = 0x80;
+    for (int i = 0; i < 8; i++) {
+        mgr->tail[l][tail_blocks * 64 - 1 - i] = (BYTE)(bitlen >> (8 * i));
+    }
+
+    mgr->data[l] = job->data;
+    mgr->full_blocks[l] = len / 64;
+    mgr->total_blocks[l] = len / 64 + tail_blocks;
+    mgr->next_block[l] = 0;
+    mgr->job[l] = job;
+    mgr->done[l] = 0;
+    job->status = SHA256_90R_JOB_PROCESSING;
+}
+
+static void mb_lane_finish(sha256_90r_mb_mgr_t* mgr, int l) {
+    sha256_90r_job_t* job = mgr->job[l];
+    WORD state[8];
+
+    for (int w = 0; w < 8; w++) state[w] = MB_STATE(mgr, w, l);
+    sha256_90r_store_digest(state, job->digest);
+    job->status = SHA256_90R_JOB_COMPLETED;
+    mgr->done[l] = 1;
+    mgr->stats.jobs_completed++;
+}
+
+// Return (and free the lane of) one finished job, or NULL
+static sha256_90r_job_t* mb_take_done(sha256_90r_mb_mgr_t* mgr) {
+    for (int l = 0; l < mgr->lanes; l++) {
+        if (mgr->job[l] && mgr->done[l]) {
+            sha256_90r_job_t* job = mgr->job[l];
+            mgr->job[l] = NULL;
+            mgr->done[l] = 0;
+            return job;
+        }
+    }
+    return NULL;
+}
+
+// One lane through the scalar transform, n blocks
+static void mb_lane_scalar(sha256_90r_mb_mgr_t* mgr, int l, size_t n) {
+    struct sha256_90r_internal_ctx ctx;
+
+    for (int w = 0; w < 8; w++) ctx.state[w] = MB_STATE(mgr, w, l);
+    for (size_t i = 0; i < n; i++) {
+        sha256_90r_transform_scalar(&ctx, mb_lane_block(mgr, l));
+        mgr->next_block[l]++;
+    }
+    for (int w = 0; w < 8; w++) MB_STATE(mgr, w, l) = ctx.state[w];
+    if (mgr->lanes == 1) {
+        // The scalar transform is this manager's kernel
+        mgr->stats.kernel_calls += n;
+        mgr->stats.lane_blocks += n;
+    } else {
+        mgr->stats.scalar_blocks += n;
+    }
+}
+
+// All lanes through the multi-lane kernel, n blocks; idle lanes hash a dummy block
+static void mb_lanes_kernel(sha256_90r_mb_mgr_t* mgr, size_t n) {
+    const BYTE* blocks[MB_MAX_LANES];
+    int busy = 0;
+
+    for (int l = 0; l < mgr->lanes; l++) {
+        if (mgr->job[l] && !mgr->done[l]) busy++;
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (int l = 0; l < mgr->lanes; l++) {
+            blocks[l] = (mgr->job[l] && !mgr->done[l]) ? mb_lane_block(mgr, l) : mb_idle_block;
+        }
+#if defined(USE_SIMD) && defined(__x86_64__)
+        if (mgr->lanes == 16) {
+            sha256_90r_blocks_avx512_16way((WORD (*)[16])mgr->state, blocks);
+        } else {
+            sha256_90r_blocks_avx2_8way((WORD (*)[8])mgr->state, blocks);
+        }
+#endif
+        for (int l = 0; l < mgr->lanes; l++) {
+            if (mgr->job[l] && !mgr->done[l]) mgr->next_block[l]++;
+        }
+    }
+    mgr->stats.kernel_calls += n;
+    mgr->stats.lane_blocks += (uint64_t)busy * n;
+}
+
+// Compress until at least one busy lane finishes. draining: no more jobs will
+// arrive, so a nearly empty manager finishes its lanes one at a time.
+static void mb_run(sha256_90r_mb_mgr_t* mgr, int draining) {
+    size_t min_left = (size_t)-1;
+    int busy = 0;
+
+    for (int l = 0; l < mgr->lanes; l++) {
+        if (!mgr->job[l] || mgr->done[l]) continue;
+        size_t left = mgr->total_blocks[l] - mgr->next_block[l];
+        if (left < min_left) min_left = left;
+        busy++;
+    }
+    if (busy == 0) return;
+
+    if (mgr->lanes == 1 || (draining && busy <= MB_DRAIN_LANES)) {
+        for (int l = 0; l < mgr->lanes; l++) {
+            if (!mgr->job[l] || mgr->done[l]) continue;
+            mb_lane_scalar(mgr, l, mgr->total_blocks[l] - mgr->next_block[l]);
+            mb_lane_finish(mgr, l);
+        }
+        return;
+    }
+
+    mb_lanes_kernel(mgr, min_left);
+    for (int l = 0; l < mgr->lanes; l++) {
+        if (mgr->job[l] && !mgr->done[l] && mgr->next_block[l] == mgr->total_blocks[l]) {
+            mb_lane_finish(mgr, l);
+        }
+    }
+}
+
+/*************************** PUBLIC API ***************************/
+
+sha256_90r_mb_mgr_t* sha256_90r_mb_new(int lanes)
+{
+    sha256_90r_mb_mgr_t* mgr;
+
+    if (lanes == 0) {
+        lanes = mb_lanes_supported(16) ? 16 : mb_lanes_supported(8) ? 8 : 1;
+    }
+    if (!mb_lanes_supported(lanes)) return NULL;
+
+    mgr = calloc(1, sizeof(*mgr));
+    if (!mgr) return NULL;
+    mgr->lanes = lanes;
+    mgr->stats.lanes = lanes;
+    return mgr;
+}
+
+void sha256_90r_mb_free(sha256_90r_mb_mgr_t* mgr)
+{
+    free(mgr);
+}
+
+sha256_90r_job_t* sha256_90r_mb_submit(sha256_90r_mb_mgr_t* mgr, sha256_90r_job_t* job)
+{
+    int free_lane = -1, free_count = 0;
+
+    if (!mgr || !job) return NULL;
+    if (!job->data && job->len > 0) {
+        job->status = SHA256_90R_JOB_ERROR;
+        return job;
+    }
+
+    for (int l = 0; l < mgr->lanes; l++) {
+        if (!mgr->job[l]) {
+            if (free_lane < 0) free_lane = l;
+            free_count++;
+        }
+    }
+    // submit() never returns with every lane taken, so there is a free lane
+    mb_lane_start(mgr, free_lane, job);
+    if (free_count > 1) return NULL;
+
+    // Every lane is taken now: return a finished job, or run until one finishes
+    job = mb_take_done(mgr);
+    if (job) return job;
+    mb_run(mgr, 0);
+    return mb_take_done(mgr);
+}
+
+sha256_90r_job_t* sha256_90r_mb_flush(sha256_90r_mb_mgr_t* mgr)
+{
+    sha256_90r_job_t* job;
+
+    if (!mgr) return NULL;
+    job = mb_take_done(mgr);
+    if (job) return job;
+    mb_run(mgr, 1);
+    return mb_take_done(mgr);
+}
+
+void sha256_90r_mb_get_stats(const sha256_90r_mb_mgr_t* mgr, sha256_90r_mb_stats_t* stats)
+{
+    if (!mgr || !stats) return;
+    *stats = mgr->stats;
+    stats->lane_utilization = mgr->stats.kernel_calls
+        ? (double)mgr->stats.lane_blocks / ((double)mgr->stats.kernel_calls * mgr->lanes)
+        : 0.0;
+}
+
+/*********************** LIBRARY-INTERNAL API ***********************/
+
+void sha256_90r_store_digest(const WORD state[8], BYTE hash[32])
+{
+    for (int w = 0; w < 8; w++) {
+        hash[4 * w]     = (BYTE)(state[w] >> 24);
+        hash[4 * w + 1] = (BYTE)(state[w] >> 16);
+        hash[4 * w + 2] = (BYTE)(state[w] >> 8);
+        hash[4 * w + 3] = (BYTE)state[w];
+    }
+}
+
+int sha256_90r_lane_width(void)
+{
+    int tuned = sha256_90r_tune_mb_lanes();
+    int has16 = sha256_90r_kernel_available(SHA256_90R_KERNEL_AVX512_16WAY);
+    int has8 = sha256_90r_kernel_available(SHA256_90R_KERNEL_AVX2_8WAY);
+
+    if (tuned == 1) return 1;
+    if (tuned == 8 && has8) return 8;
+    return has16 ? 16 : has8 ? 8 : 1;
+}
+
+void sha256_90r_lanes_run(int lanes, sha256_90r_lanes8_fn kernel8, sha256_90r_lanes16_fn kernel16,
+                          const sha256_90r_lane_ops_t* ops, void* arg, size_t count)
+{
+    struct sha256_90r_internal_ctx iv;
+    WORD st[8 * SHA256_90R_MAX_LANES];
+    const BYTE* blocks[SHA256_90R_MAX_LANES];
+    int live[SHA256_90R_MAX_LANES] = {0};
+    int last[SHA256_90R_MAX_LANES] = {0};
+    size_t queued = 0;
+    int active = 0;
+
+    sha256_90r_init_internal(&iv);
+    for (int l = 0; l < lanes; l++) {
+        for (int w = 0; w < 8; w++) SHA256_90R_LANE_STATE(st, lanes, w, l) = iv.state[w];
+    }
+
+    for (;;) {
+        for (int l = 0; l < lanes; l++) {
+            if (live[l] || queued >= count) continue;
+            ops->start(arg, l, queued++);
+            for (int w = 0; w < 8; w++) SHA256_90R_LANE_STATE(st, lanes, w, l) = iv.state[w];
+            live[l] = 1;
+            active++;
+        }
+        if (active <= 1) break;
+
+        for (int l = 0; l < lanes; l++) blocks[l] = live[l] ? ops->next(arg, l, &last[l]) : mb_idle_block;
+        if (lanes == 16) kernel16((WORD (*)[16])st, blocks);
+        else kernel8((WORD (*)[8])st, blocks);
+
+        for (int l = 0; l < lanes; l++) {
+            WORD out[8];
+            if (!live[l] || !last[l]) continue;
+            for (int w = 0; w < 8; w++) out[w] = SHA256_90R_LANE_STATE(st, lanes, w, l);
+            ops->done(arg, l, out);
+            live[l] = 0;
+            active--;
+        }
+    }
+
+    for (int l = 0; l < lanes && active > 0; l++) {
+        WORD state[8];
+        if (!live[l]) continue;
+        for (int w = 0; w < 8; w++) state[w] = SHA256_90R_LANE_STATE(st, lanes, w, l);
+        ops->finish(arg, l, state);
+        active--;
+    }
+}
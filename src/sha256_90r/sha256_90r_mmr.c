@@ -0,0 +1,514 @@
+/*********************************************************************
+* Filename:   sha256_90r_mmr.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Merkle Mountain Range: an append-only accumulator whose
+*             nodes never change once written. Nodes are kept in post-order
+*             (a node after both children), so the node covering leaves
+*             [s, s + 2^h) is at a position that depends only on s and h,
+*             and a file of nodes is valid at every committed size.
+*             Appending a leaf hashes it and the parents it completes
+*             (O(log n)); a batch hashes its new leaves, then each new
+*             level, with sha256_90r_batchv, so the lanes take whole levels.
+*             Leaves, parents and bagged peaks are domain-separated:
+*               leaf   = H(0x00 || data)
+*               parent = H(0x01 || left || right)
+*               bag    = H(0x02 || left peak || bag of the peaks to its right)
+*             The root is the bag of all peaks, left to right.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE                     // mremap
+#endif
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/****************************** MACROS ******************************/
+#define MMR_MAGIC "S90RMMR1"
+#define MMR_HEADER 64                   // Bytes before node 0
+#define MMR_MIN_NODES 4096              // Initial capacity
+
+#define MMR_LEAF 0x00
+#define MMR_NODE 0x01
+#define MMR_BAG  0x02
+
+/**************************** DATA TYPES ****************************/
+// File header; node p is at MMR_HEADER + 32 * p
+typedef struct {
+    char magic[8];
+    uint64_t leaves;                // Committed by sha256_90r_mmr_sync
+    uint8_t reserved[MMR_HEADER - 16];
+} mmr_header_t;
+
+struct sha256_90r_mmr {
+    int fd;                         // -1 in memory
+    uint8_t* map;                   // Header, then nodes
+    uint64_t capacity;              // Nodes the mapping holds
+    uint64_t leaves;                // Appended so far (>= header->leaves)
+};
+
+typedef struct {
+    uint64_t start;                 // First leaf
+    int height;                     // Covers 2^height leaves
+} mmr_peak_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static const uint8_t mmr_tag_leaf = MMR_LEAF;
+static const uint8_t mmr_tag_node = MMR_NODE;
+
+// Nodes of an MMR with n leaves
+static uint64_t mmr_size(uint64_t n) {
+    return 2 * n - (uint64_t)__builtin_popcountll(n);
+}
+
+// Position of the node covering leaves [s, s + 2^h); s is a multiple of 2^h
+static uint64_t mmr_pos(uint64_t s, int h) {
+    return mmr_size(s) + (2ULL << h) - 2;
+}
+
+static uint8_t* mmr_node(const sha256_90r_mmr_t* mmr, uint64_t pos) {
+    return mmr->map + MMR_HEADER + SHA256_90R_DIGEST_SIZE * pos;
+}
+
+static mmr_header_t* mmr_hdr(const sha256_90r_mmr_t* mmr) {
+    return (mmr_header_t*)mmr->map;
+}
+
+static size_t mmr_bytes(uint64_t nodes) {
+    return MMR_HEADER + (size_t)nodes * SHA256_90R_DIGEST_SIZE;
+}
+
+// Peaks of an MMR with n leaves, left (highest) to right; returns the count
+static int mmr_peaks(uint64_t n, mmr_peak_t peaks[64]) {
+    uint64_t start = 0;
+    int count = 0;
+
+    for (int h = 63; h >= 0; h--) {
+        if (!(n >> h & 1)) continue;
+        peaks[count].start = start;
+        peaks[count].height = h;
+        count++;
+        start += 1ULL << h;
+    }
+    return count;
+}
+
+static void mmr_hash_pair(uint8_t tag, const uint8_t left[32], const uint8_t right[32], uint8_t out[32]) {
+    sha256_90r_state_t st;
+
+    sha256_90r_state_init(&st);
+    sha256_90r_state_update(&st, &tag, 1);
+    sha256_90r_state_update(&st, left, SHA256_90R_DIGEST_SIZE);
+    sha256_90r_state_update(&st, right, SHA256_90R_DIGEST_SIZE);
+    sha256_90r_state_final(&st, out);
+}
+
+static void mmr_hash_leaf(const void* data, size_t len, uint8_t out[32]) {
+    sha256_90r_state_t st;
+
+    sha256_90r_state_init(&st);
+    sha256_90r_state_update(&st, &mmr_tag_leaf, 1);
+    sha256_90r_state_update(&st, (const uint8_t*)data, len);
+    sha256_90r_state_final(&st, out);
+}
+
+// Root from the peak hashes: bag right to left; no peaks is the empty digest
+static void mmr_bag(const uint8_t (*peaks)[32], int count, uint8_t root[32]) {
+    if (count == 0) {
+        sha256_90r_hash(NULL, 0, root);
+        return;
+    }
+    memcpy(root, peaks[count - 1], SHA256_90R_DIGEST_SIZE);
+    for (int i = count - 2; i >= 0; i--) mmr_hash_pair(MMR_BAG, peaks[i], root, root);
+}
+
+// Make room for `nodes` nodes: grow the file and the mapping by doubling
+static int mmr_reserve(sha256_90r_mmr_t* mmr, uint64_t nodes) {
+    uint64_t cap = mmr->capacity;
+    uint8_t* map;
+
+    if (nodes <= cap) return 0;
+    while (cap < nodes) cap *= 2;
+    if (mmr->fd >= 0 && ftruncate(mmr->fd, (off_t)mmr_bytes(cap)) != 0) return -1;
+    map = mremap(mmr->map, mmr_bytes(mmr->capacity), mmr_bytes(cap), MREMAP_MAYMOVE);
+    if (map == MAP_FAILED) return -1;
+    mmr->map = map;
+    mmr->capacity = cap;
+    return 0;
+}
+
+// Hash `count` nodes at one level in lanes: node i = H(tag || parts), parts
+// given as iovec lists in iov[i * 3 ..]
+static int mmr_hash_level(struct iovec* iov, const struct iovec** msgs, size_t* cnts, uint8_t** outs,
+                          size_t count, size_t parts) {
+    for (size_t i = 0; i < count; i++) {
+        msgs[i] = iov + i * 3;
+        cnts[i] = parts;
+    }
+    return sha256_90r_batchv(msgs, cnts, outs, count, SHA256_90R_MODE_SECURE);
+}
+
+/*************************** PUBLIC API ***************************/
+
+sha256_90r_mmr_t* sha256_90r_mmr_open(const char* path)
+{
+    sha256_90r_mmr_t* mmr = calloc(1, sizeof(*mmr));
+    struct stat st;
+    int err;
+
+    if (!mmr) return NULL;
+    mmr->fd = -1;
+    mmr->capacity = MMR_MIN_NODES;
+
+    if (!path) {
+        mmr->map = mmap(NULL, mmr_bytes(mmr->capacity), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mmr->map == MAP_FAILED) {
+            free(mmr);
+            return NULL;
+        }
+        memcpy(mmr_hdr(mmr)->magic, MMR_MAGIC, 8);
+        return mmr;
+    }
+
+    mmr->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (mmr->fd < 0 || fstat(mmr->fd, &st) != 0) goto fail;
+    if (st.st_size == 0) {
+        mmr_header_t hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, MMR_MAGIC, 8);
+        if (ftruncate(mmr->fd, (off_t)mmr_bytes(mmr->capacity)) != 0 ||
+            pwrite(mmr->fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) goto fail;
+    } else {
+        if ((size_t)st.st_size < MMR_HEADER) {
+            errno = EINVAL;
+            goto fail;
+        }
+        while (mmr_bytes(mmr->capacity) < (size_t)st.st_size) mmr->capacity *= 2;
+        if (ftruncate(mmr->fd, (off_t)mmr_bytes(mmr->capacity)) != 0) goto fail;
+    }
+
+    mmr->map = mmap(NULL, mmr_bytes(mmr->capacity), PROT_READ | PROT_WRITE, MAP_SHARED, mmr->fd, 0);
+    if (mmr->map == MAP_FAILED) {
+        mmr->map = NULL;
+        goto fail;
+    }
+    // The committed size says which nodes are valid; nothing is rehashed.
+    // Nodes past it (appends never synced) are overwritten by the next append.
+    if (memcmp(mmr_hdr(mmr)->magic, MMR_MAGIC, 8) != 0 ||
+        (st.st_size > 0 && mmr_bytes(mmr_size(mmr_hdr(mmr)->leaves)) > (size_t)st.st_size)) {
+        errno = EINVAL;
+        goto fail;
+    }
+    mmr->leaves = mmr_hdr(mmr)->leaves;
+    return mmr;
+
+fail:
+    err = errno;
+    if (mmr->map) munmap(mmr->map, mmr_bytes(mmr->capacity));
+    if (mmr->fd >= 0) close(mmr->fd);
+    free(mmr);
+    errno = err;
+    return NULL;
+}
+
+int sha256_90r_mmr_sync(sha256_90r_mmr_t* mmr)
+{
+    if (!mmr) return -1;
+    if (mmr->fd < 0) {
+        mmr_hdr(mmr)->leaves = mmr->leaves;
+        return 0;
+    }
+    // Nodes reach the disk before the size that makes them valid
+    if (msync(mmr->map, mmr_bytes(mmr_size(mmr->leaves)), MS_SYNC) != 0) return -1;
+    mmr_hdr(mmr)->leaves = mmr->leaves;
+    return msync(mmr->map, MMR_HEADER, MS_SYNC);
+}
+
+void sha256_90r_mmr_close(sha256_90r_mmr_t* mmr)
+{
+    if (!mmr) return;
+    sha256_90r_mmr_sync(mmr);
+    munmap(mmr->map, mmr_bytes(mmr->capacity));
+    if (mmr->fd >= 0) {
+        // Drop the unused tail of the last doubling; if this fails the file
+        // is only longer, as the header bounds the nodes
+        int rc = ftruncate(mmr->fd, (off_t)mmr_bytes(mmr_size(mmr->leaves)));
+        (void)rc;
+        close(mmr->fd);
+    }
+    free(mmr);
+}
+
+uint64_t sha256_90r_mmr_size(const sha256_90r_mmr_t* mmr)
+{
+    return mmr ? mmr->leaves : 0;
+}
+
+int sha256_90r_mmr_append_batch(sha256_90r_mmr_t* mmr, const uint8_t* const* data, const size_t* lens,
+                                size_t count)
+{
+    uint64_t n, end;
+    size_t max_level;
+    struct iovec* iov;
+    const struct iovec** msgs;
+    size_t* cnts;
+    uint8_t** outs;
+    int ret = 0;
+
+    if (!mmr || (count > 0 && (!data || !lens))) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if (!data[i] && lens[i] > 0) return -1;
+    }
+    if (count == 0) return 0;
+    n = mmr->leaves;
+    end = n + count;
+    if (mmr_reserve(mmr, mmr_size(end)) != 0) return -1;
+
+    // One level at a time: the leaves, then every parent the batch completes
+    // at height 1, 2, ... Nodes on a level are independent and share lanes.
+    max_level = count;
+    iov = malloc(max_level * 3 * sizeof(*iov));
+    msgs = malloc(max_level * sizeof(*msgs));
+    cnts = malloc(max_level * sizeof(*cnts));
+    outs = malloc(max_level * sizeof(*outs));
+    if (!iov || !msgs || !cnts || !outs) {
+        ret = -1;
+        goto done;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        iov[i * 3].iov_base = (void*)&mmr_tag_leaf;
+        iov[i * 3].iov_len = 1;
+        iov[i * 3 + 1].iov_base = (void*)data[i];
+        iov[i * 3 + 1].iov_len = lens[i];
+        outs[i] = mmr_node(mmr, mmr_pos(n + i, 0));
+    }
+    if (mmr_hash_level(iov, msgs, cnts, outs, count, 2) != 0) {
+        ret = -1;
+        goto done;
+    }
+
+    for (int h = 1; h < 64 && (end >> h) > 0; h++) {
+        uint64_t span = 1ULL << h;
+        uint64_t first = (n / span + 1) * span;    // First subtree end past n
+        size_t k = 0;
+
+        for (uint64_t stop = first; stop <= end; stop += span) {
+            uint64_t s = stop - span;
+            iov[k * 3].iov_base = (void*)&mmr_tag_node;
+            iov[k * 3].iov_len = 1;
+            iov[k * 3 + 1].iov_base = mmr_node(mmr, mmr_pos(s, h - 1));
+            iov[k * 3 + 1].iov_len = SHA256_90R_DIGEST_SIZE;
+            iov[k * 3 + 2].iov_base = mmr_node(mmr, mmr_pos(s + span / 2, h - 1));
+            iov[k * 3 + 2].iov_len = SHA256_90R_DIGEST_SIZE;
+            outs[k] = mmr_node(mmr, mmr_pos(s, h));
+            k++;
+        }
+        if (k == 0) continue;
+        if (mmr_hash_level(iov, msgs, cnts, outs, k, 3) != 0) {
+            ret = -1;
+            goto done;
+        }
+    }
+    mmr->leaves = end;
+
+done:
+    free(iov);
+    free(msgs);
+    free(cnts);
+    free(outs);
+    return ret;
+}
+
+int sha256_90r_mmr_append(sha256_90r_mmr_t* mmr, const void* data, size_t len, uint64_t* index)
+{
+    uint64_t n;
+
+    if (!mmr || (!data && len > 0)) return -1;
+    n = mmr->leaves;
+    if (mmr_reserve(mmr, mmr_size(n + 1)) != 0) return -1;
+
+    // The leaf, then one parent per trailing 1 bit of n
+    mmr_hash_leaf(data, len, mmr_node(mmr, mmr_pos(n, 0)));
+    for (int h = 1; h < 64 && (n >> (h - 1) & 1); h++) {
+        uint64_t s = (n + 1) - (1ULL << h);
+        mmr_hash_pair(MMR_NODE, mmr_node(mmr, mmr_pos(s, h - 1)),
+                      mmr_node(mmr, mmr_pos(s + (1ULL << (h - 1)), h - 1)), mmr_node(mmr, mmr_pos(s, h)));
+    }
+    mmr->leaves = n + 1;
+    if (index) *index = n;
+    return 0;
+}
+
+int sha256_90r_mmr_root(const sha256_90r_mmr_t* mmr, uint64_t leaves, uint8_t root[SHA256_90R_DIGEST_SIZE])
+{
+    mmr_peak_t peaks[64];
+    uint8_t hashes[64][32];
+    int count;
+
+    if (!mmr || !root || leaves > mmr->leaves) return -1;
+    count = mmr_peaks(leaves, peaks);
+    for (int i = 0; i < count; i++) {
+        memcpy(hashes[i], mmr_node(mmr, mmr_pos(peaks[i].start, peaks[i].height)), SHA256_90R_DIGEST_SIZE);
+    }
+    mmr_bag((const uint8_t (*)[32])hashes, count, root);
+    return 0;
+}
+
+int sha256_90r_mmr_prove_inclusion(const sha256_90r_mmr_t* mmr, uint64_t index, uint64_t leaves,
+                                   uint8_t proof[][SHA256_90R_DIGEST_SIZE], size_t* proof_len)
+{
+    mmr_peak_t peaks[64];
+    size_t len = 0;
+    int count;
+
+    if (!mmr || !proof || !proof_len || index >= leaves || leaves > mmr->leaves) return -1;
+    count = mmr_peaks(leaves, peaks);
+
+    // Siblings from the leaf up to its peak, then every other peak, left to right
+    for (int i = 0; i < count; i++) {
+        uint64_t span = 1ULL << peaks[i].height;
+        if (index < peaks[i].start || index >= peaks[i].start + span) continue;
+        for (int h = 0; h < peaks[i].height; h++) {
+            uint64_t s = index >> h << h;
+            memcpy(proof[len++], mmr_node(mmr, mmr_pos(s ^ (1ULL << h), h)), SHA256_90R_DIGEST_SIZE);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (index >= peaks[i].start && index < peaks[i].start + (1ULL << peaks[i].height)) continue;
+        memcpy(proof[len++], mmr_node(mmr, mmr_pos(peaks[i].start, peaks[i].height)), SHA256_90R_DIGEST_SIZE);
+    }
+    *proof_len = len;
+    return 0;
+}
+
+int sha256_90r_mmr_verify_inclusion(const uint8_t root[SHA256_90R_DIGEST_SIZE], uint64_t leaves, uint64_t index,
+                                    const void* data, size_t len,
+                                    const uint8_t proof[][SHA256_90R_DIGEST_SIZE], size_t proof_len)
+{
+    mmr_peak_t peaks[64];
+    uint8_t hashes[64][32], node[32], want[32];
+    size_t used = 0;
+    int count, mine = -1;
+
+    if (!root || (!data && len > 0) || (!proof && proof_len > 0) || index >= leaves) return 0;
+    count = mmr_peaks(leaves, peaks);
+    for (int i = 0; i < count; i++) {
+        if (index >= peaks[i].start && index < peaks[i].start + (1ULL << peaks[i].height)) mine = i;
+    }
+    if (proof_len != (size_t)peaks[mine].height + (size_t)(count - 1)) return 0;
+
+    mmr_hash_leaf(data, len, node);
+    for (int h = 0; h < peaks[mine].height; h++) {
+        if (index >> h & 1) mmr_hash_pair(MMR_NODE, proof[used++], node, node);
+        else mmr_hash_pair(MMR_NODE, node, proof[used++], node);
+    }
+    for (int i = 0; i < count; i++) {
+        memcpy(hashes[i], i == mine ? node : proof[used++], SHA256_90R_DIGEST_SIZE);
+    }
+    mmr_bag((const uint8_t (*)[32])hashes, count, want);
+    return memcmp(want, root, SHA256_90R_DIGEST_SIZE) == 0;
+}
+
+/* Consistency of old_leaves -> new_leaves. The new MMR's peaks are: the old
+ * peaks left of the first new mountain that holds old leaves, that mountain
+ * (climbed from the last old peak inside it, the other old peaks inside it
+ * being its left siblings), then mountains of new leaves only. Proof: every
+ * old peak, the right siblings of the climb, the remaining new peaks. */
+int sha256_90r_mmr_prove_consistency(const sha256_90r_mmr_t* mmr, uint64_t old_leaves, uint64_t new_leaves,
+                                     uint8_t proof[][SHA256_90R_DIGEST_SIZE], size_t* proof_len)
+{
+    mmr_peak_t oldp[64], newp[64];
+    size_t len = 0;
+    int nold, nnew;
+
+    if (!mmr || !proof || !proof_len || old_leaves > new_leaves || new_leaves > mmr->leaves) return -1;
+    nold = mmr_peaks(old_leaves, oldp);
+    nnew = mmr_peaks(new_leaves, newp);
+
+    for (int i = 0; i < nold; i++) {
+        memcpy(proof[len++], mmr_node(mmr, mmr_pos(oldp[i].start, oldp[i].height)), SHA256_90R_DIGEST_SIZE);
+    }
+    for (int j = 0; j < nnew; j++) {
+        uint64_t end = newp[j].start + (1ULL << newp[j].height);
+        if (end <= old_leaves) continue;                // An old peak as it was
+        if (newp[j].start < old_leaves) {
+            // Climb from the last old peak to this mountain's root
+            const mmr_peak_t* last = &oldp[nold - 1];
+            uint64_t s = last->start;
+            for (int h = last->height; h < newp[j].height; h++) {
+                if (!(s >> h & 1)) {
+                    memcpy(proof[len++], mmr_node(mmr, mmr_pos(s + (1ULL << h), h)), SHA256_90R_DIGEST_SIZE);
+                }
+                s = s >> (h + 1) << (h + 1);
+            }
+        } else {
+            memcpy(proof[len++], mmr_node(mmr, mmr_pos(newp[j].start, newp[j].height)), SHA256_90R_DIGEST_SIZE);
+        }
+    }
+    *proof_len = len;
+    return 0;
+}
+
+int sha256_90r_mmr_verify_consistency(const uint8_t old_root[SHA256_90R_DIGEST_SIZE], uint64_t old_leaves,
+                                      const uint8_t new_root[SHA256_90R_DIGEST_SIZE], uint64_t new_leaves,
+                                      const uint8_t proof[][SHA256_90R_DIGEST_SIZE], size_t proof_len)
+{
+    mmr_peak_t oldp[64], newp[64];
+    uint8_t hashes[64][32], want[32];
+    size_t used;
+    int nold, nnew, k = 0;
+
+    if (!old_root || !new_root || (!proof && proof_len > 0) || old_leaves > new_leaves) return 0;
+    nold = mmr_peaks(old_leaves, oldp);
+    nnew = mmr_peaks(new_leaves, newp);
+    if (proof_len < (size_t)nold) return 0;
+
+    // The old peaks must give the old root...
+    mmr_bag(proof, nold, want);
+    if (memcmp(want, old_root, SHA256_90R_DIGEST_SIZE) != 0) return 0;
+
+    // ...and, climbed and extended, the new one
+    used = (size_t)nold;
+    for (int j = 0; j < nnew; j++) {
+        uint64_t end = newp[j].start + (1ULL << newp[j].height);
+        if (end <= old_leaves) {
+            // Same mountains up to here, in the same order
+            memcpy(hashes[j], proof[k++], SHA256_90R_DIGEST_SIZE);
+        } else if (newp[j].start < old_leaves) {
+            const mmr_peak_t* last = &oldp[nold - 1];
+            uint64_t s = last->start;
+            uint8_t node[32];
+            int left = nold - 2;                        // Old peaks left of the climb, right to left
+
+            memcpy(node, proof[nold - 1], SHA256_90R_DIGEST_SIZE);
+            for (int h = last->height; h < newp[j].height; h++) {
+                if (s >> h & 1) {
+                    if (left < k) return 0;
+                    mmr_hash_pair(MMR_NODE, proof[left--], node, node);
+                } else {
+                    if (used >= proof_len) return 0;
+                    mmr_hash_pair(MMR_NODE, node, proof[used++], node);
+                }
+                s = s >> (h + 1) << (h + 1);
+            }
+            if (left != k - 1) return 0;
+            memcpy(hashes[j], node, SHA256_90R_DIGEST_SIZE);
+        } else {
+            if (used >= proof_len) return 0;
+            memcpy(hashes[j], proof[used++], SHA256_90R_DIGEST_SIZE);
+        }
+    }
+    if (used != proof_len) return 0;
+    mmr_bag((const uint8_t (*)[32])hashes, nnew, want);
+    return memcmp(want, new_root, SHA256_90R_DIGEST_SIZE) == 0;
+}
@@ -0,0 +1,809 @@
+/*********************************************************************
+* Filename:   sha256_90r_parallel.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Multi-threaded tree and batch hashing with NUMA placement.
+*             Work items (tree leaves or batch messages) are sorted into
+*             per-node queues by the node that holds their first page
+*             (move_pages, get_mempolicy as fallback). Workers are pinned
+*             to the CPUs of one node, drain that node's queue through a
+*             multi-buffer manager allocated after pinning, and only then
+*             steal from other nodes; stolen bytes are reported as
+*             cross-node traffic. Topology is read from sysfs, so no
+*             libnuma is needed. SHA256_90R_NUMA=0 disables placement and
+*             pinning. The incremental tree keeps every level over a
+*             caller's buffer and rehashes only the chunks marked dirty and
+*             their ancestors.
+*********************************************************************/
+
+#define _GNU_SOURCE
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/****************************** MACROS ******************************/
+#define PAR_MAX_THREADS 256
+#define PAR_QUERY_BATCH 1024        // Addresses per move_pages call
+#define PAR_MPOL_F_NODE 0x1         // get_mempolicy flags (numaif.h)
+#define PAR_MPOL_F_ADDR 0x2
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+    int nodes;
+    cpu_set_t cpus[SHA256_90R_MAX_NUMA_NODES];
+    int ncpus[SHA256_90R_MAX_NUMA_NODES];
+} par_topology_t;
+
+// Items whose memory lives on one node; workers claim them one at a time
+typedef struct {
+    sha256_90r_job_t** items;
+    size_t count;
+    size_t next;
+} par_queue_t;
+
+typedef struct {
+    par_queue_t* queues;
+    int nodes;
+    int node;                       // Home node of this worker
+    int pin;
+    uint64_t bytes;
+    uint64_t cross_bytes;
+} par_worker_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static par_topology_t par_topo;
+static pthread_once_t par_topo_once = PTHREAD_ONCE_INIT;
+
+static double par_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Parse a sysfs cpulist ("0-3,8-11") into set
+static int par_parse_cpulist(const char* path, cpu_set_t* set) {
+    char buf[4096];
+    FILE* fp = fopen(path, "r");
+    int count = 0;
+
+    CPU_ZERO(set);
+    if (!fp) return 0;
+    if (!fgets(buf, sizeof(buf), fp)) buf[0] = '\0';
+    fclose(fp);
+
+    for (char* p = buf; *p && *p != '\n';) {
+        char* end;
+        long lo = strtol(p, &end, 10), hi = lo;
+        if (end == p) break;
+        if (*end == '-') hi = strtol(end + 1, &end, 10);
+        for (long c = lo; c <= hi && c < CPU_SETSIZE; c++) {
+            CPU_SET((int)c, set);
+            count++;
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+// Nodes with CPUs this process may run on; one node holding every allowed CPU otherwise
+static void par_topology_init(void) {
+    cpu_set_t allowed;
+    char path[128];
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+        for (long c = 0; c < sysconf(_SC_NPROCESSORS_ONLN) && c < CPU_SETSIZE; c++) CPU_SET((int)c, &allowed);
+    }
+
+    for (int n = 0; n < SHA256_90R_MAX_NUMA_NODES; n++) {
+        cpu_set_t node_cpus;
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", n);
+        if (!par_parse_cpulist(path, &node_cpus)) continue;
+        CPU_AND(&node_cpus, &node_cpus, &allowed);
+        if (CPU_COUNT(&node_cpus) == 0) continue;
+        // Nodes are renumbered densely; par_node_index maps kernel ids back
+        par_topo.cpus[par_topo.nodes] = node_cpus;
+        par_topo.ncpus[par_topo.nodes] = CPU_COUNT(&node_cpus);
+        par_topo.nodes++;
+    }
+    if (par_topo.nodes == 0) {
+        par_topo.cpus[0] = allowed;
+        par_topo.ncpus[0] = CPU_COUNT(&allowed);
+        par_topo.nodes = 1;
+    }
+}
+
+static const par_topology_t* par_topology(void) {
+    pthread_once(&par_topo_once, par_topology_init);
+    return &par_topo;
+}
+
+static int par_numa_enabled(void) {
+    const char* env = getenv("SHA256_90R_NUMA");
+    return !(env && env[0] == '0');
+}
+
+// Dense index of kernel node id, or -1 if it has no usable CPUs here
+static int par_node_index(int kernel_node) {
+    const par_topology_t* topo = par_topology();
+    char path[128];
+    cpu_set_t cpus;
+
+    if (kernel_node < 0) return -1;
+    if (topo->nodes == 1) return 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", kernel_node);
+    if (!par_parse_cpulist(path, &cpus)) return -1;
+    for (int n = 0; n < topo->nodes; n++) {
+        cpu_set_t both;
+        CPU_AND(&both, &cpus, &topo->cpus[n]);
+        if (CPU_COUNT(&both)) return n;
+    }
+    return -1;
+}
+
+/**
+ * Dense node index of the page holding each address (-1: not yet faulted in
+ * or unknown). One move_pages call per PAR_QUERY_BATCH addresses; falls back
+ * to get_mempolicy per address where move_pages is unavailable.
+ */
+static void par_query_nodes(const void* const* addrs, size_t count, int* nodes) {
+    int map[64];
+    void* pages[PAR_QUERY_BATCH];
+    int status[PAR_QUERY_BATCH];
+    int use_move_pages = 1;
+
+    for (int i = 0; i < 64; i++) map[i] = -2;
+    for (size_t base = 0; base < count; base += PAR_QUERY_BATCH) {
+        size_t n = count - base < PAR_QUERY_BATCH ? count - base : PAR_QUERY_BATCH;
+        for (size_t i = 0; i < n; i++) {
+            pages[i] = (void*)((uintptr_t)addrs[base + i] & ~(uintptr_t)4095);
+            status[i] = -1;
+        }
+        if (use_move_pages && syscall(SYS_move_pages, 0, (unsigned long)n, pages, NULL, status, 0) != 0) {
+            use_move_pages = 0;
+        }
+        if (!use_move_pages) {
+            for (size_t i = 0; i < n; i++) {
+                int node = -1;
+                if (syscall(SYS_get_mempolicy, &node, NULL, 0UL, pages[i],
+                            (unsigned long)(PAR_MPOL_F_NODE | PAR_MPOL_F_ADDR)) != 0) {
+                    node = -1;
+                }
+                status[i] = node;
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            int k = status[i];
+            if (k < 0 || k >= 64) {
+                nodes[base + i] = -1;
+                continue;
+            }
+            if (map[k] == -2) map[k] = par_node_index(k);
+            nodes[base + i] = map[k];
+        }
+    }
+}
+
+static int par_bind_node(int node) {
+    const par_topology_t* topo = par_topology();
+    if (node < 0 || node >= topo->nodes) return -1;
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &topo->cpus[node]) == 0 ? 0 : -1;
+}
+
+// Next item: own node first, then steal round-robin from the others
+static sha256_90r_job_t* par_claim(par_worker_t* wk, int* from) {
+    for (int i = 0; i < wk->nodes; i++) {
+        int q = (wk->node + i) % wk->nodes;
+        par_queue_t* queue = &wk->queues[q];
+        if (__atomic_load_n(&queue->next, __ATOMIC_RELAXED) >= queue->count) continue;
+        size_t idx = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+        if (idx < queue->count) {
+            *from = q;
+            return queue->items[idx];
+        }
+    }
+    return NULL;
+}
+
+// Completed job: digest goes to the caller's slot in user_data
+static void par_job_done(sha256_90r_job_t* job) {
+    memcpy(job->user_data, job->digest, SHA256_90R_DIGEST_SIZE);
+}
+
+static void* par_worker_main(void* arg) {
+    par_worker_t* wk = (par_worker_t*)arg;
+    sha256_90r_mb_mgr_t* mgr;
+    sha256_90r_job_t *job, *done;
+    int from;
+
+    if (wk->pin) par_bind_node(wk->node);
+    // Allocated after pinning so the lane state is node-local (first touch)
+    mgr = sha256_90r_mb_new(sha256_90r_tune_mb_lanes());
+
+    while ((job = par_claim(wk, &from)) != NULL) {
+        wk->bytes += job->len;
+        if (from != wk->node) wk->cross_bytes += job->len;
+        if (!mgr) {
+            sha256_90r_hash(job->data, job->len, job->user_data);
+            continue;
+        }
+        if ((done = sha256_90r_mb_submit(mgr, job)) != NULL) par_job_done(done);
+    }
+    if (mgr) {
+        while ((done = sha256_90r_mb_flush(mgr)) != NULL) par_job_done(done);
+        sha256_90r_mb_free(mgr);
+    }
+    return NULL;
+}
+
+/**
+ * Hash every job on num_threads workers. Jobs are queued on the node that
+ * owns their first page and workers are spread over nodes in proportion to
+ * the bytes queued there.
+ */
+static int par_run(sha256_90r_job_t* jobs, size_t count, int num_threads, sha256_90r_par_stats_t* stats) {
+    const par_topology_t* topo = par_topology();
+    int numa = par_numa_enabled() && topo->nodes > 1;
+    int nodes = numa ? topo->nodes : 1;
+    par_queue_t queues[SHA256_90R_MAX_NUMA_NODES];
+    uint64_t queued[SHA256_90R_MAX_NUMA_NODES] = {0};
+    int node_threads[SHA256_90R_MAX_NUMA_NODES] = {0};
+    sha256_90r_job_t** items = NULL;
+    int* home = NULL;
+    par_worker_t* workers = NULL;
+    pthread_t* threads = NULL;
+    uint64_t unplaced = 0;
+    int started = 0, rc = -1;
+    double start;
+
+    memset(queues, 0, sizeof(queues));
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (count == 0) return 0;
+
+    if (num_threads <= 0) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < count; i++) total += jobs[i].len;
+        num_threads = sha256_90r_tune_threads((size_t)total);
+    }
+    if (num_threads > PAR_MAX_THREADS) num_threads = PAR_MAX_THREADS;
+    if ((size_t)num_threads > count) num_threads = (int)count;
+
+    items = malloc(count * sizeof(*items));
+    home = calloc(count, sizeof(*home));
+    workers = calloc((size_t)num_threads, sizeof(*workers));
+    threads = calloc((size_t)num_threads, sizeof(*threads));
+    if (!items || !home || !workers || !threads) goto out;
+
+    if (numa) {
+        const void** addrs = malloc(count * sizeof(*addrs));
+        if (!addrs) goto out;
+        for (size_t i = 0; i < count; i++) addrs[i] = jobs[i].data;
+        par_query_nodes(addrs, count, home);
+        free(addrs);
+        // Not faulted in yet: the worker that reads it first gets it, spread evenly
+        for (size_t i = 0; i < count; i++) {
+            if (home[i] < 0) {
+                home[i] = (int)(i % (size_t)nodes);
+                unplaced += jobs[i].len;
+            }
+        }
+    }
+
+    // Bucket the jobs by node: counts, offsets, fill
+    for (size_t i = 0; i < count; i++) {
+        queues[home[i]].count++;
+        queued[home[i]] += jobs[i].len + 64;
+    }
+    for (int n = 0, off = 0; n < nodes; n++) {
+        queues[n].items = items + off;
+        off += (int)queues[n].count;
+        queues[n].count = 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        par_queue_t* q = &queues[home[i]];
+        q->items[q->count++] = &jobs[i];
+    }
+
+    // One worker per node with work first, the rest where the most bytes per worker remain
+    for (int t = 0; t < num_threads; t++) {
+        int best = -1;
+        double best_score = -1.0;
+        for (int n = 0; n < nodes; n++) {
+            double score;
+            if (!queued[n]) continue;
+            score = (double)queued[n] / (node_threads[n] + 1);
+            if (node_threads[n] == 0) score += 1e30;
+            if (score > best_score) {
+                best = n;
+                best_score = score;
+            }
+        }
+        node_threads[best]++;
+        workers[t].queues = queues;
+        workers[t].nodes = nodes;
+        workers[t].node = best;
+        workers[t].pin = numa;
+    }
+
+    start = par_now();
+    if (num_threads == 1) {
+        par_worker_main(&workers[0]);
+    } else {
+        for (; started < num_threads; started++) {
+            if (pthread_create(&threads[started], NULL, par_worker_main, &workers[started]) != 0) break;
+        }
+        // Items left by workers that failed to start are stolen by the others
+        if (started == 0) par_worker_main(&workers[0]);
+        for (int t = 0; t < started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+
+    if (stats) {
+        stats->seconds = par_now() - start;
+        stats->nodes = nodes;
+        stats->threads = started > 0 ? started : 1;
+        stats->unplaced_bytes = unplaced;
+        for (int t = 0; t < (started > 0 ? started : 1); t++) {
+            stats->node_threads[workers[t].node]++;
+            stats->node_bytes[workers[t].node] += workers[t].bytes;
+            stats->cross_node_bytes += workers[t].cross_bytes;
+        }
+    }
+    rc = 0;
+
+out:
+    free(items);
+    free(home);
+    free(workers);
+    free(threads);
+    return rc;
+}
+
+// Hash `count` jobs in the calling thread with one multi-buffer manager
+static void par_hash_local(sha256_90r_job_t* jobs, size_t count) {
+    sha256_90r_mb_mgr_t* mgr = sha256_90r_mb_new(sha256_90r_tune_mb_lanes());
+    sha256_90r_job_t* done;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!mgr) {
+            sha256_90r_hash(jobs[i].data, jobs[i].len, jobs[i].user_data);
+        } else if ((done = sha256_90r_mb_submit(mgr, &jobs[i])) != NULL) {
+            par_job_done(done);
+        }
+    }
+    if (mgr) {
+        while ((done = sha256_90r_mb_flush(mgr)) != NULL) par_job_done(done);
+        sha256_90r_mb_free(mgr);
+    }
+}
+
+/**
+ * Reduce n leaf digests to the root: parent = H(left || right), an odd last
+ * node is paired with itself. Each level is hashed through the multi-buffer
+ * manager. leaves is overwritten.
+ */
+static int tree_reduce(uint8_t (*leaves)[SHA256_90R_DIGEST_SIZE], size_t n, uint8_t hash[SHA256_90R_DIGEST_SIZE]) {
+    sha256_90r_job_t* jobs;
+    uint8_t pair[2 * SHA256_90R_DIGEST_SIZE];
+
+    if (n == 1) {
+        memcpy(hash, leaves[0], SHA256_90R_DIGEST_SIZE);
+        return 0;
+    }
+    jobs = calloc((n + 1) / 2, sizeof(*jobs));
+    if (!jobs) return -1;
+
+    while (n > 1) {
+        size_t parents = (n + 1) / 2;
+        for (size_t i = 0; i < parents; i++) {
+            if (2 * i + 1 < n) {
+                jobs[i].data = leaves[2 * i];
+            } else {
+                memcpy(pair, leaves[2 * i], SHA256_90R_DIGEST_SIZE);
+                memcpy(pair + SHA256_90R_DIGEST_SIZE, leaves[2 * i], SHA256_90R_DIGEST_SIZE);
+                jobs[i].data = pair;
+            }
+            jobs[i].len = 2 * SHA256_90R_DIGEST_SIZE;
+            jobs[i].user_data = jobs[i].digest;     // Copied down once the level is done
+        }
+        par_hash_local(jobs, parents);
+        for (size_t i = 0; i < parents; i++) {
+            memcpy(leaves[i], jobs[i].digest, SHA256_90R_DIGEST_SIZE);
+        }
+        n = parents;
+    }
+    memcpy(hash, leaves[0], SHA256_90R_DIGEST_SIZE);
+    free(jobs);
+    return 0;
+}
+
+/*************************** PUBLIC API ***************************/
+
+int sha256_90r_numa_node_count(void)
+{
+    return par_topology()->nodes;
+}
+
+int sha256_90r_numa_node_of(const void* addr)
+{
+    int node;
+    if (!addr) return -1;
+    if (par_topology()->nodes == 1) return 0;
+    par_query_nodes(&addr, 1, &node);
+    return node;
+}
+
+int sha256_90r_numa_bind_thread(int node)
+{
+    return par_bind_node(node);
+}
+
+int sha256_90r_tree_hash(const uint8_t* data, size_t len, size_t chunk_size, int num_threads,
+                         uint8_t hash[SHA256_90R_DIGEST_SIZE], sha256_90r_par_stats_t* stats)
+{
+    uint8_t (*leaves)[SHA256_90R_DIGEST_SIZE];
+    sha256_90r_job_t* jobs;
+    size_t n;
+    int rc = -1;
+
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!hash || (!data && len > 0)) return -1;
+    if (chunk_size == 0) chunk_size = SHA256_90R_TREE_DEFAULT_CHUNK;
+    if (chunk_size == SHA256_90R_TREE_CHUNK_TUNED) chunk_size = sha256_90r_tune_chunk_size();
+    if (len <= chunk_size) {
+        sha256_90r_hash(data, len, hash);
+        return 0;
+    }
+
+    n = (len + chunk_size - 1) / chunk_size;
+    leaves = malloc(n * SHA256_90R_DIGEST_SIZE);
+    jobs = calloc(n, sizeof(*jobs));
+    if (leaves && jobs) {
+        for (size_t i = 0; i < n; i++) {
+            jobs[i].data = data + i * chunk_size;
+            jobs[i].len = i + 1 < n ? chunk_size : len - i * chunk_size;
+            jobs[i].user_data = leaves[i];
+        }
+        if (par_run(jobs, n, num_threads, stats) == 0) rc = tree_reduce(leaves, n, hash);
+    }
+    free(leaves);
+    free(jobs);
+    return rc;
+}
+
+int sha256_90r_batch_parallel(const uint8_t* const* messages, const size_t* lengths,
+                              uint8_t (*hashes)[SHA256_90R_DIGEST_SIZE], size_t count, int num_threads,
+                              sha256_90r_par_stats_t* stats)
+{
+    sha256_90r_job_t* jobs;
+    int rc;
+
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (count == 0) return 0;
+    if (!messages || !lengths || !hashes) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if (!messages[i] && lengths[i] > 0) return -1;
+    }
+
+    jobs = calloc(count, sizeof(*jobs));
+    if (!jobs) return -1;
+    for (size_t i = 0; i < count; i++) {
+        jobs[i].data = messages[i];
+        jobs[i].len = lengths[i];
+        jobs[i].user_data = hashes[i];
+    }
+    rc = par_run(jobs, count, num_threads, stats);
+    free(jobs);
+    return rc;
+}
+
+/*************************** STREAMING TREE ***************************/
+
+struct sha256_90r_tree_ctx {
+    size_t chunk_size;
+    size_t chunk_fill;                          // Bytes of the current chunk seen
+    struct sha256_90r_internal_ctx chunk;
+    uint8_t (*leaves)[SHA256_90R_DIGEST_SIZE];
+    size_t num_leaves;
+    size_t cap_leaves;
+};
+
+static int tree_push_leaf(sha256_90r_tree_ctx_t* ctx) {
+    if (ctx->num_leaves == ctx->cap_leaves) {
+        size_t cap = ctx->cap_leaves ? 2 * ctx->cap_leaves : 64;
+        void* grown = realloc(ctx->leaves, cap * SHA256_90R_DIGEST_SIZE);
+        if (!grown) return -1;
+        ctx->leaves = grown;
+        ctx->cap_leaves = cap;
+    }
+    sha256_90r_final_internal(&ctx->chunk, ctx->leaves[ctx->num_leaves++]);
+    sha256_90r_init_internal(&ctx->chunk);
+    ctx->chunk_fill = 0;
+    return 0;
+}
+
+sha256_90r_tree_ctx_t* sha256_90r_tree_hash_new(size_t chunk_size)
+{
+    sha256_90r_tree_ctx_t* ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) return NULL;
+    ctx->chunk_size = chunk_size == SHA256_90R_TREE_CHUNK_TUNED ? sha256_90r_tune_chunk_size()
+                    : chunk_size ? chunk_size : SHA256_90R_TREE_DEFAULT_CHUNK;
+    sha256_90r_init_internal(&ctx->chunk);
+    return ctx;
+}
+
+int sha256_90r_tree_hash_update(sha256_90r_tree_ctx_t* ctx, const uint8_t* data, size_t len)
+{
+    if (!ctx || (!data && len > 0)) return -1;
+    while (len > 0) {
+        size_t take = ctx->chunk_size - ctx->chunk_fill;
+        // A full chunk is only closed once more data follows, so the last
+        // chunk of the input is never mistaken for an empty one
+        if (take == 0) {
+            if (tree_push_leaf(ctx) != 0) return -1;
+            take = ctx->chunk_size;
+        }
+        if (take > len) take = len;
+        sha256_90r_update_internal(&ctx->chunk, data, take);
+        ctx->chunk_fill += take;
+        data += take;
+        len -= take;
+    }
+    return 0;
+}
+
+int sha256_90r_tree_hash_final(sha256_90r_tree_ctx_t* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE])
+{
+    int rc;
+
+    if (!ctx || !hash) return -1;
+    if (tree_push_leaf(ctx) != 0) return -1;
+    rc = tree_reduce(ctx->leaves, ctx->num_leaves, hash);
+    ctx->num_leaves = 0;
+    return rc;
+}
+
+void sha256_90r_tree_hash_free(sha256_90r_tree_ctx_t* ctx)
+{
+    if (!ctx) return;
+    free(ctx->leaves);
+    free(ctx);
+}
+
+/*************************** INCREMENTAL TREE ***************************/
+
+/* The tree of sha256_90r_tree_hash kept level by level over a registered
+ * buffer. Writers mark the chunks they touch in a bitmap; the root call
+ * takes the marked leaves, hashes them on the worker pool and then only the
+ * parents on their paths, one level at a time through the multi-buffer
+ * manager. */
+struct sha256_90r_itree {
+    const uint8_t* data;
+    size_t len;
+    size_t chunk_size;
+    int num_threads;
+    size_t leaves;
+    int depth;                                  // Levels, leaves included
+    size_t* level_off;                          // First node of each level
+    size_t* level_len;
+    uint8_t (*nodes)[SHA256_90R_DIGEST_SIZE];   // Leaves, then each level up
+    uint64_t* dirty;                            // One bit per leaf
+};
+
+static size_t itree_chunk_len(const sha256_90r_itree_t* t, size_t leaf) {
+    size_t off = leaf * t->chunk_size;
+    return t->len - off < t->chunk_size ? t->len - off : t->chunk_size;
+}
+
+// Dirty leaves in ascending order; their bits are cleared as they are taken
+static size_t itree_take_dirty(sha256_90r_itree_t* t, size_t* idx) {
+    size_t count = 0;
+    for (size_t w = 0; w < (t->leaves + 63) / 64; w++) {
+        uint64_t bits;
+        if (!__atomic_load_n(&t->dirty[w], __ATOMIC_RELAXED)) continue;
+        bits = __atomic_exchange_n(&t->dirty[w], 0, __ATOMIC_ACQUIRE);
+        while (bits) {
+            idx[count++] = w * 64 + (size_t)__builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+    }
+    return count;
+}
+
+// Put taken leaves back so a failed rebuild is retried by the next call
+static void itree_remark(sha256_90r_itree_t* t, const size_t* idx, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        __atomic_fetch_or(&t->dirty[idx[i] / 64], 1ULL << (idx[i] % 64), __ATOMIC_RELEASE);
+    }
+}
+
+// Below the batch threshold a lone lane would drain through the generic
+// transform; the one-shot hash takes the fastest single-stream kernel
+static void itree_hash_jobs(sha256_90r_job_t* jobs, size_t count) {
+    if (count >= sha256_90r_tune_batch_min()) {
+        par_hash_local(jobs, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) sha256_90r_hash(jobs[i].data, jobs[i].len, jobs[i].user_data);
+}
+
+// Rehash the given leaves (ascending) and every ancestor on their paths
+static int itree_rebuild(sha256_90r_itree_t* t, const size_t* leaves, size_t count, sha256_90r_par_stats_t* stats) {
+    sha256_90r_job_t* jobs = calloc(count, sizeof(*jobs));
+    size_t* idx = malloc(count * sizeof(*idx));
+    uint8_t pair[2 * SHA256_90R_DIGEST_SIZE];
+    uint64_t bytes = 0;
+    int threads;
+
+    if (!jobs || !idx) goto fail;
+    for (size_t i = 0; i < count; i++) {
+        idx[i] = leaves[i];
+        jobs[i].data = t->data + idx[i] * t->chunk_size;
+        jobs[i].len = itree_chunk_len(t, idx[i]);
+        jobs[i].user_data = t->nodes[idx[i]];
+        bytes += jobs[i].len;
+    }
+    // A few dirty chunks on one thread skip the pool
+    threads = t->num_threads > 0 ? t->num_threads : sha256_90r_tune_threads((size_t)bytes);
+    if (threads == 1 && count < sha256_90r_tune_batch_min()) {
+        double start = par_now();
+        itree_hash_jobs(jobs, count);
+        if (stats) {
+            stats->seconds = par_now() - start;
+            stats->nodes = 1;
+            stats->threads = 1;
+            stats->node_threads[0] = 1;
+            stats->node_bytes[0] = bytes;
+        }
+    } else if (par_run(jobs, count, threads, stats) != 0) {
+        goto fail;
+    }
+
+    for (int l = 0; l + 1 < t->depth; l++) {
+        uint8_t (*level)[SHA256_90R_DIGEST_SIZE] = t->nodes + t->level_off[l];
+        uint8_t (*up)[SHA256_90R_DIGEST_SIZE] = t->nodes + t->level_off[l + 1];
+        size_t n = t->level_len[l], parents = 0;
+
+        // idx is ascending, so the parents come out ascending with repeats adjacent
+        for (size_t i = 0; i < count; i++) {
+            if (parents == 0 || idx[parents - 1] != idx[i] / 2) idx[parents++] = idx[i] / 2;
+        }
+        for (size_t i = 0; i < parents; i++) {
+            size_t p = idx[i];
+            if (2 * p + 1 < n) {
+                jobs[i].data = level[2 * p];
+            } else {
+                memcpy(pair, level[2 * p], SHA256_90R_DIGEST_SIZE);
+                memcpy(pair + SHA256_90R_DIGEST_SIZE, level[2 * p], SHA256_90R_DIGEST_SIZE);
+                jobs[i].data = pair;
+            }
+            jobs[i].len = 2 * SHA256_90R_DIGEST_SIZE;
+            jobs[i].user_data = up[p];
+        }
+        itree_hash_jobs(jobs, parents);
+        count = parents;
+    }
+    free(jobs);
+    free(idx);
+    return 0;
+
+fail:
+    free(jobs);
+    free(idx);
+    return -1;
+}
+
+sha256_90r_itree_t* sha256_90r_itree_new(const uint8_t* data, size_t len, size_t chunk_size, int num_threads)
+{
+    sha256_90r_itree_t* t;
+    size_t total = 0;
+
+    if (!data && len > 0) return NULL;
+    t = calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    t->data = data;
+    t->len = len;
+    t->chunk_size = chunk_size == SHA256_90R_TREE_CHUNK_TUNED ? sha256_90r_tune_chunk_size()
+                  : chunk_size ? chunk_size : SHA256_90R_TREE_DEFAULT_CHUNK;
+    t->num_threads = num_threads;
+    // Input of at most one chunk is one leaf: its plain digest is the root
+    t->leaves = len <= t->chunk_size ? 1 : (len + t->chunk_size - 1) / t->chunk_size;
+
+    for (size_t n = t->leaves; ; n = (n + 1) / 2) {
+        t->depth++;
+        if (n == 1) break;
+    }
+    t->level_off = malloc((size_t)t->depth * sizeof(*t->level_off));
+    t->level_len = malloc((size_t)t->depth * sizeof(*t->level_len));
+    t->dirty = calloc((t->leaves + 63) / 64, sizeof(*t->dirty));
+    if (!t->level_off || !t->level_len || !t->dirty) goto fail;
+    for (int l = 0; l < t->depth; l++) {
+        t->level_off[l] = total;
+        t->level_len[l] = l == 0 ? t->leaves : (t->level_len[l - 1] + 1) / 2;
+        total += t->level_len[l];
+    }
+    t->nodes = malloc(total * SHA256_90R_DIGEST_SIZE);
+    if (!t->nodes) goto fail;
+
+    // The first root call builds the whole tree
+    if (sha256_90r_itree_mark_dirty(t, 0, len) != 0) goto fail;
+    if (len == 0) t->dirty[0] = 1;
+    return t;
+
+fail:
+    sha256_90r_itree_free(t);
+    return NULL;
+}
+
+int sha256_90r_itree_mark_dirty(sha256_90r_itree_t* t, size_t off, size_t len)
+{
+    size_t first, last;
+
+    if (!t || off > t->len || len > t->len - off) return -1;
+    if (len == 0) return 0;
+    first = off / t->chunk_size;
+    last = (off + len - 1) / t->chunk_size;
+    if (last >= t->leaves) last = t->leaves - 1;
+    // Whole words at once for large ranges
+    while (first <= last) {
+        size_t w = first / 64;
+        unsigned lo = (unsigned)(first % 64);
+        unsigned hi = last / 64 == w ? (unsigned)(last % 64) : 63;
+        uint64_t bits = (hi == 63 ? ~0ULL : (2ULL << hi) - 1) & ~((1ULL << lo) - 1);
+        __atomic_fetch_or(&t->dirty[w], bits, __ATOMIC_RELEASE);
+        first = w * 64 + hi + 1;
+    }
+    return 0;
+}
+
+size_t sha256_90r_itree_dirty_chunks(const sha256_90r_itree_t* t)
+{
+    size_t count = 0;
+    if (!t) return 0;
+    for (size_t w = 0; w < (t->leaves + 63) / 64; w++) {
+        count += (size_t)__builtin_popcountll(__atomic_load_n(&t->dirty[w], __ATOMIC_RELAXED));
+    }
+    return count;
+}
+
+int sha256_90r_itree_root(sha256_90r_itree_t* t, uint8_t hash[SHA256_90R_DIGEST_SIZE],
+                          sha256_90r_par_stats_t* stats)
+{
+    size_t* idx;
+    size_t count;
+
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!t || !hash) return -1;
+    idx = malloc(t->leaves * sizeof(*idx));
+    if (!idx) return -1;
+    count = itree_take_dirty(t, idx);
+    if (count > 0 && itree_rebuild(t, idx, count, stats) != 0) {
+        itree_remark(t, idx, count);
+        free(idx);
+        return -1;
+    }
+    memcpy(hash, t->nodes[t->level_off[t->depth - 1]], SHA256_90R_DIGEST_SIZE);
+    free(idx);
+    return 0;
+}
+
+void sha256_90r_itree_free(sha256_90r_itree_t* t)
+{
+    if (!t) return;
+    free(t->level_off);
+    free(t->level_len);
+    free(t->nodes);
+    free(t->dirty);
+    free(t);
+}
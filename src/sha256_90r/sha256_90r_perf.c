@@ -0,0 +1,252 @@
+/*********************************************************************
+* Filename:   sha256_90r_perf.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    In-process hardware performance counters (Linux
+*             perf_event_open) for benchmarks and tests. Counters follow
+*             the calling thread, count user space only, and are read as
+*             groups so ratios such as IPC come from one time slice.
+*             The uops event is a raw, vendor-specific encoding:
+*             Intel 0xB1/0x01 (UOPS_DISPATCHED.THREAD on Sandy Bridge,
+*             UOPS_EXECUTED.THREAD later), AMD 0xC1 (retired ops). Set
+*             SHA256_90R_PMC_UOPS=<hex config> to use another encoding.
+*             Store-forwarding blocks are Intel 0x03/0x02
+*             (LD_BLOCKS.STORE_FORWARD) and AMD 0x24/0x02 (store-to-load
+*             forward failures); override with SHA256_90R_PMC_STORE_FWD.
+*********************************************************************/
+
+#define _GNU_SOURCE
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+/****************************** MACROS ******************************/
+#define PMC_GROUP_CORE  0   // cycles, instructions, branch-misses, uops
+#define PMC_GROUP_CACHE 1   // L1D misses, LLC misses, store-forward blocks
+#define PMC_GROUP_SW    2   // task clock
+#define PMC_GROUPS      3
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static const char* const pmc_names[SHA256_90R_PMC_COUNT] = {
+    "cycles", "instructions", "branch-misses", "uops",
+    "l1d-misses", "llc-misses", "store-fwd-blocks", "task-clock-ns"
+};
+
+static int pmc_group(sha256_90r_pmc_event_t event) {
+    switch (event) {
+        case SHA256_90R_PMC_L1D_MISSES:
+        case SHA256_90R_PMC_LLC_MISSES:
+        case SHA256_90R_PMC_STORE_FWD: return PMC_GROUP_CACHE;
+        case SHA256_90R_PMC_TASK_CLOCK: return PMC_GROUP_SW;
+        default: return PMC_GROUP_CORE;
+    }
+}
+
+const char* sha256_90r_pmc_event_name(sha256_90r_pmc_event_t event) {
+    if (event < 0 || event >= SHA256_90R_PMC_COUNT) return "unknown";
+    return pmc_names[event];
+}
+
+#ifdef __linux__
+// Raw encoding of a vendor-specific event, or the hex config in env; 0 when unknown
+static uint64_t pmc_raw_config(const char* env_name, uint64_t intel, uint64_t amd) {
+    const char* env = getenv(env_name);
+    if (env && *env) {
+        return strtoull(env, NULL, 16);
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    char vendor[13];
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) return 0;
+    memcpy(vendor, &ebx, 4);
+    memcpy(vendor + 4, &edx, 4);
+    memcpy(vendor + 8, &ecx, 4);
+    vendor[12] = '\0';
+    if (strcmp(vendor, "GenuineIntel") == 0) return intel;
+    if (strcmp(vendor, "AuthenticAMD") == 0 || strcmp(vendor, "HygonGenuine") == 0) return amd;
+#else
+    (void)intel;
+    (void)amd;
+#endif
+    return 0;
+}
+
+static int pmc_attr(sha256_90r_pmc_event_t event, struct perf_event_attr* attr) {
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->type = PERF_TYPE_HARDWARE;
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (event) {
+        case SHA256_90R_PMC_CYCLES:
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case SHA256_90R_PMC_INSTRUCTIONS:
+            attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case SHA256_90R_PMC_BRANCH_MISSES:
+            attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case SHA256_90R_PMC_UOPS:
+            attr->type = PERF_TYPE_RAW;
+            attr->config = pmc_raw_config("SHA256_90R_PMC_UOPS", 0x01B1, 0x00C1);
+            if (attr->config == 0) return -1;
+            break;
+        case SHA256_90R_PMC_L1D_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = PERF_COUNT_HW_CACHE_L1D |
+                           (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case SHA256_90R_PMC_LLC_MISSES:
+            attr->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case SHA256_90R_PMC_STORE_FWD:
+            attr->type = PERF_TYPE_RAW;
+            attr->config = pmc_raw_config("SHA256_90R_PMC_STORE_FWD", 0x0203, 0x0224);
+            if (attr->config == 0) return -1;
+            break;
+        case SHA256_90R_PMC_TASK_CLOCK:
+            attr->type = PERF_TYPE_SOFTWARE;
+            attr->config = PERF_COUNT_SW_TASK_CLOCK;
+            break;
+        default:
+            return -1;
+    }
+    return 0;
+}
+
+int sha256_90r_pmc_open(sha256_90r_pmc_t* pmc) {
+    int opened = 0;
+
+    if (!pmc) return 0;
+    memset(pmc, 0, sizeof(*pmc));
+    for (int e = 0; e < SHA256_90R_PMC_COUNT; e++) pmc->fds[e] = -1;
+    for (int g = 0; g < PMC_GROUPS; g++) pmc->leaders[g] = -1;
+
+    // Open in enum order: the first event that opens in a group leads it,
+    // and group reads return values in this same order
+    for (int e = 0; e < SHA256_90R_PMC_COUNT; e++) {
+        struct perf_event_attr attr;
+        int g = pmc_group((sha256_90r_pmc_event_t)e);
+        if (pmc_attr((sha256_90r_pmc_event_t)e, &attr) != 0) continue;
+        attr.disabled = pmc->leaders[g] < 0;
+        long fd = syscall(__NR_perf_event_open, &attr, 0, -1, pmc->leaders[g], 0);
+        if (fd < 0) continue;
+        pmc->fds[e] = (int)fd;
+        if (pmc->leaders[g] < 0) pmc->leaders[g] = (int)fd;
+        opened++;
+    }
+    return opened;
+}
+
+void sha256_90r_pmc_close(sha256_90r_pmc_t* pmc) {
+    if (!pmc) return;
+    for (int e = 0; e < SHA256_90R_PMC_COUNT; e++) {
+        if (pmc->fds[e] >= 0) close(pmc->fds[e]);
+        pmc->fds[e] = -1;
+    }
+    for (int g = 0; g < PMC_GROUPS; g++) pmc->leaders[g] = -1;
+}
+
+int sha256_90r_pmc_start(sha256_90r_pmc_t* pmc) {
+    int any = 0;
+
+    if (!pmc) return -1;
+    memset(pmc->counts, 0, sizeof(pmc->counts));
+    memset(pmc->valid, 0, sizeof(pmc->valid));
+    for (int g = 0; g < PMC_GROUPS; g++) {
+        if (pmc->leaders[g] < 0) continue;
+        ioctl(pmc->leaders[g], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        any = 1;
+    }
+    // Enable last so resets are not counted in the other groups
+    for (int g = 0; g < PMC_GROUPS; g++) {
+        if (pmc->leaders[g] >= 0) ioctl(pmc->leaders[g], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    return any ? 0 : -1;
+}
+
+int sha256_90r_pmc_stop(sha256_90r_pmc_t* pmc) {
+    // nr, time_enabled, time_running, values[nr]
+    uint64_t buf[3 + SHA256_90R_PMC_COUNT];
+    int any = 0;
+
+    if (!pmc) return -1;
+    for (int g = 0; g < PMC_GROUPS; g++) {
+        if (pmc->leaders[g] >= 0) ioctl(pmc->leaders[g], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    for (int g = 0; g < PMC_GROUPS; g++) {
+        if (pmc->leaders[g] < 0) continue;
+        ssize_t n = read(pmc->leaders[g], buf, sizeof(buf));
+        if (n < (ssize_t)(3 * sizeof(uint64_t)) || buf[2] == 0) continue; // never scheduled
+
+        // Scale up when the kernel multiplexed this group
+        double scale = (double)buf[1] / (double)buf[2];
+        uint64_t idx = 0;
+        for (int e = 0; e < SHA256_90R_PMC_COUNT && idx < buf[0]; e++) {
+            if (pmc->fds[e] < 0 || pmc_group((sha256_90r_pmc_event_t)e) != g) continue;
+            pmc->counts[e] = (uint64_t)((double)buf[3 + idx] * scale + 0.5);
+            pmc->valid[e] = 1;
+            idx++;
+        }
+        any = 1;
+    }
+    return any ? 0 : -1;
+}
+#else
+int sha256_90r_pmc_open(sha256_90r_pmc_t* pmc) {
+    if (pmc) {
+        memset(pmc, 0, sizeof(*pmc));
+        for (int e = 0; e < SHA256_90R_PMC_COUNT; e++) pmc->fds[e] = -1;
+        for (int g = 0; g < PMC_GROUPS; g++) pmc->leaders[g] = -1;
+    }
+    return 0;
+}
+
+void sha256_90r_pmc_close(sha256_90r_pmc_t* pmc) {
+    (void)pmc;
+}
+
+int sha256_90r_pmc_start(sha256_90r_pmc_t* pmc) {
+    (void)pmc;
+    return -1;
+}
+
+int sha256_90r_pmc_stop(sha256_90r_pmc_t* pmc) {
+    (void)pmc;
+    return -1;
+}
+#endif
+
+double sha256_90r_pmc_ipc(const sha256_90r_pmc_t* pmc) {
+    if (!pmc || !pmc->valid[SHA256_90R_PMC_CYCLES] || !pmc->valid[SHA256_90R_PMC_INSTRUCTIONS] ||
+        pmc->counts[SHA256_90R_PMC_CYCLES] == 0) {
+        return -1.0;
+    }
+    return (double)pmc->counts[SHA256_90R_PMC_INSTRUCTIONS] / (double)pmc->counts[SHA256_90R_PMC_CYCLES];
+}
+
+double sha256_90r_pmc_per_kb(const sha256_90r_pmc_t* pmc, sha256_90r_pmc_event_t event, double bytes) {
+    if (!pmc || event < 0 || event >= SHA256_90R_PMC_COUNT || !pmc->valid[event] || bytes <= 0.0) {
+        return -1.0;
+    }
+    return (double)pmc->counts[event] / (bytes / 1024.0);
+}
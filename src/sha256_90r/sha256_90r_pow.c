@@ -0,0 +1,542 @@
+/*********************************************************************
+* Filename:   sha256_90r_pow.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Batched nonce search for proof-of-work over a fixed
+*             midstate. Only the final block changes between attempts, and
+*             in it only the one to three words holding the nonce, so the
+*             rounds before the first nonce word, the schedule words that
+*             do not depend on it and the constant halves of the others
+*             are computed once per job. 8 (AVX2) or 16 (AVX-512) lanes
+*             take consecutive nonces; the first digest word is compared
+*             against the target inside the vector registers and only
+*             candidate lanes are checked in full.
+*********************************************************************/
+
+#define _GNU_SOURCE
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define POW_HAVE_X86 1
+#endif
+
+/****************************** MACROS ******************************/
+#define POW_ROUNDS 90
+#define POW_CHUNK 65536             // Nonces a worker claims at a time
+#define POW_MAX_THREADS 256
+
+// Schedule term flags: which inputs of W[t] depend on the nonce
+#define POW_VARY_W2  0x1            // SIG1(W[t-2])
+#define POW_VARY_W7  0x2            // W[t-7]
+#define POW_VARY_W15 0x4            // SIG0(W[t-15])
+#define POW_VARY_W16 0x8            // W[t-16]
+#define POW_VARY_MSG 0x10           // t < 16: this message word holds nonce bytes
+
+/**************************** DATA TYPES ****************************/
+// Per-job precomputation shared by every worker and kernel
+typedef struct {
+    uint32_t midstate[8];
+    uint32_t after[8];              // State after round `first` (t1/t2 below pending)
+    uint32_t t1_pre;                // Round `first` t1 without W[first]
+    uint32_t t2_pre;                // Round `first` t2
+    int first;                      // First message word containing nonce bytes
+    int last;                       // Last message word containing nonce bytes
+    uint32_t wconst[POW_ROUNDS];    // Constant W[t], or the constant part of W[t]
+    uint8_t vary[POW_ROUNDS];       // POW_VARY_* flags
+    uint8_t tail[64];
+    int nonce_offset;
+    int nonce_size;
+    uint32_t target0;               // First target word (big-endian)
+    uint8_t target[32];
+} pow_plan_t;
+
+typedef struct {
+    const pow_plan_t *plan;
+    uint64_t start;
+    uint64_t count;
+    int lanes;
+    volatile uint64_t *next_chunk;  // Shared chunk counter
+    volatile uint64_t *best;        // Lowest hit so far (offset from start), UINT64_MAX if none
+    uint64_t hashes;
+} pow_worker_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static inline uint32_t load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Message words first..last of the tail with `nonce` written little-endian
+static inline void pow_nonce_words(const pow_plan_t *plan, uint64_t nonce, uint32_t out[3]) {
+    uint8_t buf[12];
+    int base = plan->first * 4;
+
+    memcpy(buf, plan->tail + base, (size_t)(plan->last - plan->first + 1) * 4);
+    for (int i = 0; i < plan->nonce_size; i++) {
+        buf[plan->nonce_offset - base + i] = (uint8_t)(nonce >> (8 * i));
+    }
+    for (int w = 0; w <= plan->last - plan->first; w++) {
+        out[w] = load_be32(buf + 4 * w);
+    }
+}
+
+static void pow_plan_build(pow_plan_t *plan) {
+    uint32_t a, b, c, d, e, f, g, h;
+    int varies[POW_ROUNDS];
+
+    plan->first = plan->nonce_offset / 4;
+    plan->last = (plan->nonce_offset + plan->nonce_size - 1) / 4;
+
+    for (int t = 0; t < 16; t++) {
+        varies[t] = t >= plan->first && t <= plan->last;
+        plan->vary[t] = varies[t] ? POW_VARY_MSG : 0;
+        plan->wconst[t] = load_be32(plan->tail + 4 * t);
+    }
+    // Split W[t] into the sum of its constant terms and the nonce-dependent rest
+    for (int t = 16; t < POW_ROUNDS; t++) {
+        uint32_t sum = 0;
+        uint8_t flags = 0;
+        if (varies[t - 2]) flags |= POW_VARY_W2; else sum += SIG1(plan->wconst[t - 2]);
+        if (varies[t - 7]) flags |= POW_VARY_W7; else sum += plan->wconst[t - 7];
+        if (varies[t - 15]) flags |= POW_VARY_W15; else sum += SIG0(plan->wconst[t - 15]);
+        if (varies[t - 16]) flags |= POW_VARY_W16; else sum += plan->wconst[t - 16];
+        plan->wconst[t] = sum;
+        plan->vary[t] = flags;
+        varies[t] = flags != 0;
+    }
+
+    // Rounds before the first nonce word are the same for every attempt
+    a = plan->midstate[0]; b = plan->midstate[1]; c = plan->midstate[2]; d = plan->midstate[3];
+    e = plan->midstate[4]; f = plan->midstate[5]; g = plan->midstate[6]; h = plan->midstate[7];
+    for (int t = 0; t < plan->first; t++) {
+        uint32_t t1 = h + EP1(e) + CH(e, f, g) + k_90r[t] + plan->wconst[t];
+        uint32_t t2 = EP0(a) + MAJ(a, b, c);
+        h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+    }
+    // ...and so is everything in round `first` except the W term
+    plan->t1_pre = h + EP1(e) + CH(e, f, g) + k_90r[plan->first];
+    plan->t2_pre = EP0(a) + MAJ(a, b, c);
+    plan->after[0] = a; plan->after[1] = b; plan->after[2] = c; plan->after[3] = d;
+    plan->after[4] = e; plan->after[5] = f; plan->after[6] = g; plan->after[7] = h;
+    plan->target0 = load_be32(plan->target);
+}
+
+// Full digest <= target check, both big-endian 256-bit numbers
+static int pow_meets_target(const pow_plan_t *plan, const uint32_t state[8]) {
+    for (int i = 0; i < 8; i++) {
+        uint32_t t = load_be32(plan->target + 4 * i);
+        if (state[i] != t) return state[i] < t;
+    }
+    return 1;
+}
+
+/*************************** KERNELS ***************************/
+
+// One nonce; the reference the vector kernels are tested against
+static void pow_hash_scalar(const pow_plan_t *plan, uint64_t nonce, uint32_t out[8]) {
+    uint32_t w[POW_ROUNDS], nw[3];
+    uint32_t a, b, c, d, e, f, g, h, t1;
+
+    pow_nonce_words(plan, nonce, nw);
+    for (int t = 0; t < 16; t++) {
+        w[t] = (plan->vary[t] & POW_VARY_MSG) ? nw[t - plan->first] : plan->wconst[t];
+    }
+    for (int t = 16; t < POW_ROUNDS; t++) {
+        uint32_t v = plan->wconst[t];
+        if (plan->vary[t] & POW_VARY_W2) v += SIG1(w[t - 2]);
+        if (plan->vary[t] & POW_VARY_W7) v += w[t - 7];
+        if (plan->vary[t] & POW_VARY_W15) v += SIG0(w[t - 15]);
+        if (plan->vary[t] & POW_VARY_W16) v += w[t - 16];
+        w[t] = v;
+    }
+
+    a = plan->after[0]; b = plan->after[1]; c = plan->after[2]; d = plan->after[3];
+    e = plan->after[4]; f = plan->after[5]; g = plan->after[6]; h = plan->after[7];
+    t1 = plan->t1_pre + w[plan->first];
+    h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + plan->t2_pre;
+    for (int t = plan->first + 1; t < POW_ROUNDS; t++) {
+        uint32_t t2;
+        t1 = h + EP1(e) + CH(e, f, g) + k_90r[t] + w[t];
+        t2 = EP0(a) + MAJ(a, b, c);
+        h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    out[0] = plan->midstate[0] + a; out[1] = plan->midstate[1] + b;
+    out[2] = plan->midstate[2] + c; out[3] = plan->midstate[3] + d;
+    out[4] = plan->midstate[4] + e; out[5] = plan->midstate[5] + f;
+    out[6] = plan->midstate[6] + g; out[7] = plan->midstate[7] + h;
+}
+
+#ifdef POW_HAVE_X86
+// Eight consecutive nonces. Returns a bitmask of lanes whose first digest word
+// is <= the first target word; states[word][lane] holds every lane's digest.
+__attribute__((target("avx2")))
+static unsigned pow_hash_avx2_8way(const pow_plan_t *plan, uint64_t nonce, uint32_t states[8][8]) {
+    const __m256i sign = _mm256_set1_epi32((int)0x80000000);
+    __m256i w[POW_ROUNDS];
+    __m256i a, b, c, d, e, f, g, h, t1, t2;
+    uint32_t nw[3][8];
+
+    for (int l = 0; l < 8; l++) {
+        uint32_t words[3];
+        pow_nonce_words(plan, nonce + (uint64_t)l, words);
+        for (int j = 0; j <= plan->last - plan->first; j++) nw[j][l] = words[j];
+    }
+    for (int t = 0; t < 16; t++) {
+        w[t] = (plan->vary[t] & POW_VARY_MSG) ? _mm256_loadu_si256((const __m256i *)nw[t - plan->first])
+                                              : _mm256_set1_epi32((int)plan->wconst[t]);
+    }
+    for (int t = 16; t < POW_ROUNDS; t++) {
+        __m256i v = _mm256_set1_epi32((int)plan->wconst[t]);
+        uint8_t flags = plan->vary[t];
+        if (flags & POW_VARY_W2) v = _mm256_add_epi32(v, MM256_90R_SIG1(w[t - 2]));
+        if (flags & POW_VARY_W7) v = _mm256_add_epi32(v, w[t - 7]);
+        if (flags & POW_VARY_W15) v = _mm256_add_epi32(v, MM256_90R_SIG0(w[t - 15]));
+        if (flags & POW_VARY_W16) v = _mm256_add_epi32(v, w[t - 16]);
+        w[t] = v;
+    }
+
+    // Round `first` from the shared precomputation
+    t1 = _mm256_add_epi32(_mm256_set1_epi32((int)plan->t1_pre), w[plan->first]);
+    h = _mm256_set1_epi32((int)plan->after[6]);
+    g = _mm256_set1_epi32((int)plan->after[5]);
+    f = _mm256_set1_epi32((int)plan->after[4]);
+    e = _mm256_add_epi32(_mm256_set1_epi32((int)plan->after[3]), t1);
+    d = _mm256_set1_epi32((int)plan->after[2]);
+    c = _mm256_set1_epi32((int)plan->after[1]);
+    b = _mm256_set1_epi32((int)plan->after[0]);
+    a = _mm256_add_epi32(t1, _mm256_set1_epi32((int)plan->t2_pre));
+
+    for (int t = plan->first + 1; t < POW_ROUNDS; t++) {
+        t1 = _mm256_add_epi32(h, _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(e, 6), MM256_ROTR(e, 11)),
+                                                  MM256_ROTR(e, 25)));
+        t1 = _mm256_add_epi32(t1, _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g)));
+        t1 = _mm256_add_epi32(t1, _mm256_add_epi32(_mm256_set1_epi32((int)k_90r[t]), w[t]));
+        t2 = _mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(a, 2), MM256_ROTR(a, 13)),
+                                               MM256_ROTR(a, 22)),
+                              _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b))));
+        h = g; g = f; f = e; e = _mm256_add_epi32(d, t1); d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+    }
+
+    a = _mm256_add_epi32(a, _mm256_set1_epi32((int)plan->midstate[0]));
+    {
+        // Unsigned digest0 > target0 via the sign-flipped signed compare
+        __m256i gt = _mm256_cmpgt_epi32(_mm256_xor_si256(a, sign),
+                                        _mm256_set1_epi32((int)(plan->target0 ^ 0x80000000u)));
+        unsigned mask = (~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(gt))) & 0xFFu;
+        if (!mask) return 0;
+
+        _mm256_storeu_si256((__m256i *)states[0], a);
+        _mm256_storeu_si256((__m256i *)states[1], _mm256_add_epi32(b, _mm256_set1_epi32((int)plan->midstate[1])));
+        _mm256_storeu_si256((__m256i *)states[2], _mm256_add_epi32(c, _mm256_set1_epi32((int)plan->midstate[2])));
+        _mm256_storeu_si256((__m256i *)states[3], _mm256_add_epi32(d, _mm256_set1_epi32((int)plan->midstate[3])));
+        _mm256_storeu_si256((__m256i *)states[4], _mm256_add_epi32(e, _mm256_set1_epi32((int)plan->midstate[4])));
+        _mm256_storeu_si256((__m256i *)states[5], _mm256_add_epi32(f, _mm256_set1_epi32((int)plan->midstate[5])));
+        _mm256_storeu_si256((__m256i *)states[6], _mm256_add_epi32(g, _mm256_set1_epi32((int)plan->midstate[6])));
+        _mm256_storeu_si256((__m256i *)states[7], _mm256_add_epi32(h, _mm256_set1_epi32((int)plan->midstate[7])));
+        return mask;
+    }
+}
+
+// Sixteen consecutive nonces; native rotates and a compare-to-mask
+__attribute__((target("avx512f")))
+static unsigned pow_hash_avx512_16way(const pow_plan_t *plan, uint64_t nonce, uint32_t states[8][16]) {
+    __m512i w[POW_ROUNDS];
+    __m512i a, b, c, d, e, f, g, h, t1, t2;
+    uint32_t nw[3][16];
+    __mmask16 hit;
+
+    for (int l = 0; l < 16; l++) {
+        uint32_t words[3];
+        pow_nonce_words(plan, nonce + (uint64_t)l, words);
+        for (int j = 0; j <= plan->last - plan->first; j++) nw[j][l] = words[j];
+    }
+    for (int t = 0; t < 16; t++) {
+        w[t] = (plan->vary[t] & POW_VARY_MSG) ? _mm512_loadu_si512((const void *)nw[t - plan->first])
+                                              : _mm512_set1_epi32((int)plan->wconst[t]);
+    }
+    for (int t = 16; t < POW_ROUNDS; t++) {
+        __m512i v = _mm512_set1_epi32((int)plan->wconst[t]);
+        uint8_t flags = plan->vary[t];
+        if (flags & POW_VARY_W2) v = _mm512_add_epi32(v, MM512_90R_SIG1(w[t - 2]));
+        if (flags & POW_VARY_W7) v = _mm512_add_epi32(v, w[t - 7]);
+        if (flags & POW_VARY_W15) v = _mm512_add_epi32(v, MM512_90R_SIG0(w[t - 15]));
+        if (flags & POW_VARY_W16) v = _mm512_add_epi32(v, w[t - 16]);
+        w[t] = v;
+    }
+
+    t1 = _mm512_add_epi32(_mm512_set1_epi32((int)plan->t1_pre), w[plan->first]);
+    h = _mm512_set1_epi32((int)plan->after[6]);
+    g = _mm512_set1_epi32((int)plan->after[5]);
+    f = _mm512_set1_epi32((int)plan->after[4]);
+    e = _mm512_add_epi32(_mm512_set1_epi32((int)plan->after[3]), t1);
+    d = _mm512_set1_epi32((int)plan->after[2]);
+    c = _mm512_set1_epi32((int)plan->after[1]);
+    b = _mm512_set1_epi32((int)plan->after[0]);
+    a = _mm512_add_epi32(t1, _mm512_set1_epi32((int)plan->t2_pre));
+
+    for (int t = plan->first + 1; t < POW_ROUNDS; t++) {
+        // 0x96 = x ^ y ^ z, 0xCA = x ? y : z (CH), 0xE8 = majority
+        t1 = _mm512_add_epi32(h, _mm512_ternarylogic_epi32(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11),
+                                                           _mm512_ror_epi32(e, 25), 0x96));
+        t1 = _mm512_add_epi32(t1, _mm512_ternarylogic_epi32(e, f, g, 0xCA));
+        t1 = _mm512_add_epi32(t1, _mm512_add_epi32(_mm512_set1_epi32((int)k_90r[t]), w[t]));
+        t2 = _mm512_add_epi32(_mm512_ternarylogic_epi32(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13),
+                                                        _mm512_ror_epi32(a, 22), 0x96),
+                              _mm512_ternarylogic_epi32(a, b, c, 0xE8));
+        h = g; g = f; f = e; e = _mm512_add_epi32(d, t1); d = c; c = b; b = a; a = _mm512_add_epi32(t1, t2);
+    }
+
+    a = _mm512_add_epi32(a, _mm512_set1_epi32((int)plan->midstate[0]));
+    hit = _mm512_cmple_epu32_mask(a, _mm512_set1_epi32((int)plan->target0));
+    if (!hit) return 0;
+
+    _mm512_storeu_si512((void *)states[0], a);
+    _mm512_storeu_si512((void *)states[1], _mm512_add_epi32(b, _mm512_set1_epi32((int)plan->midstate[1])));
+    _mm512_storeu_si512((void *)states[2], _mm512_add_epi32(c, _mm512_set1_epi32((int)plan->midstate[2])));
+    _mm512_storeu_si512((void *)states[3], _mm512_add_epi32(d, _mm512_set1_epi32((int)plan->midstate[3])));
+    _mm512_storeu_si512((void *)states[4], _mm512_add_epi32(e, _mm512_set1_epi32((int)plan->midstate[4])));
+    _mm512_storeu_si512((void *)states[5], _mm512_add_epi32(f, _mm512_set1_epi32((int)plan->midstate[5])));
+    _mm512_storeu_si512((void *)states[6], _mm512_add_epi32(g, _mm512_set1_epi32((int)plan->midstate[6])));
+    _mm512_storeu_si512((void *)states[7], _mm512_add_epi32(h, _mm512_set1_epi32((int)plan->midstate[7])));
+    return (unsigned)hit;
+}
+#endif // POW_HAVE_X86
+
+static int pow_widest_lanes(void) {
+#ifdef POW_HAVE_X86
+    if (__builtin_cpu_supports("avx512f")) return 16;
+    if (__builtin_cpu_supports("avx2")) return 8;
+#endif
+    return 1;
+}
+
+static int pow_lanes_supported(int lanes) {
+    switch (lanes) {
+        case 1: return 1;
+#ifdef POW_HAVE_X86
+        case 8: return __builtin_cpu_supports("avx2");
+        case 16: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return 0;
+    }
+}
+
+// Atomically lower *best to value
+static void pow_record_hit(volatile uint64_t *best, uint64_t value) {
+    uint64_t cur = __atomic_load_n(best, __ATOMIC_RELAXED);
+    while (value < cur &&
+           !__atomic_compare_exchange_n(best, &cur, value, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Search [offset, offset + n) of the job range; stops at its first hit or
+// once a lower hit exists elsewhere
+static void pow_search_range(pow_worker_t *wk, uint64_t offset, uint64_t n) {
+    const pow_plan_t *plan = wk->plan;
+    uint64_t end = offset + n;
+    uint64_t i = offset;
+
+#ifdef POW_HAVE_X86
+    if (wk->lanes == 16) {
+        uint32_t states[8][16];
+        for (; i + 16 <= end; i += 16) {
+            unsigned mask;
+            if (__atomic_load_n(wk->best, __ATOMIC_RELAXED) < i) return;
+            mask = pow_hash_avx512_16way(plan, wk->start + i, states);
+            wk->hashes += 16;
+            for (int l = 0; mask; l++, mask >>= 1) {
+                uint32_t st[8];
+                if (!(mask & 1)) continue;
+                for (int j = 0; j < 8; j++) st[j] = states[j][l];
+                if (pow_meets_target(plan, st)) {
+                    pow_record_hit(wk->best, i + (uint64_t)l);
+                    return;
+                }
+            }
+        }
+    } else if (wk->lanes == 8) {
+        uint32_t states[8][8];
+        for (; i + 8 <= end; i += 8) {
+            unsigned mask;
+            if (__atomic_load_n(wk->best, __ATOMIC_RELAXED) < i) return;
+            mask = pow_hash_avx2_8way(plan, wk->start + i, states);
+            wk->hashes += 8;
+            for (int l = 0; mask; l++, mask >>= 1) {
+                uint32_t st[8];
+                if (!(mask & 1)) continue;
+                for (int j = 0; j < 8; j++) st[j] = states[j][l];
+                if (pow_meets_target(plan, st)) {
+                    pow_record_hit(wk->best, i + (uint64_t)l);
+                    return;
+                }
+            }
+        }
+    }
+#endif
+    // Scalar lanes, and the tail of the range that does not fill a vector
+    for (; i < end; i++) {
+        uint32_t st[8];
+        if (__atomic_load_n(wk->best, __ATOMIC_RELAXED) < i) return;
+        pow_hash_scalar(plan, wk->start + i, st);
+        wk->hashes++;
+        if (pow_meets_target(plan, st)) {
+            pow_record_hit(wk->best, i);
+            return;
+        }
+    }
+}
+
+static void *pow_worker_main(void *arg) {
+    pow_worker_t *wk = (pow_worker_t *)arg;
+    uint64_t chunks = (wk->count + POW_CHUNK - 1) / POW_CHUNK;
+
+    for (;;) {
+        uint64_t chunk = __atomic_fetch_add(wk->next_chunk, 1, __ATOMIC_RELAXED);
+        uint64_t offset = chunk * POW_CHUNK;
+        if (chunk >= chunks) break;
+        // Chunks are claimed in order, so nothing later can beat a known hit
+        if (__atomic_load_n(wk->best, __ATOMIC_RELAXED) < offset) break;
+        pow_search_range(wk, offset, wk->count - offset < POW_CHUNK ? wk->count - offset : POW_CHUNK);
+    }
+    return NULL;
+}
+
+/*************************** PUBLIC API ***************************/
+
+int sha256_90r_midstate(const uint8_t* data, size_t len, uint32_t midstate[8])
+{
+    struct sha256_90r_internal_ctx ctx;
+
+    if (!midstate || (len % 64) != 0 || (!data && len)) return -1;
+    sha256_90r_init_internal(&ctx);
+    for (size_t off = 0; off < len; off += 64) {
+        sha256_90r_transform_scalar(&ctx, data + off);
+    }
+    memcpy(midstate, ctx.state, sizeof(ctx.state));
+    return 0;
+}
+
+int sha256_90r_pow_init(sha256_90r_pow_job_t* job, const uint8_t* header, size_t len,
+                        size_t nonce_offset, size_t nonce_size,
+                        const uint8_t target[SHA256_90R_DIGEST_SIZE])
+{
+    size_t prefix = len - len % 64;
+    uint64_t bitlen = (uint64_t)len * 8;
+
+    if (!job || !header || !target) return -1;
+    if (nonce_size < 1 || nonce_size > 8 || nonce_offset + nonce_size > len) return -1;
+    // The nonce and all padding must sit in one final block
+    if (len % 64 >= 56 || nonce_offset < prefix) return -1;
+
+    memset(job, 0, sizeof(*job));
+    if (sha256_90r_midstate(header, prefix, job->midstate) != 0) return -1;
+    memcpy(job->tail, header + prefix, len - prefix);
+    job->tail[len - prefix] = 0x80;
+    for (int i = 0; i < 8; i++) {
+        job->tail[63 - i] = (uint8_t)(bitlen >> (8 * i));
+    }
+    job->nonce_offset = (uint32_t)(nonce_offset - prefix);
+    job->nonce_size = (uint32_t)nonce_size;
+    memcpy(job->target, target, SHA256_90R_DIGEST_SIZE);
+    job->lanes = 0;
+    return 0;
+}
+
+int sha256_90r_pow_search(const sha256_90r_pow_job_t* job, uint64_t start_nonce, uint64_t count,
+                          int num_threads, sha256_90r_pow_result_t* result)
+{
+    pow_plan_t plan;
+    pow_worker_t *workers;
+    pthread_t *threads;
+    volatile uint64_t next_chunk = 0, best = UINT64_MAX;
+    int lanes, started = 0;
+
+    if (!job || !result) return -1;
+    memset(result, 0, sizeof(*result));
+    if (job->nonce_size < 1 || job->nonce_size > 8 || job->nonce_offset + job->nonce_size > 64) return -1;
+
+    lanes = job->lanes ? job->lanes : pow_widest_lanes();
+    if (!pow_lanes_supported(lanes)) return -1;
+
+    // Nonces past the field width would wrap onto ones already tried
+    if (job->nonce_size < 8) {
+        uint64_t space = 1ULL << (8 * job->nonce_size);
+        if (start_nonce >= space) return -1;
+        if (count > space - start_nonce) count = space - start_nonce;
+    } else if (count > UINT64_MAX - start_nonce) {
+        count = UINT64_MAX - start_nonce;
+    }
+    if (count == 0) return 0;
+
+    memset(&plan, 0, sizeof(plan));
+    memcpy(plan.midstate, job->midstate, sizeof(plan.midstate));
+    memcpy(plan.tail, job->tail, sizeof(plan.tail));
+    memcpy(plan.target, job->target, sizeof(plan.target));
+    plan.nonce_offset = (int)job->nonce_offset;
+    plan.nonce_size = (int)job->nonce_size;
+    pow_plan_build(&plan);
+
+    if (num_threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = n > 0 ? (int)n : 1;
+    }
+    if (num_threads > POW_MAX_THREADS) num_threads = POW_MAX_THREADS;
+    if ((uint64_t)num_threads > (count + POW_CHUNK - 1) / POW_CHUNK) {
+        num_threads = (int)((count + POW_CHUNK - 1) / POW_CHUNK);
+    }
+
+    workers = calloc((size_t)num_threads, sizeof(pow_worker_t));
+    threads = calloc((size_t)num_threads, sizeof(pthread_t));
+    if (!workers || !threads) {
+        free(workers);
+        free(threads);
+        return -1;
+    }
+    for (int t = 0; t < num_threads; t++) {
+        workers[t].plan = &plan;
+        workers[t].start = start_nonce;
+        workers[t].count = count;
+        workers[t].lanes = lanes;
+        workers[t].next_chunk = &next_chunk;
+        workers[t].best = &best;
+    }
+
+    if (num_threads == 1) {
+        pow_worker_main(&workers[0]);
+    } else {
+        for (; started < num_threads; started++) {
+            if (pthread_create(&threads[started], NULL, pow_worker_main, &workers[started]) != 0) break;
+        }
+        // Threads that failed to start leave their chunks to the others
+        if (started == 0) pow_worker_main(&workers[0]);
+        for (int t = 0; t < started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        result->hashes += workers[t].hashes;
+    }
+    result->lanes = lanes;
+    result->threads = started > 0 ? started : 1;
+    if (best != UINT64_MAX) {
+        uint32_t st[8];
+        result->found = 1;
+        result->nonce = start_nonce + best;
+        pow_hash_scalar(&plan, result->nonce, st);
+        sha256_90r_store_digest(st, result->digest);
+    }
+
+    free(workers);
+    free(threads);
+    return result->found;
+}
@@ -0,0 +1,287 @@
+/*********************************************************************
+* Filename:   sha256_90r_power.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Package energy measurement for benchmarks (Intel/AMD RAPL).
+*             Readings come from the powercap sysfs tree
+*             (/sys/class/powercap/intel-rapl:N/energy_uj), or, when that
+*             is absent or not readable, from the perf_event
+*             power/energy-pkg/ event opened on one CPU per package.
+*             Without either, regions are only timed and report no
+*             energy. No MSR access is needed from user space.
+*********************************************************************/
+
+#define _GNU_SOURCE
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+/****************************** MACROS ******************************/
+#define POWERCAP_ROOT "/sys/class/powercap"
+#define PERF_POWER_ROOT "/sys/bus/event_source/devices/power"
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static double energy_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Read the first line of a sysfs file; 0 on success
+static int read_sysfs_line(const char* path, char* buf, size_t len) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) return -1;
+    if (!fgets(buf, (int)len, fp)) {
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static int read_sysfs_u64(const char* path, uint64_t* value) {
+    char buf[64];
+    char* end;
+    if (read_sysfs_line(path, buf, sizeof(buf)) != 0) return -1;
+    *value = strtoull(buf, &end, 10);
+    return end == buf ? -1 : 0;
+}
+
+/*************************** POWERCAP ***************************/
+
+// Counts between two readings of a counter that wraps after range. A reading
+// below start means one wrap, which can only be undone when range is known.
+int sha256_90r_energy_delta(uint64_t start, uint64_t now, uint64_t range, uint64_t* delta) {
+    if (now >= start) {
+        *delta = now - start;
+        return 0;
+    }
+    if (range == 0 || start > range) return -1;
+    *delta = range - start + now;
+    return 0;
+}
+
+// Package zones are the top-level "intel-rapl:N" entries (sub-zones have a
+// second colon). Fills zone directory indices; returns the zone count.
+static int powercap_packages(int zones[], int max_zones) {
+    DIR* dir = opendir(POWERCAP_ROOT);
+    struct dirent* ent;
+    int count = 0;
+
+    if (!dir) return 0;
+    while ((ent = readdir(dir)) != NULL && count < max_zones) {
+        int zone;
+        char tail;
+        if (sscanf(ent->d_name, "intel-rapl:%d%c", &zone, &tail) == 1) {
+            zones[count++] = zone;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+
+// fds[] holds the zone index of each package for this source
+static int powercap_start(sha256_90r_energy_t* region) {
+    int zones[SHA256_90R_ENERGY_MAX_DOMAINS];
+    int n = powercap_packages(zones, SHA256_90R_ENERGY_MAX_DOMAINS);
+    char path[256];
+
+    for (int i = 0; i < n; i++) {
+        snprintf(path, sizeof(path), POWERCAP_ROOT "/intel-rapl:%d/energy_uj", zones[i]);
+        if (read_sysfs_u64(path, &region->start_raw[i]) != 0) {
+            // energy_uj is root-only on most distributions since 2020
+            for (int j = 0; j < i; j++) region->fds[j] = -1;
+            return -1;
+        }
+        snprintf(path, sizeof(path), POWERCAP_ROOT "/intel-rapl:%d/max_energy_range_uj", zones[i]);
+        if (read_sysfs_u64(path, &region->range_raw[i]) != 0) region->range_raw[i] = 0;
+        region->fds[i] = zones[i];
+    }
+    if (n == 0) return -1;
+
+    region->domains = n;
+    region->scale = 1e-6; // microjoules
+    return 0;
+}
+
+static int powercap_stop(sha256_90r_energy_t* region, double* joules) {
+    char path[256];
+    double total = 0.0;
+
+    for (int i = 0; i < region->domains; i++) {
+        uint64_t now, delta;
+        snprintf(path, sizeof(path), POWERCAP_ROOT "/intel-rapl:%d/energy_uj", region->fds[i]);
+        if (read_sysfs_u64(path, &now) != 0) return -1;
+        // The counter wraps at max_energy_range_uj (0 if it could not be read)
+        if (sha256_90r_energy_delta(region->start_raw[i], now, region->range_raw[i], &delta) != 0) return -1;
+        total += (double)delta * region->scale;
+    }
+    *joules = total;
+    return 0;
+}
+
+/*************************** PERF EVENT ***************************/
+#ifdef __linux__
+static long energy_perf_open(struct perf_event_attr* attr, int cpu) {
+    return syscall(__NR_perf_event_open, attr, -1, cpu, -1, 0);
+}
+
+static void perf_close_all(sha256_90r_energy_t* region) {
+    for (int i = 0; i < region->domains; i++) {
+        if (region->fds[i] >= 0) close(region->fds[i]);
+        region->fds[i] = -1;
+    }
+    region->domains = 0;
+}
+
+static int perf_start(sha256_90r_energy_t* region) {
+    char buf[256];
+    uint64_t type;
+    unsigned int config = 0;
+    double scale;
+    struct perf_event_attr attr;
+    char* cursor;
+
+    if (read_sysfs_u64(PERF_POWER_ROOT "/type", &type) != 0) return -1;
+    if (read_sysfs_line(PERF_POWER_ROOT "/events/energy-pkg", buf, sizeof(buf)) != 0) return -1;
+    if (sscanf(buf, "event=%x", &config) != 1) return -1;
+    if (read_sysfs_line(PERF_POWER_ROOT "/events/energy-pkg.scale", buf, sizeof(buf)) != 0) return -1;
+    scale = strtod(buf, NULL);
+    if (scale <= 0.0) return -1;
+    // cpumask lists one CPU per package, e.g. "0" or "0,28"
+    if (read_sysfs_line(PERF_POWER_ROOT "/cpumask", buf, sizeof(buf)) != 0) strcpy(buf, "0");
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = (uint32_t)type;
+    attr.size = sizeof(attr);
+    attr.config = config;
+
+    region->domains = 0;
+    cursor = buf;
+    while (*cursor && region->domains < SHA256_90R_ENERGY_MAX_DOMAINS) {
+        char* end;
+        long cpu = strtol(cursor, &end, 10);
+        if (end == cursor) break;
+        long fd = energy_perf_open(&attr, (int)cpu);
+        if (fd < 0) {
+            perf_close_all(region);
+            return -1;
+        }
+        region->fds[region->domains] = (int)fd;
+        if (read((int)fd, &region->start_raw[region->domains], sizeof(uint64_t)) != sizeof(uint64_t)) {
+            region->domains++;
+            perf_close_all(region);
+            return -1;
+        }
+        region->domains++;
+        cursor = (*end == ',') ? end + 1 : end;
+        if (*end == '-') break; // ranges are not used for per-package masks
+    }
+    if (region->domains == 0) return -1;
+
+    region->scale = scale;
+    return 0;
+}
+
+static int perf_stop(sha256_90r_energy_t* region, double* joules) {
+    double total = 0.0;
+    int ok = 1;
+
+    for (int i = 0; i < region->domains; i++) {
+        uint64_t now;
+        if (read(region->fds[i], &now, sizeof(now)) != sizeof(now)) {
+            ok = 0;
+            continue;
+        }
+        total += (double)(now - region->start_raw[i]) * region->scale;
+    }
+    perf_close_all(region);
+    *joules = total;
+    return ok ? 0 : -1;
+}
+#endif
+
+/*************************** PUBLIC API ***************************/
+
+int sha256_90r_energy_start(sha256_90r_energy_t* region) {
+    if (!region) return -1;
+    memset(region, 0, sizeof(*region));
+    for (int i = 0; i < SHA256_90R_ENERGY_MAX_DOMAINS; i++) region->fds[i] = -1;
+
+    if (powercap_start(region) == 0) {
+        region->source = SHA256_90R_ENERGY_POWERCAP;
+#ifdef __linux__
+    } else if (perf_start(region) == 0) {
+        region->source = SHA256_90R_ENERGY_PERF;
+#endif
+    } else {
+        region->source = SHA256_90R_ENERGY_NONE;
+        region->domains = 0;
+    }
+
+    // Take the timestamp last so counter setup is not billed to the region
+    region->start_time = energy_now();
+    return region->source == SHA256_90R_ENERGY_NONE ? -1 : 0;
+}
+
+int sha256_90r_energy_stop(sha256_90r_energy_t* region) {
+    double joules = 0.0;
+    int rc = -1;
+
+    if (!region) return -1;
+    region->seconds = energy_now() - region->start_time;
+
+    if (region->source == SHA256_90R_ENERGY_POWERCAP) {
+        rc = powercap_stop(region, &joules);
+#ifdef __linux__
+    } else if (region->source == SHA256_90R_ENERGY_PERF) {
+        rc = perf_stop(region, &joules);
+#endif
+    }
+
+    if (rc != 0) {
+        region->source = SHA256_90R_ENERGY_NONE;
+        region->joules = 0.0;
+        region->watts = 0.0;
+        return -1;
+    }
+    region->joules = joules;
+    region->watts = region->seconds > 0.0 ? joules / region->seconds : 0.0;
+    return 0;
+}
+
+sha256_90r_energy_source_t sha256_90r_energy_source(void) {
+    static int probed = 0;
+    static sha256_90r_energy_source_t source = SHA256_90R_ENERGY_NONE;
+
+    if (!probed) {
+        sha256_90r_energy_t region;
+        sha256_90r_energy_start(&region);
+        source = region.source;
+        sha256_90r_energy_stop(&region);
+        probed = 1;
+    }
+    return source;
+}
+
+const char* sha256_90r_energy_source_name(sha256_90r_energy_source_t source) {
+    switch (source) {
+        case SHA256_90R_ENERGY_POWERCAP: return "powercap";
+        case SHA256_90R_ENERGY_PERF: return "perf";
+        default: return "none";
+    }
+}
@@ -0,0 +1,286 @@
+/*********************************************************************
+* Filename:   sha256_90r_rows.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Row digests of columnar batches (sha256_90r_hash_rows).
+*             Each lane serializes one row with a cursor over the columns:
+*             a field's tag and length prefix and its value bytes go
+*             straight from the column buffers into the lane's 64-byte
+*             block, values with a whole block left are handed to the
+*             kernel in place, and the padding is written as the row
+*             ends. A lane whose row is done takes the next row, so rows
+*             of different lengths keep the 8/16 lanes full
+*             (sha256_90r_lanes_run).
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <string.h>
+
+/****************************** MACROS ******************************/
+#define ROWS_BIT(bits, i) (((bits)[(i) >> 3] >> ((i) & 7)) & 1)
+
+/**************************** DATA TYPES ****************************/
+// Serialization cursor of one row
+typedef struct {
+    size_t row;
+    size_t col;                     // Next column to open
+    BYTE head[5];                   // Tag and length prefix of the open field
+    size_t head_len;
+    size_t head_pos;
+    const BYTE* val;                // Value bytes of the open field not yet emitted
+    size_t val_left;
+    uint64_t len;                   // Message bytes emitted
+    int length_block;               // The padding spilled: one more block holds the bit length
+    int last;                       // The block just returned ends the row
+    BYTE stage[64];
+} rows_lane_t;
+
+// A batch on the lanes (sha256_90r_lanes_run callbacks' arg)
+typedef struct {
+    const sha256_90r_column_t* columns;
+    size_t ncols;
+    uint8_t (*digests)[SHA256_90R_DIGEST_SIZE];
+    rows_lane_t lane[SHA256_90R_MAX_LANES];
+} rows_batch_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int rows_valid(const sha256_90r_column_t* columns, size_t ncols, size_t rows) {
+    for (size_t c = 0; c < ncols; c++) {
+        const sha256_90r_column_t* col = &columns[c];
+        size_t first = col->offset, last = col->offset + rows;
+
+        switch (col->type) {
+        case SHA256_90R_COLUMN_FIXED:
+            if (col->width == 0 || !col->data) return 0;
+            break;
+        case SHA256_90R_COLUMN_BOOL:
+            if (!col->data) return 0;
+            break;
+        case SHA256_90R_COLUMN_BINARY: {
+            const int32_t* off = (const int32_t*)col->offsets;
+            if (!off) return 0;
+            for (size_t i = first; i < last; i++) {
+                if (off[i] < 0 || off[i + 1] < off[i]) return 0;
+            }
+            if (!col->data && off[last] > off[first]) return 0;
+            break;
+        }
+        case SHA256_90R_COLUMN_LARGE_BINARY: {
+            const int64_t* off = (const int64_t*)col->offsets;
+            if (!off) return 0;
+            for (size_t i = first; i < last; i++) {
+                if (off[i] < 0 || off[i + 1] < off[i] || off[i + 1] - off[i] > (int64_t)UINT32_MAX) return 0;
+            }
+            if (!col->data && off[last] > off[first]) return 0;
+            break;
+        }
+        default:
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void rows_lane_start(rows_lane_t* lane, size_t row) {
+    lane->row = row;
+    lane->col = 0;
+    lane->head_len = 0;
+    lane->head_pos = 0;
+    lane->val_left = 0;
+    lane->len = 0;
+    lane->length_block = 0;
+    lane->last = 0;
+}
+
+// Set up the next column's field: its tag (and length) and its value bytes
+static void rows_open_field(rows_lane_t* lane, const sha256_90r_column_t* col) {
+    size_t i = col->offset + lane->row;
+
+    lane->col++;
+    lane->head_pos = 0;
+    lane->val_left = 0;
+    if (col->validity && !ROWS_BIT(col->validity, i)) {
+        lane->head[0] = 0x00;
+        lane->head_len = 1;
+        return;
+    }
+    lane->head[0] = 0x01;
+    lane->head_len = 1;
+    switch (col->type) {
+    case SHA256_90R_COLUMN_FIXED:
+        lane->val = (const BYTE*)col->data + i * col->width;
+        lane->val_left = col->width;
+        break;
+    case SHA256_90R_COLUMN_BOOL:
+        lane->head[1] = (BYTE)ROWS_BIT((const BYTE*)col->data, i);
+        lane->head_len = 2;
+        break;
+    default: {
+        uint64_t start, end;
+        if (col->type == SHA256_90R_COLUMN_BINARY) {
+            start = (uint64_t)((const int32_t*)col->offsets)[i];
+            end = (uint64_t)((const int32_t*)col->offsets)[i + 1];
+        } else {
+            start = (uint64_t)((const int64_t*)col->offsets)[i];
+            end = (uint64_t)((const int64_t*)col->offsets)[i + 1];
+        }
+        for (int b = 0; b < 4; b++) lane->head[1 + b] = (BYTE)((end - start) >> (8 * b));
+        lane->head_len = 5;
+        lane->val = (const BYTE*)col->data + start;
+        lane->val_left = (size_t)(end - start);
+        break;
+    }
+    }
+}
+
+// Copy with the common fixed widths inlined
+static inline void rows_copy(BYTE* dst, const BYTE* src, size_t len) {
+    switch (len) {
+    case 4: memcpy(dst, src, 4); break;
+    case 8: memcpy(dst, src, 8); break;
+    case 16: memcpy(dst, src, 16); break;
+    default: memcpy(dst, src, len); break;
+    }
+}
+
+// Next block of the lane's row: in place while the open value has a whole
+// block left at a block boundary, else assembled in stage. Sets last on the
+// final (padded) block.
+static const BYTE* rows_lane_block(rows_lane_t* lane, const sha256_90r_column_t* columns, size_t ncols) {
+    size_t p = 0;
+
+    if (lane->length_block) {
+        uint64_t bitlen = lane->len * 8;
+        memset(lane->stage, 0, 56);
+        for (int i = 0; i < 8; i++) lane->stage[63 - i] = (BYTE)(bitlen >> (8 * i));
+        lane->last = 1;
+        return lane->stage;
+    }
+    for (;;) {
+        if (lane->head_pos == lane->head_len && lane->val_left == 0) {
+            if (lane->col == ncols) break;
+            rows_open_field(lane, &columns[lane->col]);
+            // A field that fits goes in whole
+            if (p + lane->head_len + lane->val_left <= 64) {
+                for (size_t i = 0; i < lane->head_len; i++) lane->stage[p + i] = lane->head[i];
+                p += lane->head_len;
+                if (lane->val_left > 0) rows_copy(lane->stage + p, lane->val, lane->val_left);
+                p += lane->val_left;
+                lane->len += lane->head_len + lane->val_left;
+                lane->head_pos = lane->head_len;
+                lane->val_left = 0;
+                if (p == 64) return lane->stage;
+                continue;
+            }
+        }
+        while (lane->head_pos < lane->head_len && p < 64) {
+            lane->stage[p++] = lane->head[lane->head_pos++];
+            lane->len++;
+        }
+        if (lane->head_pos == lane->head_len && lane->val_left > 0) {
+            size_t take;
+            if (p == 0 && lane->val_left >= 64) {
+                const BYTE* block = lane->val;
+                lane->val += 64;
+                lane->val_left -= 64;
+                lane->len += 64;
+                return block;
+            }
+            take = lane->val_left < 64 - p ? lane->val_left : 64 - p;
+            memcpy(lane->stage + p, lane->val, take);
+            lane->val += take;
+            lane->val_left -= take;
+            lane->len += take;
+            p += take;
+        }
+        if (p == 64) return lane->stage;
+    }
+
+    // The row ended at p: 0x80, zeros, and the bit length here or in one more block
+    lane->stage[p++] = 0x80;
+    memset(lane->stage + p, 0, 64 - p);
+    if (p > 56) {
+        lane->length_block = 1;
+        return lane->stage;
+    }
+    {
+        uint64_t bitlen = lane->len * 8;
+        for (int i = 0; i < 8; i++) lane->stage[63 - i] = (BYTE)(bitlen >> (8 * i));
+    }
+    lane->last = 1;
+    return lane->stage;
+}
+
+// Finish a lane's row on the single-stream transform from the given state
+static void rows_lane_finish_single(rows_lane_t* lane, const WORD state[8], const sha256_90r_column_t* columns,
+                                    size_t ncols, uint8_t hash[SHA256_90R_DIGEST_SIZE]) {
+    struct sha256_90r_internal_ctx ctx;
+
+    sha256_90r_init_internal(&ctx);
+    memcpy(ctx.state, state, sizeof(ctx.state));
+    do {
+        sha256_90r_transform(&ctx, rows_lane_block(lane, columns, ncols));
+    } while (!lane->last);
+    sha256_90r_store_digest(ctx.state, hash);
+}
+
+static void rows_batch_start(void* arg, int l, size_t row) {
+    rows_lane_start(&((rows_batch_t*)arg)->lane[l], row);
+}
+
+static const BYTE* rows_batch_next(void* arg, int l, int* last) {
+    rows_batch_t* batch = arg;
+    const BYTE* block = rows_lane_block(&batch->lane[l], batch->columns, batch->ncols);
+
+    *last = batch->lane[l].last;
+    return block;
+}
+
+static void rows_batch_done(void* arg, int l, const WORD state[8]) {
+    rows_batch_t* batch = arg;
+    sha256_90r_store_digest(state, batch->digests[batch->lane[l].row]);
+}
+
+static void rows_batch_finish(void* arg, int l, const WORD state[8]) {
+    rows_batch_t* batch = arg;
+    rows_lane_t* lane = &batch->lane[l];
+    rows_lane_finish_single(lane, state, batch->columns, batch->ncols, batch->digests[lane->row]);
+}
+
+static const sha256_90r_lane_ops_t rows_lane_ops = {
+    rows_batch_start, rows_batch_next, rows_batch_done, rows_batch_finish
+};
+
+/*************************** PUBLIC API ***************************/
+
+int sha256_90r_hash_rows(const sha256_90r_column_t* columns, size_t ncols, size_t rows,
+                         uint8_t (*digests)[SHA256_90R_DIGEST_SIZE])
+{
+    struct sha256_90r_internal_ctx iv;
+    rows_batch_t batch;
+    int lanes;
+
+    if (rows == 0) return 0;
+    if ((!columns && ncols > 0) || !digests || !rows_valid(columns, ncols, rows)) return -1;
+
+    // Same rule as sha256_90r_batch(): lanes once the batch reaches the tuned
+    // size, the single-stream transform row by row below it
+    lanes = sha256_90r_lane_width();
+    if (lanes > 1 && rows >= 2 && rows >= sha256_90r_tune_batch_min()) {
+        batch.columns = columns;
+        batch.ncols = ncols;
+        batch.digests = digests;
+        sha256_90r_lanes_run(lanes, SHA256_90R_LANE_KERNELS, &rows_lane_ops, &batch, rows);
+        return 0;
+    }
+    sha256_90r_init_internal(&iv);
+    for (size_t r = 0; r < rows; r++) {
+        rows_lane_t lane;
+        rows_lane_start(&lane, r);
+        rows_lane_finish_single(&lane, iv.state, columns, ncols, digests[r]);
+    }
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*********************************************************************
+* Filename:   sha256_90r_striped.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Lane-striped hashing of a single message (algorithm IDs
+*             SHA256_90R_ALG_STRIPED*_V1). The input is dealt round-robin
+*             in 64-byte units to 4, 8 or 16 independent SHA256-90R lanes,
+*             so every full stripe of lanes * 64 contiguous bytes is one
+*             call of a multi-lane kernel with one block per lane. Lane
+*             states are kept word-major (state[word][lane]) like the
+*             multi-buffer manager's. At the end every lane is padded as
+*             its own message and the lane digests are compressed, behind
+*             a header naming the version, lane count and total length,
+*             into the final digest.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/****************************** MACROS ******************************/
+#define STRIPED_MAX_LANES SHA256_90R_STRIPED_MAX_LANES
+#define STRIPED_HEADER_SIZE 16
+#define STRIPED_STATE(ctx, w, l) SHA256_90R_LANE_STATE((ctx)->state, (ctx)->lanes, w, l)
+
+/**************************** DATA TYPES ****************************/
+typedef enum {
+    STRIPED_KERNEL_SCALAR = 0,
+    STRIPED_KERNEL_AVX2_8WAY,
+    STRIPED_KERNEL_AVX512_16WAY
+} striped_kernel_t;
+
+struct sha256_90r_striped_ctx {
+    sha256_90r_alg_t alg;
+    int lanes;
+    striped_kernel_t kernel;
+    WORD state[8 * STRIPED_MAX_LANES];          // Word-major chaining values (STRIPED_STATE)
+    BYTE buf[STRIPED_MAX_LANES * 64];           // Partial stripe
+    size_t buf_len;
+    uint64_t total;                             // Message bytes so far
+    uint64_t stripes;                           // Full stripes compressed
+};
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+
+static int striped_lanes(sha256_90r_alg_t alg) {
+    switch (alg) {
+        case SHA256_90R_ALG_STRIPED4_V1: return 4;
+        case SHA256_90R_ALG_STRIPED8_V1: return 8;
+        case SHA256_90R_ALG_STRIPED16_V1: return 16;
+        default: return 0;
+    }
+}
+
+// Widest kernel that covers the lane count on this CPU. The 8-way kernel
+// takes every count: SSE-width 4-way code builds each vector from scalars and
+// loses to a half-filled 8-way call.
+static striped_kernel_t striped_pick_kernel(int lanes) {
+#if defined(USE_SIMD) && defined(__x86_64__)
+    if (lanes == 16 && __builtin_cpu_supports("avx512f")) return STRIPED_KERNEL_AVX512_16WAY;
+    if (__builtin_cpu_supports("avx2")) return STRIPED_KERNEL_AVX2_8WAY;
+#else
+    (void)lanes;
+#endif
+    return STRIPED_KERNEL_SCALAR;
+}
+
+static void striped_reset(sha256_90r_striped_ctx_t* ctx) {
+    struct sha256_90r_internal_ctx iv;
+
+    sha256_90r_init_internal(&iv);
+    for (int l = 0; l < ctx->lanes; l++) {
+        for (int w = 0; w < 8; w++) STRIPED_STATE(ctx, w, l) = iv.state[w];
+    }
+    ctx->buf_len = 0;
+    ctx->total = 0;
+    ctx->stripes = 0;
+}
+
+// One full stripe: block l of the stripe extends lane l
+static void striped_compress(sha256_90r_striped_ctx_t* ctx, const BYTE* stripe) {
+    switch (ctx->kernel) {
+#if defined(USE_SIMD) && defined(__x86_64__)
+        case STRIPED_KERNEL_AVX512_16WAY: {
+            const BYTE* blocks[16];
+            for (int l = 0; l < 16; l++) blocks[l] = stripe + 64 * l;
+            sha256_90r_blocks_avx512_16way((WORD (*)[16])ctx->state, blocks);
+            break;
+        }
+        case STRIPED_KERNEL_AVX2_8WAY: {
+            const BYTE* blocks[8];
+            if (ctx->lanes == 8) {
+                for (int l = 0; l < 8; l++) blocks[l] = stripe + 64 * l;
+                sha256_90r_blocks_avx2_8way((WORD (*)[8])ctx->state, blocks);
+                break;
+            }
+            // 16 lanes as two groups of 8; 4 lanes as one group whose upper
+            // half recompresses the same blocks and is discarded
+            for (int g = 0; g < ctx->lanes; g += 8) {
+                WORD st[8][8];
+                for (int l = 0; l < 8; l++) {
+                    int src = g + l % ctx->lanes;
+                    for (int w = 0; w < 8; w++) st[w][l] = STRIPED_STATE(ctx, w, src);
+                    blocks[l] = stripe + 64 * src;
+                }
+                sha256_90r_blocks_avx2_8way(st, blocks);
+                for (int l = 0; l < 8 && g + l < ctx->lanes; l++) {
+                    for (int w = 0; w < 8; w++) STRIPED_STATE(ctx, w, g + l) = st[w][l];
+                }
+            }
+            break;
+        }
+#endif
+        default:
+            for (int l = 0; l < ctx->lanes; l++) {
+                struct sha256_90r_internal_ctx lane;
+                for (int w = 0; w < 8; w++) lane.state[w] = STRIPED_STATE(ctx, w, l);
+                sha256_90r_transform_scalar(&lane, stripe + 64 * l);
+                for (int w = 0; w < 8; w++) STRIPED_STATE(ctx, w, l) = lane.state[w];
+            }
+            break;
+    }
+    ctx->stripes++;
+}
+
+/*************************** PUBLIC API ***************************/
+
+const char* sha256_90r_alg_name(sha256_90r_alg_t alg)
+{
+    switch (alg) {
+        case SHA256_90R_ALG_SHA256_90R: return "SHA256-90R";
+        case SHA256_90R_ALG_STRIPED4_V1: return "SHA256-90R-S4/v1";
+        case SHA256_90R_ALG_STRIPED8_V1: return "SHA256-90R-S8/v1";
+        case SHA256_90R_ALG_STRIPED16_V1: return "SHA256-90R-S16/v1";
+        default: return NULL;
+    }
+}
+
+sha256_90r_striped_ctx_t* sha256_90r_striped_new(sha256_90r_alg_t alg)
+{
+    sha256_90r_striped_ctx_t* ctx;
+    int lanes = striped_lanes(alg);
+
+    if (lanes == 0) return NULL;
+    ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) return NULL;
+    ctx->alg = alg;
+    ctx->lanes = lanes;
+    ctx->kernel = striped_pick_kernel(lanes);
+    striped_reset(ctx);
+    return ctx;
+}
+
+void sha256_90r_striped_free(sha256_90r_striped_ctx_t* ctx)
+{
+    free(ctx);
+}
+
+int sha256_90r_striped_update(sha256_90r_striped_ctx_t* ctx, const void* data, size_t len)
+{
+    const BYTE* p = (const BYTE*)data;
+    size_t stripe = 64 * (size_t)(ctx ? ctx->lanes : 0);
+
+    if (!ctx || (!data && len > 0)) return -1;
+    ctx->total += len;
+
+    if (ctx->buf_len > 0) {
+        size_t take = stripe - ctx->buf_len;
+        if (take > len) take = len;
+        memcpy(ctx->buf + ctx->buf_len, p, take);
+        ctx->buf_len += take;
+        p += take;
+        len -= take;
+        if (ctx->buf_len < stripe) return 0;
+        striped_compress(ctx, ctx->buf);
+        ctx->buf_len = 0;
+    }
+    // Whole stripes straight from the caller's buffer
+    while (len >= stripe) {
+        striped_compress(ctx, p);
+        p += stripe;
+        len -= stripe;
+    }
+    if (len > 0) {
+        memcpy(ctx->buf, p, len);
+        ctx->buf_len = len;
+    }
+    return 0;
+}
+
+/* Writes the digest and starts the context over on a new message */
+int sha256_90r_striped_final(sha256_90r_striped_ctx_t* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE])
+{
+    struct sha256_90r_internal_ctx outer;
+    BYTE header[STRIPED_HEADER_SIZE];
+
+    if (!ctx || !hash) return -1;
+
+    header[0] = 'S';
+    header[1] = '9';
+    header[2] = '0';
+    header[3] = 'R';
+    header[4] = SHA256_90R_STRIPED_VERSION;
+    header[5] = (BYTE)ctx->lanes;
+    header[6] = 0;
+    header[7] = 0;
+    for (int i = 0; i < 8; i++) header[8 + i] = (BYTE)(ctx->total >> (56 - 8 * i));
+
+    sha256_90r_init_internal(&outer);
+    sha256_90r_update_internal(&outer, header, sizeof(header));
+
+    // Lane l's remainder is unit l of the partial stripe (possibly empty);
+    // each lane is padded with its own length
+    for (int l = 0; l < ctx->lanes; l++) {
+        struct sha256_90r_internal_ctx lane;
+        BYTE digest[SHA256_90R_DIGEST_SIZE];
+        size_t off = 64 * (size_t)l;
+        size_t part = ctx->buf_len > off ? ctx->buf_len - off : 0;
+
+        if (part > 64) part = 64;
+        for (int w = 0; w < 8; w++) lane.state[w] = STRIPED_STATE(ctx, w, l);
+        lane.datalen = 0;
+        lane.bitlen = ctx->stripes * 512;
+        sha256_90r_update_internal(&lane, ctx->buf + off, part);
+        sha256_90r_final_internal(&lane, digest);
+        sha256_90r_update_internal(&outer, digest, sizeof(digest));
+    }
+    sha256_90r_final_internal(&outer, hash);
+
+    striped_reset(ctx);
+    return 0;
+}
+
+int sha256_90r_striped_hash(sha256_90r_alg_t alg, const void* data, size_t len,
+                            uint8_t hash[SHA256_90R_DIGEST_SIZE])
+{
+    sha256_90r_striped_ctx_t ctx;
+
+    if ((!data && len > 0) || !hash) return -1;
+    if (alg == SHA256_90R_ALG_SHA256_90R) {
+        sha256_90r_hash((const uint8_t*)data, len, hash);
+        return 0;
+    }
+    ctx.lanes = striped_lanes(alg);
+    if (ctx.lanes == 0) return -1;
+    ctx.alg = alg;
+    ctx.kernel = striped_pick_kernel(ctx.lanes);
+    striped_reset(&ctx);
+    if (sha256_90r_striped_update(&ctx, data, len) != 0) return -1;
+    return sha256_90r_striped_final(&ctx, hash);
+}
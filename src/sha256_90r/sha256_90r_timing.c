@@ -0,0 +1,590 @@
+/*********************************************************************
+* Filename:   sha256_90r_timing.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    dudect-style timing-leak analyzer for SHA256-90R.
+*             Measurements of a "fixed" and a "random" input class are
+*             interleaved in random order and timed with rdtscp. Each
+*             sample is pushed into streaming Welch t-tests (uncropped,
+*             cropped at 100 percentiles, and a second-order test), so
+*             no sample storage beyond one batch is needed. Workers run
+*             on every online CPU and their accumulators are merged at
+*             the end (Chan et al. parallel variance).
+*             Reference: Reparaz, Balasch, Verbauwhede, "Dude, is my
+*             code constant time?", DATE 2017.
+*********************************************************************/
+
+#define _GNU_SOURCE
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/****************************** MACROS ******************************/
+#define CT_NUM_CROPS         100                     // Percentile crops (dudect default)
+#define CT_TEST_UNCROPPED    0
+#define CT_TEST_SECOND_ORDER (CT_NUM_CROPS + 1)
+#define CT_NUM_TESTS         (CT_NUM_CROPS + 2)
+#define CT_BATCH             4096                    // Measurements per batch
+#define CT_CALIBRATION       4096                    // Warm-up measurements used for percentiles
+#define CT_ENOUGH            10000                   // Samples a test needs before it is scored
+#define CT_UPDATE_LEN        128                     // Two-block message for the update API
+#define CT_FINAL_LEN         37                      // Partial block for the final API
+#define CT_BLOCK_LEN         64
+
+/**************************** DATA TYPES ****************************/
+typedef void (*ct_transform_fn)(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
+
+// Streaming Welch accumulator (Welford mean/M2 per class)
+typedef struct {
+    double n[2];
+    double mean[2];
+    double m2[2];
+} ct_welch_t;
+
+typedef struct {
+    // Configuration (shared by all workers)
+    sha256_90r_backend_t backend;
+    sha256_90r_mode_t mode;
+    sha256_90r_ct_api_t api;
+    ct_transform_fn transform;
+    size_t input_len;
+    const BYTE *fixed_input;
+    const double *thresholds;
+
+    // Per-worker parameters and results
+    uint64_t measurements;
+    uint64_t seed;
+    int cpu;
+    int status;
+    ct_welch_t tests[CT_NUM_TESTS];
+} ct_worker_t;
+
+/*********************** STATISTICS ***********************/
+
+static void ct_welch_push(ct_welch_t *w, double x, int cls)
+{
+    double delta;
+
+    w->n[cls] += 1.0;
+    delta = x - w->mean[cls];
+    w->mean[cls] += delta / w->n[cls];
+    w->m2[cls] += delta * (x - w->mean[cls]);
+}
+
+static void ct_welch_merge(ct_welch_t *dst, const ct_welch_t *src)
+{
+    for (int cls = 0; cls < 2; cls++) {
+        double n = dst->n[cls] + src->n[cls];
+        double delta;
+
+        if (src->n[cls] == 0.0) continue;
+        if (dst->n[cls] == 0.0) {
+            dst->n[cls] = src->n[cls];
+            dst->mean[cls] = src->mean[cls];
+            dst->m2[cls] = src->m2[cls];
+            continue;
+        }
+        delta = src->mean[cls] - dst->mean[cls];
+        dst->mean[cls] += delta * src->n[cls] / n;
+        dst->m2[cls] += src->m2[cls] + delta * delta * dst->n[cls] * src->n[cls] / n;
+        dst->n[cls] = n;
+    }
+}
+
+static double ct_welch_t_value(const ct_welch_t *w)
+{
+    double var0, var1, den;
+
+    if (w->n[0] < 2.0 || w->n[1] < 2.0) return 0.0;
+    var0 = w->m2[0] / (w->n[0] - 1.0);
+    var1 = w->m2[1] / (w->n[1] - 1.0);
+    den = sqrt(var0 / w->n[0] + var1 / w->n[1]);
+    if (den == 0.0) return 0.0;
+    return (w->mean[0] - w->mean[1]) / den;
+}
+
+static int ct_compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*********************** MEASUREMENT ***********************/
+
+// Serializing cycle counter; falls back to a monotonic clock in nanoseconds
+static inline uint64_t ct_timestamp(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int aux;
+    return __rdtscp(&aux);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t ct_rand_next(uint64_t *s)
+{
+    // xorshift64*: the generator only has to decorrelate classes from timing
+    uint64_t x = *s;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *s = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+// Fill one batch: random bytes for every input, then overwrite class-0 inputs with the fixed value
+static void ct_prepare_batch(ct_worker_t *w, uint64_t *rng, BYTE *inputs, uint8_t *classes, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        BYTE *in = inputs + i * w->input_len;
+        uint64_t r = 0;
+
+        for (size_t j = 0; j < w->input_len; j++) {
+            if ((j & 7) == 0) r = ct_rand_next(rng);
+            in[j] = (BYTE)r;
+            r >>= 8;
+        }
+        classes[i] = (uint8_t)(ct_rand_next(rng) & 1);
+        if (classes[i] == 0) {
+            memcpy(in, w->fixed_input, w->input_len);
+        }
+    }
+}
+
+// Time one call of the API under test; setup work happens outside the timed window
+static uint64_t ct_measure_one(ct_worker_t *w, SHA256_90R_CTX *ctx, const BYTE *in)
+{
+    struct sha256_90r_internal_ctx tctx;
+    uint8_t hash[SHA256_90R_DIGEST_SIZE];
+    uint64_t start, end;
+
+    switch (w->api) {
+        case SHA256_90R_CT_API_TRANSFORM:
+            sha256_90r_init_internal(&tctx);
+            start = ct_timestamp();
+            w->transform(&tctx, in);
+            end = ct_timestamp();
+            break;
+
+        case SHA256_90R_CT_API_UPDATE:
+            sha256_90r_reset(ctx);
+            start = ct_timestamp();
+            sha256_90r_update(ctx, in, w->input_len);
+            end = ct_timestamp();
+            break;
+
+        case SHA256_90R_CT_API_FINAL:
+            sha256_90r_reset(ctx);
+            sha256_90r_update(ctx, in, w->input_len);
+            start = ct_timestamp();
+            sha256_90r_final(ctx, hash);
+            end = ct_timestamp();
+            break;
+
+        case SHA256_90R_CT_API_ONESHOT:
+        default:
+            start = ct_timestamp();
+            sha256_90r_reset(ctx);
+            sha256_90r_update(ctx, in, w->input_len);
+            sha256_90r_final(ctx, hash);
+            end = ct_timestamp();
+            break;
+    }
+
+    return end - start;
+}
+
+static void ct_push_sample(ct_worker_t *w, double x, int cls)
+{
+    ct_welch_push(&w->tests[CT_TEST_UNCROPPED], x, cls);
+
+    for (int k = 0; k < CT_NUM_CROPS; k++) {
+        if (x < w->thresholds[k]) {
+            ct_welch_push(&w->tests[1 + k], x, cls);
+        }
+    }
+
+    // Second-order test on centered squares, once the class means have settled
+    const ct_welch_t *base = &w->tests[CT_TEST_UNCROPPED];
+    if (base->n[0] + base->n[1] > CT_ENOUGH) {
+        double centered = x - base->mean[cls];
+        ct_welch_push(&w->tests[CT_TEST_SECOND_ORDER], centered * centered, cls);
+    }
+}
+
+static SHA256_90R_CTX *ct_new_context(const ct_worker_t *w)
+{
+    SHA256_90R_CTX *ctx = sha256_90r_new_backend(w->backend);
+    if (ctx) {
+        ctx->mode = w->mode;
+    }
+    return ctx;
+}
+
+// Run `count` measurements; with samples != NULL the raw cycles are returned instead of pushed
+static int ct_run(ct_worker_t *w, uint64_t count, uint64_t *samples)
+{
+    SHA256_90R_CTX *ctx = ct_new_context(w);
+    BYTE *inputs = malloc(CT_BATCH * w->input_len);
+    uint8_t *classes = malloc(CT_BATCH);
+    uint64_t *cycles = malloc(CT_BATCH * sizeof(uint64_t));
+    uint64_t rng = w->seed | 1;
+    uint64_t done = 0;
+    int status = 0;
+
+    if (!ctx || !inputs || !classes || !cycles) {
+        status = -1;
+        goto out;
+    }
+
+    while (done < count) {
+        size_t n = (count - done) < CT_BATCH ? (size_t)(count - done) : CT_BATCH;
+
+        ct_prepare_batch(w, &rng, inputs, classes, n);
+        for (size_t i = 0; i < n; i++) {
+            cycles[i] = ct_measure_one(w, ctx, inputs + i * w->input_len);
+        }
+
+        if (samples) {
+            memcpy(samples + done, cycles, n * sizeof(uint64_t));
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                ct_push_sample(w, (double)cycles[i], classes[i]);
+            }
+        }
+        done += n;
+    }
+
+out:
+    sha256_90r_free(ctx);
+    free(inputs);
+    free(classes);
+    free(cycles);
+    return status;
+}
+
+static void *ct_worker_main(void *arg)
+{
+    ct_worker_t *w = (ct_worker_t *)arg;
+
+#ifdef __linux__
+    if (w->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);  // Best effort
+    }
+#endif
+
+    w->status = ct_run(w, w->measurements, NULL);
+    return NULL;
+}
+
+/*********************** BACKEND SELECTION ***********************/
+
+static ct_transform_fn ct_backend_transform(sha256_90r_backend_t backend)
+{
+    switch (backend) {
+        case SHA256_90R_BACKEND_AUTO:
+            return sha256_90r_transform;
+
+        case SHA256_90R_BACKEND_SCALAR:
+            return sha256_90r_transform_scalar;
+
+        case SHA256_90R_BACKEND_SIMD:
+#if defined(USE_SIMD) && defined(__x86_64__)
+            return __builtin_cpu_supports("avx2") ? sha256_90r_transform_avx2 : NULL;
+#elif defined(USE_SIMD) && defined(__ARM_NEON)
+            return sha256_90r_transform_neon;
+#else
+            return NULL;
+#endif
+
+        case SHA256_90R_BACKEND_FPGA:
+#ifdef USE_FPGA_PIPELINE
+            return sha256_90r_transform_fpga;
+#else
+            return NULL;
+#endif
+
+        case SHA256_90R_BACKEND_JIT:
+#ifdef USE_JIT_CODEGEN
+            return sha256_90r_transform_jit;
+#else
+            return NULL;
+#endif
+
+        default:
+            return NULL;
+    }
+}
+
+#if defined(USE_SIMD) && defined(__x86_64__)
+// Lane kernels under the transform signature: the class input in every lane,
+// lane 0 written back
+static void ct_kernel_avx2_8way(struct sha256_90r_internal_ctx *ctx, const BYTE data[])
+{
+    WORD state[8][8];
+    const BYTE *blocks[8];
+
+    for (int l = 0; l < 8; l++) {
+        blocks[l] = data;
+        for (int w = 0; w < 8; w++) state[w][l] = ctx->state[w];
+    }
+    sha256_90r_blocks_avx2_8way(state, blocks);
+    for (int w = 0; w < 8; w++) ctx->state[w] = state[w][0];
+}
+
+static void ct_kernel_avx512_16way(struct sha256_90r_internal_ctx *ctx, const BYTE data[])
+{
+    WORD state[8][16];
+    const BYTE *blocks[16];
+
+    for (int l = 0; l < 16; l++) {
+        blocks[l] = data;
+        for (int w = 0; w < 8; w++) state[w][l] = ctx->state[w];
+    }
+    sha256_90r_blocks_avx512_16way(state, blocks);
+    for (int w = 0; w < 8; w++) ctx->state[w] = state[w][0];
+}
+#endif
+
+static ct_transform_fn ct_kernel_transform(sha256_90r_kernel_t kernel)
+{
+    if (!sha256_90r_kernel_available(kernel)) return NULL;
+
+    switch (kernel) {
+        case SHA256_90R_KERNEL_SCALAR:
+            return sha256_90r_transform_scalar;
+
+        case SHA256_90R_KERNEL_SCALAR_ROLLING:
+            return sha256_90r_transform_scalar_rolling;
+
+#if defined(USE_SIMD) && defined(__x86_64__)
+        case SHA256_90R_KERNEL_AVX2:
+            return sha256_90r_transform_avx2;
+
+        case SHA256_90R_KERNEL_AVX2_8WAY:
+            return ct_kernel_avx2_8way;
+
+        case SHA256_90R_KERNEL_AVX512_16WAY:
+            return ct_kernel_avx512_16way;
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        case SHA256_90R_KERNEL_SCALAR_BMI2:
+            return sha256_90r_transform_bmi2;
+#endif
+
+        default:
+            return NULL;
+    }
+}
+
+// CPUs this process may run on, in order; returns the count written
+static int ct_online_cpus(int *cpus, int max)
+{
+    int count = 0;
+
+#ifdef __linux__
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE && count < max; c++) {
+            if (CPU_ISSET(c, &set)) cpus[count++] = c;
+        }
+    }
+#endif
+    if (count == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        if (n < 1) n = 1;
+        for (int c = 0; c < n && count < max; c++) cpus[count++] = c;
+    }
+    return count;
+}
+
+/*************************** ANALYSIS ***************************/
+
+// Calibrate, run the workers and score the merged tests for a configured prototype
+static int ct_analyze(const ct_worker_t *proto_in, uint64_t measurements, int num_threads,
+                      sha256_90r_leak_report_t *report)
+{
+    double thresholds[CT_NUM_CROPS];
+    BYTE fixed_input[CT_UPDATE_LEN];
+    ct_worker_t proto = *proto_in, *workers = NULL;
+    pthread_t *threads = NULL;
+    uint64_t *samples = NULL;
+    int cpus[CPU_SETSIZE];
+    int num_cpus, status = -1;
+
+    // The fixed class is the all-zero input, as in the dudect reference examples
+    memset(fixed_input, 0, sizeof(fixed_input));
+    proto.fixed_input = fixed_input;
+
+    // Warm-up pass: discard the samples but derive the crop thresholds from them
+    samples = malloc(CT_CALIBRATION * sizeof(uint64_t));
+    if (!samples || ct_run(&proto, CT_CALIBRATION, samples) != 0) goto out;
+    qsort(samples, CT_CALIBRATION, sizeof(uint64_t), ct_compare_u64);
+    for (int k = 0; k < CT_NUM_CROPS; k++) {
+        double p = 1.0 - pow(0.5, 10.0 * (double)(k + 1) / CT_NUM_CROPS);
+        size_t idx = (size_t)(p * CT_CALIBRATION);
+        if (idx >= CT_CALIBRATION) idx = CT_CALIBRATION - 1;
+        thresholds[k] = (double)samples[idx];
+    }
+    proto.thresholds = thresholds;
+
+    num_cpus = ct_online_cpus(cpus, CPU_SETSIZE);
+    if (num_threads <= 0) num_threads = num_cpus;
+    if ((uint64_t)num_threads > measurements) num_threads = measurements > 0 ? (int)measurements : 1;
+
+    workers = calloc((size_t)num_threads, sizeof(ct_worker_t));
+    threads = calloc((size_t)num_threads, sizeof(pthread_t));
+    if (!workers || !threads) goto out;
+
+    for (int t = 0; t < num_threads; t++) {
+        workers[t] = proto;
+        workers[t].measurements = measurements / (uint64_t)num_threads +
+                                  ((uint64_t)t < measurements % (uint64_t)num_threads ? 1 : 0);
+        workers[t].seed = proto.seed + 0xD1B54A32D192ED03ull * (uint64_t)(t + 1);
+        workers[t].cpu = cpus[t % num_cpus];
+    }
+
+    if (num_threads == 1) {
+        ct_worker_main(&workers[0]);
+    } else {
+        int started = 0;
+        for (; started < num_threads; started++) {
+            if (pthread_create(&threads[started], NULL, ct_worker_main, &workers[started]) != 0) break;
+        }
+        for (int t = 0; t < started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        for (int t = started; t < num_threads; t++) {
+            workers[t].status = -1;
+        }
+    }
+
+    // Merge per-thread accumulators and score every test with enough samples
+    {
+        ct_welch_t merged[CT_NUM_TESTS];
+        uint64_t enough;
+        double max_t = 0.0;
+
+        memset(merged, 0, sizeof(merged));
+        for (int t = 0; t < num_threads; t++) {
+            if (workers[t].status != 0) goto out;
+            for (int i = 0; i < CT_NUM_TESTS; i++) {
+                ct_welch_merge(&merged[i], &workers[t].tests[i]);
+            }
+        }
+
+        report->class_counts[0] = (uint64_t)merged[CT_TEST_UNCROPPED].n[0];
+        report->class_counts[1] = (uint64_t)merged[CT_TEST_UNCROPPED].n[1];
+        report->measurements = report->class_counts[0] + report->class_counts[1];
+        report->threads = num_threads;
+        report->t_uncropped = ct_welch_t_value(&merged[CT_TEST_UNCROPPED]);
+        report->t_second_order = ct_welch_t_value(&merged[CT_TEST_SECOND_ORDER]);
+
+        // Short runs score tests holding at least a tenth of the samples
+        enough = report->measurements / 10 < CT_ENOUGH ? report->measurements / 10 : CT_ENOUGH;
+        for (int i = 0; i < CT_NUM_TESTS; i++) {
+            double t;
+            if (merged[i].n[0] + merged[i].n[1] < (double)enough) continue;
+            t = fabs(ct_welch_t_value(&merged[i]));
+            if (t > max_t) max_t = t;
+        }
+        report->leak_score = max_t;
+        report->leak_detected = max_t > SHA256_90R_CT_T_THRESHOLD;
+    }
+    status = 0;
+
+out:
+    free(samples);
+    free(workers);
+    free(threads);
+    return status;
+}
+
+/*************************** PUBLIC API ***************************/
+
+const char* sha256_90r_ct_api_name(sha256_90r_ct_api_t api)
+{
+    switch (api) {
+        case SHA256_90R_CT_API_TRANSFORM: return "transform";
+        case SHA256_90R_CT_API_UPDATE:    return "update";
+        case SHA256_90R_CT_API_FINAL:     return "final";
+        case SHA256_90R_CT_API_ONESHOT:   return "oneshot";
+        default: return "unknown";
+    }
+}
+
+int sha256_90r_leak_test(sha256_90r_backend_t backend, sha256_90r_mode_t mode,
+                         sha256_90r_ct_api_t api, uint64_t measurements,
+                         int num_threads, sha256_90r_leak_report_t* report)
+{
+    ct_worker_t proto;
+
+    if (!report || api < SHA256_90R_CT_API_TRANSFORM || api > SHA256_90R_CT_API_ONESHOT) {
+        return -1;
+    }
+    memset(report, 0, sizeof(*report));
+    if (sha256_90r_init_library() != 0) return -1;
+
+    memset(&proto, 0, sizeof(proto));
+    proto.backend = backend;
+    proto.mode = mode;
+    proto.api = api;
+    proto.cpu = -1;
+    proto.seed = 0x9E3779B97F4A7C15ull ^ ((uint64_t)backend << 32) ^ (uint64_t)api;
+
+    if (api == SHA256_90R_CT_API_TRANSFORM) {
+        proto.transform = ct_backend_transform(backend);
+        if (!proto.transform) return 0;
+        proto.input_len = CT_BLOCK_LEN;
+    } else {
+        if (!sha256_90r_backend_available(backend)) return 0;
+        proto.input_len = (api == SHA256_90R_CT_API_UPDATE) ? CT_UPDATE_LEN :
+                          (api == SHA256_90R_CT_API_FINAL)  ? CT_FINAL_LEN : CT_BLOCK_LEN;
+    }
+    report->supported = 1;
+    return ct_analyze(&proto, measurements, num_threads, report);
+}
+
+int sha256_90r_leak_test_kernel(sha256_90r_kernel_t kernel, uint64_t measurements,
+                                int num_threads, sha256_90r_leak_report_t* report)
+{
+    ct_worker_t proto;
+
+    if (!report) return -1;
+    memset(report, 0, sizeof(*report));
+    if (sha256_90r_init_library() != 0) return -1;
+
+    memset(&proto, 0, sizeof(proto));
+    proto.backend = SHA256_90R_BACKEND_AUTO;
+    proto.mode = SHA256_90R_MODE_SECURE;
+    proto.api = SHA256_90R_CT_API_TRANSFORM;
+    proto.cpu = -1;
+    proto.seed = 0xC2B2AE3D27D4EB4Full ^ ((uint64_t)kernel << 32);
+    proto.transform = ct_kernel_transform(kernel);
+    proto.input_len = CT_BLOCK_LEN;
+    if (!proto.transform) return 0;
+
+    report->supported = 1;
+    return ct_analyze(&proto, measurements, num_threads, report);
+}
@@ -0,0 +1,614 @@
+/*********************************************************************
+* Filename:   sha256_90r_tune.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Self-calibrating autotuner. A short measurement pass times
+*             the single-stream kernels, each available backend, the
+*             multi-buffer widths, the batch size at which lanes beat
+*             one-at-a-time hashing, thread scaling and the tree chunk
+*             size, and the resulting plan replaces the hard-coded
+*             performance estimates. Plans are cached in a small key=value
+*             file keyed by CPU model and CPU count, so later processes
+*             on the same machine skip the measurement. Nothing here can
+*             change a digest: every path the plan chooses between
+*             computes the same function.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+/****************************** MACROS ******************************/
+#define TUNE_MIN_SECONDS 0.002          // Shortest timed run per measurement
+#define TUNE_BUF_SIZE (64 * 1024)       // Single-stream / backend input
+#define TUNE_BATCH_MSG_LEN 256          // Message size for the batch threshold
+#define TUNE_BATCH_MAX 64               // Largest batch tried for the threshold
+#define TUNE_TREE_BUF_SIZE (4u << 20)   // Input for thread and chunk scaling
+#define TUNE_MAX_THREADS_TRIED 64
+#define TUNE_MIN_BYTES_PER_THREAD (64 * 1024)
+#define TUNE_THREAD_AMORTIZE 20         // Work per thread vs. its start-up cost
+#define TUNE_DEFAULT_BATCH_MIN 8        // Before tuning
+#define TUNE_DEFAULT_BYTES_PER_THREAD (256 * 1024)
+#define TUNE_CACHE_DIR "sha256-90r"
+
+/**************************** DATA TYPES ****************************/
+typedef void (*tune_fn_t)(void* arg);
+
+typedef struct {
+    SHA256_90R_CTX* ctx;
+    const uint8_t* data;
+    size_t len;
+} tune_update_arg_t;
+
+typedef struct {
+    sha256_90r_mb_mgr_t* mgr;
+    sha256_90r_job_t* jobs;
+    size_t count;
+} tune_mb_arg_t;
+
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    size_t chunk;
+    int threads;
+} tune_tree_arg_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static pthread_mutex_t g_tune_lock = PTHREAD_MUTEX_INITIALIZER;    // One measurement at a time
+static pthread_mutex_t g_plan_lock = PTHREAD_MUTEX_INITIALIZER;    // Guards g_plan / g_tuned
+static sha256_90r_tune_plan_t g_plan;
+static int g_tuned = 0;
+
+static double tune_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int tune_online_cpus(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+/**
+ * Call fn until TUNE_MIN_SECONDS have passed (one untimed warm-up call
+ * first) and return the rate in bytes per second.
+ */
+static double tune_rate(tune_fn_t fn, void* arg, size_t bytes_per_call) {
+    double start, elapsed;
+    size_t calls = 0;
+
+    fn(arg);
+    start = tune_now();
+    do {
+        fn(arg);
+        calls++;
+        elapsed = tune_now() - start;
+    } while (elapsed < TUNE_MIN_SECONDS);
+    return (double)bytes_per_call * (double)calls / elapsed;
+}
+
+static void tune_update_fn(void* p) {
+    tune_update_arg_t* a = (tune_update_arg_t*)p;
+    sha256_90r_update(a->ctx, a->data, a->len);
+}
+
+static void tune_hash_fn(void* p) {
+    tune_update_arg_t* a = (tune_update_arg_t*)p;
+    uint8_t out[SHA256_90R_DIGEST_SIZE];
+    sha256_90r_hash(a->data, a->len, out);
+}
+
+static void tune_seq_fn(void* p) {
+    tune_mb_arg_t* a = (tune_mb_arg_t*)p;
+    for (size_t i = 0; i < a->count; i++) sha256_90r_hash(a->jobs[i].data, a->jobs[i].len, a->jobs[i].digest);
+}
+
+static void tune_mb_fn(void* p) {
+    tune_mb_arg_t* a = (tune_mb_arg_t*)p;
+    for (size_t i = 0; i < a->count; i++) sha256_90r_mb_submit(a->mgr, &a->jobs[i]);
+    while (sha256_90r_mb_flush(a->mgr) != NULL) {
+    }
+}
+
+static void tune_tree_fn(void* p) {
+    tune_tree_arg_t* a = (tune_tree_arg_t*)p;
+    uint8_t out[SHA256_90R_DIGEST_SIZE];
+    sha256_90r_tree_hash(a->data, a->len, a->chunk, a->threads, out, NULL);
+}
+
+static void* tune_empty_thread(void* arg) {
+    return arg;
+}
+
+// Seconds to start and join one thread
+static double tune_thread_overhead(void) {
+    double start = tune_now();
+    int n = 0;
+
+    for (; n < 16; n++) {
+        pthread_t t;
+        if (pthread_create(&t, NULL, tune_empty_thread, NULL) != 0) break;
+        pthread_join(t, NULL);
+    }
+    return n ? (tune_now() - start) / n : 0.0;
+}
+
+static void tune_cpu_model(char model[64]) {
+    memset(model, 0, 64);
+#if defined(__x86_64__) || defined(__i386__)
+    {
+        unsigned int regs[12];
+        if (__get_cpuid_max(0x80000000, NULL) >= 0x80000004) {
+            for (unsigned int i = 0; i < 3; i++) {
+                __get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2], &regs[4 * i + 3]);
+            }
+            memcpy(model, regs, 48);
+        }
+    }
+#endif
+    if (model[0] == '\0') {
+        FILE* f = fopen("/proc/cpuinfo", "r");
+        char line[256];
+        while (f && fgets(line, sizeof(line), f)) {
+            char* colon = strchr(line, ':');
+            if (colon && (strncmp(line, "model name", 10) == 0 || strncmp(line, "CPU part", 8) == 0)) {
+                snprintf(model, 64, "%s", colon + 1);
+                break;
+            }
+        }
+        if (f) fclose(f);
+    }
+
+    // Trim, and keep the cache file one-key-per-line
+    {
+        size_t start = 0, len;
+        while (model[start] == ' ' || model[start] == '\t') start++;
+        memmove(model, model + start, 64 - start);
+        len = strlen(model);
+        while (len > 0 && (model[len - 1] == ' ' || model[len - 1] == '\n' || model[len - 1] == '\r')) model[--len] = '\0';
+        for (size_t i = 0; i < len; i++) {
+            if (model[i] == '\n' || model[i] == '=') model[i] = ' ';
+        }
+    }
+    if (model[0] == '\0') snprintf(model, 64, "unknown");
+}
+
+static void tune_defaults(sha256_90r_tune_plan_t* plan) {
+    sha256_90r_mb_mgr_t* mgr = sha256_90r_mb_new(0);
+    sha256_90r_mb_stats_t st;
+
+    memset(plan, 0, sizeof(*plan));
+    tune_cpu_model(plan->cpu_model);
+    plan->cpus = tune_online_cpus();
+    plan->kernel = (sha256_90r_kernel_t)sha256_90r_transform_default();
+    plan->mb_lanes = 1;
+    if (mgr) {
+        sha256_90r_mb_get_stats(mgr, &st);
+        plan->mb_lanes = st.lanes;
+        sha256_90r_mb_free(mgr);
+    }
+    plan->batch_min_count = TUNE_DEFAULT_BATCH_MIN;
+    plan->max_threads = plan->cpus;
+    plan->bytes_per_thread = TUNE_DEFAULT_BYTES_PER_THREAD;
+    plan->tree_chunk_size = SHA256_90R_TREE_DEFAULT_CHUNK;
+}
+
+/**
+ * Cache file path; 0 on success, -1 when caching is disabled or there is
+ * no usable home directory
+ */
+static int tune_cache_path(const sha256_90r_tune_plan_t* plan, char* path, size_t size) {
+    const char* env = getenv("SHA256_90R_TUNE_CACHE");
+    const char* base;
+    char dir[512];
+    uint64_t key = 0xcbf29ce484222325ULL;     // FNV-1a over model and CPU count
+    char cpus[16];
+
+    if (env && *env) {
+        if (strcmp(env, "off") == 0) return -1;
+        return snprintf(path, size, "%s", env) < (int)size ? 0 : -1;
+    }
+
+    snprintf(cpus, sizeof(cpus), "/%d", plan->cpus);
+    for (const char* p = plan->cpu_model; *p; p++) key = (key ^ (uint8_t)*p) * 0x100000001b3ULL;
+    for (const char* p = cpus; *p; p++) key = (key ^ (uint8_t)*p) * 0x100000001b3ULL;
+
+    if ((base = getenv("XDG_CACHE_HOME")) != NULL && *base) {
+        snprintf(dir, sizeof(dir), "%s/" TUNE_CACHE_DIR, base);
+    } else if ((base = getenv("HOME")) != NULL && *base) {
+        snprintf(dir, sizeof(dir), "%s/.cache", base);
+        mkdir(dir, 0700);
+        snprintf(dir, sizeof(dir), "%s/.cache/" TUNE_CACHE_DIR, base);
+    } else {
+        return -1;
+    }
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) return -1;
+    return snprintf(path, size, "%s/tune-%016llx.conf", dir, (unsigned long long)key) < (int)size ? 0 : -1;
+}
+
+/**
+ * Load a cached plan for this machine; 0 if one matched the library
+ * version, CPU model and CPU count
+ */
+static int tune_cache_load(sha256_90r_tune_plan_t* plan) {
+    sha256_90r_tune_plan_t cached = *plan;
+    char path[1024], line[256];
+    int matched = 0, fields = 0;
+    FILE* f;
+
+    if (tune_cache_path(plan, path, sizeof(path)) != 0 || (f = fopen(path, "r")) == NULL) return -1;
+    while (fgets(line, sizeof(line), f)) {
+        char* val = strchr(line, '=');
+        char* end;
+        if (line[0] == '#' || !val) continue;
+        *val++ = '\0';
+        if ((end = strchr(val, '\n')) != NULL) *end = '\0';
+
+        if (strcmp(line, "version") == 0) {
+            matched += strcmp(val, sha256_90r_version()) == 0;
+        } else if (strcmp(line, "cpu_model") == 0) {
+            matched += strcmp(val, plan->cpu_model) == 0;
+        } else if (strcmp(line, "cpus") == 0) {
+            matched += atoi(val) == plan->cpus;
+        } else if (strcmp(line, "kernel") == 0) {
+            cached.kernel = (sha256_90r_kernel_t)atoi(val);
+            fields++;
+        } else if (strcmp(line, "kernel_gbps") == 0) {
+            cached.kernel_gbps = strtod(val, NULL);
+        } else if (strcmp(line, "mb_lanes") == 0) {
+            cached.mb_lanes = atoi(val);
+            fields++;
+        } else if (strcmp(line, "mb_gbps") == 0) {
+            cached.mb_gbps = strtod(val, NULL);
+        } else if (strcmp(line, "batch_min_count") == 0) {
+            cached.batch_min_count = (size_t)strtoull(val, NULL, 10);
+            fields++;
+        } else if (strcmp(line, "max_threads") == 0) {
+            cached.max_threads = atoi(val);
+            fields++;
+        } else if (strcmp(line, "bytes_per_thread") == 0) {
+            cached.bytes_per_thread = (size_t)strtoull(val, NULL, 10);
+            fields++;
+        } else if (strcmp(line, "tree_chunk_size") == 0) {
+            cached.tree_chunk_size = (size_t)strtoull(val, NULL, 10);
+            fields++;
+        } else if (strcmp(line, "tune_seconds") == 0) {
+            cached.tune_seconds = strtod(val, NULL);
+        } else if (strcmp(line, "backend_gbps") == 0) {
+            char* p = val;
+            for (int b = 0; b < SHA256_90R_NUM_BACKENDS && *p; b++) {
+                cached.backend_gbps[b] = strtod(p, &p);
+                if (*p == ',') p++;
+            }
+        }
+    }
+    fclose(f);
+
+    // Reject stale or hand-edited plans the rest of the library cannot use
+    if (matched != 3 || fields != 6 || cached.max_threads < 1 || cached.bytes_per_thread == 0 ||
+        cached.tree_chunk_size == 0 || cached.batch_min_count == 0 ||
+        sha256_90r_transform_select(cached.kernel) != 0) {
+        return -1;
+    }
+    {
+        sha256_90r_mb_mgr_t* mgr = sha256_90r_mb_new(cached.mb_lanes);
+        if (!mgr) return -1;
+        sha256_90r_mb_free(mgr);
+    }
+    cached.from_cache = 1;
+    *plan = cached;
+    return 0;
+}
+
+// Write via a temporary file and rename so readers never see half a plan
+static void tune_cache_save(const sha256_90r_tune_plan_t* plan) {
+    char path[1024], tmp[1100];
+    FILE* f;
+
+    if (tune_cache_path(plan, path, sizeof(path)) != 0) return;
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    if ((f = fopen(tmp, "w")) == NULL) return;
+
+    fprintf(f, "# SHA256-90R autotune plan (delete to re-measure)\n");
+    fprintf(f, "version=%s\n", sha256_90r_version());
+    fprintf(f, "cpu_model=%s\n", plan->cpu_model);
+    fprintf(f, "cpus=%d\n", plan->cpus);
+    fprintf(f, "kernel=%d\n", (int)plan->kernel);
+    fprintf(f, "kernel_gbps=%.4f\n", plan->kernel_gbps);
+    fprintf(f, "mb_lanes=%d\n", plan->mb_lanes);
+    fprintf(f, "mb_gbps=%.4f\n", plan->mb_gbps);
+    fprintf(f, "batch_min_count=%zu\n", plan->batch_min_count);
+    fprintf(f, "max_threads=%d\n", plan->max_threads);
+    fprintf(f, "bytes_per_thread=%zu\n", plan->bytes_per_thread);
+    fprintf(f, "tree_chunk_size=%zu\n", plan->tree_chunk_size);
+    fprintf(f, "tune_seconds=%.4f\n", plan->tune_seconds);
+    fprintf(f, "backend_gbps=");
+    for (int b = 0; b < SHA256_90R_NUM_BACKENDS; b++) {
+        fprintf(f, "%s%.4f", b ? "," : "", plan->backend_gbps[b]);
+    }
+    fprintf(f, "\n");
+
+    if (fclose(f) != 0 || rename(tmp, path) != 0) unlink(tmp);
+}
+
+// Fastest single-stream kernel; leaves it selected
+static void tune_kernel(sha256_90r_tune_plan_t* plan, const uint8_t* buf) {
+    static const sha256_90r_kernel_t kernels[] = {
+        SHA256_90R_KERNEL_SCALAR, SHA256_90R_KERNEL_SCALAR_ROLLING, SHA256_90R_KERNEL_AVX2,
+        SHA256_90R_KERNEL_SCALAR_BMI2
+    };
+    tune_update_arg_t arg = {NULL, buf, TUNE_BUF_SIZE};
+
+    plan->kernel_gbps = 0.0;
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        double gbps;
+        if (sha256_90r_transform_select(kernels[k]) != 0) continue;
+        gbps = tune_rate(tune_hash_fn, &arg, TUNE_BUF_SIZE) * 8e-9;
+        if (gbps > plan->kernel_gbps) {
+            plan->kernel_gbps = gbps;
+            plan->kernel = kernels[k];
+        }
+    }
+    sha256_90r_transform_select(plan->kernel);
+}
+
+// Widest is not always fastest (AVX-512 frequency licences), so time each width
+static void tune_lanes(sha256_90r_tune_plan_t* plan, const uint8_t* buf, sha256_90r_job_t* jobs) {
+    static const int widths[] = {1, 8, 16};
+    size_t count = TUNE_BUF_SIZE / 1024;
+
+    for (size_t i = 0; i < count; i++) {
+        jobs[i].data = buf + i * 1024;
+        jobs[i].len = 1024;
+    }
+    plan->mb_gbps = 0.0;
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        tune_mb_arg_t arg = {sha256_90r_mb_new(widths[w]), jobs, count};
+        double gbps;
+        if (!arg.mgr) continue;
+        gbps = tune_rate(tune_mb_fn, &arg, count * 1024) * 8e-9;
+        sha256_90r_mb_free(arg.mgr);
+        if (gbps > plan->mb_gbps) {
+            plan->mb_gbps = gbps;
+            plan->mb_lanes = widths[w];
+        }
+    }
+}
+
+// Smallest batch of short messages where the lanes beat one-at-a-time hashing
+static void tune_batch_min(sha256_90r_tune_plan_t* plan, const uint8_t* buf, sha256_90r_job_t* jobs) {
+    tune_mb_arg_t arg = {sha256_90r_mb_new(plan->mb_lanes), jobs, 0};
+
+    plan->batch_min_count = TUNE_BATCH_MAX + 1;
+    if (!arg.mgr || plan->mb_lanes == 1) {
+        sha256_90r_mb_free(arg.mgr);
+        return;
+    }
+    for (size_t i = 0; i < TUNE_BATCH_MAX; i++) {
+        jobs[i].data = buf + i * TUNE_BATCH_MSG_LEN;
+        jobs[i].len = TUNE_BATCH_MSG_LEN;
+    }
+    for (size_t c = 2; c <= TUNE_BATCH_MAX; c *= 2) {
+        arg.count = c;
+        if (tune_rate(tune_mb_fn, &arg, c) > tune_rate(tune_seq_fn, &arg, c)) {
+            plan->batch_min_count = c;
+            break;
+        }
+    }
+    sha256_90r_mb_free(arg.mgr);
+}
+
+// Measured Gbps for every backend a context can be created with
+static void tune_backends(sha256_90r_tune_plan_t* plan, const uint8_t* buf) {
+    for (int b = 0; b < SHA256_90R_NUM_BACKENDS; b++) {
+        tune_update_arg_t arg = {NULL, buf, TUNE_BUF_SIZE};
+
+        plan->backend_gbps[b] = 0.0;
+        if (!sha256_90r_backend_available((sha256_90r_backend_t)b)) continue;
+        if (b == SHA256_90R_BACKEND_AUTO) {
+            plan->backend_gbps[b] = plan->kernel_gbps;
+            continue;
+        }
+        if (b == SHA256_90R_BACKEND_SIMD && plan->mb_lanes > 1) {
+            // A single stream has no lanes to fill; SIMD pays off across messages
+            plan->backend_gbps[b] = plan->mb_gbps;
+            continue;
+        }
+        if ((arg.ctx = sha256_90r_new_backend((sha256_90r_backend_t)b)) == NULL) continue;
+        plan->backend_gbps[b] = tune_rate(tune_update_fn, &arg, TUNE_BUF_SIZE) * 8e-9;
+        sha256_90r_free(arg.ctx);
+    }
+}
+
+// Thread scaling and tree chunk size (multi-CPU machines only)
+static void tune_threads(sha256_90r_tune_plan_t* plan) {
+    static const size_t chunks[] = {64 * 1024, 256 * 1024, 1024 * 1024};
+    double rates[TUNE_MAX_THREADS_TRIED + 1] = {0};
+    double best = 0.0, overhead;
+    tune_tree_arg_t arg;
+    int limit = plan->cpus < TUNE_MAX_THREADS_TRIED ? plan->cpus : TUNE_MAX_THREADS_TRIED;
+    double per_thread;
+
+    plan->max_threads = 1;
+    plan->tree_chunk_size = SHA256_90R_TREE_DEFAULT_CHUNK;
+    overhead = tune_thread_overhead();
+    per_thread = plan->mb_gbps > plan->kernel_gbps ? plan->mb_gbps : plan->kernel_gbps;
+    plan->bytes_per_thread = (size_t)(TUNE_THREAD_AMORTIZE * overhead * per_thread / 8e-9);
+    if (plan->bytes_per_thread < TUNE_MIN_BYTES_PER_THREAD) plan->bytes_per_thread = TUNE_MIN_BYTES_PER_THREAD;
+    if (limit < 2) return;
+
+    arg.len = TUNE_TREE_BUF_SIZE;
+    arg.data = calloc(1, arg.len);
+    if (!arg.data) return;
+
+    // Powers of two up to the CPU count, then the CPU count itself
+    arg.chunk = 64 * 1024;
+    for (int n = 1; n <= limit; n = n * 2 > limit && n != limit ? limit : n * 2) {
+        arg.threads = n;
+        rates[n] = tune_rate(tune_tree_fn, &arg, arg.len);
+        if (rates[n] > best) best = rates[n];
+    }
+    for (int n = 1; n <= limit; n++) {
+        if (rates[n] >= 0.95 * best) {
+            plan->max_threads = n;
+            break;
+        }
+    }
+
+    best = 0.0;
+    arg.threads = plan->max_threads;
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        double r;
+        arg.chunk = chunks[c];
+        if (arg.len / arg.chunk < (size_t)arg.threads) break;
+        r = tune_rate(tune_tree_fn, &arg, arg.len);
+        if (r > best) {
+            best = r;
+            plan->tree_chunk_size = chunks[c];
+        }
+    }
+    free((void*)arg.data);
+}
+
+static int tune_measure(sha256_90r_tune_plan_t* plan) {
+    uint8_t* buf = malloc(TUNE_BUF_SIZE);
+    sha256_90r_job_t* jobs = calloc(TUNE_BUF_SIZE / 1024 > TUNE_BATCH_MAX ? TUNE_BUF_SIZE / 1024 : TUNE_BATCH_MAX,
+                                    sizeof(*jobs));
+    double start = tune_now();
+
+    if (!buf || !jobs) {
+        free(buf);
+        free(jobs);
+        return -1;
+    }
+    for (size_t i = 0; i < TUNE_BUF_SIZE; i++) buf[i] = (uint8_t)(i * 131 + (i >> 8));
+
+    tune_kernel(plan, buf);
+    tune_lanes(plan, buf, jobs);
+    tune_batch_min(plan, buf, jobs);
+    tune_backends(plan, buf);
+    tune_threads(plan);
+    plan->tune_seconds = tune_now() - start;
+    plan->from_cache = 0;
+
+    free(buf);
+    free(jobs);
+    return 0;
+}
+
+/*************************** PUBLIC API ***************************/
+
+int sha256_90r_autotune(int flags, sha256_90r_tune_plan_t* plan)
+{
+    sha256_90r_tune_plan_t p;
+    int rc = 0;
+
+    pthread_mutex_lock(&g_tune_lock);
+    pthread_mutex_lock(&g_plan_lock);
+    if (g_tuned && !(flags & SHA256_90R_TUNE_FORCE)) {
+        if (plan) *plan = g_plan;
+        pthread_mutex_unlock(&g_plan_lock);
+        pthread_mutex_unlock(&g_tune_lock);
+        return 0;
+    }
+    pthread_mutex_unlock(&g_plan_lock);
+
+    // Measure without g_plan_lock: the tree and batch code being timed reads the plan
+    tune_defaults(&p);
+    if ((flags & (SHA256_90R_TUNE_FORCE | SHA256_90R_TUNE_NO_CACHE)) || tune_cache_load(&p) != 0) {
+        rc = tune_measure(&p);
+        if (rc == 0 && !(flags & SHA256_90R_TUNE_NO_CACHE)) tune_cache_save(&p);
+    }
+    if (rc == 0) {
+        pthread_mutex_lock(&g_plan_lock);
+        g_plan = p;
+        g_tuned = 1;
+        pthread_mutex_unlock(&g_plan_lock);
+        if (plan) *plan = p;
+    }
+    pthread_mutex_unlock(&g_tune_lock);
+    return rc;
+}
+
+int sha256_90r_get_tune_plan(sha256_90r_tune_plan_t* plan)
+{
+    int tuned;
+
+    if (!plan) return -1;
+    pthread_mutex_lock(&g_plan_lock);
+    tuned = g_tuned;
+    if (tuned) *plan = g_plan;
+    pthread_mutex_unlock(&g_plan_lock);
+    if (!tuned) tune_defaults(plan);
+    return tuned ? 0 : -1;
+}
+
+int sha256_90r_tune_threads(size_t len)
+{
+    size_t n;
+    int max_threads;
+
+    pthread_mutex_lock(&g_plan_lock);
+    if (!g_tuned) {
+        pthread_mutex_unlock(&g_plan_lock);
+        return tune_online_cpus();
+    }
+    n = len / g_plan.bytes_per_thread;
+    max_threads = g_plan.max_threads;
+    pthread_mutex_unlock(&g_plan_lock);
+    if (n < 1) n = 1;
+    return n > (size_t)max_threads ? max_threads : (int)n;
+}
+
+/*********************** LIBRARY-INTERNAL API ***********************/
+
+int sha256_90r_tune_mb_lanes(void)
+{
+    int lanes;
+    pthread_mutex_lock(&g_plan_lock);
+    lanes = g_tuned ? g_plan.mb_lanes : 0;
+    pthread_mutex_unlock(&g_plan_lock);
+    return lanes;
+}
+
+size_t sha256_90r_tune_chunk_size(void)
+{
+    size_t chunk;
+    pthread_mutex_lock(&g_plan_lock);
+    chunk = g_tuned ? g_plan.tree_chunk_size : SHA256_90R_TREE_DEFAULT_CHUNK;
+    pthread_mutex_unlock(&g_plan_lock);
+    return chunk;
+}
+
+size_t sha256_90r_tune_batch_min(void)
+{
+    size_t count;
+    pthread_mutex_lock(&g_plan_lock);
+    count = g_tuned ? g_plan.batch_min_count : TUNE_DEFAULT_BATCH_MIN;
+    pthread_mutex_unlock(&g_plan_lock);
+    return count;
+}
+
+double sha256_90r_tune_backend_gbps(int backend)
+{
+    double gbps;
+    if (backend < 0 || backend >= SHA256_90R_NUM_BACKENDS) return 0.0;
+    if (sha256_90r_autotune(0, NULL) != 0) return 0.0;
+    pthread_mutex_lock(&g_plan_lock);
+    gbps = g_plan.backend_gbps[backend];
+    pthread_mutex_unlock(&g_plan_lock);
+    return gbps;
+}
@@ -0,0 +1,477 @@
+/*********************************************************************
+* Filename:   sha256_90r_variant.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Round-count variants of SHA256-90R (72, 80, 90 and 128
+*             rounds). The kernel forms of every count but 90 are
+*             generated from one template, sha256_90r_variant_template.h,
+*             included once per round count; the 90-round member is
+*             SHA256-90R and runs the hand-written kernels of sha256.c.
+*             A registry maps round counts to their kernel tables.
+*             Variant R runs the first R round constants (k_90r, then
+*             k_variant_ext) with SHA256-90R's IV and padding, so 72/80
+*             are truncations of SHA256-90R. Adding a round count is one
+*             more inclusion and registry entry; counts above 128 need
+*             more constants.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include "sha256_90r.h"
+#include "sha256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/****************************** MACROS ******************************/
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VARIANT_X86 1
+#endif
+#if defined(USE_SIMD) && defined(__x86_64__)
+#define VARIANT_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define VARIANT_PASTE_(a, b) a##b
+#define VARIANT_PASTE(a, b) VARIANT_PASTE_(a, b)
+// variant_<form>_r<VARIANT_R>
+#define VARIANT_FN(form) VARIANT_PASTE(variant_##form##_r, VARIANT_R)
+
+#define VARIANT_LOAD_BE32(p) (((WORD)(p)[0] << 24) | ((WORD)(p)[1] << 16) | ((WORD)(p)[2] << 8) | (WORD)(p)[3])
+
+// Round constant i; the kernels unroll every round, so the branch folds away
+#define VARIANT_K(i) ((i) < 90 ? k_90r[i] : k_variant_ext[(i) - 90])
+
+#define VARIANT_ROUND(i, w) do { \
+    t1 = h + EP1(e) + CH(e, f, g) + VARIANT_K(i) + (w); \
+    t2 = EP0(a) + MAJ(a, b, c); \
+    h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2; \
+} while (0)
+
+// Paired rounds of the BMI2 kernel (see sha256_90r_transform_bmi2 in sha256.c):
+// CH terms added, MAJ through the carried b ^ c, names rotated by the caller
+#define VARIANT_BMI2_ROUND(a, b, c, d, e, f, g, h, hkw) \
+    h = (hkw) + EP1(e) + ((e) & (f)) + (~(e) & (g)); \
+    d += h; \
+    t = (a) ^ (b); \
+    h += EP0(a) + ((t & bc) ^ (b)); \
+    bc = t
+
+#define VARIANT_W(i) ((i) < 16 ? w[(i) & 15] : (w[(i) & 15] += SIG1(w[((i) - 2) & 15]) + \
+    w[((i) - 7) & 15] + SIG0(w[((i) - 15) & 15])))
+
+#define VARIANT_ROUNDS2(a, b, c, d, e, f, g, h, i) do { \
+    WORD kw0 = (h) + VARIANT_K(i) + VARIANT_W(i); \
+    WORD kw1 = (g) + VARIANT_K((i) + 1) + VARIANT_W((i) + 1); \
+    VARIANT_BMI2_ROUND(a, b, c, d, e, f, g, h, kw0); \
+    VARIANT_BMI2_ROUND(h, a, b, c, d, e, f, g, kw1); \
+} while (0)
+
+#ifdef VARIANT_SIMD
+#define VMM_ROTR(x, n) _mm_or_si128(_mm_srli_epi32((x), (n)), _mm_slli_epi32((x), 32 - (n)))
+#define VMM_SIG0(x) _mm_xor_si128(_mm_xor_si128(VMM_ROTR(x, 7), VMM_ROTR(x, 18)), _mm_srli_epi32(x, 3))
+#define VMM_SIG1(x) _mm_xor_si128(_mm_xor_si128(VMM_ROTR(x, 17), VMM_ROTR(x, 19)), _mm_srli_epi32(x, 10))
+
+// m[i..i+3]: lanes 0-1 take SIG1 of m[i-2], m[i-1]; lanes 2-3 of the new m[i], m[i+1]
+#define VARIANT_EXPAND4(m, i) do { \
+    __m128i base_ = _mm_add_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i *)&(m)[(i) - 16]), \
+                                                VMM_SIG0(_mm_loadu_si128((const __m128i *)&(m)[(i) - 15]))), \
+                                  _mm_loadu_si128((const __m128i *)&(m)[(i) - 7])); \
+    __m128i lo_ = _mm_add_epi32(base_, VMM_SIG1(_mm_loadl_epi64((const __m128i *)&(m)[(i) - 2]))); \
+    _mm_storeu_si128((__m128i *)&(m)[i], _mm_add_epi32(lo_, _mm_slli_si128(VMM_SIG1(lo_), 8))); \
+} while (0)
+
+#define VMM256_ROUND(i, w) do { \
+    __m256i t1_ = _mm256_add_epi32(h, _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(e, 6), MM256_ROTR(e, 11)), \
+                                                       MM256_ROTR(e, 25))); \
+    t1_ = _mm256_add_epi32(t1_, _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g))); \
+    t1_ = _mm256_add_epi32(t1_, _mm256_add_epi32(_mm256_set1_epi32((int)VARIANT_K(i)), (w))); \
+    __m256i t2_ = _mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(a, 2), MM256_ROTR(a, 13)), \
+                                                    MM256_ROTR(a, 22)), \
+                                   _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)))); \
+    h = g; g = f; f = e; e = _mm256_add_epi32(d, t1_); d = c; c = b; b = a; a = _mm256_add_epi32(t1_, t2_); \
+} while (0)
+
+#define VMM512_ROUND(i, w) do { \
+    __m512i t1_ = _mm512_add_epi32(h, _mm512_ternarylogic_epi32(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11), \
+                                                                _mm512_ror_epi32(e, 25), 0x96)); \
+    t1_ = _mm512_add_epi32(t1_, _mm512_ternarylogic_epi32(e, f, g, 0xCA)); \
+    t1_ = _mm512_add_epi32(t1_, _mm512_add_epi32(_mm512_set1_epi32((int)VARIANT_K(i)), (w))); \
+    __m512i t2_ = _mm512_add_epi32(_mm512_ternarylogic_epi32(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13), \
+                                                             _mm512_ror_epi32(a, 22), 0x96), \
+                                   _mm512_ternarylogic_epi32(a, b, c, 0xE8)); \
+    h = g; g = f; f = e; e = _mm512_add_epi32(d, t1_); d = c; c = b; b = a; a = _mm512_add_epi32(t1_, t2_); \
+} while (0)
+#endif // VARIANT_SIMD
+
+/**************************** VARIABLES *****************************/
+
+// Rounds 90..127 (0..89 are k_90r): first 32 bits of the fractional parts of
+// the cube roots of the 91st..128th primes, continuing the SHA-256 derivation
+__attribute__((aligned(64))) static const WORD k_variant_ext[SHA256_90R_VARIANT_MAX_ROUNDS - 90] = {
+    0xc226a69a,0xd304f19a,0xde1be20a,0xe39bb437,0xee84927c,0xf3edd277,
+    0xfbfdfe53,0x0bee2c7a,0x0e90181c,0x25f57204,0x2da45582,0x3a52c34c,0x41dc0172,0x495796fc,
+    0x4bd31fc6,0x533cde21,0x5f7abfe3,0x66c206b3,0x6dfcc6bc,0x7062f20f,0x778d5127,0x7eaba3cc,
+    0x8363eccc,0x85be1c25,0x93c04028,0x9f4a205f,0xa1953565,0xa627bb0f,0xacfa8089,0xb3c29b23,
+    0xb602f6fa,0xc36cee0a,0xc7dc81ee,0xce7b8471,0xd740288c,0xe21dba7a,0xeabbff66,0xf56a9e60
+};
+
+/*********************** KERNEL INSTANTIATIONS **********************/
+#define VARIANT_R 72
+#include "sha256_90r_variant_template.h"
+#define VARIANT_R 80
+#include "sha256_90r_variant_template.h"
+#define VARIANT_R 128
+#include "sha256_90r_variant_template.h"
+
+// The 90-round member is not instantiated: it runs the single-block kernels
+// of sha256.c, block by block on a context holding the chaining state
+static inline void variant_hand_blocks(void (*transform)(struct sha256_90r_internal_ctx *, const BYTE *),
+                                       WORD state[8], const BYTE *data, size_t nblocks)
+{
+    struct sha256_90r_internal_ctx ctx;
+
+    memcpy(ctx.state, state, sizeof(ctx.state));
+    for (; nblocks > 0; nblocks--, data += 64) transform(&ctx, data);
+    memcpy(state, ctx.state, sizeof(ctx.state));
+}
+
+static void variant_hand_scalar(WORD state[8], const BYTE *data, size_t nblocks)
+{
+    variant_hand_blocks(sha256_90r_transform_scalar, state, data, nblocks);
+}
+
+static void variant_hand_rolling(WORD state[8], const BYTE *data, size_t nblocks)
+{
+    variant_hand_blocks(sha256_90r_transform_scalar_rolling, state, data, nblocks);
+}
+
+#ifdef VARIANT_X86
+static void variant_hand_bmi2(WORD state[8], const BYTE *data, size_t nblocks)
+{
+    variant_hand_blocks(sha256_90r_transform_bmi2, state, data, nblocks);
+}
+#endif
+
+#ifdef VARIANT_SIMD
+static void variant_hand_avx2(WORD state[8], const BYTE *data, size_t nblocks)
+{
+    variant_hand_blocks(sha256_90r_transform_avx2, state, data, nblocks);
+}
+#endif
+
+/**************************** DATA TYPES ****************************/
+typedef void (*variant_blocks_fn)(WORD state[8], const BYTE *data, size_t nblocks);
+typedef void (*variant_lanes8_fn)(WORD state[8][8], const BYTE *const blocks[8]);
+typedef void (*variant_lanes16_fn)(WORD state[8][16], const BYTE *const blocks[16]);
+
+struct sha256_90r_variant {
+    int rounds;
+    const char *name;
+    variant_blocks_fn scalar;
+    variant_blocks_fn rolling;
+    variant_blocks_fn bmi2;             // NULL where not built
+    variant_blocks_fn avx2;
+    variant_lanes8_fn lanes8;
+    variant_lanes16_fn lanes16;
+};
+
+#ifdef VARIANT_X86
+#define VARIANT_BMI2_FN(r) variant_bmi2_r##r
+#else
+#define VARIANT_BMI2_FN(r) NULL
+#endif
+#ifdef VARIANT_SIMD
+#define VARIANT_SIMD_FNS(r) variant_avx2_r##r, variant_avx2_8way_r##r, variant_avx512_16way_r##r
+#else
+#define VARIANT_SIMD_FNS(r) NULL, NULL, NULL
+#endif
+#define VARIANT_ENTRY(r) \
+    { r, "SHA256-" #r "R", variant_scalar_r##r, variant_rolling_r##r, VARIANT_BMI2_FN(r), VARIANT_SIMD_FNS(r) }
+
+// SHA256-90R itself: the hand-written kernels of sha256.c (variant_hand_*)
+#ifdef VARIANT_X86
+#define VARIANT_HAND_BMI2 variant_hand_bmi2
+#else
+#define VARIANT_HAND_BMI2 NULL
+#endif
+#ifdef VARIANT_SIMD
+#define VARIANT_HAND_SIMD variant_hand_avx2, SHA256_90R_LANE_KERNELS
+#else
+#define VARIANT_HAND_SIMD NULL, NULL, NULL
+#endif
+#define VARIANT_HAND_ENTRY \
+    { 90, "SHA256-90R", variant_hand_scalar, variant_hand_rolling, VARIANT_HAND_BMI2, VARIANT_HAND_SIMD }
+
+static const struct sha256_90r_variant g_variants[] = {
+    VARIANT_ENTRY(72),
+    VARIANT_ENTRY(80),
+    VARIANT_HAND_ENTRY,
+    VARIANT_ENTRY(128),
+};
+#define NUM_VARIANTS (sizeof(g_variants) / sizeof(g_variants[0]))
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+
+// Single-stream kernel of v, or NULL if the form is not built or not supported here
+static variant_blocks_fn variant_blocks(const sha256_90r_variant_t *v, sha256_90r_kernel_t kernel)
+{
+    if (!sha256_90r_kernel_available(kernel)) return NULL;
+    switch (kernel) {
+        case SHA256_90R_KERNEL_SCALAR:         return v->scalar;
+        case SHA256_90R_KERNEL_SCALAR_ROLLING: return v->rolling;
+        case SHA256_90R_KERNEL_SCALAR_BMI2:    return v->bmi2;
+        case SHA256_90R_KERNEL_AVX2:           return v->avx2;
+        default:                               return NULL;
+    }
+}
+
+static void variant_reset(sha256_90r_variant_ctx_t *ctx)
+{
+    struct sha256_90r_internal_ctx iv;
+
+    sha256_90r_init_internal(&iv);
+    memcpy(ctx->state, iv.state, sizeof(ctx->state));
+    ctx->bitlen = 0;
+    ctx->datalen = 0;
+}
+
+// Last partial block, 0x80 and the bit length in one or two blocks; returns the count
+static size_t variant_pad_tail(BYTE tail[128], const BYTE *msg, size_t len)
+{
+    size_t rem = len % 64;
+    size_t n = rem < 56 ? 1 : 2;
+    uint64_t bits = (uint64_t)len * 8;
+
+    memset(tail, 0, 128);
+    if (rem) memcpy(tail, msg + len - rem, rem);
+    tail[rem] = 0x80;
+    for (int i = 0; i < 8; i++) tail[64 * n - 1 - i] = (BYTE)(bits >> (8 * i));
+    return n;
+}
+
+// Best single-stream kernel of v on this CPU
+static variant_blocks_fn variant_default_blocks(const sha256_90r_variant_t *v)
+{
+    variant_blocks_fn blocks = variant_blocks(v, (sha256_90r_kernel_t)sha256_90r_transform_default());
+    return blocks ? blocks : v->scalar;
+}
+
+// One batch message in a lane: whole blocks from the caller, then the padded tail
+typedef struct {
+    size_t index;               // Message number
+    const BYTE *msg;
+    size_t full;                // Whole message blocks
+    size_t nblocks;             // full + tail blocks
+    size_t next;                // Next block to compress
+    BYTE tail[128];
+} variant_lane_t;
+
+// A batch on the lanes (sha256_90r_lanes_run callbacks' arg)
+typedef struct {
+    variant_blocks_fn single;   // Finishes the last message
+    const uint8_t **messages;
+    const size_t *lengths;
+    uint8_t **hashes;
+    variant_lane_t lane[SHA256_90R_MAX_LANES];
+} variant_batch_t;
+
+static void variant_batch_start(void *arg, int l, size_t index)
+{
+    variant_batch_t *batch = arg;
+    variant_lane_t *lane = &batch->lane[l];
+
+    lane->index = index;
+    lane->msg = batch->messages[index];
+    lane->full = batch->lengths[index] / 64;
+    lane->nblocks = lane->full + variant_pad_tail(lane->tail, lane->msg, batch->lengths[index]);
+    lane->next = 0;
+}
+
+static const BYTE *variant_batch_next(void *arg, int l, int *last)
+{
+    variant_lane_t *lane = &((variant_batch_t *)arg)->lane[l];
+    const BYTE *block = lane->next < lane->full ? lane->msg + 64 * lane->next
+                                                : lane->tail + 64 * (lane->next - lane->full);
+
+    *last = ++lane->next == lane->nblocks;
+    return block;
+}
+
+static void variant_batch_done(void *arg, int l, const WORD state[8])
+{
+    variant_batch_t *batch = arg;
+    sha256_90r_store_digest(state, batch->hashes[batch->lane[l].index]);
+}
+
+// The last message: its remaining whole blocks in one call, then the tail
+static void variant_batch_finish(void *arg, int l, const WORD lane_state[8])
+{
+    variant_batch_t *batch = arg;
+    variant_lane_t *lane = &batch->lane[l];
+    WORD state[8];
+
+    memcpy(state, lane_state, sizeof(state));
+    if (lane->next < lane->full) {
+        batch->single(state, lane->msg + 64 * lane->next, lane->full - lane->next);
+        lane->next = lane->full;
+    }
+    batch->single(state, lane->tail + 64 * (lane->next - lane->full), lane->nblocks - lane->next);
+    sha256_90r_store_digest(state, batch->hashes[lane->index]);
+}
+
+static const sha256_90r_lane_ops_t variant_lane_ops = {
+    variant_batch_start, variant_batch_next, variant_batch_done, variant_batch_finish
+};
+
+/*************************** PUBLIC API ***************************/
+
+size_t sha256_90r_variant_count(void)
+{
+    return NUM_VARIANTS;
+}
+
+const sha256_90r_variant_t* sha256_90r_variant_get(size_t index)
+{
+    return index < NUM_VARIANTS ? &g_variants[index] : NULL;
+}
+
+const sha256_90r_variant_t* sha256_90r_variant_find(int rounds)
+{
+    for (size_t i = 0; i < NUM_VARIANTS; i++) {
+        if (g_variants[i].rounds == rounds) return &g_variants[i];
+    }
+    return NULL;
+}
+
+int sha256_90r_variant_rounds(const sha256_90r_variant_t* v)
+{
+    return v ? v->rounds : 0;
+}
+
+const char* sha256_90r_variant_name(const sha256_90r_variant_t* v)
+{
+    return v ? v->name : NULL;
+}
+
+int sha256_90r_variant_kernel_available(const sha256_90r_variant_t* v, sha256_90r_kernel_t kernel)
+{
+    if (!v || !sha256_90r_kernel_available(kernel)) return 0;
+    switch (kernel) {
+        case SHA256_90R_KERNEL_AVX2_8WAY:    return v->lanes8 != NULL;
+        case SHA256_90R_KERNEL_AVX512_16WAY: return v->lanes16 != NULL;
+        default:                             return variant_blocks(v, kernel) != NULL;
+    }
+}
+
+int sha256_90r_variant_init(sha256_90r_variant_ctx_t* ctx, const sha256_90r_variant_t* v)
+{
+    if (!ctx || !v) return -1;
+    ctx->variant = v;
+    // Same CPUID default as sha256_90r_hash() before tuning
+    ctx->kernel = (sha256_90r_kernel_t)sha256_90r_transform_default();
+    if (!variant_blocks(v, ctx->kernel)) ctx->kernel = SHA256_90R_KERNEL_SCALAR;
+    variant_reset(ctx);
+    return 0;
+}
+
+int sha256_90r_variant_set_kernel(sha256_90r_variant_ctx_t* ctx, sha256_90r_kernel_t kernel)
+{
+    if (!ctx || !ctx->variant || !variant_blocks(ctx->variant, kernel)) return -1;
+    ctx->kernel = kernel;
+    return 0;
+}
+
+int sha256_90r_variant_update(sha256_90r_variant_ctx_t* ctx, const void* data, size_t len)
+{
+    const BYTE *p = (const BYTE *)data;
+    variant_blocks_fn blocks;
+    size_t n;
+
+    if (!ctx || !ctx->variant || (!data && len > 0)) return -1;
+    blocks = variant_blocks(ctx->variant, ctx->kernel);
+    if (!blocks) return -1;
+
+    if (ctx->datalen > 0) {
+        size_t take = 64 - ctx->datalen;
+        if (take > len) take = len;
+        memcpy(ctx->data + ctx->datalen, p, take);
+        ctx->datalen += (uint32_t)take;
+        p += take;
+        len -= take;
+        if (ctx->datalen < 64) return 0;
+        blocks(ctx->state, ctx->data, 1);
+        ctx->bitlen += 512;
+        ctx->datalen = 0;
+    }
+    // Whole blocks straight from the caller's buffer
+    n = len / 64;
+    if (n > 0) {
+        blocks(ctx->state, p, n);
+        ctx->bitlen += (uint64_t)n * 512;
+        p += n * 64;
+        len -= n * 64;
+    }
+    if (len > 0) {
+        memcpy(ctx->data, p, len);
+        ctx->datalen = (uint32_t)len;
+    }
+    return 0;
+}
+
+int sha256_90r_variant_final(sha256_90r_variant_ctx_t* ctx, uint8_t hash[SHA256_90R_DIGEST_SIZE])
+{
+    BYTE tail[128];
+    variant_blocks_fn blocks;
+    uint64_t bits;
+    size_t n;
+
+    if (!ctx || !ctx->variant || !hash) return -1;
+    blocks = variant_blocks(ctx->variant, ctx->kernel);
+    if (!blocks) return -1;
+
+    // Buffered bytes, 0x80 and the bit length of bitlen / 8 + datalen bytes
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, ctx->data, ctx->datalen);
+    tail[ctx->datalen] = 0x80;
+    n = ctx->datalen < 56 ? 1 : 2;
+    bits = ctx->bitlen + (uint64_t)ctx->datalen * 8;
+    for (int i = 0; i < 8; i++) tail[64 * n - 1 - i] = (BYTE)(bits >> (8 * i));
+    blocks(ctx->state, tail, n);
+    sha256_90r_store_digest(ctx->state, hash);
+    variant_reset(ctx);
+    return 0;
+}
+
+int sha256_90r_variant_hash(const sha256_90r_variant_t* v, const void* data, size_t len,
+                            uint8_t hash[SHA256_90R_DIGEST_SIZE])
+{
+    sha256_90r_variant_ctx_t ctx;
+
+    if (!hash || sha256_90r_variant_init(&ctx, v) != 0) return -1;
+    if (sha256_90r_variant_update(&ctx, data, len) != 0) return -1;
+    return sha256_90r_variant_final(&ctx, hash);
+}
+
+int sha256_90r_variant_batch(const sha256_90r_variant_t* v, const uint8_t** messages, const size_t* lengths,
+                             uint8_t** hashes, size_t count)
+{
+    variant_batch_t batch;
+    int lanes;
+
+    if (!v || (count > 0 && (!messages || !lengths || !hashes))) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if ((!messages[i] && lengths[i] > 0) || !hashes[i]) return -1;
+    }
+
+    lanes = sha256_90r_lane_width();
+    if (lanes == 1 || count < 2) {
+        for (size_t i = 0; i < count; i++) sha256_90r_variant_hash(v, messages[i], lengths[i], hashes[i]);
+        return 0;
+    }
+    batch.single = variant_default_blocks(v);
+    batch.messages = messages;
+    batch.lengths = lengths;
+    batch.hashes = hashes;
+    sha256_90r_lanes_run(lanes, v->lanes8, v->lanes16, &variant_lane_ops, &batch, count);
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*********************************************************************
+* Filename:   sha256_90r_variant_template.h
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Kernel template for the round-count variants. Included by
+*             sha256_90r_variant.c once per round count with VARIANT_R
+*             defined; every inclusion emits the full kernel set for that
+*             count (pre-expanded, rolling and BMI2 scalar, AVX2 schedule,
+*             AVX2 8-lane, AVX-512 16-lane), named variant_<form>_r<R>.
+*             Loop bounds are the constant VARIANT_R, so each instantiation
+*             is unrolled into straight-line code exactly like the
+*             hand-written 90-round kernels in sha256.c. No include guard:
+*             this file is meant to be included repeatedly.
+*********************************************************************/
+
+#ifndef VARIANT_R
+#error "define VARIANT_R before including sha256_90r_variant_template.h"
+#endif
+#if VARIANT_R < 16 || VARIANT_R > SHA256_90R_VARIANT_MAX_ROUNDS || VARIANT_R % 2 != 0
+#error "VARIANT_R must be even and within 16..SHA256_90R_VARIANT_MAX_ROUNDS"
+#endif
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+
+// Pre-expanded schedule (SHA256_90R_KERNEL_SCALAR)
+__attribute__((optimize("O3", "unroll-loops", "inline-functions")))
+static void VARIANT_FN(scalar)(WORD state[8], const BYTE *data, size_t nblocks)
+{
+    for (; nblocks > 0; nblocks--, data += 64) {
+        WORD m[VARIANT_R];
+        WORD a, b, c, d, e, f, g, h, t1, t2;
+        int i;
+
+        for (i = 0; i < 16; i++) m[i] = VARIANT_LOAD_BE32(data + 4 * i);
+#pragma GCC unroll 128
+        for (i = 16; i < VARIANT_R; i++) m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+#pragma GCC unroll 128
+        for (i = 0; i < VARIANT_R; i++) {
+            VARIANT_ROUND(i, m[i]);
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+// 16-word rolling schedule (SHA256_90R_KERNEL_SCALAR_ROLLING)
+__attribute__((optimize("O3", "unroll-loops", "inline-functions")))
+static void VARIANT_FN(rolling)(WORD state[8], const BYTE *data, size_t nblocks)
+{
+    for (; nblocks > 0; nblocks--, data += 64) {
+        WORD w[16];
+        WORD a, b, c, d, e, f, g, h, t1, t2;
+        int i;
+
+        for (i = 0; i < 16; i++) w[i] = VARIANT_LOAD_BE32(data + 4 * i);
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+#pragma GCC unroll 128
+        for (i = 0; i < VARIANT_R; i++) {
+            if (i >= 16)
+                w[i & 15] += SIG1(w[(i - 2) & 15]) + w[(i - 7) & 15] + SIG0(w[(i - 15) & 15]);
+            VARIANT_ROUND(i, w[i & 15]);
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#ifdef VARIANT_X86
+// rorx/andn rounds in renamed pairs (SHA256_90R_KERNEL_SCALAR_BMI2); eight
+// rounds bring the names back to a..h, the last R % 8 are spelled out
+__attribute__((target("bmi,bmi2"), optimize("O3", "unroll-loops")))
+static void VARIANT_FN(bmi2)(WORD state[8], const BYTE *data, size_t nblocks)
+{
+    for (; nblocks > 0; nblocks--, data += 64) {
+        WORD w[16];
+        WORD a, b, c, d, e, f, g, h, t, bc;
+        int i;
+
+        for (i = 0; i < 16; i++) w[i] = VARIANT_LOAD_BE32(data + 4 * i);
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+        bc = b ^ c;
+
+#pragma GCC unroll 16
+        for (i = 0; i + 8 <= VARIANT_R; i += 8) {
+            VARIANT_ROUNDS2(a, b, c, d, e, f, g, h, i);
+            VARIANT_ROUNDS2(g, h, a, b, c, d, e, f, i + 2);
+            VARIANT_ROUNDS2(e, f, g, h, a, b, c, d, i + 4);
+            VARIANT_ROUNDS2(c, d, e, f, g, h, a, b, i + 6);
+        }
+#if VARIANT_R % 8 == 0
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+#elif VARIANT_R % 8 == 2
+        VARIANT_ROUNDS2(a, b, c, d, e, f, g, h, VARIANT_R - 2);
+        state[0] += g; state[1] += h; state[2] += a; state[3] += b;
+        state[4] += c; state[5] += d; state[6] += e; state[7] += f;
+#elif VARIANT_R % 8 == 4
+        VARIANT_ROUNDS2(a, b, c, d, e, f, g, h, VARIANT_R - 4);
+        VARIANT_ROUNDS2(g, h, a, b, c, d, e, f, VARIANT_R - 2);
+        state[0] += e; state[1] += f; state[2] += g; state[3] += h;
+        state[4] += a; state[5] += b; state[6] += c; state[7] += d;
+#else
+        VARIANT_ROUNDS2(a, b, c, d, e, f, g, h, VARIANT_R - 6);
+        VARIANT_ROUNDS2(g, h, a, b, c, d, e, f, VARIANT_R - 4);
+        VARIANT_ROUNDS2(e, f, g, h, a, b, c, d, VARIANT_R - 2);
+        state[0] += c; state[1] += d; state[2] += e; state[3] += f;
+        state[4] += g; state[5] += h; state[6] += a; state[7] += b;
+#endif
+    }
+}
+#endif // VARIANT_X86
+
+#ifdef VARIANT_SIMD
+// Schedule expanded four words per step, scalar rounds (SHA256_90R_KERNEL_AVX2)
+__attribute__((target("avx2")))
+static void VARIANT_FN(avx2)(WORD state[8], const BYTE *data, size_t nblocks)
+{
+    for (; nblocks > 0; nblocks--, data += 64) {
+        WORD m[VARIANT_R] __attribute__((aligned(32)));
+        WORD a, b, c, d, e, f, g, h, t1, t2;
+        int i;
+
+        for (i = 0; i < 16; i++) m[i] = VARIANT_LOAD_BE32(data + 4 * i);
+        for (i = 16; i + 4 <= VARIANT_R; i += 4) VARIANT_EXPAND4(m, i);
+        for (; i < VARIANT_R; i++) m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+#pragma GCC unroll 128
+        for (i = 0; i < VARIANT_R; i++) {
+            VARIANT_ROUND(i, m[i]);
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+// Eight lanes, one block each, word-major state (SHA256_90R_KERNEL_AVX2_8WAY)
+__attribute__((target("avx2")))
+static void VARIANT_FN(avx2_8way)(WORD state[8][8], const BYTE *const blocks[8])
+{
+    __m256i w[16], s[8];
+    int i;
+
+    sha256_90r_load_msg_8way(blocks, w);
+    for (i = 0; i < 8; i++) s[i] = _mm256_loadu_si256((const __m256i *)state[i]);
+    {
+        __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+#pragma GCC unroll 128
+        for (i = 0; i < VARIANT_R; i++) {
+            if (i >= 16) {
+                w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], MM256_90R_SIG0(w[(i - 15) & 15])),
+                                             _mm256_add_epi32(w[(i - 7) & 15], MM256_90R_SIG1(w[(i - 2) & 15])));
+            }
+            VMM256_ROUND(i, w[i & 15]);
+        }
+        s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+        s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+        s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+        s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+    }
+    for (i = 0; i < 8; i++) _mm256_storeu_si256((__m256i *)state[i], s[i]);
+}
+
+// Sixteen lanes (SHA256_90R_KERNEL_AVX512_16WAY; AVX-512F checked by the caller)
+__attribute__((target("avx512f")))
+static void VARIANT_FN(avx512_16way)(WORD state[8][16], const BYTE *const blocks[16])
+{
+    __m512i w[16], s[8];
+    int i;
+
+    sha256_90r_load_msg_16way(blocks, w);
+    for (i = 0; i < 8; i++) s[i] = _mm512_loadu_si512((const void *)state[i]);
+    {
+        __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+#pragma GCC unroll 128
+        for (i = 0; i < VARIANT_R; i++) {
+            if (i >= 16) {
+                w[i & 15] = _mm512_add_epi32(_mm512_add_epi32(w[i & 15], MM512_90R_SIG0(w[(i - 15) & 15])),
+                                             _mm512_add_epi32(w[(i - 7) & 15], MM512_90R_SIG1(w[(i - 2) & 15])));
+            }
+            VMM512_ROUND(i, w[i & 15]);
+        }
+        s[0] = _mm512_add_epi32(s[0], a); s[1] = _mm512_add_epi32(s[1], b);
+        s[2] = _mm512_add_epi32(s[2], c); s[3] = _mm512_add_epi32(s[3], d);
+        s[4] = _mm512_add_epi32(s[4], e); s[5] = _mm512_add_epi32(s[5], f);
+        s[6] = _mm512_add_epi32(s[6], g); s[7] = _mm512_add_epi32(s[7], h);
+    }
+    for (i = 0; i < 8; i++) _mm512_storeu_si512((void *)state[i], s[i]);
+}
+#endif // VARIANT_SIMD
+
+#undef VARIANT_R
@@ -26,15 +26,150 @@ struct sha256_90r_internal_ctx {
 	WORD state[8];
 };
 
+#ifdef SHA256_90R_PUBLIC_H
+// Public context wrapper (opaque SHA256_90R_CTX in sha256_90r.h). Defined here so
+// that library modules other than sha256_90r.c can reach the internal state.
+struct sha256_90r_ctx {
+	struct sha256_90r_internal_ctx internal_ctx;
+	sha256_90r_mode_t mode;
+	sha256_90r_backend_t backend;
+};
+#endif
+
+/*************************** ROUND MACROS ***************************/
+// SHA-256 round functions, shared by every module that runs the rounds in scalar code
+#define ROTRIGHT(a,b) (((a) >> (b)) | ((a) << (32-(b))))
+
+#define CH(x,y,z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x,y,z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define EP0(x) (ROTRIGHT(x,2) ^ ROTRIGHT(x,13) ^ ROTRIGHT(x,22))
+#define EP1(x) (ROTRIGHT(x,6) ^ ROTRIGHT(x,11) ^ ROTRIGHT(x,25))
+#define SIG0(x) (ROTRIGHT(x,7) ^ ROTRIGHT(x,18) ^ ((x) >> 3))
+#define SIG1(x) (ROTRIGHT(x,17) ^ ROTRIGHT(x,19) ^ ((x) >> 10))
+
+// Vector forms for the lane kernels. Expand only in code compiled for AVX2
+// (MM256_*) or AVX-512F (MM512_*) with <immintrin.h> included.
+#define MM256_ROTR(x,n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define MM256_90R_SIG0(x) _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(x, 7), MM256_ROTR(x, 18)), \
+                                           _mm256_srli_epi32(x, 3))
+#define MM256_90R_SIG1(x) _mm256_xor_si256(_mm256_xor_si256(MM256_ROTR(x, 17), MM256_ROTR(x, 19)), \
+                                           _mm256_srli_epi32(x, 10))
+// 0x96 = x ^ y ^ z in ternary logic
+#define MM512_90R_SIG0(x) _mm512_ternarylogic_epi32(_mm512_ror_epi32(x, 7), _mm512_ror_epi32(x, 18), \
+                                                    _mm512_srli_epi32(x, 3), 0x96)
+#define MM512_90R_SIG1(x) _mm512_ternarylogic_epi32(_mm512_ror_epi32(x, 17), _mm512_ror_epi32(x, 19), \
+                                                    _mm512_srli_epi32(x, 10), 0x96)
+
+/*************************** INTERNAL CONSTANTS ***********************/
+// SHA256-90R round constants, shared by every module that runs its rounds.
+// Defined here rather than exported so that unrolled kernels can still fold
+// them into immediates.
+__attribute__((aligned(64))) static const WORD k_90r[96] = { // Padded to multiple of 32 for AVX-512
+	0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+	0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+	0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+	0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+	0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+	0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+	0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+	0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2,
+	// Extended constants for SHA-256-90R (optimized sequence)
+	0xc67178f2,0xca273ece,0xd186b8c7,0xeada7dd6,0xf57d4f7f,0x06f067aa,0x0a637dc5,0x113f9804,
+	0x1b710b35,0x28db77f5,0x32caab7b,0x3c9ebe0a,0x431d67c4,0x4cc5d4be,0x597f299c,0x5fcb6fab,
+	0x6c44198c,0x7ba0ea2d,0x7eabf2d0,0x8dbe8d03,0x90bb1721,0x99a2ad45,0x9f86e289,0xa84c4472,
+	0xb3df34fc,0xb99bb8d7,
+	// Padding for alignment (used for SIMD register spills)
+	0x00000000,0x00000000,0x00000000,0x00000000,0x00000000,0x00000000
+};
+
 /*************************** INTERNAL FUNCTIONS ***********************/
 // Internal function declarations (implementation details only)
 // Note: Public API functions are declared in sha256_90r.h, not here
 void sha256_90r_init_internal(struct sha256_90r_internal_ctx *ctx);
 void sha256_90r_update_internal(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len);
-void sha256_90r_update_fast(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len);
+// update_internal that also copies data to dst (sha256_90r_copy_update)
+void sha256_90r_copy_update_internal(struct sha256_90r_internal_ctx *ctx, BYTE dst[], const BYTE src[], size_t len);
+// len zero bytes through the zero-schedule transform (file holes)
+void sha256_90r_update_zeros_internal(struct sha256_90r_internal_ctx *ctx, unsigned long long len);
+// update_internal for file data; zero blocks skip the schedule outside SECURE mode
+void sha256_90r_update_sparse_internal(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len);
 void sha256_90r_final_internal(struct sha256_90r_internal_ctx *ctx, BYTE hash[]);
 void sha256_90r_transform(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
+
+// Zero memory that held key material. The volatile stores keep the compiler
+// from dropping the writes to memory about to be freed or reused.
+static inline void sha256_90r_wipe(void *p, size_t n)
+{
+	volatile BYTE *v = (volatile BYTE *)p;
+	while (n--) *v++ = 0;
+}
+
+// Kernel behind sha256_90r_transform's scalar path (sha256_90r_kernel_t); -1 if unknown
+int sha256_90r_transform_select(int kernel);
+// Kernel used until one is selected: AVX2 in FAST builds, else SCALAR_BMI2 if
+// CPUID reports BMI1+BMI2
+int sha256_90r_transform_default(void);
+
+// Autotune plan as seen by the other modules (defaults until tuned; see sha256_90r_tune.c)
+int sha256_90r_tune_mb_lanes(void);                 // 0 = widest supported
+size_t sha256_90r_tune_chunk_size(void);
+size_t sha256_90r_tune_batch_min(void);
+double sha256_90r_tune_backend_gbps(int backend);   // Tunes on first use
+
+// Energy counter delta across at most one wrap at range (sha256_90r_power.c).
+// Returns -1 if the counter went backwards and range is unknown (0).
+int sha256_90r_energy_delta(uint64_t start, uint64_t now, uint64_t range, uint64_t *delta);
+
+// Streaming mode for large updates (see sha256_90r_set_streaming)
+#define SHA256_90R_STREAM_DEFAULT_DISTANCE 256
+#define SHA256_90R_STREAM_FALLBACK_THRESHOLD (8u << 20)     // When the LLC size is unknown
+void sha256_90r_stream_config(size_t threshold, size_t prefetch_distance, int hints);
+void sha256_90r_stream_get_config(size_t *threshold, size_t *prefetch_distance, int *hints);
 void sha256_90r_transform_scalar(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
+void sha256_90r_transform_scalar_rolling(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+// rorx/andn rounds; BMI1 and BMI2 required at run time
+void sha256_90r_transform_bmi2(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
+#endif
+
+// Dual digest: one message schedule drives the SHA-256 and SHA-256-90R chains.
+// shared != 0 is only valid while both states are equal (first block of a
+// message); one chain then runs to round 63 and is forked for SHA-256.
+void sha256_90r_dual_transform(WORD state_256[8], WORD state_90r[8], const BYTE data[], int shared);
+void sha256_90r_dual_batch_internal(const BYTE *const data[], const size_t lens[],
+                                    BYTE (*hashes_256)[32], BYTE (*hashes_90r)[32], size_t count);
+
+// Multi-lane batches (sha256_90r_mb.c). Lane states are word-major: word w of
+// lane l is st[w * lanes + l], so the lane kernels see state[8][lanes].
+#define SHA256_90R_MAX_LANES 16
+#define SHA256_90R_LANE_STATE(st, lanes, w, l) ((st)[(w) * (lanes) + (l)])
+
+typedef void (*sha256_90r_lanes8_fn)(WORD state[8][8], const BYTE *const blocks[8]);
+typedef void (*sha256_90r_lanes16_fn)(WORD state[8][16], const BYTE *const blocks[16]);
+
+// Callbacks of sha256_90r_lanes_run(); arg is the caller's, l the lane
+typedef struct {
+	void (*start)(void *arg, int l, size_t index);          // Lane l takes message `index`
+	const BYTE *(*next)(void *arg, int l, int *last);       // Next block; *last = 1 on the final one
+	void (*done)(void *arg, int l, const WORD state[8]);    // Lane l's message is fully compressed
+	void (*finish)(void *arg, int l, const WORD state[8]);  // Compress the rest single-stream
+} sha256_90r_lane_ops_t;
+
+// Big-endian digest of a chaining state
+void sha256_90r_store_digest(const WORD state[8], BYTE hash[32]);
+// Lane width for a batch: the tuned multi-buffer width, else the widest; 1 = no lanes
+int sha256_90r_lane_width(void);
+// Hash messages 0..count-1 `lanes` (8 or 16) at a time. A lane whose message
+// ends takes the next one at once, idle lanes hash a zero block, and the last
+// message goes to ops->finish instead of one lane of a wide call.
+void sha256_90r_lanes_run(int lanes, sha256_90r_lanes8_fn kernel8, sha256_90r_lanes16_fn kernel16,
+                          const sha256_90r_lane_ops_t *ops, void *arg, size_t count);
+// SHA256-90R's own lane kernels as the kernel8, kernel16 arguments
+#if defined(USE_SIMD) && defined(__x86_64__)
+#define SHA256_90R_LANE_KERNELS sha256_90r_blocks_avx2_8way, sha256_90r_blocks_avx512_16way
+#else
+#define SHA256_90R_LANE_KERNELS NULL, NULL
+#endif
 
 #ifdef USE_SIMD
 void sha256_90r_transform_simd(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
@@ -43,8 +178,18 @@ void sha256_90r_transform_avx512(struct sha256_90r_internal_ctx *ctx, const BYTE
 void sha256_90r_transform_neon(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
 void sha256_90r_transform_avx2_4way(WORD states[4][8], const BYTE data[4][64]);
 void sha256_90r_transform_avx2_8way(struct sha256_90r_internal_ctx ctxs[8], const BYTE data[8][64]);
-#ifdef __AVX512F__
+void sha256_90r_transform_avx2_8way_rolling(struct sha256_90r_internal_ctx ctxs[8], const BYTE data[8][64]);
+// AVX-512F required at run time
 void sha256_90r_transform_avx512_16way(struct sha256_90r_internal_ctx ctxs[16], const BYTE data[16][64]);
+void sha256_90r_transform_avx512_16way_rolling(struct sha256_90r_internal_ctx ctxs[16], const BYTE data[16][64]);
+// Word-major lane kernels (state[word][lane], one block pointer per lane)
+void sha256_90r_blocks_avx2_8way(WORD state[8][8], const BYTE *const blocks[8]);
+void sha256_90r_blocks_avx512_16way(WORD state[8][16], const BYTE *const blocks[16]);
+#ifdef __x86_64__
+#include <immintrin.h>
+// Message words 0..15 of 8/16 blocks, word-major and byte-swapped (AVX2 / AVX-512F)
+void sha256_90r_load_msg_8way(const BYTE *const blocks[8], __m256i w[16]);
+void sha256_90r_load_msg_16way(const BYTE *const blocks[16], __m512i w[16]);
 #endif
 #endif
 
@@ -63,22 +208,6 @@ void sha256_90r_transform_pipelined(struct sha256_90r_internal_ctx *ctx, const B
 void sha256_90r_transform_parallel(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len, int num_threads);
 void sha256_90r_update_parallel(struct sha256_90r_internal_ctx *ctx, const BYTE data[], size_t len, int num_threads);
 
-#ifdef USE_TREE_HASHING
-typedef struct {
-	size_t chunk_size;
-	int max_threads;
-	struct sha256_90r_internal_ctx **contexts;
-	BYTE **intermediate_hashes;
-	size_t num_chunks;
-	size_t processed_bytes;
-} SHA256_90R_TREE_CTX;
-
-void sha256_90r_tree_hash(const BYTE *data, size_t len, BYTE hash[], size_t chunk_size, int max_threads);
-void sha256_90r_tree_hash_init(SHA256_90R_TREE_CTX *ctx, size_t chunk_size, int max_threads);
-void sha256_90r_tree_hash_update(SHA256_90R_TREE_CTX *ctx, const BYTE *data, size_t len);
-void sha256_90r_tree_hash_final(SHA256_90R_TREE_CTX *ctx, BYTE hash[]);
-#endif
-
 #ifdef USE_SHA_NI
 void sha256_90r_transform_sha_ni(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
 #endif
@@ -88,6 +217,37 @@ void sha256_90r_transform_armv8_crypto(struct sha256_90r_internal_ctx *ctx, cons
 #endif
 
 #ifdef USE_FPGA_PIPELINE
+// Cycle-level pipeline model: ceil(90 / rounds_per_stage) stages, one block
+// issued at most every initiation_interval clocks, one arriving every
+// source_interval clocks.
+typedef struct {
+	int rounds_per_stage;       // Unroll factor U (1..90)
+	int initiation_interval;    // Clocks between issues into stage 0
+	int source_interval;        // Clocks between block arrivals at the input
+	int use_simd;               // 0 forces the portable stage kernel
+} fpga_sim_config_t;
+
+typedef struct {
+	uint64_t clocks;            // Clocks until the last block retired
+	uint64_t hashes;            // Blocks retired
+	uint64_t busy_stage_clocks; // Sum over clocks of occupied stages
+	uint64_t ii_stalls;         // Clocks a ready block waited on the initiation interval
+	uint64_t bubbles;           // Issue opportunities with no block ready
+	int depth;                  // Pipeline stages
+	double occupancy;           // busy_stage_clocks / (clocks * depth)
+	double hashes_per_clock;    // hashes / clocks
+	double sim_seconds;         // Host time spent simulating
+} fpga_sim_stats_t;
+
+fpga_sim_config_t fpga_sim_config_default(void);
+// Runs num_blocks 64-byte blocks through the pipeline. in_states == NULL starts
+// every block from the IV; out_states (may be NULL) receives the chained state.
+// Returns 0 on success, -1 on invalid configuration or allocation failure.
+int sha256_90r_fpga_simulate(const fpga_sim_config_t *cfg,
+                             const WORD (*in_states)[8],
+                             const BYTE *blocks, size_t num_blocks,
+                             WORD (*out_states)[8],
+                             fpga_sim_stats_t *stats);
 void sha256_90r_transform_fpga(struct sha256_90r_internal_ctx *ctx, const BYTE data[]);
 void print_fpga_analysis(void);
 #endif
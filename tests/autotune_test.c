@@ -0,0 +1,220 @@
+/*********************************************************************
+* Filename:   autotune_test.c
+* Author:     SHA256-90R autotune test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Runs the autotuner against a private cache file and checks
+*             that a matching cache file is applied, that a forced tune is
+*             sane and short, that another process reuses the cached plan
+*             and re-measures a corrupt one, and that digests do not depend
+*             on the tuned kernel, batch threshold or thread count.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0x452821e638d01377ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define NUM_MESSAGES 100
+#define MAX_MSG_LEN 1500
+#define BIG_LEN (3 * 1024 * 1024 + 77)
+#define MAX_TUNE_SECONDS 2.0       // Generous: the target is ~100 ms on an idle machine
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int check_plan(const char* name, const sha256_90r_tune_plan_t* p) {
+    int failures = 0;
+
+    if (p->cpus < 1 || p->max_threads < 1 || p->max_threads > p->cpus || p->bytes_per_thread == 0 ||
+        p->tree_chunk_size == 0 || p->batch_min_count == 0 || p->cpu_model[0] == '\0' ||
+        (p->mb_lanes != 1 && p->mb_lanes != 8 && p->mb_lanes != 16) ||
+        !sha256_90r_kernel_single_stream(p->kernel) || !sha256_90r_kernel_available(p->kernel)) {
+        printf("  FAIL: %s plan out of range\n", name);
+        failures++;
+    }
+    if (p->kernel_gbps <= 0.0 || p->mb_gbps <= 0.0 ||
+        p->backend_gbps[SHA256_90R_BACKEND_SCALAR] <= 0.0 || p->backend_gbps[SHA256_90R_BACKEND_AUTO] <= 0.0) {
+        printf("  FAIL: %s plan is missing measurements\n", name);
+        failures++;
+    }
+    for (int b = 0; b < SHA256_90R_NUM_BACKENDS; b++) {
+        if ((p->backend_gbps[b] > 0.0) != (sha256_90r_backend_available((sha256_90r_backend_t)b) != 0)) {
+            printf("  FAIL: %s backend %d measured %.3f Gbps but available=%d\n", name, b,
+                   p->backend_gbps[b], sha256_90r_backend_available((sha256_90r_backend_t)b));
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static void print_plan(const sha256_90r_tune_plan_t* p) {
+    printf("  cpu: %s (%d online)\n", p->cpu_model, p->cpus);
+    printf("  kernel=%s %.2f Gbps, mb_lanes=%d %.2f Gbps, batch_min=%zu\n",
+           sha256_90r_kernel_name(p->kernel), p->kernel_gbps,
+           p->mb_lanes, p->mb_gbps, p->batch_min_count);
+    printf("  max_threads=%d bytes_per_thread=%zu tree_chunk=%zu tuned in %.1f ms%s\n", p->max_threads,
+           p->bytes_per_thread, p->tree_chunk_size, p->tune_seconds * 1e3, p->from_cache ? " (cached)" : "");
+}
+
+// Digests must not move when the plan changes which path is taken
+static int check_digests(const uint8_t* buf) {
+    const uint8_t* msgs[NUM_MESSAGES];
+    size_t lens[NUM_MESSAGES];
+    uint8_t digests[NUM_MESSAGES][32];
+    uint8_t* outs[NUM_MESSAGES];
+    uint8_t want[32], got[32];
+    int failures = 0;
+
+    for (int i = 0; i < NUM_MESSAGES; i++) {
+        lens[i] = i < 3 ? (size_t)(i * 55 / 2) : next_random() % MAX_MSG_LEN;
+        msgs[i] = buf + next_random() % (BIG_LEN - MAX_MSG_LEN);
+        outs[i] = digests[i];
+    }
+
+    for (int mode = SHA256_90R_MODE_SECURE; mode <= SHA256_90R_MODE_FAST; mode++) {
+        for (size_t count = 1; count <= NUM_MESSAGES; count = count * 3 + 1) {
+            memset(digests, 0, sizeof(digests));
+            sha256_90r_batch(msgs, lens, outs, count, (sha256_90r_mode_t)mode);
+            for (size_t i = 0; i < count; i++) {
+                sha256_90r_hash(msgs[i], lens[i], want);
+                if (memcmp(digests[i], want, 32) != 0) {
+                    if (failures++ < 3) printf("  FAIL: batch mode=%d count=%zu message %zu mismatch\n", mode, count, i);
+                }
+            }
+        }
+    }
+
+    // Tuned thread count and default chunk give the same root as one thread
+    sha256_90r_tree_hash(buf, BIG_LEN, 0, 1, want, NULL);
+    if (sha256_90r_tree_hash(buf, BIG_LEN, 0, 0, got, NULL) != 0 || memcmp(got, want, 32) != 0) {
+        printf("  FAIL: tree root with tuned threads differs\n");
+        failures++;
+    }
+    // The tuned chunk is just another chunk size
+    {
+        sha256_90r_tune_plan_t p;
+        sha256_90r_get_tune_plan(&p);
+        sha256_90r_tree_hash(buf, BIG_LEN, p.tree_chunk_size, 1, want, NULL);
+        if (sha256_90r_tree_hash(buf, BIG_LEN, SHA256_90R_TREE_CHUNK_TUNED, 0, got, NULL) != 0 ||
+            memcmp(got, want, 32) != 0) {
+            printf("  FAIL: SHA256_90R_TREE_CHUNK_TUNED root differs from chunk %zu\n", p.tree_chunk_size);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// Child process: tune once against the cache and report whether it was reused
+static int run_child(void) {
+    sha256_90r_tune_plan_t p;
+    if (sha256_90r_autotune(0, &p) != 0) return 1;
+    return 10 + p.from_cache;
+}
+
+static int spawn_child(void) {
+    int status;
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/proc/self/exe", "autotune_test", "--child", (char*)NULL);
+        _exit(1);
+    }
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status) >= 10 ? WEXITSTATUS(status) - 10 : -1;
+}
+
+static void write_cache(const char* path, const sha256_90r_tune_plan_t* p, int kernel, int batch_min) {
+    FILE* f = fopen(path, "w");
+    if (!f) return;
+    fprintf(f, "# hand-written plan\nversion=%s\ncpu_model=%s\ncpus=%d\nkernel=%d\nmb_lanes=%d\n"
+               "batch_min_count=%d\nmax_threads=%d\nbytes_per_thread=65536\ntree_chunk_size=131072\n",
+            sha256_90r_version(), p->cpu_model, p->cpus, kernel, p->mb_lanes, batch_min, p->cpus);
+    fclose(f);
+}
+
+int main(int argc, char** argv) {
+    char cache[] = "/tmp/sha256_90r_tune_XXXXXX";
+    sha256_90r_tune_plan_t plan;
+    uint8_t* buf = malloc(BIG_LEN);
+    uint8_t untuned[32], got[32];
+    int failed = 0, fd, reused;
+
+    if (argc > 1 && strcmp(argv[1], "--child") == 0) return run_child();
+
+    printf("=== SHA256-90R Autotune Test ===\n");
+    if (!buf || (fd = mkstemp(cache)) < 0) {
+        printf("FAIL: setup\n");
+        return 1;
+    }
+    close(fd);
+    setenv("SHA256_90R_TUNE_CACHE", cache, 1);
+    for (size_t i = 0; i < BIG_LEN; i++) buf[i] = (uint8_t)next_random();
+    sha256_90r_hash(buf, BIG_LEN, untuned);
+
+    // Untuned: defaults, reported as such
+    if (sha256_90r_get_tune_plan(&plan) != -1 || sha256_90r_tune_threads(1) < 1) {
+        printf("  FAIL: untuned plan reported as tuned\n");
+        failed = 1;
+    }
+
+    // A matching cache file is applied as-is: rolling kernel, lanes for every batch
+    write_cache(cache, &plan, SHA256_90R_KERNEL_SCALAR_ROLLING, 1);
+    if (sha256_90r_autotune(0, &plan) != 0 || !plan.from_cache || plan.kernel != SHA256_90R_KERNEL_SCALAR_ROLLING ||
+        plan.batch_min_count != 1 || plan.tree_chunk_size != 131072) {
+        printf("  FAIL: hand-written cache not applied\n");
+        failed = 1;
+    }
+    sha256_90r_hash(buf, BIG_LEN, got);
+    if (memcmp(got, untuned, 32) != 0) {
+        printf("  FAIL: digest changed under the rolling kernel\n");
+        failed = 1;
+    }
+    failed |= check_digests(buf) != 0;
+
+    // Forced: measured, sane, short, and written back
+    if (sha256_90r_autotune(SHA256_90R_TUNE_FORCE, &plan) != 0 || plan.from_cache) {
+        printf("  FAIL: forced autotune did not measure\n");
+        failed = 1;
+    } else {
+        print_plan(&plan);
+        failed |= check_plan("measured", &plan);
+        if (plan.tune_seconds > MAX_TUNE_SECONDS) {
+            printf("  FAIL: tuning took %.3f s\n", plan.tune_seconds);
+            failed = 1;
+        }
+    }
+    sha256_90r_hash(buf, BIG_LEN, got);
+    if (memcmp(got, untuned, 32) != 0) {
+        printf("  FAIL: digest changed under the measured plan\n");
+        failed = 1;
+    }
+    failed |= check_digests(buf) != 0;
+
+    // Another process reuses the file; a corrupt file is re-measured
+    reused = spawn_child();
+    printf("  second process: %s\n", reused == 1 ? "plan loaded from cache" : "re-measured");
+    if (reused != 1) failed = 1;
+    write_cache(cache, &plan, 7, 1);
+    reused = spawn_child();
+    printf("  corrupt cache:  %s\n", reused == 0 ? "rejected, re-measured" : "used");
+    if (reused != 0) failed = 1;
+
+    {
+        double scalar = sha256_90r_backend_performance(SHA256_90R_BACKEND_SCALAR);
+        double gpu = sha256_90r_backend_performance(SHA256_90R_BACKEND_GPU);
+        if (scalar <= 0.0 || (gpu > 0.0) != (sha256_90r_backend_available(SHA256_90R_BACKEND_GPU) != 0)) {
+            printf("  FAIL: backend_performance scalar=%.3f gpu=%.3f\n", scalar, gpu);
+            failed = 1;
+        }
+    }
+
+    unlink(cache);
+    printf("%s\n", failed ? "Autotune test FAILED" : "Autotune test PASSED");
+    free(buf);
+    return failed ? 1 : 0;
+}
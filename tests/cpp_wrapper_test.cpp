@@ -0,0 +1,123 @@
+/*********************************************************************
+* Filename:   cpp_wrapper_test.cpp
+* Author:     SHA256-90R C++ wrapper test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks sha256_90r.hpp against the C API: digests folded at
+*             compile time (static_assert on the self-test vector), the
+*             constexpr path at run time across padding boundaries, and the
+*             move-only hasher over uneven pieces, after a move, and with
+*             the span overloads when built as C++20.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "../src/sha256_90r/sha256_90r.hpp"
+#define TEST_RNG_SEED 0x13198a2e03707344ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define MAX_LEN 300
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Compile time: the self-test vector for "abc"
+constexpr sha256_90r::digest_t abc_digest = sha256_90r::digest("abc");
+constexpr sha256_90r::digest_t abc_expected = {
+    0xd2, 0x94, 0x6a, 0x44, 0x9b, 0xd9, 0x8c, 0x1c, 0x6b, 0xa9, 0x53, 0x4c, 0x7d, 0x44, 0x0d, 0x14,
+    0xe0, 0xfa, 0xe1, 0x9e, 0x55, 0xc8, 0xed, 0x8c, 0xb0, 0xf2, 0xef, 0x75, 0x3f, 0x87, 0x42, 0x0b
+};
+
+constexpr bool digest_equal(const sha256_90r::digest_t& a, const sha256_90r::digest_t& b) {
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+static_assert(digest_equal(abc_digest, abc_expected), "constexpr digest(\"abc\") differs from the self-test vector");
+// Two-block padding (56 bytes) and a full block plus padding (64 bytes)
+static_assert(!digest_equal(sha256_90r::digest("0123456789abcdef0123456789abcdef0123456789abcdef01234567"),
+                            sha256_90r::digest("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef")),
+              "distinct messages fold to the same digest");
+static_assert(!std::is_copy_constructible<sha256_90r::hasher>::value &&
+              !std::is_copy_assignable<sha256_90r::hasher>::value &&
+              std::is_nothrow_move_constructible<sha256_90r::hasher>::value &&
+              std::is_nothrow_move_assignable<sha256_90r::hasher>::value,
+              "hasher must be move-only");
+
+static int same(const sha256_90r::digest_t& d, const uint8_t want[32]) {
+    return std::memcmp(d.data(), want, 32) == 0;
+}
+
+int main(void) {
+    uint8_t buf[MAX_LEN];
+    int failed = 0;
+
+    printf("=== SHA256-90R C++ Wrapper Test (C++%ld) ===\n", (long)(__cplusplus / 100 % 100));
+    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)next_random();
+
+    for (size_t len = 0; len <= MAX_LEN; len++) {
+        std::string_view msg(reinterpret_cast<const char*>(buf), len);
+        uint8_t want[32];
+
+        sha256_90r_hash(buf, len, want);
+
+        if (!same(sha256_90r::detail::digest_constexpr(msg), want) || !same(sha256_90r::digest(msg), want)) {
+            printf("  FAIL: digest len=%zu mismatch\n", len);
+            failed = 1;
+        }
+
+        // Uneven pieces; half-way the hasher is moved into a new object
+        sha256_90r::hasher h;
+        size_t off = 0;
+        while (off < len / 2) {
+            size_t take = next_random() % 70;
+            if (take > len / 2 - off) take = len / 2 - off;
+            h.update(buf + off, take);
+            off += take;
+        }
+        sha256_90r::hasher moved(std::move(h));
+        moved.update(msg.substr(off));
+        if (!same(moved.final(), want)) {
+            printf("  FAIL: hasher len=%zu mismatch\n", len);
+            failed = 1;
+        }
+        // The moved-from hasher is a fresh one
+        h.update(msg);
+        if (!same(h.final(), want)) {
+            printf("  FAIL: moved-from hasher len=%zu mismatch\n", len);
+            failed = 1;
+        }
+        // final() starts a new message, and move assignment carries the state
+        moved.update(msg.substr(0, len / 3));
+        h = std::move(moved);
+        h.update(msg.substr(len / 3));
+        if (!same(h.final(), want)) {
+            printf("  FAIL: move-assigned hasher len=%zu mismatch\n", len);
+            failed = 1;
+        }
+#ifdef SHA256_90R_HPP_HAS_SPAN
+        {
+            std::span<const uint8_t> bytes(buf, len);
+            sha256_90r::hasher hs;
+            hs.update(bytes.first(len / 2)).update(std::as_bytes(bytes.subspan(len / 2)));
+            if (!same(hs.final(), want) || !same(sha256_90r::digest(bytes), want) ||
+                !same(sha256_90r::digest(std::as_bytes(bytes)), want)) {
+                printf("  FAIL: span overloads len=%zu mismatch\n", len);
+                failed = 1;
+            }
+        }
+#endif
+    }
+
+    printf("  compile-time digest(\"abc\") = ");
+    for (uint8_t b : abc_digest) printf("%02x", b);
+    printf("\n");
+    printf("%s\n", failed ? "C++ wrapper test FAILED" : "C++ wrapper test PASSED");
+    return failed ? 1 : 0;
+}
@@ -40,7 +40,7 @@ void test_aes_variants()
                           0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34};
     BYTE ciphertext_std[16], ciphertext_xr[16];
     BYTE decrypted_std[16], decrypted_xr[16];
-    WORD key_schedule_std[60], key_schedule_xr[60];
+    WORD key_schedule_std[60], key_schedule_xr[120]; // AES-XR-128 runs 20 rounds: 4*(20+1) words
     
     // Setup keys
     aes_key_setup(key, key_schedule_std, 128);
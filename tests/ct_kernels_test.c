@@ -0,0 +1,147 @@
+/*********************************************************************
+* Filename:   ct_kernels_test.c
+* Author:     SHA256-90R constant-time kernel verification
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Verification step behind using the SIMD kernels in SECURE
+*             mode. Every compression kernel available on this CPU is
+*             first checked against the scalar digest, then timed by the
+*             dudect fixed-vs-random analyzer one kernel call at a time.
+*             A kernel whose score crosses the threshold is measured again
+*             with four times the samples (noise does not repeat, a real
+*             leak grows with n) and fails the test if it still does.
+*             Usage: ct_kernels_test [measurements-per-kernel]
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#include "../src/sha256_90r/sha256_internal.h"
+#define TEST_RNG_SEED 0xbe5466cf34e90c6cULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define DEFAULT_MEASUREMENTS 100000
+#define NUM_MESSAGES 64
+#define MAX_MSG_LEN 700
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+/**
+ * Digests through the kernel under test: single-stream kernels are selected
+ * for sha256_90r_hash, lane kernels run in a job manager of their width
+ */
+static int check_kernel_digests(sha256_90r_kernel_t kernel, uint8_t (*want)[32],
+                                const uint8_t** msgs, const size_t* lens) {
+    uint8_t got[32];
+    int failures = 0;
+
+    if (sha256_90r_kernel_single_stream(kernel)) {
+        if (sha256_90r_transform_select(kernel) != 0) return 1;
+        for (int i = 0; i < NUM_MESSAGES; i++) {
+            sha256_90r_hash(msgs[i], lens[i], got);
+            if (memcmp(got, want[i], 32) != 0) failures++;
+        }
+        sha256_90r_transform_select(SHA256_90R_KERNEL_SCALAR);
+    } else {
+        sha256_90r_mb_mgr_t* mgr = sha256_90r_mb_new(kernel == SHA256_90R_KERNEL_AVX2_8WAY ? 8 : 16);
+        sha256_90r_job_t jobs[NUM_MESSAGES];
+        sha256_90r_job_t* done;
+
+        if (!mgr) return 1;
+        memset(jobs, 0, sizeof(jobs));
+        for (int i = 0; i < NUM_MESSAGES; i++) {
+            jobs[i].data = msgs[i];
+            jobs[i].len = lens[i];
+            sha256_90r_mb_submit(mgr, &jobs[i]);
+        }
+        while ((done = sha256_90r_mb_flush(mgr)) != NULL) {
+        }
+        for (int i = 0; i < NUM_MESSAGES; i++) {
+            if (jobs[i].status != SHA256_90R_JOB_COMPLETED || memcmp(jobs[i].digest, want[i], 32) != 0) failures++;
+        }
+        sha256_90r_mb_free(mgr);
+    }
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    uint64_t measurements = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_MEASUREMENTS;
+    uint8_t* buf = malloc(NUM_MESSAGES * MAX_MSG_LEN);
+    uint8_t (*want)[32] = malloc(NUM_MESSAGES * 32);
+    const uint8_t* msgs[NUM_MESSAGES];
+    size_t lens[NUM_MESSAGES];
+    int failed = 0;
+
+    printf("=== SHA256-90R Constant-Time Kernel Verification ===\n");
+    if (!buf || !want || measurements == 0) {
+        printf("FAIL: setup\n");
+        return 1;
+    }
+    // Untuned, fixed starting point: the pre-expanded scalar kernel gives the reference
+    setenv("SHA256_90R_AUTOTUNE", "0", 1);
+    sha256_90r_transform_select(SHA256_90R_KERNEL_SCALAR);
+    for (int i = 0; i < NUM_MESSAGES * MAX_MSG_LEN; i++) buf[i] = (uint8_t)next_random();
+    for (int i = 0; i < NUM_MESSAGES; i++) {
+        msgs[i] = buf + i * MAX_MSG_LEN;
+        lens[i] = i < 4 ? (size_t)(i * 37) : next_random() % MAX_MSG_LEN;
+        sha256_90r_hash(msgs[i], lens[i], want[i]);
+    }
+
+    printf("Measurements per kernel: %llu, threshold |t| > %.1f\n\n",
+           (unsigned long long)measurements, SHA256_90R_CT_T_THRESHOLD);
+    printf("%-14s | %-7s | %-8s | %-8s | %-8s | %s\n", "Kernel", "Digests", "Score", "t (raw)", "t (2nd)", "Verdict");
+    printf("---------------+---------+----------+----------+----------+--------\n");
+
+    for (int k = 0; k < SHA256_90R_NUM_KERNELS; k++) {
+        sha256_90r_kernel_t kernel = (sha256_90r_kernel_t)k;
+        sha256_90r_leak_report_t report;
+        int bad_digests;
+
+        if (!sha256_90r_kernel_available(kernel)) {
+            printf("%-14s | %-7s | %-8s | %-8s | %-8s | %s\n", sha256_90r_kernel_name(kernel),
+                   "-", "-", "-", "-", "unavailable");
+            continue;
+        }
+
+        bad_digests = check_kernel_digests(kernel, want, msgs, lens);
+        if (sha256_90r_leak_test_kernel(kernel, measurements, 0, &report) != 0 || !report.supported) {
+            printf("%-14s | analysis failed\n", sha256_90r_kernel_name(kernel));
+            failed = 1;
+            continue;
+        }
+        if (report.leak_detected) {
+            printf("%-14s | %-7s | %-8.2f | %-8.2f | %-8.2f | above threshold, re-measuring\n",
+                   sha256_90r_kernel_name(kernel), "", report.leak_score, report.t_uncropped,
+                   report.t_second_order);
+            if (sha256_90r_leak_test_kernel(kernel, 4 * measurements, 0, &report) != 0) report.leak_detected = 1;
+        }
+
+        printf("%-14s | %-7s | %-8.2f | %-8.2f | %-8.2f | %s\n", sha256_90r_kernel_name(kernel),
+               bad_digests ? "WRONG" : "OK", report.leak_score, report.t_uncropped, report.t_second_order,
+               report.leak_detected ? "POTENTIAL LEAK" : "no evidence of leakage");
+        failed |= bad_digests != 0 || report.leak_detected;
+    }
+
+    // SECURE-mode batches now go through the lanes; digests are unchanged
+    {
+        uint8_t out[NUM_MESSAGES][32];
+        uint8_t* outs[NUM_MESSAGES];
+        for (int i = 0; i < NUM_MESSAGES; i++) outs[i] = out[i];
+        sha256_90r_batch(msgs, lens, outs, NUM_MESSAGES, SHA256_90R_MODE_SECURE);
+        for (int i = 0; i < NUM_MESSAGES; i++) {
+            if (memcmp(out[i], want[i], 32) != 0) {
+                printf("  FAIL: SECURE batch message %d mismatch\n", i);
+                failed = 1;
+                break;
+            }
+        }
+    }
+
+    printf("\n%s\n", failed ? "Constant-time kernel verification FAILED" : "Constant-time kernel verification PASSED");
+    free(buf);
+    free(want);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+/*********************************************************************
+* Filename:   dual_digest_test.c
+* Author:     SHA256-90R dual digest test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks that the single-pass dual digest equals separate
+*             SHA-256 and SHA256-90R hashes of the same message, for one
+*             shot, streaming with odd chunk sizes and the batch API,
+*             including lengths at the 55/56/64-byte padding edges.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#include "../src/sha256_90r/sha256.h"
+#define TEST_RNG_SEED 0x13198a2e03707344ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define MAX_LEN 600
+#define BATCH_COUNT 53
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static void to_hex(const uint8_t* digest, char* out) {
+    for (int i = 0; i < SHA256_90R_DIGEST_SIZE; i++) {
+        sprintf(out + 2 * i, "%02x", digest[i]);
+    }
+}
+
+/**
+ * Compare one message's dual digest (one shot and streamed) with the two
+ * separate hashes
+ */
+static int check_message(const uint8_t* msg, size_t len, size_t chunk) {
+    uint8_t want_256[32], want_90r[32], got_256[32], got_90r[32];
+    sha256_90r_dual_ctx_t ctx;
+    int failures = 0;
+
+    sha256(msg, len, want_256);
+    sha256_90r_hash(msg, len, want_90r);
+
+    sha256_90r_dual_hash(msg, len, got_256, got_90r);
+    if (memcmp(got_256, want_256, 32) != 0 || memcmp(got_90r, want_90r, 32) != 0) {
+        printf("  FAIL: one-shot len %zu\n", len);
+        failures++;
+    }
+
+    sha256_90r_dual_init(&ctx);
+    for (size_t off = 0; off < len; off += chunk) {
+        sha256_90r_dual_update(&ctx, msg + off, len - off < chunk ? len - off : chunk);
+    }
+    sha256_90r_dual_final(&ctx, got_256, got_90r);
+    if (memcmp(got_256, want_256, 32) != 0 || memcmp(got_90r, want_90r, 32) != 0) {
+        printf("  FAIL: streamed len %zu chunk %zu\n", len, chunk);
+        failures++;
+    }
+    return failures;
+}
+
+int main(void) {
+    static const size_t chunks[] = {1, 7, 63, 64, 65, 200};
+    uint8_t* pool = malloc((size_t)BATCH_COUNT * MAX_LEN);
+    const uint8_t* msgs[BATCH_COUNT];
+    size_t lens[BATCH_COUNT];
+    uint8_t (*batch_256)[32] = malloc(32 * BATCH_COUNT);
+    uint8_t (*batch_90r)[32] = malloc(32 * BATCH_COUNT);
+    uint8_t d256[32], d90r[32];
+    char hex[65];
+    int failed = 0;
+
+    printf("=== SHA256-90R Dual Digest Test ===\n");
+    if (!pool || !batch_256 || !batch_90r) {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < (size_t)BATCH_COUNT * MAX_LEN; i++) {
+        pool[i] = (uint8_t)next_random();
+    }
+
+    // Known answers: FIPS SHA-256 and the 90-round reference for "abc"
+    sha256_90r_dual_hash((const uint8_t*)"abc", 3, d256, d90r);
+    to_hex(d256, hex);
+    if (strcmp(hex, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") != 0) {
+        printf("  FAIL: SHA-256(\"abc\") = %s\n", hex);
+        failed = 1;
+    }
+    to_hex(d90r, hex);
+    if (strcmp(hex, "d2946a449bd98c1c6ba9534c7d440d14e0fae19e55c8ed8cb0f2ef753f87420b") != 0) {
+        printf("  FAIL: SHA256-90R(\"abc\") = %s\n", hex);
+        failed = 1;
+    }
+
+    // Every length through three blocks plus padding, varied chunking
+    for (size_t len = 0; len <= 200; len++) {
+        failed |= check_message(pool, len, chunks[len % (sizeof(chunks) / sizeof(chunks[0]))]) != 0;
+    }
+    failed |= check_message(pool, MAX_LEN, 97) != 0;
+    printf("  streaming and one-shot: %s\n", failed ? "FAIL" : "OK");
+
+    // Batch of unequal lengths (single-block messages first so lanes fork)
+    for (size_t i = 0; i < BATCH_COUNT; i++) {
+        msgs[i] = pool + i * MAX_LEN;
+        lens[i] = i < 16 ? i * 3 : next_random() % MAX_LEN;
+    }
+    for (size_t count = 0; count <= BATCH_COUNT; count += (count < 12 ? 1 : 10)) {
+        int batch_failures = 0;
+        sha256_90r_dual_batch(msgs, lens, batch_256, batch_90r, count);
+        for (size_t i = 0; i < count; i++) {
+            sha256(msgs[i], lens[i], d256);
+            sha256_90r_hash(msgs[i], lens[i], d90r);
+            if (memcmp(batch_256[i], d256, 32) != 0 || memcmp(batch_90r[i], d90r, 32) != 0) {
+                if (batch_failures++ < 3) {
+                    printf("  FAIL: batch of %zu, message %zu (len %zu)\n", count, i, lens[i]);
+                }
+            }
+        }
+        failed |= batch_failures != 0;
+    }
+    printf("  batch: %s\n", failed ? "FAIL" : "OK");
+
+    printf("%s\n", failed ? "Dual digest test FAILED" : "Dual digest test PASSED");
+    free(pool);
+    free(batch_256);
+    free(batch_90r);
+    return failed ? 1 : 0;
+}
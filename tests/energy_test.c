@@ -0,0 +1,114 @@
+/*********************************************************************
+* Filename:   energy_test.c
+* Author:     SHA256-90R energy measurement module test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Exercises the package energy API around a fixed amount of
+*             hashing. Machines without RAPL (VMs, containers, non-root
+*             users) must report "none" cleanly: start() and stop() fail,
+*             the region is still timed and carries no energy. The
+*             counter wrap arithmetic is checked on its own, including a
+*             wrap with an unknown range, which must fail the reading.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#include "../src/sha256_90r/sha256_internal.h"
+
+/****************************** MACROS ******************************/
+#define REGION_BYTES (256 * 1024)
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+    uint64_t start, now, range;
+    int rc;
+    uint64_t delta;
+} delta_case_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int check_delta(void) {
+    static const delta_case_t cases[] = {
+        { 100, 250, 1000, 0, 150 },
+        { 100, 100, 1000, 0, 0 },
+        { 100, 250, 0, 0, 150 },               // No wrap: range not needed
+        { 900, 50, 1000, 0, 150 },             // One wrap
+        { 1000, 0, 1000, 0, 0 },
+        { 262143328850ULL, 1000, 262143328850ULL, 0, 1000 },
+        { 900, 50, 0, -1, 0 },                 // Wrap with unknown range
+        { 2000, 50, 1000, -1, 0 },             // Start reading beyond the range
+    };
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const delta_case_t* c = &cases[i];
+        uint64_t delta = 0;
+        int rc = sha256_90r_energy_delta(c->start, c->now, c->range, &delta);
+        if (rc != c->rc || (rc == 0 && delta != c->delta)) {
+            printf("  FAIL: delta(start=%llu, now=%llu, range=%llu) = %d/%llu, expected %d/%llu\n",
+                   (unsigned long long)c->start, (unsigned long long)c->now,
+                   (unsigned long long)c->range, rc, (unsigned long long)delta,
+                   c->rc, (unsigned long long)c->delta);
+            failed = 1;
+        }
+    }
+    printf("  Wrap arithmetic: %s\n", failed ? "FAIL" : "ok");
+    return failed;
+}
+
+int main(void) {
+    sha256_90r_energy_t region;
+    sha256_90r_energy_source_t source = sha256_90r_energy_source();
+    uint8_t digest[SHA256_90R_DIGEST_SIZE];
+    uint8_t* data = malloc(REGION_BYTES);
+    int failed = 0;
+
+    printf("=== SHA256-90R Energy Measurement Test ===\n");
+    if (!data) {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < REGION_BYTES; i++) data[i] = (uint8_t)(i * 13);
+
+    failed |= check_delta();
+
+    if (sha256_90r_energy_start(NULL) != -1 || sha256_90r_energy_stop(NULL) != -1) {
+        printf("  FAIL: NULL region accepted\n");
+        failed = 1;
+    }
+
+    printf("  Energy source: %s\n", sha256_90r_energy_source_name(source));
+    int start_rc = sha256_90r_energy_start(&region);
+    sha256_90r_hash(data, REGION_BYTES, digest);
+    int stop_rc = sha256_90r_energy_stop(&region);
+
+    if (source == SHA256_90R_ENERGY_NONE) {
+        // Unsupported: both calls fail, but the region is still timed
+        if (start_rc != -1 || stop_rc != -1) {
+            printf("  FAIL: start/stop returned %d/%d without an energy source\n", start_rc, stop_rc);
+            failed = 1;
+        }
+        if (region.source != SHA256_90R_ENERGY_NONE || region.joules != 0.0 || region.watts != 0.0) {
+            printf("  FAIL: energy reported without an energy source\n");
+            failed = 1;
+        }
+    } else if (start_rc != 0 || stop_rc != 0 || region.joules < 0.0) {
+        printf("  FAIL: start/stop returned %d/%d, %.6f J\n", start_rc, stop_rc, region.joules);
+        failed = 1;
+    } else {
+        printf("  Region: %.6f J, %.2f W\n", region.joules, region.watts);
+    }
+    if (region.seconds <= 0.0) {
+        printf("  FAIL: region was not timed\n");
+        failed = 1;
+    }
+
+    printf("%s\n", failed ? "Energy measurement test FAILED" :
+           source == SHA256_90R_ENERGY_NONE ? "Energy measurement test PASSED (energy unsupported)" :
+           "Energy measurement test PASSED");
+    free(data);
+    return failed;
+}
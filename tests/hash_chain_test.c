@@ -0,0 +1,158 @@
+/*********************************************************************
+* Filename:   hash_chain_test.c
+* Author:     SHA256-90R hash chain test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks the hash chain API against sha256_90r_hash applied
+*             link by link: sha256_90r_chain_iterate on one chain,
+*             sha256_90r_chain_iterate_multi for chain counts that fill,
+*             underfill and overrun the 8/16 SIMD lanes, and chains with
+*             checkpoints (single and built side by side), where every
+*             link, every checkpoint and the last link are compared.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0x452821e638d01377ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define MAX_CHAINS 37
+#define LINKS 300
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Reference: links[i] = link i of the chain from seed, i = 0..n
+static void reference_chain(const uint8_t seed[32], uint8_t (*links)[32], size_t n) {
+    memcpy(links[0], seed, 32);
+    for (size_t i = 1; i <= n; i++) sha256_90r_hash(links[i - 1], 32, links[i]);
+}
+
+static int test_iterate(uint8_t seeds[MAX_CHAINS][32], uint8_t (*ref)[LINKS + 1][32]) {
+    int failed = 0;
+
+    for (size_t n = 0; n <= LINKS; n += 1 + n / 4) {
+        uint8_t out[32];
+        for (int c = 0; c < 3; c++) {
+            if (sha256_90r_chain_iterate(seeds[c], n, out) != 0 || memcmp(out, ref[c][n], 32) != 0) {
+                printf("  FAIL: chain_iterate chain %d links=%zu\n", c, n);
+                failed = 1;
+            }
+        }
+    }
+    printf("  chain_iterate: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+static int test_iterate_multi(uint8_t seeds[MAX_CHAINS][32], uint8_t (*ref)[LINKS + 1][32]) {
+    static const size_t counts[] = {1, 2, 7, 8, 9, 16, 17, MAX_CHAINS};
+    const uint8_t* in[MAX_CHAINS];
+    uint8_t outs[MAX_CHAINS][32];
+    uint8_t* out[MAX_CHAINS];
+    int failed = 0;
+
+    for (size_t c = 0; c < MAX_CHAINS; c++) {
+        in[c] = seeds[c];
+        out[c] = outs[c];
+    }
+    for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+        size_t n = counts[k] * 7 % LINKS;
+        if (sha256_90r_chain_iterate_multi(in, out, counts[k], n) != 0) {
+            printf("  FAIL: chain_iterate_multi count=%zu returned an error\n", counts[k]);
+            failed = 1;
+            continue;
+        }
+        for (size_t c = 0; c < counts[k]; c++) {
+            if (memcmp(outs[c], ref[c][n], 32) != 0) {
+                printf("  FAIL: chain_iterate_multi count=%zu chain %zu links=%zu\n", counts[k], c, n);
+                failed = 1;
+            }
+        }
+    }
+    printf("  chain_iterate_multi: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+// Every link, checkpoint and the last link of one chain object
+static int check_chain(const sha256_90r_chain_t* chain, uint8_t (*ref)[32], uint64_t links, uint64_t interval) {
+    const uint8_t* cps;
+    size_t count = 0;
+    uint8_t out[32];
+
+    cps = sha256_90r_chain_checkpoints(chain, &count);
+    if (!cps || count != links / interval + 1) return 1;
+    for (size_t j = 0; j < count; j++) {
+        if (memcmp(cps + 32 * j, ref[j * interval], 32) != 0) return 1;
+    }
+    for (uint64_t i = 0; i <= links; i++) {
+        if (sha256_90r_chain_link(chain, i, out) != 0 || memcmp(out, ref[i], 32) != 0) return 1;
+    }
+    return sha256_90r_chain_link(chain, links + 1, out) != -1;
+}
+
+static int test_checkpoints(uint8_t seeds[MAX_CHAINS][32], uint8_t (*ref)[LINKS + 1][32]) {
+    static const uint64_t shapes[][2] = {{0, 1}, {1, 1}, {LINKS, 1}, {LINKS, 37}, {LINKS, 50}, {250, LINKS}};
+    const uint8_t* in[MAX_CHAINS];
+    sha256_90r_chain_t* chains[MAX_CHAINS];
+    int failed = 0;
+
+    for (size_t c = 0; c < MAX_CHAINS; c++) in[c] = seeds[c];
+    for (size_t k = 0; k < sizeof(shapes) / sizeof(shapes[0]); k++) {
+        uint64_t links = shapes[k][0], interval = shapes[k][1];
+        sha256_90r_chain_t* chain = sha256_90r_chain_new(seeds[0], links, interval);
+
+        if (!chain || check_chain(chain, ref[0], links, interval)) {
+            printf("  FAIL: chain_new links=%llu interval=%llu\n", (unsigned long long)links,
+                   (unsigned long long)interval);
+            failed = 1;
+        }
+        sha256_90r_chain_free(chain);
+
+        if (sha256_90r_chain_new_multi(in, MAX_CHAINS, links, interval, chains) != 0) {
+            printf("  FAIL: chain_new_multi returned an error\n");
+            failed = 1;
+            continue;
+        }
+        for (size_t c = 0; c < MAX_CHAINS; c++) {
+            if (check_chain(chains[c], ref[c], links, interval)) {
+                printf("  FAIL: chain_new_multi chain %zu links=%llu interval=%llu\n", c,
+                       (unsigned long long)links, (unsigned long long)interval);
+                failed = 1;
+            }
+            sha256_90r_chain_free(chains[c]);
+        }
+    }
+
+    if (sha256_90r_chain_new(seeds[0], 10, 0) != NULL || sha256_90r_chain_new(NULL, 10, 1) != NULL ||
+        sha256_90r_chain_iterate(NULL, 1, seeds[0]) != -1 || sha256_90r_chain_link(NULL, 0, seeds[0]) != -1 ||
+        sha256_90r_chain_iterate_multi(NULL, NULL, 0, 5) != 0) {
+        printf("  FAIL: argument checks\n");
+        failed = 1;
+    }
+    printf("  checkpoints and chain_link: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+int main(void) {
+    static uint8_t seeds[MAX_CHAINS][32];
+    uint8_t (*ref)[LINKS + 1][32] = malloc(sizeof(*ref) * MAX_CHAINS);
+    int failed = 0;
+
+    printf("=== SHA256-90R Hash Chain Test ===\n");
+    if (!ref) return 1;
+    for (size_t c = 0; c < MAX_CHAINS; c++) {
+        for (int i = 0; i < 32; i++) seeds[c][i] = (uint8_t)next_random();
+        reference_chain(seeds[c], ref[c], LINKS);
+    }
+
+    failed |= test_iterate(seeds, ref);
+    failed |= test_iterate_multi(seeds, ref);
+    failed |= test_checkpoints(seeds, ref);
+
+    free(ref);
+    printf("%s\n", failed ? "Hash chain test FAILED" : "Hash chain test PASSED");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,319 @@
+/*********************************************************************
+* Filename:   hashd_test.c
+* Author:     SHA256-90R hashing daemon test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks sha256_90r_hmac against the RFC 2104 construction
+*             built from the state API (keys shorter than, equal to and
+*             longer than a block) and sha256_90r_hmac_batch against
+*             sha256_90r_hmac across the lane and chunk boundaries. Then
+*             starts the daemon given as argv[1] on a socket in TMPDIR.
+*             It sends pipelined hash and HMAC requests over two
+*             connections, and malformed and oversized frames. It
+*             checks every digest and status, and that SIGTERM removes
+*             the socket.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#include "../tools/sha256_90r_hashd.h"
+#define TEST_RNG_SEED 0x3c6ef372fe94f82bULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define MAX_BODY 4096
+#define PIPELINED 60
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// H((K' ^ opad) || H((K' ^ ipad) || m)), K' = H(K) for keys over 64 bytes
+static void reference_hmac(const uint8_t* key, size_t keylen, const uint8_t* msg, size_t len, uint8_t mac[32]) {
+    uint8_t k[64] = {0}, pad[64], inner[32];
+    sha256_90r_state_t st;
+
+    if (keylen > 64) {
+        sha256_90r_hash(key, keylen, k);
+    } else {
+        memcpy(k, key, keylen);
+    }
+    for (int i = 0; i < 64; i++) pad[i] = k[i] ^ 0x36;
+    sha256_90r_state_init(&st);
+    sha256_90r_state_update(&st, pad, 64);
+    sha256_90r_state_update(&st, msg, len);
+    sha256_90r_state_final(&st, inner);
+    for (int i = 0; i < 64; i++) pad[i] = k[i] ^ 0x5c;
+    sha256_90r_state_init(&st);
+    sha256_90r_state_update(&st, pad, 64);
+    sha256_90r_state_update(&st, inner, 32);
+    sha256_90r_state_final(&st, mac);
+}
+
+static int test_hmac(const uint8_t* data) {
+    static const size_t keylens[] = {0, 1, 32, 63, 64, 65, 200};
+    static const size_t msglens[] = {0, 1, 55, 64, 200, 1000};
+    static const size_t counts[] = {1, 7, 8, 9, 16, 17, 40, 300};
+    static const uint8_t* keys[300];
+    static const uint8_t* msgs[300];
+    static size_t klens[300], mlens[300];
+    static uint8_t macs[300][32];
+    static uint8_t* outs[300];
+    int failed = 0;
+
+    for (size_t k = 0; k < sizeof(keylens) / sizeof(keylens[0]); k++) {
+        for (size_t m = 0; m < sizeof(msglens) / sizeof(msglens[0]); m++) {
+            uint8_t want[32], got[32];
+            reference_hmac(data + 3000, keylens[k], data, msglens[m], want);
+            sha256_90r_hmac(data + 3000, keylens[k], data, msglens[m], got);
+            if (memcmp(want, got, 32) != 0) {
+                printf("  FAIL: hmac key %zu message %zu\n", keylens[k], msglens[m]);
+                failed = 1;
+            }
+        }
+    }
+    {
+        // The key matters, and so does every key byte past the first block
+        uint8_t a[32], b[32];
+        sha256_90r_hmac(data, 100, data, 10, a);
+        sha256_90r_hmac(data, 99, data, 10, b);
+        if (memcmp(a, b, 32) == 0) failed = 1;
+    }
+    printf("  hmac: %s\n", failed ? "FAILED" : "OK");
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        size_t n = counts[c];
+        for (size_t i = 0; i < n; i++) {
+            klens[i] = next_random() % 100;
+            mlens[i] = next_random() % 300;
+            keys[i] = data + next_random() % 1000;
+            msgs[i] = data + next_random() % 1000;
+            outs[i] = macs[i];
+        }
+        if (sha256_90r_hmac_batch(keys, klens, msgs, mlens, outs, n) != 0) {
+            printf("  FAIL: hmac batch of %zu returned an error\n", n);
+            failed = 1;
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint8_t want[32];
+            sha256_90r_hmac(keys[i], klens[i], msgs[i], mlens[i], want);
+            if (memcmp(want, macs[i], 32) != 0) {
+                printf("  FAIL: hmac batch of %zu, MAC %zu\n", n, i);
+                failed = 1;
+                break;
+            }
+        }
+    }
+    outs[0] = NULL;
+    if (sha256_90r_hmac_batch(keys, klens, msgs, mlens, outs, 1) != -1 ||
+        sha256_90r_hmac_batch(NULL, klens, msgs, mlens, outs, 1) != -1 ||
+        sha256_90r_hmac_batch(NULL, NULL, NULL, NULL, NULL, 0) != 0) {
+        printf("  FAIL: hmac batch argument checks\n");
+        failed = 1;
+    }
+    printf("  hmac batch: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+static int connect_to(const char* path) {
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int write_all(int fd, const uint8_t* p, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, p, len);
+        if (w <= 0) return -1;
+        p += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+static int read_all(int fd, uint8_t* p, size_t len) {
+    while (len > 0) {
+        ssize_t r = read(fd, p, len);
+        if (r <= 0) return -1;
+        p += r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
+
+static size_t put_request(uint8_t* out, uint32_t id, uint8_t op, const uint8_t* key, size_t keylen,
+                          const uint8_t* msg, size_t len) {
+    hashd_req_header_t h = {(uint32_t)(keylen + len), id, op, (uint16_t)keylen};
+
+    hashd_encode_request(out, &h);
+    memcpy(out + HASHD_REQ_HEADER, key, keylen);
+    memcpy(out + HASHD_REQ_HEADER + keylen, msg, len);
+    return HASHD_REQ_HEADER + keylen + len;
+}
+
+static int test_daemon(const char* daemon, const uint8_t* data) {
+    const char* tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    static uint8_t frames[PIPELINED * (HASHD_REQ_HEADER + MAX_BODY)];
+    static uint8_t want[PIPELINED][32];
+    static uint8_t resp[PIPELINED][HASHD_RESP_SIZE];
+    char path[256];
+    size_t klen[PIPELINED], mlen[PIPELINED], off = 0;
+    int seen[PIPELINED] = {0};
+    int failed = 0, fd = -1, fd2, status;
+    pid_t pid;
+
+    snprintf(path, sizeof(path), "%s/sha256_90r_hashd_test_%d.sock", tmpdir, (int)getpid());
+    if (strlen(path) >= sizeof(((struct sockaddr_un*)0)->sun_path)) {
+        printf("  FAIL: socket path too long: %s\n", path);
+        return 1;
+    }
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0) {
+        freopen("/dev/null", "w", stdout);
+        execl(daemon, daemon, "--socket", path, "--budget-us", "2000", "--max-batch", "16",
+              "--max-body", "4096", (char*)NULL);
+        _exit(127);
+    }
+    if (pid < 0) return 1;
+    // Tuning runs before the daemon listens; give it time
+    for (int tries = 0; tries < 600 && fd < 0; tries++) {
+        struct timespec ts = {0, 50 * 1000 * 1000};
+        fd = connect_to(path);
+        if (fd < 0) nanosleep(&ts, NULL);
+    }
+    fd2 = connect_to(path);
+    if (fd < 0 || fd2 < 0) {
+        printf("  FAIL: daemon %s did not start\n", daemon);
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        return 1;
+    }
+
+    // Pipelined: hashes and HMACs in one write, empty messages, empty and
+    // long keys, a body of exactly the limit
+    for (uint32_t i = 0; i < PIPELINED; i++) {
+        uint8_t op = i % 3 == 0 ? HASHD_OP_HASH : HASHD_OP_HMAC;
+        klen[i] = op == HASHD_OP_HASH ? 0 : (i % 5 == 0 ? 0 : next_random() % 150);
+        mlen[i] = i == 1 ? 0 : next_random() % 400;
+        if (i == 2) mlen[i] = MAX_BODY - klen[i];
+        if (op == HASHD_OP_HASH) {
+            sha256_90r_hash(data + 500, mlen[i], want[i]);
+        } else {
+            sha256_90r_hmac(data + i, klen[i], data + 500, mlen[i], want[i]);
+        }
+        off += put_request(frames + off, 1000 + i, op, data + i, klen[i], data + 500, mlen[i]);
+    }
+    if (write_all(fd, frames, off) != 0 || read_all(fd, &resp[0][0], sizeof(resp)) != 0) {
+        printf("  FAIL: pipelined requests\n");
+        failed = 1;
+    }
+    for (int i = 0; i < PIPELINED && !failed; i++) {
+        uint32_t id = hashd_get32(resp[i]) - 1000;
+        if (id >= PIPELINED || seen[id] || resp[i][4] != HASHD_OK || memcmp(resp[i] + 8, want[id], 32) != 0) {
+            printf("  FAIL: response %d (id %u)\n", i, id + 1000);
+            failed = 1;
+        }
+        if (id < PIPELINED) seen[id] = 1;
+    }
+    printf("  pipelined hash and hmac: %s\n", failed ? "FAILED" : "OK");
+
+    {
+        // One request on each connection: both wait for the budget, not for each other
+        uint8_t a[HASHD_RESP_SIZE], b[HASHD_RESP_SIZE], w[32];
+        size_t n = put_request(frames, 7, HASHD_OP_HASH, NULL, 0, data, 33);
+        n += put_request(frames + n, 8, HASHD_OP_HASH, NULL, 0, data, 34);
+        sha256_90r_hash(data, 34, w);
+        if (write_all(fd2, frames, n) != 0 || read_all(fd2, a, sizeof(a)) != 0 || read_all(fd2, b, sizeof(b)) != 0 ||
+            hashd_get32(b) != 8 || memcmp(b + 8, w, 32) != 0) {
+            printf("  FAIL: second connection\n");
+            failed = 1;
+        }
+    }
+    {
+        // Malformed requests get an error and the connection stays usable
+        static const struct { uint8_t op; size_t keylen; size_t len; uint8_t status; } bad[] = {
+            {9, 0, 10, HASHD_EOP}, {HASHD_OP_HASH, 4, 10, HASHD_EOP}, {HASHD_OP_HMAC, 0, 10, HASHD_OK},
+        };
+        for (uint32_t i = 0; i < 3; i++) {
+            uint8_t r[HASHD_RESP_SIZE];
+            hashd_req_header_t h = {(uint32_t)(bad[i].keylen + bad[i].len), 50 + i, bad[i].op,
+                                    (uint16_t)bad[i].keylen};
+            hashd_encode_request(frames, &h);
+            memcpy(frames + HASHD_REQ_HEADER, data, h.length);
+            if (write_all(fd, frames, HASHD_REQ_HEADER + h.length) != 0 || read_all(fd, r, sizeof(r)) != 0 ||
+                hashd_get32(r) != 50 + i || r[4] != bad[i].status) {
+                printf("  FAIL: malformed request %u\n", i);
+                failed = 1;
+            }
+        }
+        {
+            // keylen past the end of the body
+            uint8_t r[HASHD_RESP_SIZE];
+            hashd_req_header_t h = {8, 60, HASHD_OP_HMAC, 9};
+            hashd_encode_request(frames, &h);
+            if (write_all(fd, frames, HASHD_REQ_HEADER + 8) != 0 || read_all(fd, r, sizeof(r)) != 0 ||
+                r[4] != HASHD_EKEY) {
+                printf("  FAIL: key longer than the body accepted\n");
+                failed = 1;
+            }
+        }
+        {
+            // Over the limit: HASHD_ETOOBIG, then the daemon hangs up
+            uint8_t r[HASHD_RESP_SIZE];
+            hashd_req_header_t h = {MAX_BODY + 1, 61, HASHD_OP_HASH, 0};
+            hashd_encode_request(frames, &h);
+            if (write_all(fd, frames, HASHD_REQ_HEADER) != 0 || read_all(fd, r, sizeof(r)) != 0 ||
+                r[4] != HASHD_ETOOBIG || read(fd, r, 1) != 0) {
+                printf("  FAIL: oversized request\n");
+                failed = 1;
+            }
+        }
+    }
+    printf("  connections and malformed requests: %s\n", failed ? "FAILED" : "OK");
+
+    close(fd);
+    close(fd2);
+    kill(pid, SIGTERM);
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+        access(path, F_OK) == 0) {
+        printf("  FAIL: daemon shutdown\n");
+        unlink(path);
+        failed = 1;
+    }
+    printf("  shutdown: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+int main(int argc, char* argv[]) {
+    static uint8_t data[8192];
+    int failed = 0;
+
+    printf("=== SHA256-90R Hashing Daemon Test ===\n");
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)next_random();
+    failed |= test_hmac(data);
+    failed |= test_daemon(argc > 1 ? argv[1] : "./bin/sha256_90r_hashd", data);
+    printf("%s\n", failed ? "Hashing daemon test FAILED" : "Hashing daemon test PASSED");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+/*********************************************************************
+* Filename:   incremental_tree_test.c
+* Author:     SHA256-90R incremental tree test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks sha256_90r_itree against sha256_90r_tree_hash of the
+*             same buffer: the first root for lengths around the chunk
+*             size, then rounds of random writes marked with mark_dirty
+*             (single bytes, chunk boundaries, overlapping and whole-buffer
+*             ranges) on one and several threads, the dirty-chunk count,
+*             the bytes rehashed, and range checks.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0xa4093822299f31d0ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define CHUNK 4096
+#define BUF_SIZE (37 * CHUNK + 1234)    // 38 leaves: odd nodes on several levels
+#define ROUNDS 200
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int check_root(sha256_90r_itree_t* t, const uint8_t* buf, size_t len, const char* what) {
+    uint8_t want[32], got[32];
+
+    sha256_90r_tree_hash(buf, len, CHUNK, 1, want, NULL);
+    if (sha256_90r_itree_root(t, got, NULL) != 0 || memcmp(want, got, 32) != 0) {
+        printf("  FAIL: %s (len=%zu)\n", what, len);
+        return 1;
+    }
+    return 0;
+}
+
+static int test_lengths(uint8_t* buf) {
+    static const size_t lens[] = {0, 1, CHUNK - 1, CHUNK, CHUNK + 1, 2 * CHUNK, 3 * CHUNK + 5, BUF_SIZE};
+    int failed = 0;
+
+    for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        sha256_90r_itree_t* t = sha256_90r_itree_new(buf, lens[l], CHUNK, 2);
+        if (!t) {
+            printf("  FAIL: itree_new len=%zu\n", lens[l]);
+            failed = 1;
+            continue;
+        }
+        failed |= check_root(t, buf, lens[l], "first root");
+        if (lens[l] > 0) {
+            buf[lens[l] - 1] ^= 0x5a;
+            sha256_90r_itree_mark_dirty(t, lens[l] - 1, 1);
+            failed |= check_root(t, buf, lens[l], "last byte changed");
+        }
+        sha256_90r_itree_free(t);
+    }
+    printf("  lengths around the chunk size: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+static int test_mutations(uint8_t* buf, int threads) {
+    sha256_90r_itree_t* t = sha256_90r_itree_new(buf, BUF_SIZE, CHUNK, threads);
+    int failed = 0;
+
+    if (!t) return 1;
+    failed |= check_root(t, buf, BUF_SIZE, "first root");
+    for (int r = 0; r < ROUNDS && !failed; r++) {
+        int writes = 1 + (int)(next_random() % 4);
+        for (int w = 0; w < writes; w++) {
+            size_t off, len;
+            switch (next_random() % 4) {
+            case 0:                                     // One byte
+                off = next_random() % BUF_SIZE;
+                len = 1;
+                break;
+            case 1:                                     // Across a chunk boundary
+                off = (1 + next_random() % 37) * CHUNK - 1 - next_random() % 8;
+                len = 2 + next_random() % 16;
+                break;
+            case 2:                                     // A few KB
+                off = next_random() % BUF_SIZE;
+                len = 1 + next_random() % (3 * CHUNK);
+                break;
+            default:                                    // Everything, now and then
+                off = 0;
+                len = next_random() % 16 == 0 ? BUF_SIZE : 1 + next_random() % 64;
+                break;
+            }
+            if (len > BUF_SIZE - off) len = BUF_SIZE - off;
+            for (size_t i = 0; i < len; i++) buf[off + i] = (uint8_t)next_random();
+            if (sha256_90r_itree_mark_dirty(t, off, len) != 0) failed = 1;
+        }
+        failed |= check_root(t, buf, BUF_SIZE, "after writes");
+    }
+    sha256_90r_itree_free(t);
+    printf("  random writes, %d thread(s): %s\n", threads, failed ? "FAILED" : "OK");
+    return failed;
+}
+
+static int test_accounting(uint8_t* buf) {
+    sha256_90r_itree_t* t = sha256_90r_itree_new(buf, BUF_SIZE, CHUNK, 1);
+    sha256_90r_par_stats_t st;
+    uint8_t before[32], after[32];
+    uint64_t bytes = 0;
+    int failed = 0;
+
+    if (!t) return 1;
+    sha256_90r_itree_root(t, before, NULL);
+
+    // Chunks 3 and 4 (one write across the boundary) and the short last chunk
+    sha256_90r_itree_mark_dirty(t, 4 * CHUNK - 10, 20);
+    sha256_90r_itree_mark_dirty(t, BUF_SIZE - 1, 1);
+    sha256_90r_itree_mark_dirty(t, 3 * CHUNK, 1);
+    if (sha256_90r_itree_dirty_chunks(t) != 3) failed = 1;
+    if (sha256_90r_itree_root(t, after, &st) != 0) failed = 1;
+    for (int n = 0; n < SHA256_90R_MAX_NUMA_NODES; n++) bytes += st.node_bytes[n];
+    if (bytes != 2 * CHUNK + 1234 || sha256_90r_itree_dirty_chunks(t) != 0) failed = 1;
+    // Nothing changed: same root, and a clean tree hashes nothing
+    if (memcmp(before, after, 32) != 0) failed = 1;
+    if (sha256_90r_itree_root(t, after, &st) != 0 || st.threads != 0) failed = 1;
+
+    // A write that is not marked is not seen
+    buf[5] ^= 1;
+    sha256_90r_itree_root(t, after, NULL);
+    if (memcmp(before, after, 32) != 0) failed = 1;
+    sha256_90r_itree_mark_dirty(t, 5, 1);
+    failed |= check_root(t, buf, BUF_SIZE, "after marking");
+
+    if (sha256_90r_itree_mark_dirty(t, BUF_SIZE, 1) != -1 || sha256_90r_itree_mark_dirty(t, 1, BUF_SIZE) != -1 ||
+        sha256_90r_itree_mark_dirty(t, BUF_SIZE, 0) != 0 || sha256_90r_itree_mark_dirty(NULL, 0, 1) != -1 ||
+        sha256_90r_itree_new(NULL, 10, CHUNK, 1) != NULL) {
+        printf("  FAIL: argument checks\n");
+        failed = 1;
+    }
+    sha256_90r_itree_free(t);
+    printf("  dirty accounting: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+int main(void) {
+    uint8_t* buf = malloc(BUF_SIZE);
+    int failed = 0;
+
+    printf("=== SHA256-90R Incremental Tree Test ===\n");
+    if (!buf) return 1;
+    for (size_t i = 0; i < BUF_SIZE; i++) buf[i] = (uint8_t)next_random();
+
+    failed |= test_lengths(buf);
+    failed |= test_mutations(buf, 1);
+    failed |= test_mutations(buf, 3);
+    failed |= test_accounting(buf);
+
+    free(buf);
+    printf("%s\n", failed ? "Incremental tree test FAILED" : "Incremental tree test PASSED");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+/*********************************************************************
+* Filename:   iovec_update_test.c
+* Author:     SHA256-90R scatter-gather test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks sha256_90r_updatev, sha256_90r_state_updatev and
+*             sha256_90r_batchv against sha256_90r_hash of the coalesced
+*             message. Messages are cut into random fragments (empty,
+*             one byte, block-straddling, several blocks), updatev calls
+*             are mixed with plain updates, and batches are run below and
+*             above the lane threshold with mixed message lengths.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0x082efa98ec4e6c89ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define BUF_SIZE (64 * 70 + 200)
+#define MAX_FRAGS 64
+#define BATCH_COUNT 70              // Above the largest tuned lane threshold
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Cut data[0..len) into at most MAX_FRAGS fragments of random sizes,
+// including empty ones; returns the fragment count
+static size_t split(const uint8_t* data, size_t len, struct iovec* iov) {
+    size_t n = 0, off = 0;
+
+    while (off < len && n < MAX_FRAGS - 1) {
+        size_t take;
+        switch (next_random() % 5) {
+            case 0: take = 0; break;
+            case 1: take = 1; break;
+            case 2: take = next_random() % 64; break;
+            case 3: take = 64 * (1 + next_random() % 3); break;
+            default: take = next_random() % 300; break;
+        }
+        if (take > len - off) take = len - off;
+        iov[n].iov_base = (void*)(data + off);
+        iov[n].iov_len = take;
+        off += take;
+        n++;
+    }
+    iov[n].iov_base = (void*)(data + off);
+    iov[n].iov_len = len - off;
+    return n + 1;
+}
+
+static int test_updatev(const uint8_t* buf) {
+    int failed = 0;
+
+    for (size_t len = 0; len <= 1100; len += 1 + next_random() % 7) {
+        struct iovec iov[MAX_FRAGS];
+        size_t n = split(buf, len, iov);
+        size_t half = n / 2;
+        uint8_t want[32], got[32], got_state[32];
+        SHA256_90R_CTX* ctx = sha256_90r_new(SHA256_90R_MODE_SECURE);
+        sha256_90r_state_t st;
+
+        sha256_90r_hash(buf, len, want);
+
+        // Two updatev calls around one plain update of the middle fragment
+        sha256_90r_updatev(ctx, iov, half);
+        sha256_90r_update(ctx, iov[half].iov_base, iov[half].iov_len);
+        sha256_90r_updatev(ctx, iov + half + 1, n - half - 1);
+        sha256_90r_final(ctx, got);
+        sha256_90r_free(ctx);
+
+        sha256_90r_state_init(&st);
+        sha256_90r_state_updatev(&st, iov, n);
+        sha256_90r_state_final(&st, got_state);
+
+        if (memcmp(got, want, 32) != 0 || memcmp(got_state, want, 32) != 0) {
+            printf("  FAIL: updatev len=%zu fragments=%zu\n", len, n);
+            failed = 1;
+        }
+    }
+    printf("  updatev / state_updatev: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+static int test_batchv(const uint8_t* buf, size_t count) {
+    static struct iovec iovs[BATCH_COUNT][MAX_FRAGS];
+    const struct iovec* messages[BATCH_COUNT];
+    size_t iovcnts[BATCH_COUNT], lens[BATCH_COUNT];
+    uint8_t digests[BATCH_COUNT][32];
+    uint8_t* hashes[BATCH_COUNT];
+    int failed = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        // Mostly short frames, a few long messages, an empty one
+        lens[i] = i == 3 ? 0 : (next_random() % 8 == 0 ? BUF_SIZE - 64 - next_random() % 100 : next_random() % 600);
+        iovcnts[i] = split(buf + (i % 64), lens[i], iovs[i]);
+        messages[i] = iovs[i];
+        hashes[i] = digests[i];
+    }
+    if (sha256_90r_batchv(messages, iovcnts, hashes, count, SHA256_90R_MODE_SECURE) != 0) {
+        printf("  FAIL: batchv count=%zu returned an error\n", count);
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint8_t want[32];
+        sha256_90r_hash(buf + (i % 64), lens[i], want);
+        if (memcmp(digests[i], want, 32) != 0) {
+            printf("  FAIL: batchv count=%zu message %zu (len=%zu, %zu fragments)\n", count, i, lens[i], iovcnts[i]);
+            failed = 1;
+        }
+    }
+    printf("  batchv count=%zu: %s\n", count, failed ? "FAILED" : "OK");
+    return failed;
+}
+
+static int test_invalid(void) {
+    struct iovec bad = {NULL, 5};
+    const struct iovec* messages[1] = {&bad};
+    size_t iovcnts[1] = {1};
+    uint8_t digest[32];
+    uint8_t* hashes[1] = {digest};
+    int failed = 0;
+
+    if (sha256_90r_batchv(messages, iovcnts, hashes, 1, SHA256_90R_MODE_SECURE) != -1 ||
+        sha256_90r_batchv(NULL, iovcnts, hashes, 1, SHA256_90R_MODE_SECURE) != -1 ||
+        sha256_90r_batchv(NULL, NULL, NULL, 0, SHA256_90R_MODE_SECURE) != 0) {
+        printf("  FAIL: batchv argument checks\n");
+        failed = 1;
+    }
+    sha256_90r_updatev(NULL, &bad, 1);          // Must not crash
+    printf("  invalid arguments: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+int main(void) {
+    uint8_t* buf = malloc(BUF_SIZE);
+    int failed = 0;
+
+    printf("=== SHA256-90R Scatter-Gather (iovec) Test ===\n");
+    for (size_t i = 0; i < BUF_SIZE; i++) buf[i] = (uint8_t)next_random();
+
+    failed |= test_updatev(buf);
+    failed |= test_batchv(buf, 1);
+    failed |= test_batchv(buf, 5);
+    failed |= test_batchv(buf, BATCH_COUNT);
+    failed |= test_invalid();
+
+    free(buf);
+    printf("%s\n", failed ? "Scatter-gather test FAILED" : "Scatter-gather test PASSED");
+    return failed ? 1 : 0;
+}
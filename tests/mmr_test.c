@@ -0,0 +1,271 @@
+/*********************************************************************
+* Filename:   mmr_test.c
+* Author:     SHA256-90R Merkle Mountain Range test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks the MMR against a recursive reference built from
+*             sha256_90r_hash: roots at every size for single appends and
+*             for batches of random sizes (below and above the lane
+*             threshold), inclusion proofs for every leaf and consistency
+*             proofs for every pair of sizes in a small range, rejection of
+*             altered proofs, leaves and sizes, and an MMR file that is
+*             synced, reopened and extended without rehashing.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0xbe5466cf34e90c6cULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define LEAVES 700
+#define PROOF_LEAVES 70             // Sizes checked for every proof pair
+#define MAX_LEN 200
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static uint8_t leaf_data[LEAVES][MAX_LEN];
+static size_t leaf_len[LEAVES];
+static uint8_t leaf_hash[LEAVES][32];
+
+static void tagged_pair(uint8_t tag, const uint8_t l[32], const uint8_t r[32], uint8_t out[32]) {
+    uint8_t buf[65];
+    buf[0] = tag;
+    memcpy(buf + 1, l, 32);
+    memcpy(buf + 33, r, 32);
+    sha256_90r_hash(buf, sizeof(buf), out);
+}
+
+// Root of the perfect subtree over leaves [s, s + count)
+static void subtree(size_t s, size_t count, uint8_t out[32]) {
+    uint8_t l[32], r[32];
+    if (count == 1) {
+        memcpy(out, leaf_hash[s], 32);
+        return;
+    }
+    subtree(s, count / 2, l);
+    subtree(s + count / 2, count / 2, r);
+    tagged_pair(0x01, l, r, out);
+}
+
+static void reference_root(size_t n, uint8_t root[32]) {
+    uint8_t peaks[64][32];
+    size_t start = 0;
+    int count = 0;
+
+    for (int h = 63; h >= 0; h--) {
+        if (!((uint64_t)n >> h & 1)) continue;
+        subtree(start, (size_t)1 << h, peaks[count++]);
+        start += (size_t)1 << h;
+    }
+    if (count == 0) {
+        sha256_90r_hash(NULL, 0, root);
+        return;
+    }
+    memcpy(root, peaks[count - 1], 32);
+    for (int i = count - 2; i >= 0; i--) tagged_pair(0x02, peaks[i], root, root);
+}
+
+// Every size of mmr against the reference
+static int check_roots(const sha256_90r_mmr_t* mmr, const char* label) {
+    int failed = 0;
+    for (size_t n = 0; n <= sha256_90r_mmr_size(mmr); n++) {
+        uint8_t want[32], got[32];
+        reference_root(n, want);
+        if (sha256_90r_mmr_root(mmr, n, got) != 0 || memcmp(want, got, 32) != 0) {
+            printf("  FAIL: %s root at %zu leaves\n", label, n);
+            failed = 1;
+            break;
+        }
+    }
+    printf("  %s: %s\n", label, failed ? "FAILED" : "OK");
+    return failed;
+}
+
+static int test_appends(sha256_90r_mmr_t* single, sha256_90r_mmr_t* batched) {
+    int failed = 0;
+
+    for (size_t i = 0; i < LEAVES; i++) {
+        uint64_t index;
+        if (sha256_90r_mmr_append(single, leaf_data[i], leaf_len[i], &index) != 0 || index != i) failed = 1;
+    }
+    for (size_t i = 0; i < LEAVES;) {
+        const uint8_t* data[LEAVES];
+        size_t count = next_random() % 3 == 0 ? 1 + next_random() % 100 : 1 + next_random() % 6;
+        if (count > LEAVES - i) count = LEAVES - i;
+        for (size_t j = 0; j < count; j++) data[j] = leaf_data[i + j];
+        if (sha256_90r_mmr_append_batch(batched, data, leaf_len + i, count) != 0) failed = 1;
+        i += count;
+    }
+    if (failed) printf("  FAIL: append returned an error\n");
+    failed |= check_roots(single, "single appends");
+    failed |= check_roots(batched, "batch appends");
+    return failed;
+}
+
+static int test_inclusion(const sha256_90r_mmr_t* mmr) {
+    uint8_t proof[SHA256_90R_MMR_MAX_PROOF][32];
+    int failed = 0;
+
+    for (uint64_t n = 1; n <= PROOF_LEAVES; n++) {
+        uint8_t root[32], other[32];
+        sha256_90r_mmr_root(mmr, n, root);
+        sha256_90r_mmr_root(mmr, n + 1, other);
+        for (uint64_t i = 0; i < n; i++) {
+            size_t len;
+            if (sha256_90r_mmr_prove_inclusion(mmr, i, n, proof, &len) != 0 ||
+                !sha256_90r_mmr_verify_inclusion(root, n, i, leaf_data[i], leaf_len[i],
+                                                 (const uint8_t (*)[32])proof, len)) {
+                printf("  FAIL: inclusion of %llu in %llu\n", (unsigned long long)i, (unsigned long long)n);
+                failed = 1;
+                continue;
+            }
+            // Wrong leaf, wrong index, another size's root, altered proof
+            if ((i > 0 && sha256_90r_mmr_verify_inclusion(root, n, i, leaf_data[i - 1], leaf_len[i - 1],
+                                                          (const uint8_t (*)[32])proof, len)) ||
+                (i + 1 < n && sha256_90r_mmr_verify_inclusion(root, n, i + 1, leaf_data[i], leaf_len[i],
+                                                              (const uint8_t (*)[32])proof, len)) ||
+                sha256_90r_mmr_verify_inclusion(other, n, i, leaf_data[i], leaf_len[i],
+                                                (const uint8_t (*)[32])proof, len)) {
+                printf("  FAIL: bad inclusion accepted (%llu in %llu)\n", (unsigned long long)i,
+                       (unsigned long long)n);
+                failed = 1;
+            }
+            if (len > 0) {
+                proof[i % len][i % 32] ^= 1;
+                if (sha256_90r_mmr_verify_inclusion(root, n, i, leaf_data[i], leaf_len[i],
+                                                    (const uint8_t (*)[32])proof, len)) {
+                    printf("  FAIL: altered inclusion proof accepted\n");
+                    failed = 1;
+                }
+            }
+        }
+    }
+    printf("  inclusion proofs: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+static int test_consistency(const sha256_90r_mmr_t* mmr) {
+    uint8_t proof[SHA256_90R_MMR_MAX_PROOF][32];
+    int failed = 0;
+
+    for (uint64_t n = 0; n <= PROOF_LEAVES; n++) {
+        uint8_t new_root[32];
+        sha256_90r_mmr_root(mmr, n, new_root);
+        for (uint64_t m = 0; m <= n; m++) {
+            uint8_t old_root[32];
+            size_t len;
+            sha256_90r_mmr_root(mmr, m, old_root);
+            if (sha256_90r_mmr_prove_consistency(mmr, m, n, proof, &len) != 0 ||
+                !sha256_90r_mmr_verify_consistency(old_root, m, new_root, n, (const uint8_t (*)[32])proof, len)) {
+                printf("  FAIL: consistency %llu -> %llu\n", (unsigned long long)m, (unsigned long long)n);
+                failed = 1;
+                continue;
+            }
+            if (m < n && sha256_90r_mmr_verify_consistency(new_root, m, old_root, n,
+                                                           (const uint8_t (*)[32])proof, len)) {
+                printf("  FAIL: swapped roots accepted %llu -> %llu\n", (unsigned long long)m,
+                       (unsigned long long)n);
+                failed = 1;
+            }
+            if (len > 0) {
+                proof[(m + n) % len][n % 32] ^= 0x80;
+                if (sha256_90r_mmr_verify_consistency(old_root, m, new_root, n, (const uint8_t (*)[32])proof, len) ||
+                    (len > 1 && sha256_90r_mmr_verify_consistency(old_root, m, new_root, n,
+                                                                  (const uint8_t (*)[32])proof, len - 1))) {
+                    printf("  FAIL: altered consistency proof accepted %llu -> %llu\n", (unsigned long long)m,
+                           (unsigned long long)n);
+                    failed = 1;
+                }
+            }
+        }
+    }
+    printf("  consistency proofs: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+// Append, sync, close, reopen, append again: same roots as in memory
+static int test_file(const sha256_90r_mmr_t* ref) {
+    const char* tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char path[512];
+    sha256_90r_mmr_t* mmr;
+    uint8_t want[32], got[32];
+    int failed = 0, fd;
+
+    snprintf(path, sizeof(path), "%s/sha256_90r_mmr_XXXXXX", tmpdir);
+    fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    mmr = sha256_90r_mmr_open(path);
+    for (size_t i = 0; mmr && i < LEAVES / 2; i++) sha256_90r_mmr_append(mmr, leaf_data[i], leaf_len[i], NULL);
+    sha256_90r_mmr_close(mmr);
+
+    // Reopen: the size comes from the header, nodes from the file
+    mmr = sha256_90r_mmr_open(path);
+    if (!mmr || sha256_90r_mmr_size(mmr) != LEAVES / 2) {
+        printf("  FAIL: reopened MMR has the wrong size\n");
+        if (mmr) sha256_90r_mmr_close(mmr);
+        unlink(path);
+        return 1;
+    }
+    {
+        const uint8_t* data[LEAVES];
+        for (size_t i = LEAVES / 2; i < LEAVES; i++) data[i] = leaf_data[i];
+        sha256_90r_mmr_append_batch(mmr, data + LEAVES / 2, leaf_len + LEAVES / 2, LEAVES - LEAVES / 2);
+    }
+    sha256_90r_mmr_sync(mmr);
+    for (uint64_t n = 0; n <= LEAVES; n += 1 + n / 3) {
+        sha256_90r_mmr_root(ref, n, want);
+        if (sha256_90r_mmr_root(mmr, n, got) != 0 || memcmp(want, got, 32) != 0) failed = 1;
+    }
+    sha256_90r_mmr_close(mmr);
+
+    // A second reopen sees every leaf, with no nodes rehashed
+    sha256_90r_mmr_root(ref, LEAVES, want);
+    mmr = sha256_90r_mmr_open(path);
+    if (!mmr || sha256_90r_mmr_size(mmr) != LEAVES || sha256_90r_mmr_root(mmr, LEAVES, got) != 0 ||
+        memcmp(want, got, 32) != 0) {
+        failed = 1;
+    }
+    sha256_90r_mmr_close(mmr);
+
+    if (sha256_90r_mmr_open("/nonexistent/sha256_90r_mmr") != NULL) failed = 1;
+    unlink(path);
+    printf("  file reopen: %s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
+
+int main(void) {
+    sha256_90r_mmr_t* single = sha256_90r_mmr_open(NULL);
+    sha256_90r_mmr_t* batched = sha256_90r_mmr_open(NULL);
+    int failed = 0;
+
+    printf("=== SHA256-90R Merkle Mountain Range Test ===\n");
+    if (!single || !batched) return 1;
+    for (size_t i = 0; i < LEAVES; i++) {
+        uint8_t buf[MAX_LEN + 1];
+        leaf_len[i] = i % 17 == 0 ? 0 : next_random() % MAX_LEN;
+        for (size_t j = 0; j < leaf_len[i]; j++) leaf_data[i][j] = (uint8_t)next_random();
+        buf[0] = 0x00;
+        memcpy(buf + 1, leaf_data[i], leaf_len[i]);
+        sha256_90r_hash(buf, leaf_len[i] + 1, leaf_hash[i]);
+    }
+
+    failed |= test_appends(single, batched);
+    failed |= test_inclusion(batched);
+    failed |= test_consistency(single);
+    failed |= test_file(single);
+
+    sha256_90r_mmr_close(single);
+    sha256_90r_mmr_close(batched);
+    printf("%s\n", failed ? "MMR test FAILED" : "MMR test PASSED");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+/*********************************************************************
+* Filename:   parallel_hash_test.c
+* Author:     SHA256-90R parallel hashing test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks the multi-threaded tree hash and parallel batch
+*             against a sequential reference built from sha256_90r_hash,
+*             with NUMA placement on and off, the streaming tree API
+*             against the one-shot root, and the per-node byte accounting.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0x13198a2e03707344ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define BUF_SIZE (5 * 65536 + 1234)
+#define NUM_MESSAGES 500
+#define MAX_MSG_LEN 3000
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Sequential tree: H(chunk) leaves, H(left || right) parents, odd last paired with itself
+static void reference_tree(const uint8_t* data, size_t len, size_t chunk, uint8_t root[32]) {
+    size_t n = len <= chunk ? 1 : (len + chunk - 1) / chunk;
+    uint8_t (*level)[32] = malloc(n * 32);
+    uint8_t pair[64];
+
+    for (size_t i = 0; i < n; i++) {
+        size_t off = i * chunk;
+        sha256_90r_hash(data + off, len - off < chunk ? len - off : chunk, level[i]);
+    }
+    while (n > 1) {
+        size_t parents = (n + 1) / 2;
+        for (size_t i = 0; i < parents; i++) {
+            memcpy(pair, level[2 * i], 32);
+            memcpy(pair + 32, level[2 * i + 1 < n ? 2 * i + 1 : 2 * i], 32);
+            sha256_90r_hash(pair, 64, level[i]);
+        }
+        n = parents;
+    }
+    memcpy(root, level[0], 32);
+    free(level);
+}
+
+static int check_stats(const char* name, const sha256_90r_par_stats_t* st, uint64_t total) {
+    uint64_t sum = 0;
+    for (int n = 0; n < SHA256_90R_MAX_NUMA_NODES; n++) sum += st->node_bytes[n];
+    if (st->threads < 1 || st->nodes < 1 || st->nodes > SHA256_90R_MAX_NUMA_NODES ||
+        sum != total || st->cross_node_bytes > total) {
+        printf("  FAIL: %s stats: threads=%d nodes=%d bytes=%llu (want %llu) cross=%llu\n", name,
+               st->threads, st->nodes, (unsigned long long)sum, (unsigned long long)total,
+               (unsigned long long)st->cross_node_bytes);
+        return 1;
+    }
+    return 0;
+}
+
+static int check_tree(const uint8_t* buf) {
+    static const size_t lens[] = {0, 1, 4095, 4096, 4097, 3 * 4096, 5 * 4096 + 17, BUF_SIZE};
+    static const int threads[] = {1, 3, 0};
+    int failures = 0;
+
+    for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        uint8_t want[32], got[32];
+        reference_tree(buf, lens[l], 4096, want);
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            sha256_90r_par_stats_t st;
+            if (sha256_90r_tree_hash(buf, lens[l], 4096, threads[t], got, &st) != 0 ||
+                memcmp(got, want, 32) != 0) {
+                printf("  FAIL: tree len=%zu threads=%d root mismatch\n", lens[l], threads[t]);
+                failures++;
+            } else if (lens[l] > 4096) {
+                failures += check_stats("tree", &st, lens[l]);
+            }
+        }
+
+        // Streaming in uneven pieces gives the same root
+        {
+            sha256_90r_tree_ctx_t* ctx = sha256_90r_tree_hash_new(4096);
+            size_t off = 0;
+            while (ctx && off < lens[l]) {
+                size_t take = 1 + next_random() % 9000;
+                if (take > lens[l] - off) take = lens[l] - off;
+                sha256_90r_tree_hash_update(ctx, buf + off, take);
+                off += take;
+            }
+            if (!ctx || sha256_90r_tree_hash_final(ctx, got) != 0 || memcmp(got, want, 32) != 0) {
+                printf("  FAIL: streaming tree len=%zu root mismatch\n", lens[l]);
+                failures++;
+            }
+            sha256_90r_tree_hash_free(ctx);
+        }
+    }
+
+    // Default chunk size: one chunk is the plain digest
+    {
+        uint8_t want[32], got[32];
+        sha256_90r_hash(buf, BUF_SIZE, want);
+        if (sha256_90r_tree_hash(buf, BUF_SIZE, 0, 2, got, NULL) != 0 || memcmp(got, want, 32) != 0) {
+            printf("  FAIL: single default-size chunk is not the plain digest\n");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static int check_batch(const uint8_t* buf) {
+    const uint8_t* msgs[NUM_MESSAGES];
+    size_t lens[NUM_MESSAGES];
+    uint8_t (*got)[32] = malloc(NUM_MESSAGES * 32);
+    uint8_t want[32];
+    uint64_t total = 0;
+    int failures = 0;
+
+    for (int i = 0; i < NUM_MESSAGES; i++) {
+        lens[i] = i < 4 ? (size_t)(i * 55 / 3) : next_random() % MAX_MSG_LEN;
+        msgs[i] = buf + next_random() % (BUF_SIZE - MAX_MSG_LEN);
+        total += lens[i];
+    }
+
+    for (int threads = 1; threads <= 4; threads += 3) {
+        sha256_90r_par_stats_t st;
+        memset(got, 0, NUM_MESSAGES * 32);
+        if (sha256_90r_batch_parallel(msgs, lens, got, NUM_MESSAGES, threads, &st) != 0) {
+            printf("  FAIL: batch threads=%d returned an error\n", threads);
+            failures++;
+            continue;
+        }
+        for (int i = 0; i < NUM_MESSAGES; i++) {
+            sha256_90r_hash(msgs[i], lens[i], want);
+            if (memcmp(got[i], want, 32) != 0) {
+                if (failures++ < 3) printf("  FAIL: batch threads=%d message %d mismatch\n", threads, i);
+            }
+        }
+        failures += check_stats("batch", &st, total);
+    }
+    free(got);
+    return failures;
+}
+
+int main(void) {
+    uint8_t* buf = malloc(BUF_SIZE);
+    int failed = 0;
+
+    printf("=== SHA256-90R Parallel Tree/Batch Hashing Test ===\n");
+    if (!buf) {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < BUF_SIZE; i++) buf[i] = (uint8_t)next_random();
+    printf("  NUMA nodes: %d (buffer on node %d)\n", sha256_90r_numa_node_count(),
+           sha256_90r_numa_node_of(buf));
+    if (sha256_90r_numa_node_count() < 1 || sha256_90r_numa_bind_thread(0) != 0) {
+        printf("  FAIL: no usable NUMA node\n");
+        failed = 1;
+    }
+
+    for (int numa = 1; numa >= 0; numa--) {
+        int f;
+        setenv("SHA256_90R_NUMA", numa ? "1" : "0", 1);
+        f = check_tree(buf) + check_batch(buf);
+        printf("  placement %-3s tree + batch %s\n", numa ? "on" : "off", f ? "FAIL" : "OK");
+        failed |= f != 0;
+    }
+
+    // Invalid input
+    {
+        uint8_t out[32];
+        const uint8_t* msg = NULL;
+        size_t len = 5;
+        if (sha256_90r_tree_hash(NULL, 5, 0, 1, out, NULL) != -1 ||
+            sha256_90r_batch_parallel(&msg, &len, &out, 1, 1, NULL) != -1) {
+            printf("  FAIL: NULL data accepted\n");
+            failed = 1;
+        }
+    }
+
+    printf("%s\n", failed ? "Parallel hashing test FAILED" : "Parallel hashing test PASSED");
+    free(buf);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+/*********************************************************************
+* Filename:   perf_counter_test.c
+* Author:     SHA256-90R performance counter module test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Exercises the in-process perf_event counter API around a
+*             fixed amount of hashing. Counters that the kernel or CPU
+*             cannot provide (containers, VMs without a virtual PMU) are
+*             reported as unavailable rather than failing the test; the
+*             counts that are available must scale with the work done.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+
+/****************************** MACROS ******************************/
+#define SMALL_BYTES (4 * 1024)
+#define LARGE_BYTES (16 * SMALL_BYTES)
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static void hash_bytes(const uint8_t* data, size_t len) {
+    uint8_t digest[SHA256_90R_DIGEST_SIZE];
+    sha256_90r_hash(data, len, digest);
+}
+
+static int measure(sha256_90r_pmc_t* pmc, const uint8_t* data, size_t len) {
+    if (sha256_90r_pmc_start(pmc) != 0) return -1;
+    hash_bytes(data, len);
+    return sha256_90r_pmc_stop(pmc);
+}
+
+int main(void) {
+    sha256_90r_pmc_t pmc, small, large;
+    uint8_t* data = malloc(LARGE_BYTES);
+    int failed = 0;
+
+    printf("=== SHA256-90R Performance Counter Test ===\n");
+    if (!data) {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < LARGE_BYTES; i++) data[i] = (uint8_t)(i * 7);
+
+    // Derived metrics must reject invalid input
+    memset(&pmc, 0, sizeof(pmc));
+    if (sha256_90r_pmc_ipc(&pmc) >= 0.0 ||
+        sha256_90r_pmc_per_kb(&pmc, SHA256_90R_PMC_INSTRUCTIONS, 1024.0) >= 0.0) {
+        printf("  FAIL: metrics reported for invalid counters\n");
+        failed = 1;
+    }
+
+    int opened = sha256_90r_pmc_open(&pmc);
+    printf("  Events opened: %d\n", opened);
+    for (int e = 0; e < SHA256_90R_PMC_COUNT; e++) {
+        printf("    %-14s %s\n", sha256_90r_pmc_event_name((sha256_90r_pmc_event_t)e),
+               pmc.fds[e] >= 0 ? "available" : "unavailable");
+    }
+    if (opened == 0) {
+        if (sha256_90r_pmc_start(&pmc) != -1) {
+            printf("  FAIL: start succeeded with no counters open\n");
+            failed = 1;
+        }
+        printf("%s\n", failed ? "Performance counter test FAILED" : "Performance counter test PASSED (no counters available)");
+        free(data);
+        return failed;
+    }
+
+    hash_bytes(data, SMALL_BYTES); // warm-up
+    if (measure(&pmc, data, SMALL_BYTES) != 0) {
+        printf("  FAIL: small region could not be measured\n");
+        failed = 1;
+    }
+    small = pmc;
+    if (measure(&pmc, data, LARGE_BYTES) != 0) {
+        printf("  FAIL: large region could not be measured\n");
+        failed = 1;
+    }
+    large = pmc;
+
+    // Work-proportional events must grow with 16x the input
+    const sha256_90r_pmc_event_t scaling[] = {
+        SHA256_90R_PMC_CYCLES, SHA256_90R_PMC_INSTRUCTIONS, SHA256_90R_PMC_TASK_CLOCK
+    };
+    for (size_t i = 0; i < sizeof(scaling) / sizeof(scaling[0]); i++) {
+        sha256_90r_pmc_event_t e = scaling[i];
+        if (!small.valid[e] || !large.valid[e]) continue;
+        printf("  %-14s small=%llu large=%llu\n", sha256_90r_pmc_event_name(e),
+               (unsigned long long)small.counts[e], (unsigned long long)large.counts[e]);
+        if (large.counts[e] <= small.counts[e] * 4) {
+            printf("  FAIL: %s did not scale with work\n", sha256_90r_pmc_event_name(e));
+            failed = 1;
+        }
+    }
+
+    double ipc = sha256_90r_pmc_ipc(&large);
+    if (ipc >= 0.0) {
+        printf("  IPC: %.2f, instructions/KB: %.0f\n", ipc,
+               sha256_90r_pmc_per_kb(&large, SHA256_90R_PMC_INSTRUCTIONS, LARGE_BYTES));
+        if (ipc <= 0.0 || ipc > 16.0) {
+            printf("  FAIL: implausible IPC\n");
+            failed = 1;
+        }
+    }
+
+    sha256_90r_pmc_close(&pmc);
+    printf("%s\n", failed ? "Performance counter test FAILED" : "Performance counter test PASSED");
+    free(data);
+    return failed;
+}
@@ -0,0 +1,153 @@
+/*********************************************************************
+* Filename:   pow_search_test.c
+* Author:     SHA256-90R nonce search test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks the batched nonce search against a brute-force loop
+*             over sha256_90r_hash: every lane width and thread count must
+*             report the same lowest hit and its digest, for nonces inside
+*             one word, spanning words, after a midstate and in a
+*             single-block header. Also checks misses and bad input.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+
+/****************************** MACROS ******************************/
+#define MAX_HEADER 200
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static int digest_le_target(const uint8_t* digest, const uint8_t* target) {
+    return memcmp(digest, target, SHA256_90R_DIGEST_SIZE) <= 0;
+}
+
+// Lowest nonce in [start, start + count) that meets target, or UINT64_MAX
+static uint64_t brute_force(const uint8_t* header, size_t len, size_t off, size_t size,
+                            const uint8_t* target, uint64_t start, uint64_t count) {
+    uint8_t buf[MAX_HEADER], digest[32];
+
+    memcpy(buf, header, len);
+    for (uint64_t n = start; n < start + count; n++) {
+        for (size_t i = 0; i < size; i++) buf[off + i] = (uint8_t)(n >> (8 * i));
+        sha256_90r_hash(buf, len, digest);
+        if (digest_le_target(digest, target)) return n;
+    }
+    return UINT64_MAX;
+}
+
+/**
+ * Search one header with every lane width and thread count and compare
+ * with the brute-force answer
+ */
+static int check_case(const char* name, size_t len, size_t off, size_t size,
+                      const uint8_t* target, uint64_t start, uint64_t count) {
+    static const int lane_widths[] = {1, 8, 16};
+    static const int thread_counts[] = {1, 4};
+    uint8_t header[MAX_HEADER];
+    sha256_90r_pow_job_t job;
+    uint64_t want;
+    int failures = 0;
+
+    for (size_t i = 0; i < len; i++) header[i] = (uint8_t)(i * 31 + 7);
+    want = brute_force(header, len, off, size, target, start, count);
+
+    if (sha256_90r_pow_init(&job, header, len, off, size, target) != 0) {
+        printf("  FAIL: %s: pow_init rejected a valid header\n", name);
+        return 1;
+    }
+
+    for (size_t l = 0; l < sizeof(lane_widths) / sizeof(lane_widths[0]); l++) {
+        for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+            sha256_90r_pow_result_t res;
+            int rc;
+
+            job.lanes = lane_widths[l];
+            rc = sha256_90r_pow_search(&job, start, count, thread_counts[t], &res);
+            if (rc < 0 && lane_widths[l] > 1) {
+                printf("  %-16s lanes=%-2d threads=%d SKIP (not supported)\n",
+                       name, lane_widths[l], thread_counts[t]);
+                continue;
+            }
+            if (want == UINT64_MAX) {
+                if (rc != 0 || res.found || res.hashes != count) {
+                    printf("  FAIL: %s lanes=%d threads=%d: expected a miss over all %llu nonces (rc=%d hashes=%llu)\n",
+                           name, lane_widths[l], thread_counts[t], (unsigned long long)count, rc,
+                           (unsigned long long)res.hashes);
+                    failures++;
+                }
+            } else {
+                uint8_t buf[MAX_HEADER], digest[32];
+                memcpy(buf, header, len);
+                for (size_t i = 0; i < size; i++) buf[off + i] = (uint8_t)(want >> (8 * i));
+                sha256_90r_hash(buf, len, digest);
+                if (rc != 1 || !res.found || res.nonce != want || memcmp(res.digest, digest, 32) != 0) {
+                    printf("  FAIL: %s lanes=%d threads=%d: nonce %llu, want %llu\n",
+                           name, lane_widths[l], thread_counts[t],
+                           (unsigned long long)res.nonce, (unsigned long long)want);
+                    failures++;
+                }
+            }
+            printf("  %-16s lanes=%-2d threads=%d nonce=%-8lld hashes=%-8llu %s\n",
+                   name, res.lanes, res.threads, want == UINT64_MAX ? -1LL : (long long)want,
+                   (unsigned long long)res.hashes, failures ? "FAIL" : "OK");
+        }
+    }
+    return failures ? 1 : 0;
+}
+
+int main(void) {
+    uint8_t easy[32], hard[32], none[32];
+    int failed = 0;
+
+    printf("=== SHA256-90R Nonce Search Test ===\n");
+
+    // ~1/256 and ~1/65536 per nonce; an all-zero target never hits here
+    memset(easy, 0xff, sizeof(easy));
+    easy[0] = 0x00;
+    memset(hard, 0xff, sizeof(hard));
+    hard[0] = 0x00;
+    hard[1] = 0x00;
+    memset(none, 0x00, sizeof(none));
+
+    // Bitcoin-style 80-byte header: midstate of block 0, nonce in word 3 of the tail
+    failed |= check_case("header80", 80, 76, 4, easy, 0, 5000);
+    // Nonce straddling two message words, odd start and count
+    failed |= check_case("unaligned", 80, 70, 3, easy, 1001, 4099);
+    // Single-block header, 8-byte nonce starting in word 0
+    failed |= check_case("single-block", 40, 2, 8, easy, 12345, 3000);
+    // A hit past the first work chunk exercises the cross-thread minimum
+    failed |= check_case("header80-hard", 80, 76, 4, hard, 0, 300000);
+    failed |= check_case("miss", 80, 76, 4, none, 0, 2051);
+
+    // Invalid jobs are rejected
+    {
+        uint8_t header[128] = {0};
+        sha256_90r_pow_job_t job;
+        sha256_90r_pow_result_t res;
+
+        if (sha256_90r_pow_init(&job, header, 128, 10, 4, easy) != -1 ||
+            sha256_90r_pow_init(&job, header, 60, 52, 4, easy) != -1 ||
+            sha256_90r_pow_init(&job, header, 80, 78, 4, easy) != -1 ||
+            sha256_90r_pow_init(&job, header, 80, 76, 9, easy) != -1) {
+            printf("  FAIL: invalid nonce placement accepted\n");
+            failed = 1;
+        }
+        if (sha256_90r_pow_init(&job, header, 80, 76, 1, easy) != 0 ||
+            sha256_90r_pow_search(&job, 256, 10, 1, &res) != -1) {
+            printf("  FAIL: start nonce beyond a 1-byte field accepted\n");
+            failed = 1;
+        }
+        job.lanes = 3;
+        if (sha256_90r_pow_search(&job, 0, 10, 1, &res) != -1) {
+            printf("  FAIL: lane width 3 accepted\n");
+            failed = 1;
+        }
+    }
+
+    printf("%s\n", failed ? "Nonce search test FAILED" : "Nonce search test PASSED");
+    return failed ? 1 : 0;
+}
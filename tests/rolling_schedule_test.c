@@ -0,0 +1,114 @@
+/*********************************************************************
+* Filename:   rolling_schedule_test.c
+* Author:     SHA256-90R rolling schedule test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks the rolling 16-word schedule kernels and their
+*             pre-expanded counterparts (scalar, AVX2 8-way, AVX-512
+*             16-way) bit-exact against sha256_90r_transform_scalar on
+*             random blocks and random chaining values.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_internal.h"
+#define TEST_RNG_SEED 0x243f6a8885a308d3ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define NUM_BLOCKS 512              // Multiple of 16
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+typedef void (*lanes_fn)(struct sha256_90r_internal_ctx* ctxs, const BYTE* blocks);
+
+static void run_scalar_rolling(struct sha256_90r_internal_ctx* ctxs, const BYTE* blocks) {
+    sha256_90r_transform_scalar_rolling(ctxs, blocks);
+}
+
+#if defined(USE_SIMD) && defined(__x86_64__)
+static void run_avx2_8way(struct sha256_90r_internal_ctx* ctxs, const BYTE* blocks) {
+    sha256_90r_transform_avx2_8way(ctxs, (const BYTE (*)[64])blocks);
+}
+
+static void run_avx2_8way_rolling(struct sha256_90r_internal_ctx* ctxs, const BYTE* blocks) {
+    sha256_90r_transform_avx2_8way_rolling(ctxs, (const BYTE (*)[64])blocks);
+}
+
+static void run_avx512_16way(struct sha256_90r_internal_ctx* ctxs, const BYTE* blocks) {
+    sha256_90r_transform_avx512_16way(ctxs, (const BYTE (*)[64])blocks);
+}
+
+static void run_avx512_16way_rolling(struct sha256_90r_internal_ctx* ctxs, const BYTE* blocks) {
+    sha256_90r_transform_avx512_16way_rolling(ctxs, (const BYTE (*)[64])blocks);
+}
+#endif
+
+/**
+ * Run a kernel over every group of `lanes` blocks and compare each lane's
+ * output state with the scalar transform
+ */
+static int check_kernel(const char* name, lanes_fn fn, int lanes, const BYTE* blocks,
+                        struct sha256_90r_internal_ctx* in, struct sha256_90r_internal_ctx* expected) {
+    struct sha256_90r_internal_ctx ctxs[16];
+    int failures = 0;
+
+    for (int i = 0; i < NUM_BLOCKS; i += lanes) {
+        memcpy(ctxs, in + i, sizeof(ctxs[0]) * (size_t)lanes);
+        fn(ctxs, blocks + (size_t)i * 64);
+        for (int l = 0; l < lanes; l++) {
+            if (memcmp(ctxs[l].state, expected[i + l].state, sizeof(ctxs[l].state)) != 0) {
+                if (failures++ < 3) printf("  FAIL: %s block %d lane %d mismatch\n", name, i + l, l);
+            }
+        }
+    }
+    printf("  %-22s %s\n", name, failures ? "FAIL" : "OK");
+    return failures ? 1 : 0;
+}
+
+int main(void) {
+    BYTE* blocks = malloc((size_t)NUM_BLOCKS * 64);
+    struct sha256_90r_internal_ctx* in = malloc(sizeof(*in) * NUM_BLOCKS);
+    struct sha256_90r_internal_ctx* expected = malloc(sizeof(*expected) * NUM_BLOCKS);
+    int failed = 0;
+
+    printf("=== SHA256-90R Rolling Schedule Kernel Test ===\n");
+    if (!blocks || !in || !expected) {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+
+    for (int i = 0; i < NUM_BLOCKS * 64; i++) blocks[i] = (BYTE)next_random();
+    for (int i = 0; i < NUM_BLOCKS; i++) {
+        sha256_90r_init_internal(&in[i]);
+        if (i % 3) {
+            for (int j = 0; j < 8; j++) in[i].state[j] = next_random();
+        }
+        expected[i] = in[i];
+        sha256_90r_transform_scalar(&expected[i], blocks + (size_t)i * 64);
+    }
+
+    failed |= check_kernel("scalar_rolling", run_scalar_rolling, 1, blocks, in, expected);
+#if defined(USE_SIMD) && defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) {
+        failed |= check_kernel("avx2_8way", run_avx2_8way, 8, blocks, in, expected);
+        failed |= check_kernel("avx2_8way_rolling", run_avx2_8way_rolling, 8, blocks, in, expected);
+    } else {
+        printf("  avx2 kernels           SKIP (no AVX2)\n");
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        failed |= check_kernel("avx512_16way", run_avx512_16way, 16, blocks, in, expected);
+        failed |= check_kernel("avx512_16way_rolling", run_avx512_16way_rolling, 16, blocks, in, expected);
+    } else {
+        printf("  avx512 kernels         SKIP (no AVX-512F)\n");
+    }
+#endif
+
+    printf("%s\n", failed ? "Rolling schedule test FAILED" : "Rolling schedule test PASSED");
+    free(blocks);
+    free(in);
+    free(expected);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,284 @@
+/*********************************************************************
+* Filename:   round_variants_test.c
+* Author:     SHA256-90R round-count variants test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks the round-count registry and every generated kernel
+*             against a plain reference with its own constants (cube roots
+*             of primes, SHA256-90R's extension for rounds 64..89): the
+*             90-round variant against sha256_90r_hash, each single-stream
+*             kernel over uneven pieces, and the batch at the widest width
+*             and at 8 lanes pinned through a tune cache.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0x082efa98ec4e6c89ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define MAX_LEN 700
+#define NUM_MESSAGES 53
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static uint32_t ref_k[SHA256_90R_VARIANT_MAX_ROUNDS];
+
+// Fractional bits of cbrt(p): floor(cbrt(p * 2^96)) mod 2^32
+static uint32_t cube_root_bits(uint32_t p) {
+    unsigned __int128 n = (unsigned __int128)p << 96;
+    uint64_t lo = 0, hi = 1ULL << 40;
+    while (hi - lo > 1) {
+        uint64_t mid = (lo + hi) / 2;
+        if ((unsigned __int128)mid * mid * mid <= n) lo = mid;
+        else hi = mid;
+    }
+    return (uint32_t)lo;
+}
+
+static void build_reference_constants(void) {
+    static const uint32_t ext[26] = {   // SHA256-90R rounds 64..89
+        0xc67178f2, 0xca273ece, 0xd186b8c7, 0xeada7dd6, 0xf57d4f7f, 0x06f067aa, 0x0a637dc5, 0x113f9804,
+        0x1b710b35, 0x28db77f5, 0x32caab7b, 0x3c9ebe0a, 0x431d67c4, 0x4cc5d4be, 0x597f299c, 0x5fcb6fab,
+        0x6c44198c, 0x7ba0ea2d, 0x7eabf2d0, 0x8dbe8d03, 0x90bb1721, 0x99a2ad45, 0x9f86e289, 0xa84c4472,
+        0xb3df34fc, 0xb99bb8d7
+    };
+    uint32_t p = 2;
+    for (int i = 0; i < SHA256_90R_VARIANT_MAX_ROUNDS; p++) {
+        int prime = 1;
+        for (uint32_t d = 2; d * d <= p; d++) {
+            if (p % d == 0) { prime = 0; break; }
+        }
+        if (!prime) continue;
+        ref_k[i] = (i >= 64 && i < 90) ? ext[i - 64] : cube_root_bits(p);
+        i++;
+    }
+}
+
+static void reference_compress(int rounds, uint32_t s[8], const uint8_t* blk) {
+    uint32_t w[SHA256_90R_VARIANT_MAX_ROUNDS];
+    uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+
+    for (int i = 0; i < 16; i++)
+        w[i] = ((uint32_t)blk[4 * i] << 24) | ((uint32_t)blk[4 * i + 1] << 16) | ((uint32_t)blk[4 * i + 2] << 8) | blk[4 * i + 3];
+    for (int i = 16; i < rounds; i++)
+        w[i] = (ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10)) + w[i - 7] +
+               (ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3)) + w[i - 16];
+    for (int i = 0; i < rounds; i++) {
+        uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + ref_k[i] + w[i];
+        uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+    }
+    s[0] += a; s[1] += b; s[2] += c; s[3] += d; s[4] += e; s[5] += f; s[6] += g; s[7] += h;
+}
+
+static void reference_hash(int rounds, const uint8_t* msg, size_t len, uint8_t out[32]) {
+    uint32_t s[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    uint8_t tail[128] = {0};
+    size_t full = len / 64, rem = len % 64, n = rem < 56 ? 1 : 2;
+
+    for (size_t i = 0; i < full; i++) reference_compress(rounds, s, msg + 64 * i);
+    memcpy(tail, msg + 64 * full, rem);
+    tail[rem] = 0x80;
+    for (int i = 0; i < 8; i++) tail[64 * n - 1 - i] = (uint8_t)((uint64_t)len * 8 >> (8 * i));
+    for (size_t i = 0; i < n; i++) reference_compress(rounds, s, tail + 64 * i);
+    for (int i = 0; i < 8; i++) {
+        out[4 * i] = (uint8_t)(s[i] >> 24); out[4 * i + 1] = (uint8_t)(s[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(s[i] >> 8); out[4 * i + 3] = (uint8_t)s[i];
+    }
+}
+
+// Every single-stream kernel of v, one-shot and over uneven pieces
+static int check_kernels(const sha256_90r_variant_t* v, const uint8_t* buf) {
+    static const sha256_90r_kernel_t kernels[] = {
+        SHA256_90R_KERNEL_SCALAR, SHA256_90R_KERNEL_SCALAR_ROLLING,
+        SHA256_90R_KERNEL_SCALAR_BMI2, SHA256_90R_KERNEL_AVX2
+    };
+    int rounds = sha256_90r_variant_rounds(v);
+    int failures = 0;
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        sha256_90r_variant_ctx_t ctx;
+        int avail = sha256_90r_variant_kernel_available(v, kernels[k]);
+
+        sha256_90r_variant_init(&ctx, v);
+        if ((sha256_90r_variant_set_kernel(&ctx, kernels[k]) == 0) != avail) {
+            printf("  FAIL: %s set_kernel(%s) disagrees with kernel_available\n",
+                   sha256_90r_variant_name(v), sha256_90r_kernel_name(kernels[k]));
+            failures++;
+        }
+        if (!avail) continue;
+
+        for (size_t len = 0; len <= MAX_LEN; len += (len < 130 ? 1 : 37)) {
+            uint8_t want[32], got[32];
+            size_t off = 0;
+
+            reference_hash(rounds, buf, len, want);
+            while (off < len) {
+                size_t take = next_random() % 150;
+                if (take > len - off) take = len - off;
+                sha256_90r_variant_update(&ctx, buf + off, take);
+                off += take;
+            }
+            if (sha256_90r_variant_final(&ctx, got) != 0 || memcmp(got, want, 32) != 0) {
+                if (failures++ < 5) printf("  FAIL: %s %s len=%zu mismatch\n", sha256_90r_variant_name(v),
+                                           sha256_90r_kernel_name(kernels[k]), len);
+            }
+        }
+    }
+    return failures;
+}
+
+static int check_batch(const sha256_90r_variant_t* v, const uint8_t* buf, const char* width) {
+    const uint8_t* msgs[NUM_MESSAGES];
+    size_t lens[NUM_MESSAGES];
+    uint8_t digests[NUM_MESSAGES][32];
+    uint8_t* outs[NUM_MESSAGES];
+    int failures = 0;
+
+    for (int i = 0; i < NUM_MESSAGES; i++) {
+        // A few long messages so the last lane outlives the others
+        lens[i] = i % 17 == 3 ? MAX_LEN - (size_t)i : next_random() % 300;
+        msgs[i] = buf + next_random() % 64;
+        outs[i] = digests[i];
+    }
+    for (size_t count = 1; count <= NUM_MESSAGES; count = count * 2 + 3) {
+        memset(digests, 0, sizeof(digests));
+        if (sha256_90r_variant_batch(v, msgs, lens, outs, count) != 0) {
+            printf("  FAIL: %s batch (%s) count=%zu rejected\n", sha256_90r_variant_name(v), width, count);
+            return 1;
+        }
+        for (size_t i = 0; i < count; i++) {
+            uint8_t want[32];
+            reference_hash(sha256_90r_variant_rounds(v), msgs[i], lens[i], want);
+            if (memcmp(digests[i], want, 32) != 0 && failures++ < 3) {
+                printf("  FAIL: %s batch (%s) count=%zu message %zu mismatch\n",
+                       sha256_90r_variant_name(v), width, count, i);
+            }
+        }
+    }
+    return failures;
+}
+
+// Pins the multi-buffer width through a hand-written tune cache
+static int force_mb_lanes(const char* path, int lanes) {
+    sha256_90r_tune_plan_t p;
+    FILE* f = fopen(path, "w");
+
+    if (!f) return -1;
+    sha256_90r_get_tune_plan(&p);
+    fprintf(f, "version=%s\ncpu_model=%s\ncpus=%d\nkernel=%d\nmb_lanes=%d\nbatch_min_count=1\n"
+               "max_threads=%d\nbytes_per_thread=65536\ntree_chunk_size=131072\n",
+            sha256_90r_version(), p.cpu_model, p.cpus, (int)SHA256_90R_KERNEL_SCALAR, lanes, p.cpus);
+    fclose(f);
+    return sha256_90r_autotune(0, &p) == 0 && p.from_cache && p.mb_lanes == lanes ? 0 : -1;
+}
+
+int main(void) {
+    static const int expected_rounds[] = {72, 80, 90, 128};
+    uint8_t* buf = malloc(MAX_LEN + 64);
+    uint8_t digests[4][32];
+    char cache[] = "/tmp/sha256_90r_variant_XXXXXX";
+    int failed = 0, fd;
+
+    printf("=== SHA256-90R Round-Count Variants Test ===\n");
+    if (!buf) {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < MAX_LEN + 64; i++) buf[i] = (uint8_t)next_random();
+    build_reference_constants();
+
+    // Registry
+    if (sha256_90r_variant_count() != 4 || sha256_90r_variant_get(4) != NULL ||
+        sha256_90r_variant_find(91) != NULL || sha256_90r_variant_find(0) != NULL) {
+        printf("  FAIL: registry size or lookup of unknown round counts\n");
+        failed = 1;
+    }
+    for (int i = 0; i < 4; i++) {
+        const sha256_90r_variant_t* v = sha256_90r_variant_find(expected_rounds[i]);
+        char name[32];
+        snprintf(name, sizeof(name), "SHA256-%dR", expected_rounds[i]);
+        if (!v || v != sha256_90r_variant_get((size_t)i) || sha256_90r_variant_rounds(v) != expected_rounds[i] ||
+            strcmp(sha256_90r_variant_name(v), name) != 0) {
+            printf("  FAIL: registry entry for %d rounds\n", expected_rounds[i]);
+            failed = 1;
+        }
+    }
+
+    // The 90-round variant is SHA256-90R
+    for (size_t len = 0; len <= MAX_LEN; len += 7) {
+        uint8_t want[32], got[32], ref[32];
+        sha256_90r_hash(buf, len, want);
+        reference_hash(90, buf, len, ref);
+        if (sha256_90r_variant_hash(sha256_90r_variant_find(90), buf, len, got) != 0 ||
+            memcmp(got, want, 32) != 0 || memcmp(ref, want, 32) != 0) {
+            printf("  FAIL: 90-round variant differs from sha256_90r_hash at len=%zu\n", len);
+            failed = 1;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < sha256_90r_variant_count(); i++) {
+        const sha256_90r_variant_t* v = sha256_90r_variant_get(i);
+        int f = check_kernels(v, buf) + check_batch(v, buf, "default width");
+        printf("  %-12s kernels:", sha256_90r_variant_name(v));
+        for (int k = 0; k < SHA256_90R_NUM_KERNELS; k++) {
+            if (sha256_90r_variant_kernel_available(v, (sha256_90r_kernel_t)k))
+                printf(" %s", sha256_90r_kernel_name((sha256_90r_kernel_t)k));
+        }
+        printf(" -> %s\n", f ? "FAIL" : "OK");
+        failed |= f != 0;
+        sha256_90r_variant_hash(v, buf, 100, digests[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        for (int j = i + 1; j < 4; j++) {
+            if (memcmp(digests[i], digests[j], 32) == 0) {
+                printf("  FAIL: %d- and %d-round digests collide\n", expected_rounds[i], expected_rounds[j]);
+                failed = 1;
+            }
+        }
+    }
+
+    // Batch at the 8-lane width (count 1 above already took the serial path).
+    // A process applies one plan, so this comes after the default-width runs.
+    if (sha256_90r_kernel_available(SHA256_90R_KERNEL_AVX2_8WAY) && (fd = mkstemp(cache)) >= 0) {
+        close(fd);
+        setenv("SHA256_90R_TUNE_CACHE", cache, 1);
+        if (force_mb_lanes(cache, 8) != 0) {
+            printf("  FAIL: could not pin mb_lanes=8\n");
+            failed = 1;
+        } else {
+            for (size_t i = 0; i < sha256_90r_variant_count(); i++)
+                failed |= check_batch(sha256_90r_variant_get(i), buf, "8 lanes") != 0;
+            printf("  batch at 8 lanes: %s\n", failed ? "FAIL" : "OK");
+        }
+        unlink(cache);
+    }
+
+    // Invalid input
+    {
+        sha256_90r_variant_ctx_t ctx;
+        const uint8_t* msg = NULL;
+        size_t len = 5;
+        uint8_t out[32];
+        uint8_t* outp = out;
+        if (sha256_90r_variant_init(&ctx, NULL) != -1 ||
+            sha256_90r_variant_hash(sha256_90r_variant_find(80), NULL, 3, out) != -1 ||
+            sha256_90r_variant_batch(sha256_90r_variant_find(80), &msg, &len, &outp, 1) != -1 ||
+            (sha256_90r_variant_init(&ctx, sha256_90r_variant_find(72)) == 0 &&
+             sha256_90r_variant_set_kernel(&ctx, SHA256_90R_KERNEL_AVX2_8WAY) != -1)) {
+            printf("  FAIL: invalid arguments accepted\n");
+            failed = 1;
+        }
+    }
+
+    printf("%s\n", failed ? "Round-count variants test FAILED" : "Round-count variants test PASSED");
+    free(buf);
+    return failed ? 1 : 0;
+}
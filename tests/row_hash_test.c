@@ -0,0 +1,193 @@
+/*********************************************************************
+* Filename:   row_hash_test.c
+* Author:     SHA256-90R columnar row hashing test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks sha256_90r_hash_rows against sha256_90r_hash of each
+*             row serialized by hand: fixed-width, bool, binary and
+*             large-binary columns with and without nulls, values shorter
+*             and longer than a block, sliced batches, row counts that
+*             fill, underfill and overrun the 8/16 lanes, int32 and int64
+*             offsets giving the same digests, and argument checks.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0x082efa98ec4e6c89ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define MAX_ROWS 1200
+#define SLICE 3                     // Row 0 of the sliced batch is value 3
+#define NCOLS 7
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Row i (buffer index) as the documented message
+static size_t serialize_row(const sha256_90r_column_t* cols, size_t ncols, size_t i, uint8_t* out) {
+    size_t n = 0;
+    for (size_t c = 0; c < ncols; c++) {
+        const sha256_90r_column_t* col = &cols[c];
+        size_t k = col->offset + i;
+        uint64_t start, end;
+
+        if (col->validity && !(col->validity[k / 8] >> (k % 8) & 1)) {
+            out[n++] = 0x00;
+            continue;
+        }
+        out[n++] = 0x01;
+        switch (col->type) {
+        case SHA256_90R_COLUMN_FIXED:
+            memcpy(out + n, (const uint8_t*)col->data + k * col->width, col->width);
+            n += col->width;
+            break;
+        case SHA256_90R_COLUMN_BOOL:
+            out[n++] = ((const uint8_t*)col->data)[k / 8] >> (k % 8) & 1;
+            break;
+        default:
+            if (col->type == SHA256_90R_COLUMN_BINARY) {
+                start = (uint64_t)((const int32_t*)col->offsets)[k];
+                end = (uint64_t)((const int32_t*)col->offsets)[k + 1];
+            } else {
+                start = (uint64_t)((const int64_t*)col->offsets)[k];
+                end = (uint64_t)((const int64_t*)col->offsets)[k + 1];
+            }
+            for (int b = 0; b < 4; b++) out[n++] = (uint8_t)((end - start) >> (8 * b));
+            memcpy(out + n, (const uint8_t*)col->data + start, end - start);
+            n += end - start;
+            break;
+        }
+    }
+    return n;
+}
+
+static int check_rows(const sha256_90r_column_t* cols, size_t ncols, size_t rows, const char* what) {
+    static uint8_t got[MAX_ROWS][32];
+    static uint8_t msg[16384];
+
+    if (sha256_90r_hash_rows(cols, ncols, rows, got) != 0) {
+        printf("  FAIL: %s rows=%zu returned an error\n", what, rows);
+        return 1;
+    }
+    for (size_t r = 0; r < rows; r++) {
+        uint8_t want[32];
+        sha256_90r_hash(msg, serialize_row(cols, ncols, r, msg), want);
+        if (memcmp(want, got[r], 32) != 0) {
+            printf("  FAIL: %s rows=%zu row %zu\n", what, rows, r);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    static int32_t i32[MAX_ROWS + SLICE];
+    static int64_t i64[MAX_ROWS + SLICE];
+    static uint8_t fsb[MAX_ROWS + SLICE][16];
+    static uint8_t bools[(MAX_ROWS + SLICE + 7) / 8], bool_valid[(MAX_ROWS + SLICE + 7) / 8];
+    static uint8_t i64_valid[(MAX_ROWS + SLICE + 7) / 8], str_valid[(MAX_ROWS + SLICE + 7) / 8];
+    static int32_t str_off[MAX_ROWS + SLICE + 1], blob_off[MAX_ROWS + SLICE + 1];
+    static int64_t str_off64[MAX_ROWS + SLICE + 1];
+    static const size_t counts[] = {1, 2, 7, 8, 9, 15, 16, 17, 33, 100, MAX_ROWS};
+    uint8_t* strs = malloc((MAX_ROWS + SLICE) * 40);
+    uint8_t* blobs = malloc((MAX_ROWS + SLICE) * 300);
+    sha256_90r_column_t cols[NCOLS], sliced[NCOLS];
+    int failed = 0;
+
+    printf("=== SHA256-90R Row Hashing Test ===\n");
+    if (!strs || !blobs) return 1;
+    for (size_t i = 0; i < MAX_ROWS + SLICE; i++) {
+        i32[i] = (int32_t)next_random();
+        i64[i] = (int64_t)next_random() << 32 | next_random();
+        for (int b = 0; b < 16; b++) fsb[i][b] = (uint8_t)next_random();
+        if (next_random() & 1) bools[i / 8] |= (uint8_t)(1 << (i % 8));
+        if (next_random() % 4) bool_valid[i / 8] |= (uint8_t)(1 << (i % 8));
+        if (next_random() % 3) i64_valid[i / 8] |= (uint8_t)(1 << (i % 8));
+        if (next_random() % 5) str_valid[i / 8] |= (uint8_t)(1 << (i % 8));
+        // Short strings, and blobs from empty to several blocks
+        str_off[i + 1] = str_off[i] + (int32_t)(next_random() % 40);
+        blob_off[i + 1] = blob_off[i] + (int32_t)(i % 11 == 0 ? 0 : next_random() % 300);
+    }
+    for (size_t i = 0; i <= MAX_ROWS + SLICE; i++) str_off64[i] = str_off[i];
+    for (int32_t i = 0; i < str_off[MAX_ROWS + SLICE]; i++) strs[i] = (uint8_t)('a' + next_random() % 26);
+    for (int32_t i = 0; i < blob_off[MAX_ROWS + SLICE]; i++) blobs[i] = (uint8_t)next_random();
+
+    memset(cols, 0, sizeof(cols));
+    cols[0] = (sha256_90r_column_t){SHA256_90R_COLUMN_FIXED, 4, i32, NULL, NULL, 0};
+    cols[1] = (sha256_90r_column_t){SHA256_90R_COLUMN_FIXED, 8, i64, NULL, i64_valid, 0};
+    cols[2] = (sha256_90r_column_t){SHA256_90R_COLUMN_BOOL, 0, bools, NULL, bool_valid, 0};
+    cols[3] = (sha256_90r_column_t){SHA256_90R_COLUMN_BINARY, 0, strs, str_off, str_valid, 0};
+    cols[4] = (sha256_90r_column_t){SHA256_90R_COLUMN_FIXED, 16, fsb, NULL, NULL, 0};
+    cols[5] = (sha256_90r_column_t){SHA256_90R_COLUMN_BINARY, 0, blobs, blob_off, NULL, 0};
+    cols[6] = (sha256_90r_column_t){SHA256_90R_COLUMN_LARGE_BINARY, 0, strs, str_off64, NULL, 0};
+
+    // Every prefix of the schema, so rows range from one byte to several blocks
+    for (size_t n = 1; n <= NCOLS; n++) {
+        for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+            failed |= check_rows(cols, n, counts[k], "columns");
+        }
+    }
+    printf("  fixed, bool, binary columns: %s\n", failed ? "FAILED" : "OK");
+
+    // A slice of every column: buffers and bitmaps start at value SLICE
+    for (int c = 0; c < NCOLS; c++) {
+        sliced[c] = cols[c];
+        sliced[c].offset = SLICE;
+    }
+    failed |= check_rows(sliced, NCOLS, MAX_ROWS, "sliced");
+    failed |= check_rows(sliced, NCOLS, 5, "sliced");
+    {
+        // Nothing but nulls, and no columns at all (the empty message)
+        static const uint8_t none[(MAX_ROWS + SLICE + 7) / 8];
+        static uint8_t got[MAX_ROWS][32];
+        uint8_t empty[32];
+        sha256_90r_column_t nulls = cols[3];
+        nulls.validity = none;
+        failed |= check_rows(&nulls, 1, 100, "all null");
+        sha256_90r_hash(NULL, 0, empty);
+        if (sha256_90r_hash_rows(NULL, 0, 20, got) != 0 || memcmp(got[19], empty, 32) != 0) failed = 1;
+    }
+    printf("  slices and nulls: %s\n", failed ? "FAILED" : "OK");
+
+    {
+        // int32 and int64 offsets over the same strings give the same digests
+        static uint8_t a[MAX_ROWS][32], b[MAX_ROWS][32];
+        if (sha256_90r_hash_rows(&cols[3], 1, MAX_ROWS, a) != 0 ||
+            sha256_90r_hash_rows(&(sha256_90r_column_t){SHA256_90R_COLUMN_LARGE_BINARY, 0, strs, str_off64,
+                                                         str_valid, 0}, 1, MAX_ROWS, b) != 0 ||
+            memcmp(a, b, sizeof(a)) != 0) {
+            printf("  FAIL: binary and large binary differ\n");
+            failed = 1;
+        }
+    }
+    {
+        static uint8_t got[16][32];
+        int32_t bad_off[4] = {0, 5, 3, 8};
+        sha256_90r_column_t bad[4] = {
+            {SHA256_90R_COLUMN_FIXED, 0, i32, NULL, NULL, 0},
+            {SHA256_90R_COLUMN_BINARY, 0, strs, bad_off, NULL, 0},
+            {SHA256_90R_COLUMN_BINARY, 0, strs, NULL, NULL, 0},
+            {(sha256_90r_column_type_t)42, 4, i32, NULL, NULL, 0},
+        };
+        for (int c = 0; c < 4; c++) {
+            if (sha256_90r_hash_rows(&bad[c], 1, 3, got) != -1) {
+                printf("  FAIL: bad column %d accepted\n", c);
+                failed = 1;
+            }
+        }
+        if (sha256_90r_hash_rows(cols, 1, 3, NULL) != -1 || sha256_90r_hash_rows(NULL, 1, 3, got) != -1 ||
+            sha256_90r_hash_rows(bad, 1, 0, got) != 0) {
+            printf("  FAIL: argument checks\n");
+            failed = 1;
+        }
+    }
+    printf("  offset widths and argument checks: %s\n", failed ? "FAILED" : "OK");
+
+    free(strs);
+    free(blobs);
+    printf("%s\n", failed ? "Row hashing test FAILED" : "Row hashing test PASSED");
+    return failed ? 1 : 0;
+}
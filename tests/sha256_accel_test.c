@@ -0,0 +1,191 @@
+/*********************************************************************
+* Filename:   sha256_accel_test.c
+* Author:     SHA256-90R legacy SHA-256 acceleration test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks every standard SHA-256 implementation this CPU
+*             supports (scalar, SHA-NI, 8-lane AVX2) against the
+*             FIPS 180-2 test vectors, streaming with odd chunk sizes,
+*             and the batch API against the scalar code for messages of
+*             random, unequal lengths.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256.h"
+#define TEST_RNG_SEED 0x243f6a8885a308d3ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define BATCH_COUNT 77
+#define BATCH_MAX_LEN 700
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+    const char* msg;
+    size_t repeat;
+    const char* digest;
+} sha256_vector_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static const sha256_vector_t vectors[] = {
+    {"", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+    {"abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+    {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+     "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+    {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmno"
+     "ijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+     "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"},
+    {"a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+};
+
+
+static void to_hex(const BYTE* hash, char* out) {
+    for (int i = 0; i < SHA256_BLOCK_SIZE; i++) {
+        sprintf(out + 2 * i, "%02x", hash[i]);
+    }
+}
+
+/**
+ * Hash each vector in chunks of 1, 63, 64, 65 and 1000 bytes (and whole)
+ */
+static int check_vectors(void) {
+    static const size_t chunks[] = {0, 1, 63, 64, 65, 1000};
+    int failures = 0;
+
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+        size_t unit = strlen(vectors[v].msg);
+        size_t len = unit * vectors[v].repeat;
+        BYTE* msg = malloc(len + 1);
+        if (!msg) return 1;
+        for (size_t r = 0; r < vectors[v].repeat; r++) {
+            memcpy(msg + r * unit, vectors[v].msg, unit);
+        }
+
+        for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+            SHA256_CTX ctx;
+            BYTE hash[SHA256_BLOCK_SIZE];
+            char hex[2 * SHA256_BLOCK_SIZE + 1];
+            size_t step = chunks[c] ? chunks[c] : (len ? len : 1);
+
+            // Byte-at-a-time over a million bytes adds nothing but time
+            if (vectors[v].repeat > 1 && chunks[c] == 1) continue;
+
+            sha256_init(&ctx);
+            for (size_t off = 0; off < len; off += step) {
+                sha256_update(&ctx, msg + off, len - off < step ? len - off : step);
+            }
+            sha256_final(&ctx, hash);
+            to_hex(hash, hex);
+            if (strcmp(hex, vectors[v].digest) != 0) {
+                printf("  FAIL: vector %zu chunk %zu: got %s\n", v, chunks[c], hex);
+                failures++;
+            }
+        }
+
+        // One-shot and single-message batch must agree
+        {
+            BYTE hash[SHA256_BLOCK_SIZE];
+            BYTE batch_hash[1][SHA256_BLOCK_SIZE];
+            const BYTE* ptrs[1] = {msg};
+            char hex[2 * SHA256_BLOCK_SIZE + 1];
+
+            sha256(msg, len, hash);
+            to_hex(hash, hex);
+            if (strcmp(hex, vectors[v].digest) != 0) {
+                printf("  FAIL: vector %zu one-shot: got %s\n", v, hex);
+                failures++;
+            }
+            sha256_batch(ptrs, &len, batch_hash, 1);
+            to_hex(batch_hash[0], hex);
+            if (strcmp(hex, vectors[v].digest) != 0) {
+                printf("  FAIL: vector %zu batch: got %s\n", v, hex);
+                failures++;
+            }
+        }
+        free(msg);
+    }
+    return failures;
+}
+
+/**
+ * Batch of unequal messages (lengths around the 55/56/64 padding edges
+ * included) against the reference digests computed with scalar code
+ */
+static int check_batch(const BYTE* const* msgs, const size_t* lens, BYTE (*expected)[SHA256_BLOCK_SIZE]) {
+    BYTE (*hashes)[SHA256_BLOCK_SIZE] = malloc(sizeof(*hashes) * BATCH_COUNT);
+    int failures = 0;
+
+    if (!hashes) return 1;
+    memset(hashes, 0, sizeof(*hashes) * BATCH_COUNT);
+
+    // Every prefix size, so lanes drain in every pattern
+    for (size_t count = 0; count <= BATCH_COUNT; count += (count < 17 ? 1 : 20)) {
+        sha256_batch(msgs, lens, hashes, count);
+        for (size_t i = 0; i < count; i++) {
+            if (memcmp(hashes[i], expected[i], SHA256_BLOCK_SIZE) != 0) {
+                if (failures++ < 3) {
+                    printf("  FAIL: batch of %zu, message %zu (len %zu) mismatch\n", count, i, lens[i]);
+                }
+            }
+        }
+    }
+    free(hashes);
+    return failures;
+}
+
+int main(void) {
+    static const SHA256_IMPL impls[] = {
+        SHA256_IMPL_SCALAR, SHA256_IMPL_SHA_NI, SHA256_IMPL_AVX2, SHA256_IMPL_AUTO
+    };
+    const BYTE* msgs[BATCH_COUNT];
+    size_t lens[BATCH_COUNT];
+    BYTE (*expected)[SHA256_BLOCK_SIZE] = malloc(sizeof(*expected) * BATCH_COUNT);
+    BYTE* pool = malloc((size_t)BATCH_COUNT * BATCH_MAX_LEN);
+    int failed = 0;
+
+    printf("=== Standard SHA-256 Implementation Test ===\n");
+    if (!expected || !pool) {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < (size_t)BATCH_COUNT * BATCH_MAX_LEN; i++) {
+        pool[i] = (BYTE)next_random();
+    }
+    for (size_t i = 0; i < BATCH_COUNT; i++) {
+        static const size_t edges[] = {0, 1, 55, 56, 63, 64, 65, 119, 120, 128};
+        msgs[i] = pool + i * BATCH_MAX_LEN;
+        lens[i] = i < sizeof(edges) / sizeof(edges[0]) ? edges[i] : next_random() % BATCH_MAX_LEN;
+    }
+
+    if (sha256_set_impl(SHA256_IMPL_SCALAR) != 0) {
+        printf("FAIL: scalar implementation rejected\n");
+        return 1;
+    }
+    for (size_t i = 0; i < BATCH_COUNT; i++) {
+        sha256(msgs[i], lens[i], expected[i]);
+    }
+
+    for (size_t n = 0; n < sizeof(impls) / sizeof(impls[0]); n++) {
+        int failures;
+        if (sha256_set_impl(impls[n]) != 0) {
+            printf("  %-10s not supported on this CPU, skipped\n", sha256_impl_name(impls[n]));
+            continue;
+        }
+        failures = check_vectors();
+        failures += check_batch(msgs, lens, expected);
+        printf("  %-10s (%s) %s\n", sha256_impl_name(impls[n]),
+               sha256_impl_name(sha256_get_impl()), failures ? "FAIL" : "OK");
+        failed |= failures != 0;
+    }
+
+    sha256_set_impl(SHA256_IMPL_AUTO);
+    printf("%s\n", failed ? "SHA-256 implementation test FAILED" : "SHA-256 implementation test PASSED");
+    free(expected);
+    free(pool);
+    return failed ? 1 : 0;
+}
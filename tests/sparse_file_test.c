@@ -0,0 +1,135 @@
+/*********************************************************************
+* Filename:   sparse_file_test.c
+* Author:     SHA256-90R sparse file hashing test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks sha256_90r_hash_fd / sha256_90r_hash_file against
+*             sha256_90r_hash of the file read in full: empty, all-hole
+*             and odd-sized files, data extents at aligned and unaligned
+*             offsets between holes, written-out zero blocks between
+*             data, and files ending in a hole or in data. Reports how
+*             many bytes were skipped as holes and checks the accounting
+*             and that the descriptor's offset is left alone.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0x13198a2e03707344ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define MAX_FILE (8u << 20)
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static void write_at(int fd, const uint8_t* data, size_t len, off_t off) {
+    if (pwrite(fd, data, len, off) != (ssize_t)len) {
+        perror("pwrite");
+        exit(1);
+    }
+}
+
+// Hash the file both ways and compare; returns 1 on failure
+static int check(const char* label, const char* path, uint8_t* scratch, uint64_t* holes) {
+    sha256_90r_file_stats_t stats;
+    uint8_t want[32], got_fd[32], got_path[32];
+    int fd = open(path, O_RDONLY);
+    off_t size = lseek(fd, 0, SEEK_END), done = 0;
+    int failed = 0;
+
+    lseek(fd, 0, SEEK_SET);
+    while (done < size) {
+        ssize_t got = read(fd, scratch + done, (size_t)(size - done));
+        if (got <= 0) break;
+        done += got;
+    }
+    sha256_90r_hash(scratch, (size_t)size, want);
+
+    lseek(fd, 123, SEEK_SET);
+    if (sha256_90r_hash_fd(fd, got_fd, &stats) != 0 || lseek(fd, 0, SEEK_CUR) != 123) {
+        printf("  FAIL: %s: hash_fd failed or moved the offset\n", label);
+        failed = 1;
+    }
+    close(fd);
+    if (sha256_90r_hash_file(path, got_path, NULL) != 0) {
+        printf("  FAIL: %s: hash_file failed\n", label);
+        failed = 1;
+    }
+    if (memcmp(got_fd, want, 32) != 0 || memcmp(got_path, want, 32) != 0) {
+        printf("  FAIL: %s: digest differs from reading the whole file\n", label);
+        failed = 1;
+    }
+    if (stats.file_size != (uint64_t)size || stats.bytes_read + stats.hole_bytes != (uint64_t)size) {
+        printf("  FAIL: %s: stats %llu read + %llu holes != %lld bytes\n", label,
+               (unsigned long long)stats.bytes_read, (unsigned long long)stats.hole_bytes, (long long)size);
+        failed = 1;
+    }
+    *holes += stats.hole_bytes;
+    printf("  %-28s %9lld bytes, %9llu skipped as holes: %s\n", label, (long long)size,
+           (unsigned long long)stats.hole_bytes, failed ? "FAILED" : "OK");
+    return failed;
+}
+
+int main(void) {
+    const char* tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char path[512];
+    uint8_t* scratch = malloc(MAX_FILE);
+    uint8_t* data = malloc(1u << 20);
+    uint64_t holes = 0;
+    int failed = 0, fd;
+
+    printf("=== SHA256-90R Sparse File Test ===\n");
+    snprintf(path, sizeof(path), "%s/sha256_90r_sparse_XXXXXX", tmpdir);
+    fd = mkstemp(path);
+    if (fd < 0 || !scratch || !data) {
+        perror("mkstemp");
+        return 1;
+    }
+    for (size_t i = 0; i < (1u << 20); i++) data[i] = (uint8_t)next_random();
+
+    failed |= check("empty", path, scratch, &holes);
+
+    if (ftruncate(fd, (1u << 20) + 37) != 0) return 1;
+    failed |= check("all hole, odd size", path, scratch, &holes);
+
+    // Data between holes, at page-aligned and unaligned offsets, ending in a hole
+    if (ftruncate(fd, 0) != 0 || ftruncate(fd, (6u << 20) + 5) != 0) return 1;
+    write_at(fd, data, 4096, 0);
+    write_at(fd, data + 100, 70000, 1u << 20);
+    write_at(fd, data + 7, 333, (3u << 20) + 4093);
+    write_at(fd, data + 999, 64 * 1024, 5u << 20);
+    failed |= check("extents between holes", path, scratch, &holes);
+
+    // Ends in data, odd length
+    write_at(fd, data + 5, 10001, (6u << 20) + 5);
+    failed |= check("ends in data", path, scratch, &holes);
+
+    // Zero blocks written out inside data (not holes), around uneven data
+    if (ftruncate(fd, 0) != 0) return 1;
+    memset(scratch, 0, 300000);
+    write_at(fd, scratch, 300000, 0);
+    write_at(fd, data, 61, 4096 + 3);
+    write_at(fd, data, 64, 65536);
+    write_at(fd, data, 1, 299999);
+    failed |= check("zero blocks inside data", path, scratch, &holes);
+
+    close(fd);
+    unlink(path);
+    if (holes == 0) printf("  (this filesystem reported no holes; files were read in full)\n");
+
+    if (sha256_90r_hash_file("/nonexistent/sha256_90r", scratch, NULL) != -1 ||
+        sha256_90r_hash_fd(-1, scratch, NULL) != -1) {
+        printf("  FAIL: errors not reported\n");
+        failed = 1;
+    }
+
+    free(scratch);
+    free(data);
+    printf("%s\n", failed ? "Sparse file test FAILED" : "Sparse file test PASSED");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*********************************************************************
+* Filename:   striped_hash_test.c
+* Author:     SHA256-90R striped hashing test
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Checks every striped algorithm ID against a reference built
+*             from sha256_90r_hash: each lane's 64-byte units are gathered
+*             into their own message, hashed, and the lane digests hashed
+*             behind the header. Lengths around unit and stripe boundaries,
+*             uneven streaming, context reuse after final, and that the
+*             IDs really name different functions.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#define TEST_RNG_SEED 0xa4093822299f31d0ULL
+#include "test_util.h"
+
+/****************************** MACROS ******************************/
+#define BUF_SIZE (16 * 64 * 40 + 333)
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+// Straight from the definition: lane j takes units j, j + L, j + 2L, ...
+static void reference_striped(int lanes, const uint8_t* data, size_t len, uint8_t out[32]) {
+    uint8_t* lane_msg = malloc(len + 64);
+    uint8_t* outer = malloc(16 + 32 * lanes);
+
+    memcpy(outer, "S90R", 4);
+    outer[4] = 1;
+    outer[5] = (uint8_t)lanes;
+    outer[6] = outer[7] = 0;
+    for (int i = 0; i < 8; i++) outer[8 + i] = (uint8_t)((uint64_t)len >> (56 - 8 * i));
+
+    for (int j = 0; j < lanes; j++) {
+        size_t n = 0;
+        for (size_t off = 64 * (size_t)j; off < len; off += 64 * (size_t)lanes) {
+            size_t take = len - off < 64 ? len - off : 64;
+            memcpy(lane_msg + n, data + off, take);
+            n += take;
+        }
+        sha256_90r_hash(lane_msg, n, outer + 16 + 32 * j);
+    }
+    sha256_90r_hash(outer, 16 + 32 * (size_t)lanes, out);
+    free(lane_msg);
+    free(outer);
+}
+
+static int check_alg(sha256_90r_alg_t alg, int lanes, const uint8_t* buf) {
+    size_t stripe = 64 * (size_t)lanes;
+    size_t lens[] = {0, 1, 63, 64, 65, stripe - 1, stripe, stripe + 1, stripe + 64, 2 * stripe - 65,
+                     3 * stripe + 17, BUF_SIZE};
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        uint8_t want[32], got[32];
+        sha256_90r_striped_ctx_t* ctx;
+
+        reference_striped(lanes, buf, lens[i], want);
+        if (sha256_90r_striped_hash(alg, buf, lens[i], got) != 0 || memcmp(got, want, 32) != 0) {
+            printf("  FAIL: %s one-shot len=%zu mismatch\n", sha256_90r_alg_name(alg), lens[i]);
+            failures++;
+        }
+
+        // Uneven pieces, then the same context again for a second message
+        ctx = sha256_90r_striped_new(alg);
+        for (int round = 0; round < 2 && ctx; round++) {
+            size_t off = 0;
+            while (off < lens[i]) {
+                size_t take = next_random() % (2 * stripe + 3);
+                if (take > lens[i] - off) take = lens[i] - off;
+                sha256_90r_striped_update(ctx, buf + off, take);
+                off += take;
+            }
+            if (sha256_90r_striped_final(ctx, got) != 0 || memcmp(got, want, 32) != 0) {
+                printf("  FAIL: %s streaming len=%zu round %d mismatch\n", sha256_90r_alg_name(alg), lens[i], round);
+                failures++;
+            }
+        }
+        if (!ctx) failures++;
+        sha256_90r_striped_free(ctx);
+    }
+    return failures;
+}
+
+int main(void) {
+    static const struct { sha256_90r_alg_t alg; int lanes; } algs[] = {
+        {SHA256_90R_ALG_STRIPED4_V1, 4},
+        {SHA256_90R_ALG_STRIPED8_V1, 8},
+        {SHA256_90R_ALG_STRIPED16_V1, 16},
+    };
+    uint8_t* buf = malloc(BUF_SIZE);
+    uint8_t digests[4][32];
+    int failed = 0;
+
+    printf("=== SHA256-90R Striped Hashing Test ===\n");
+    if (!buf) {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < BUF_SIZE; i++) buf[i] = (uint8_t)next_random();
+
+    for (size_t a = 0; a < sizeof(algs) / sizeof(algs[0]); a++) {
+        int f = check_alg(algs[a].alg, algs[a].lanes, buf);
+        printf("  %-18s %s\n", sha256_90r_alg_name(algs[a].alg), f ? "FAIL" : "OK");
+        failed |= f != 0;
+    }
+
+    // Every ID is a distinct function of the same input
+    sha256_90r_striped_hash(SHA256_90R_ALG_SHA256_90R, buf, 5000, digests[0]);
+    sha256_90r_striped_hash(SHA256_90R_ALG_STRIPED4_V1, buf, 5000, digests[1]);
+    sha256_90r_striped_hash(SHA256_90R_ALG_STRIPED8_V1, buf, 5000, digests[2]);
+    sha256_90r_striped_hash(SHA256_90R_ALG_STRIPED16_V1, buf, 5000, digests[3]);
+    for (int i = 0; i < 4; i++) {
+        for (int j = i + 1; j < 4; j++) {
+            if (memcmp(digests[i], digests[j], 32) == 0) {
+                printf("  FAIL: algorithm IDs %d and %d collide\n", i, j);
+                failed = 1;
+            }
+        }
+    }
+    {
+        uint8_t want[32];
+        sha256_90r_hash(buf, 5000, want);
+        if (memcmp(digests[0], want, 32) != 0) {
+            printf("  FAIL: SHA256_90R_ALG_SHA256_90R is not sha256_90r_hash\n");
+            failed = 1;
+        }
+    }
+
+    // Invalid input
+    {
+        uint8_t out[32];
+        if (sha256_90r_striped_new((sha256_90r_alg_t)0x0105) != NULL ||
+            sha256_90r_striped_new(SHA256_90R_ALG_SHA256_90R) != NULL ||
+            sha256_90r_striped_hash((sha256_90r_alg_t)0x0208, buf, 10, out) != -1 ||
+            sha256_90r_striped_hash(SHA256_90R_ALG_STRIPED8_V1, NULL, 10, out) != -1 ||
+            sha256_90r_alg_name((sha256_90r_alg_t)0x0105) != NULL) {
+            printf("  FAIL: unknown algorithm ID or NULL data accepted\n");
+            failed = 1;
+        }
+    }
+
+    printf("%s\n", failed ? "Striped hashing test FAILED" : "Striped hashing test PASSED");
+    free(buf);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+/*********************************************************************
+* Filename:   test_util.h
+* Author:     SHA256-90R test helpers
+* Copyright:
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Helpers shared by the standalone tests. next_random() is
+*             a xorshift64* generator; a test picks its own fixed seed
+*             by defining TEST_RNG_SEED before including this header,
+*             so every run sees the same inputs.
+*********************************************************************/
+
+#ifndef SHA256_90R_TEST_UTIL_H
+#define SHA256_90R_TEST_UTIL_H
+
+/*************************** HEADER FILES ***************************/
+#include <stdint.h>
+
+/****************************** MACROS ******************************/
+#ifndef TEST_RNG_SEED
+#define TEST_RNG_SEED 0x9e3779b97f4a7c15ULL
+#endif
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static uint64_t rng_state = TEST_RNG_SEED;
+
+static inline uint32_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545f4914f6cdd1dULL) >> 32);
+}
+
+#endif // SHA256_90R_TEST_UTIL_H
@@ -23,6 +23,7 @@
 /****************************** MACROS ******************************/
 #define NUM_SAMPLES 10000
 #define INPUT_SIZE 64  // 64 bytes = 512 bits (one block)
+#define DUDECT_MEASUREMENTS 10000  // Per backend/API pair in the default run
 
 /**************************** DATA TYPES ****************************/
 typedef struct {
@@ -401,8 +402,65 @@ void collect_timing_samples_backend(double *samples, size_t count, const uint8_t
     printf("\n");
 }
 
+/**
+ * dudect-style fixed-vs-random analysis of every available backend and API.
+ * Returns the number of backend/API pairs whose leak score exceeds the threshold.
+ */
+int run_dudect_analysis(uint64_t measurements, int num_threads) {
+    const sha256_90r_backend_t backends[] = {
+        SHA256_90R_BACKEND_AUTO, SHA256_90R_BACKEND_SCALAR, SHA256_90R_BACKEND_SIMD,
+        SHA256_90R_BACKEND_SHA_NI, SHA256_90R_BACKEND_GPU, SHA256_90R_BACKEND_FPGA,
+        SHA256_90R_BACKEND_JIT
+    };
+    const char* backend_names[] = { "auto", "scalar", "simd", "sha_ni", "gpu", "fpga", "jit" };
+    int leaks = 0;
+
+    printf("=== dudect Fixed-vs-Random Leak Analysis ===\n");
+    printf("Measurements per pair: %llu, threshold |t| > %.1f\n\n",
+           (unsigned long long)measurements, SHA256_90R_CT_T_THRESHOLD);
+    printf("%-8s | %-9s | %-10s | %-10s | %-10s | %-8s | %-s\n",
+           "Backend", "API", "Score", "t (raw)", "t (2nd)", "Threads", "Verdict");
+    printf("%-8s-+-%-9s-+-%-10s-+-%-10s-+-%-10s-+-%-8s-+-%-s\n",
+           "--------", "---------", "----------", "----------", "----------", "--------", "-------");
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        for (int api = SHA256_90R_CT_API_TRANSFORM; api <= SHA256_90R_CT_API_ONESHOT; api++) {
+            sha256_90r_leak_report_t report;
+
+            if (sha256_90r_leak_test(backends[b], SHA256_90R_MODE_SECURE, (sha256_90r_ct_api_t)api,
+                                     measurements, num_threads, &report) != 0) {
+                printf("%-8s | %-9s | analysis failed\n", backend_names[b],
+                       sha256_90r_ct_api_name((sha256_90r_ct_api_t)api));
+                continue;
+            }
+            if (!report.supported) {
+                printf("%-8s | %-9s | %-10s | %-10s | %-10s | %-8s | %s\n", backend_names[b],
+                       sha256_90r_ct_api_name((sha256_90r_ct_api_t)api), "-", "-", "-", "-", "unavailable");
+                continue;
+            }
+
+            printf("%-8s | %-9s | %-10.2f | %-10.2f | %-10.2f | %-8d | %s\n", backend_names[b],
+                   sha256_90r_ct_api_name((sha256_90r_ct_api_t)api), report.leak_score,
+                   report.t_uncropped, report.t_second_order, report.threads,
+                   report.leak_detected ? "POTENTIAL LEAK" : "no evidence of leakage");
+            leaks += report.leak_detected;
+        }
+    }
+    printf("\n");
+
+    return leaks;
+}
+
 /*********************** MAIN FUNCTION ***********************/
 int main(int argc, char* argv[]) {
+    // Analyzer-only run: timing_leak_test --dudect [measurements] [threads]
+    // Exits 1 if any backend/API pair leaks, so CI can gate on it
+    if (argc > 1 && strcmp(argv[1], "--dudect") == 0) {
+        uint64_t measurements = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000ull;
+        int threads = argc > 3 ? atoi(argv[3]) : 0;
+        return run_dudect_analysis(measurements, threads) ? 1 : 0;
+    }
+
     printf("=== SHA256-90R Timing Side-Channel Leak Test ===\n");
     printf("Testing for timing differences between similar inputs\n");
     printf("Input size: %d bytes (%d bits)\n", INPUT_SIZE, INPUT_SIZE * 8);
@@ -581,7 +639,10 @@ int main(int argc, char* argv[]) {
 
     printf("\nNote: This comprehensive test covers multiple input patterns. While no\n");
     printf("      significant leaks were detected, additional testing with more diverse\n");
-    printf("      inputs and cache-based side-channel analysis would be beneficial.\n");
+    printf("      inputs and cache-based side-channel analysis would be beneficial.\n\n");
+
+    // Interleaved fixed-vs-random measurements for every backend and API
+    run_dudect_analysis(DUDECT_MEASUREMENTS, 0);
 
     // Cleanup
     free(samples1);
@@ -0,0 +1,569 @@
+/*********************************************************************
+* Filename:   sha256_90r_hashd.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Local hashing daemon. Clients send hash and HMAC requests
+*             over a Unix stream socket (framing in sha256_90r_hashd.h)
+*             and may pipeline any number of them. Requests from every
+*             connection go into one queue, which is hashed as a batch
+*             when it holds --max-batch requests, when its oldest
+*             request has waited --budget-us, or as soon as every
+*             connected client has a request queued (waiting longer
+*             could not add to the batch). Concurrent small requests
+*             then fill the multi-buffer lanes that none of the clients
+*             would fill alone. Feature detection and tuning run
+*             once, at startup. One thread: epoll for the sockets, a
+*             timerfd for the latency budget. Responses are written as
+*             each batch completes.
+*
+*             The socket is created mode 0600; chmod it to let another
+*             user or group connect. HMAC keys are wiped from the read
+*             buffer once parsed and from each request before it is freed.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#include "../src/sha256_90r/sha256_internal.h"
+#include "sha256_90r_hashd.h"
+
+/****************************** MACROS ******************************/
+#define HASHD_READ_BUF (64 * 1024)
+#define HASHD_OUT_HIGH (1 << 20)     // Stop reading a client with this many unsent response bytes
+#define HASHD_MAX_EVENTS 64
+
+#define HASHD_FLUSH_FULL 0
+#define HASHD_FLUSH_BUDGET 1
+#define HASHD_FLUSH_ALL_WAITING 2
+
+/**************************** DATA TYPES ****************************/
+typedef struct hashd_conn hashd_conn_t;
+
+typedef struct hashd_req {
+    struct hashd_req* next;
+    hashd_conn_t* conn;
+    uint64_t arrived;               // CLOCK_MONOTONIC ns, when the body completed
+    uint32_t id;
+    uint8_t op;
+    uint16_t keylen;
+    uint32_t length;
+    uint32_t got;                   // Body bytes received so far
+    uint8_t body[];                 // Key, then payload
+} hashd_req_t;
+
+struct hashd_conn {
+    int fd;
+    int closed;                     // Freed once none of its requests are queued
+    int touched;                    // Has responses from the batch being written
+    uint32_t events;                // epoll interest currently registered
+    size_t pending;                 // Requests in the queue
+    hashd_req_t* cur;               // Request whose body is arriving
+    hashd_conn_t* next_dead;
+    uint8_t* out;
+    size_t out_off, out_len, out_cap;
+    size_t in_len;
+    uint8_t in[HASHD_READ_BUF];
+};
+
+typedef struct {
+    const char* path;
+    uint64_t budget_ns;
+    size_t max_batch;
+    uint32_t max_body;
+} hashd_config_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static hashd_config_t cfg = {HASHD_DEFAULT_SOCKET, 100000, 64, 1 << 20};
+
+static int epfd = -1, listen_fd = -1, timer_fd = -1;
+static hashd_req_t* queue_head;
+static hashd_req_t** queue_tail = &queue_head;
+static size_t queued;
+static hashd_conn_t* dead_conns;
+static size_t open_conns, waiting_conns;  // Connected; connected with a request queued
+
+// Batch scratch, max_batch entries each
+static hashd_req_t** batch;
+static hashd_conn_t** batch_conns;
+static const uint8_t** hash_msgs;
+static size_t* hash_lens;
+static uint8_t** hash_outs;
+static const uint8_t** hmac_keys;
+static size_t* hmac_keylens;
+static const uint8_t** hmac_msgs;
+static size_t* hmac_lens;
+static uint8_t** hmac_outs;
+static uint8_t (*digests)[SHA256_90R_DIGEST_SIZE];
+
+static uint64_t stat_requests, stat_batches, stat_full, stat_budget, stat_waiting, stat_errors, stat_max_batch;
+
+static volatile sig_atomic_t stop_requested;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void timer_arm(uint64_t deadline) {
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t)(deadline / 1000000000ULL);
+    its.it_value.tv_nsec = (long)(deadline % 1000000000ULL);
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+// A request's key is the first keylen bytes of its body
+static void req_free(hashd_req_t* r) {
+    if (!r) return;
+    sha256_90r_wipe(r->body, r->keylen < r->got ? r->keylen : r->got);
+    free(r);
+}
+
+static void conn_update_events(hashd_conn_t* c) {
+    size_t backlog = c->out_len - c->out_off;
+    uint32_t want = (backlog > HASHD_OUT_HIGH ? 0 : EPOLLIN) | (backlog ? EPOLLOUT : 0);
+    struct epoll_event ev;
+
+    if (c->closed || want == c->events) return;
+    ev.events = want;
+    ev.data.ptr = c;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->events = want;
+}
+
+// Stop using the socket; the struct lives until its queued requests are done
+static void conn_close(hashd_conn_t* c) {
+    if (c->closed) return;
+    c->closed = 1;
+    open_conns--;
+    if (c->pending > 0) waiting_conns--;
+    epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    c->next_dead = dead_conns;
+    dead_conns = c;
+}
+
+static void conns_reap(void) {
+    hashd_conn_t** p = &dead_conns;
+
+    while (*p) {
+        hashd_conn_t* c = *p;
+        if (c->pending == 0) {
+            *p = c->next_dead;
+            req_free(c->cur);
+            free(c->out);
+            sha256_90r_wipe(c, sizeof(*c));     // Unparsed bytes in c->in
+            free(c);
+        } else {
+            p = &c->next_dead;
+        }
+    }
+}
+
+static void conn_reply(hashd_conn_t* c, uint32_t id, uint8_t status, const uint8_t* digest) {
+    if (c->closed) return;
+    if (c->out_len + HASHD_RESP_SIZE > c->out_cap) {
+        if (c->out_off > 0) {
+            memmove(c->out, c->out + c->out_off, c->out_len - c->out_off);
+            c->out_len -= c->out_off;
+            c->out_off = 0;
+        }
+        if (c->out_len + HASHD_RESP_SIZE > c->out_cap) {
+            size_t cap = c->out_cap ? c->out_cap * 2 : 64 * HASHD_RESP_SIZE;
+            uint8_t* out = realloc(c->out, cap);
+            if (!out) {
+                conn_close(c);
+                return;
+            }
+            c->out = out;
+            c->out_cap = cap;
+        }
+    }
+    hashd_encode_response(c->out + c->out_len, id, status, digest);
+    c->out_len += HASHD_RESP_SIZE;
+    if (status != HASHD_OK) stat_errors++;
+}
+
+static void conn_send(hashd_conn_t* c) {
+    while (!c->closed && c->out_off < c->out_len) {
+        ssize_t w = send(c->fd, c->out + c->out_off, c->out_len - c->out_off, MSG_NOSIGNAL);
+        if (w > 0) {
+            c->out_off += (size_t)w;
+        } else if (w < 0 && errno == EINTR) {
+            continue;
+        } else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            conn_close(c);
+            return;
+        }
+    }
+    if (c->out_off == c->out_len) c->out_off = c->out_len = 0;
+    conn_update_events(c);
+}
+
+// Hash everything queued, max_batch requests at a time
+static void queue_flush(int reason) {
+    if (queued == 0) return;
+    if (reason == HASHD_FLUSH_FULL) {
+        stat_full++;
+    } else if (reason == HASHD_FLUSH_BUDGET) {
+        stat_budget++;
+    } else {
+        stat_waiting++;
+    }
+
+    while (queue_head) {
+        size_t n = 0, nh = 0, nm = 0;
+        int hmac_rc = 0;
+
+        while (queue_head && n < cfg.max_batch) {
+            hashd_req_t* r = queue_head;
+            queue_head = r->next;
+            batch[n] = r;
+            if (r->op == HASHD_OP_HASH) {
+                hash_msgs[nh] = r->body;
+                hash_lens[nh] = r->length;
+                hash_outs[nh++] = digests[n];
+            } else {
+                hmac_keys[nm] = r->body;
+                hmac_keylens[nm] = r->keylen;
+                hmac_msgs[nm] = r->body + r->keylen;
+                hmac_lens[nm] = r->length - r->keylen;
+                hmac_outs[nm++] = digests[n];
+            }
+            n++;
+        }
+        queued -= n;
+
+        if (nh > 0) sha256_90r_batch(hash_msgs, hash_lens, hash_outs, nh, SHA256_90R_MODE_SECURE);
+        if (nm > 0) {
+            hmac_rc = sha256_90r_hmac_batch(hmac_keys, hmac_keylens, hmac_msgs, hmac_lens, hmac_outs, nm);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            hashd_req_t* r = batch[i];
+            hashd_conn_t* c = r->conn;
+            if (r->op == HASHD_OP_HMAC && hmac_rc != 0) {
+                conn_reply(c, r->id, HASHD_EINTERNAL, NULL);
+            } else {
+                conn_reply(c, r->id, HASHD_OK, digests[i]);
+            }
+            if (--c->pending == 0 && !c->closed) waiting_conns--;
+            batch_conns[i] = c->touched ? NULL : c;
+            c->touched = 1;
+            req_free(r);
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (!batch_conns[i]) continue;
+            batch_conns[i]->touched = 0;
+            conn_send(batch_conns[i]);
+        }
+
+        stat_batches++;
+        if (n > stat_max_batch) stat_max_batch = n;
+    }
+    queue_tail = &queue_head;
+}
+
+// A request whose body is complete: answer errors now, queue the rest
+static void request_ready(hashd_conn_t* c, hashd_req_t* r) {
+    stat_requests++;
+    if ((r->op != HASHD_OP_HASH && r->op != HASHD_OP_HMAC) || (r->op == HASHD_OP_HASH && r->keylen)) {
+        conn_reply(c, r->id, HASHD_EOP, NULL);
+        req_free(r);
+        return;
+    }
+    if (r->keylen > r->length) {
+        conn_reply(c, r->id, HASHD_EKEY, NULL);
+        req_free(r);
+        return;
+    }
+
+    r->arrived = now_ns();
+    r->next = NULL;
+    *queue_tail = r;
+    queue_tail = &r->next;
+    if (c->pending++ == 0) waiting_conns++;
+    if (queued++ == 0 && cfg.budget_ns > 0) timer_arm(r->arrived + cfg.budget_ns);
+    if (queued >= cfg.max_batch) queue_flush(HASHD_FLUSH_FULL);
+}
+
+// Cut the bytes in c->in into requests
+static void conn_parse(hashd_conn_t* c) {
+    size_t pos = 0;
+
+    while (!c->closed) {
+        hashd_req_t* r = c->cur;
+        size_t take;
+
+        if (!r) {
+            hashd_req_header_t h;
+            if (c->in_len - pos < HASHD_REQ_HEADER) break;
+            hashd_decode_request(c->in + pos, &h);
+            pos += HASHD_REQ_HEADER;
+            if (h.length > cfg.max_body) {
+                stat_requests++;
+                conn_reply(c, h.id, HASHD_ETOOBIG, NULL);
+                conn_send(c);
+                conn_close(c);
+                return;
+            }
+            r = malloc(sizeof(*r) + h.length);
+            if (!r) {
+                conn_close(c);
+                return;
+            }
+            r->conn = c;
+            r->id = h.id;
+            r->op = h.op;
+            r->keylen = h.keylen;
+            r->length = h.length;
+            r->got = 0;
+            c->cur = r;
+        }
+
+        take = c->in_len - pos;
+        if (take > r->length - r->got) take = r->length - r->got;
+        memcpy(r->body + r->got, c->in + pos, take);
+        r->got += (uint32_t)take;
+        pos += take;
+        if (r->got < r->length) break;
+        c->cur = NULL;
+        request_ready(c, r);
+    }
+
+    if (c->closed) return;
+    memmove(c->in, c->in + pos, c->in_len - pos);
+    c->in_len -= pos;
+    sha256_90r_wipe(c->in + c->in_len, pos);    // Consumed bytes, keys included
+}
+
+static void conn_read(hashd_conn_t* c) {
+    while (!c->closed && c->out_len - c->out_off <= HASHD_OUT_HIGH) {
+        ssize_t r = read(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len);
+        if (r > 0) {
+            c->in_len += (size_t)r;
+            conn_parse(c);
+        } else if (r == 0) {
+            conn_close(c);
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            conn_close(c);
+        }
+    }
+    if (!c->closed) conn_send(c);
+}
+
+static void accept_all(void) {
+    for (;;) {
+        struct epoll_event ev;
+        hashd_conn_t* c;
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        c = calloc(1, sizeof(*c));
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->events = EPOLLIN;
+        open_conns++;
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            open_conns--;
+            close(fd);
+            free(c);
+        }
+    }
+}
+
+// Bind path, replacing a socket file left behind by a daemon that is gone
+static int listen_on(const char* path) {
+    struct sockaddr_un addr;
+    mode_t old_mask;
+    int fd, rc;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "hashd: socket path too long: %s\n", path);
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    old_mask = umask(077);
+    rc = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    if (rc != 0 && errno == EADDRINUSE) {
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe >= 0 && connect(probe, (struct sockaddr*)&addr, sizeof(addr)) != 0 && errno == ECONNREFUSED) {
+            unlink(path);
+            rc = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+        } else {
+            errno = EADDRINUSE;
+        }
+        if (probe >= 0) close(probe);
+    }
+    umask(old_mask);
+    if (rc != 0 || listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "hashd: cannot listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int alloc_scratch(size_t n) {
+    batch = malloc(n * sizeof(*batch));
+    batch_conns = malloc(n * sizeof(*batch_conns));
+    hash_msgs = malloc(n * sizeof(*hash_msgs));
+    hash_lens = malloc(n * sizeof(*hash_lens));
+    hash_outs = malloc(n * sizeof(*hash_outs));
+    hmac_keys = malloc(n * sizeof(*hmac_keys));
+    hmac_keylens = malloc(n * sizeof(*hmac_keylens));
+    hmac_msgs = malloc(n * sizeof(*hmac_msgs));
+    hmac_lens = malloc(n * sizeof(*hmac_lens));
+    hmac_outs = malloc(n * sizeof(*hmac_outs));
+    digests = malloc(n * sizeof(*digests));
+    return batch && batch_conns && hash_msgs && hash_lens && hash_outs && hmac_keys && hmac_keylens &&
+           hmac_msgs && hmac_lens && hmac_outs && digests ? 0 : -1;
+}
+
+static void usage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --socket PATH      Unix socket to listen on (default %s)\n", HASHD_DEFAULT_SOCKET);
+    printf("  --budget-us N      Longest a request waits for its batch to fill (default 100;\n");
+    printf("                     0 hashes whatever one poll round delivered)\n");
+    printf("  --max-batch N      Requests per batch; a full batch is hashed at once (default 64)\n");
+    printf("  --max-body N       Largest key + payload accepted, in bytes (default 1048576)\n");
+}
+
+int main(int argc, char* argv[]) {
+    struct epoll_event events[HASHD_MAX_EVENTS];
+    struct epoll_event ev;
+    struct sigaction sa;
+    sha256_90r_tune_plan_t plan;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            cfg.path = argv[++i];
+        } else if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc) {
+            cfg.budget_ns = strtoull(argv[++i], NULL, 10) * 1000ULL;
+        } else if (strcmp(argv[i], "--max-batch") == 0 && i + 1 < argc) {
+            cfg.max_batch = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-body") == 0 && i + 1 < argc) {
+            cfg.max_body = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (cfg.max_batch == 0) cfg.max_batch = 1;
+    if (alloc_scratch(cfg.max_batch) != 0) {
+        fprintf(stderr, "hashd: out of memory\n");
+        return 1;
+    }
+
+    // Pay for feature detection and tuning once, for every client
+    sha256_90r_autotune(0, &plan);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    listen_fd = listen_on(cfg.path);
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (listen_fd < 0 || epfd < 0 || timer_fd < 0) return 1;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &listen_fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.ptr = &timer_fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, timer_fd, &ev);
+
+    printf("hashd: listening on %s (budget %llu us, batches of up to %zu, %d lanes from %zu messages)\n",
+           cfg.path, (unsigned long long)(cfg.budget_ns / 1000), cfg.max_batch, plan.mb_lanes,
+           plan.batch_min_count);
+    fflush(stdout);
+
+    while (!stop_requested) {
+        int n = epoll_wait(epfd, events, HASHD_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("hashd: epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            void* p = events[i].data.ptr;
+            if (p == &listen_fd) {
+                accept_all();
+            } else if (p == &timer_fd) {
+                uint64_t expirations;
+                if (read(timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) break;
+                // The timer may belong to a batch that filled up since; re-aim it
+                if (queue_head) {
+                    uint64_t deadline = queue_head->arrived + cfg.budget_ns;
+                    if (now_ns() >= deadline) {
+                        queue_flush(HASHD_FLUSH_BUDGET);
+                    } else {
+                        timer_arm(deadline);
+                    }
+                }
+            } else {
+                hashd_conn_t* c = p;
+                if (c->closed) continue;
+                if (events[i].events & EPOLLOUT) conn_send(c);
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) conn_read(c);
+            }
+        }
+        if (cfg.budget_ns == 0) {
+            queue_flush(HASHD_FLUSH_BUDGET);
+        } else if (queued > 0 && waiting_conns == open_conns) {
+            queue_flush(HASHD_FLUSH_ALL_WAITING);
+        }
+        conns_reap();
+    }
+
+    queue_flush(HASHD_FLUSH_BUDGET);
+    unlink(cfg.path);
+    printf("hashd: %llu requests in %llu batches (mean %.1f, largest %llu); flushed %llu full, "
+           "%llu on budget, %llu with every client waiting; %llu errors\n",
+           (unsigned long long)stat_requests, (unsigned long long)stat_batches,
+           stat_batches ? (double)(stat_requests - stat_errors) / (double)stat_batches : 0.0,
+           (unsigned long long)stat_max_batch, (unsigned long long)stat_full, (unsigned long long)stat_budget,
+           (unsigned long long)stat_waiting, (unsigned long long)stat_errors);
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*********************************************************************
+* Filename:   sha256_90r_hashd.h
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Wire format of sha256_90r_hashd, the local hashing daemon.
+*             A client sends frames on a Unix stream socket and may keep
+*             any number in flight; every frame gets one fixed-size
+*             response carrying the frame's id. Responses can come back
+*             in a different order from the requests. All integers are
+*             little-endian.
+*
+*             Request (12-byte header, then body):
+*               u32 length     body bytes (key + payload)
+*               u32 id         echoed in the response
+*               u8  op         HASHD_OP_HASH or HASHD_OP_HMAC
+*               u8  reserved   0
+*               u16 keylen     HMAC key bytes at the start of the body
+*                              (0 for HASHD_OP_HASH)
+*
+*             Response (40 bytes):
+*               u32 id
+*               u8  status     HASHD_OK or an HASHD_E* code
+*               u8  reserved[3]
+*               u8  digest[32] zero unless status is HASHD_OK
+*
+*             A body longer than the daemon's limit is answered with
+*             HASHD_ETOOBIG and the connection is closed, since the rest
+*             of the stream cannot be trusted to be framed.
+*********************************************************************/
+
+#ifndef SHA256_90R_HASHD_H
+#define SHA256_90R_HASHD_H
+
+/*************************** HEADER FILES ***************************/
+#include <stdint.h>
+#include <string.h>
+
+/****************************** MACROS ******************************/
+#define HASHD_DEFAULT_SOCKET "/tmp/sha256_90r_hashd.sock"
+
+#define HASHD_REQ_HEADER 12
+#define HASHD_RESP_SIZE 40
+
+#define HASHD_OP_HASH 1
+#define HASHD_OP_HMAC 2
+
+#define HASHD_OK 0
+#define HASHD_EOP 1                  // Unknown op, or a hash request with a key
+#define HASHD_EKEY 2                 // keylen larger than the body
+#define HASHD_ETOOBIG 3              // Body over the daemon's limit
+#define HASHD_EINTERNAL 4            // Daemon out of memory; the request may be retried
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+    uint32_t length;
+    uint32_t id;
+    uint8_t op;
+    uint16_t keylen;
+} hashd_req_header_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static inline void hashd_put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t hashd_get32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline void hashd_encode_request(uint8_t out[HASHD_REQ_HEADER], const hashd_req_header_t* h) {
+    hashd_put32(out, h->length);
+    hashd_put32(out + 4, h->id);
+    out[8] = h->op;
+    out[9] = 0;
+    out[10] = (uint8_t)h->keylen;
+    out[11] = (uint8_t)(h->keylen >> 8);
+}
+
+static inline void hashd_decode_request(const uint8_t in[HASHD_REQ_HEADER], hashd_req_header_t* h) {
+    h->length = hashd_get32(in);
+    h->id = hashd_get32(in + 4);
+    h->op = in[8];
+    h->keylen = (uint16_t)(in[10] | in[11] << 8);
+}
+
+static inline void hashd_encode_response(uint8_t out[HASHD_RESP_SIZE], uint32_t id, uint8_t status,
+                                         const uint8_t* digest) {
+    hashd_put32(out, id);
+    out[4] = status;
+    out[5] = out[6] = out[7] = 0;
+    if (digest) {
+        memcpy(out + 8, digest, 32);
+    } else {
+        memset(out + 8, 0, 32);
+    }
+}
+
+#endif // SHA256_90R_HASHD_H
@@ -0,0 +1,327 @@
+/*********************************************************************
+* Filename:   sha256_90r_hashd_load.c
+* Author:     SHA256-90R Development Team
+* Copyright:  Public Domain
+* Disclaimer: This code is presented "as is" without any guarantees.
+* Details:    Load generator for sha256_90r_hashd. Each connection runs
+*             in its own thread and keeps --depth requests in flight.
+*             It reports throughput and latency percentiles, measured
+*             from send to response. After the timed run it recomputes
+*             every digest in-process to check the answers, and it
+*             times the same requests hashed one at a time in-process
+*             for comparison.
+*********************************************************************/
+
+/*************************** HEADER FILES ***************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../src/sha256_90r/sha256_90r.h"
+#include "sha256_90r_hashd.h"
+
+/****************************** MACROS ******************************/
+#define LOAD_MAX_KEY 1024
+#define LOAD_RECV_BUF (HASHD_RESP_SIZE * 256)
+
+/**************************** DATA TYPES ****************************/
+typedef struct {
+    const char* path;
+    int connections;
+    size_t requests;                // Per connection
+    size_t depth;
+    size_t size;                    // Payload bytes
+    size_t key_size;
+    const char* op;                 // "hash", "hmac" or "mix"
+} load_config_t;
+
+typedef struct {
+    int index;
+    int fd;
+    uint8_t key[LOAD_MAX_KEY];
+    uint8_t* payload;               // Request i carries i in its first 4 bytes
+    uint8_t* send_buf;
+    uint64_t* sent_at;
+    uint64_t* latency;
+    uint8_t (*digests)[SHA256_90R_DIGEST_SIZE];
+    uint8_t* status;
+    uint64_t start, end;
+    int failed;
+} load_conn_t;
+
+/*********************** FUNCTION DEFINITIONS ***********************/
+static load_config_t cfg = {HASHD_DEFAULT_SOCKET, 8, 20000, 8, 64, 32, "hash"};
+static pthread_barrier_t start_barrier;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint8_t request_op(size_t i) {
+    if (strcmp(cfg.op, "hmac") == 0) return HASHD_OP_HMAC;
+    if (strcmp(cfg.op, "mix") == 0 && (i & 1)) return HASHD_OP_HMAC;
+    return HASHD_OP_HASH;
+}
+
+// Payload of request i (written into the connection's payload buffer)
+static const uint8_t* request_payload(load_conn_t* c, size_t i) {
+    if (cfg.size >= 4) hashd_put32(c->payload, (uint32_t)i);
+    return c->payload;
+}
+
+static void expected_digest(load_conn_t* c, size_t i, uint8_t out[SHA256_90R_DIGEST_SIZE]) {
+    const uint8_t* msg = request_payload(c, i);
+
+    if (request_op(i) == HASHD_OP_HMAC) {
+        sha256_90r_hmac(c->key, cfg.key_size, msg, cfg.size, out);
+    } else {
+        sha256_90r_hash(msg, cfg.size, out);
+    }
+}
+
+static int send_all(int fd, const uint8_t* p, size_t len) {
+    while (len > 0) {
+        ssize_t w = send(fd, p, len, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return -1;
+        p += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+// Frames for requests [from, to) into send_buf; returns the byte count
+static size_t encode_requests(load_conn_t* c, size_t from, size_t to) {
+    size_t n = 0;
+
+    for (size_t i = from; i < to; i++) {
+        hashd_req_header_t h;
+        size_t keylen = request_op(i) == HASHD_OP_HMAC ? cfg.key_size : 0;
+
+        h.length = (uint32_t)(keylen + cfg.size);
+        h.id = (uint32_t)i;
+        h.op = request_op(i);
+        h.keylen = (uint16_t)keylen;
+        hashd_encode_request(c->send_buf + n, &h);
+        n += HASHD_REQ_HEADER;
+        memcpy(c->send_buf + n, c->key, keylen);
+        n += keylen;
+        memcpy(c->send_buf + n, request_payload(c, i), cfg.size);
+        n += cfg.size;
+    }
+    return n;
+}
+
+static void* load_thread(void* arg) {
+    load_conn_t* c = arg;
+    uint8_t in[LOAD_RECV_BUF];
+    size_t in_len = 0, sent = 0, done = 0;
+
+    pthread_barrier_wait(&start_barrier);
+    c->start = now_ns();
+    while (done < cfg.requests) {
+        ssize_t r;
+
+        if (sent < cfg.requests && sent - done < cfg.depth) {
+            size_t to = done + cfg.depth < cfg.requests ? done + cfg.depth : cfg.requests;
+            size_t bytes = encode_requests(c, sent, to);
+            uint64_t t = now_ns();
+            for (size_t i = sent; i < to; i++) c->sent_at[i] = t;
+            if (send_all(c->fd, c->send_buf, bytes) != 0) break;
+            sent = to;
+        }
+
+        r = recv(c->fd, in + in_len, sizeof(in) - in_len, 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        in_len += (size_t)r;
+
+        {
+            uint64_t t = now_ns();
+            size_t pos = 0;
+            for (; in_len - pos >= HASHD_RESP_SIZE; pos += HASHD_RESP_SIZE) {
+                uint32_t id = hashd_get32(in + pos);
+                if (id >= sent || c->latency[id]) {
+                    c->failed = 1;
+                    continue;
+                }
+                c->latency[id] = t - c->sent_at[id];
+                c->status[id] = in[pos + 4];
+                memcpy(c->digests[id], in + pos + 8, SHA256_90R_DIGEST_SIZE);
+                done++;
+            }
+            memmove(in, in + pos, in_len - pos);
+            in_len -= pos;
+        }
+    }
+    c->end = now_ns();
+    if (done < cfg.requests) c->failed = 1;
+    return NULL;
+}
+
+static int connect_to(const char* path) {
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0 || strlen(path) >= sizeof(addr.sun_path)) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile_us(const uint64_t* sorted, size_t n, double p) {
+    size_t k;
+
+    if (n == 0) return 0.0;                // No answered requests
+    k = (size_t)(p / 100.0 * (double)(n - 1) + 0.5);
+    return (double)sorted[k] / 1000.0;
+}
+
+static void usage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --socket PATH       Daemon socket (default %s)\n", HASHD_DEFAULT_SOCKET);
+    printf("  --connections N     Concurrent clients, one thread each (default 8)\n");
+    printf("  --requests N        Requests per connection (default 20000)\n");
+    printf("  --depth N           Requests each connection keeps in flight (default 8)\n");
+    printf("  --size N            Payload bytes (default 64)\n");
+    printf("  --op hash|hmac|mix  Request type; mix alternates (default hash)\n");
+    printf("  --key-size N        HMAC key bytes (default 32)\n");
+}
+
+int main(int argc, char* argv[]) {
+    load_conn_t* conns;
+    pthread_t* threads;
+    uint64_t* all;
+    uint64_t first = UINT64_MAX, last = 0, t0;
+    size_t total, answered = 0, mismatches = 0, errors = 0;
+    int failed = 0;
+    double secs;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            cfg.path = argv[++i];
+        } else if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+            cfg.connections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+            cfg.requests = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            cfg.depth = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            cfg.size = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--op") == 0 && i + 1 < argc) {
+            cfg.op = argv[++i];
+        } else if (strcmp(argv[i], "--key-size") == 0 && i + 1 < argc) {
+            cfg.key_size = strtoul(argv[++i], NULL, 10);
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (cfg.connections < 1 || cfg.requests < 1 || cfg.depth < 1 || cfg.key_size > LOAD_MAX_KEY ||
+        (strcmp(cfg.op, "hash") != 0 && strcmp(cfg.op, "hmac") != 0 && strcmp(cfg.op, "mix") != 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    conns = calloc((size_t)cfg.connections, sizeof(*conns));
+    threads = calloc((size_t)cfg.connections, sizeof(*threads));
+    if (!conns || !threads) return 1;
+    for (int i = 0; i < cfg.connections; i++) {
+        load_conn_t* c = &conns[i];
+        c->index = i;
+        c->fd = connect_to(cfg.path);
+        if (c->fd < 0) {
+            fprintf(stderr, "hashd_load: cannot connect to %s: %s\n", cfg.path, strerror(errno));
+            return 1;
+        }
+        for (size_t b = 0; b < cfg.key_size; b++) c->key[b] = (uint8_t)(i * 31 + b);
+        c->payload = malloc(cfg.size + 4);
+        c->send_buf = malloc(cfg.depth * (HASHD_REQ_HEADER + cfg.key_size + cfg.size));
+        c->sent_at = calloc(cfg.requests, sizeof(*c->sent_at));
+        c->latency = calloc(cfg.requests, sizeof(*c->latency));
+        c->digests = calloc(cfg.requests, sizeof(*c->digests));
+        c->status = calloc(cfg.requests, 1);
+        if (!c->payload || !c->send_buf || !c->sent_at || !c->latency || !c->digests || !c->status) return 1;
+        for (size_t b = 0; b < cfg.size; b++) c->payload[b] = (uint8_t)(b * 7 + i);
+    }
+
+    pthread_barrier_init(&start_barrier, NULL, (unsigned)cfg.connections);
+    for (int i = 0; i < cfg.connections; i++) pthread_create(&threads[i], NULL, load_thread, &conns[i]);
+    for (int i = 0; i < cfg.connections; i++) pthread_join(threads[i], NULL);
+    pthread_barrier_destroy(&start_barrier);
+
+    total = (size_t)cfg.connections * cfg.requests;
+    all = malloc(total * sizeof(*all));
+    if (!all) return 1;
+    for (int i = 0; i < cfg.connections; i++) {
+        load_conn_t* c = &conns[i];
+        if (c->start < first) first = c->start;
+        if (c->end > last) last = c->end;
+        failed |= c->failed;
+        for (size_t r = 0; r < cfg.requests; r++) {
+            uint8_t want[SHA256_90R_DIGEST_SIZE];
+            if (c->latency[r]) all[answered++] = c->latency[r];  // Unanswered requests have no latency
+            if (c->status[r] != HASHD_OK) {
+                errors++;
+                continue;
+            }
+            expected_digest(c, r, want);
+            if (memcmp(want, c->digests[r], SHA256_90R_DIGEST_SIZE) != 0) mismatches++;
+        }
+        close(c->fd);
+    }
+    qsort(all, answered, sizeof(*all), cmp_u64);
+    secs = (double)(last - first) / 1e9;
+
+    printf("hashd load: %d connections x %zu requests, depth %zu, %zu-byte %s payloads\n",
+           cfg.connections, cfg.requests, cfg.depth, cfg.size, cfg.op);
+    printf("  throughput: %.0f req/s (%.1f MB/s of payload)\n", (double)total / secs,
+           (double)total * (double)cfg.size / secs / 1e6);
+    printf("  latency us (%zu answered): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n", answered,
+           percentile_us(all, answered, 50), percentile_us(all, answered, 90), percentile_us(all, answered, 99),
+           percentile_us(all, answered, 99.9), answered ? (double)all[answered - 1] / 1000.0 : 0.0);
+    printf("  verified: %zu of %zu digests match (%zu error responses)%s\n", total - mismatches - errors,
+           total, errors, failed ? "; some responses missing or unexpected" : "");
+
+    // The same requests, one message at a time in this process
+    t0 = now_ns();
+    for (int i = 0; i < cfg.connections; i++) {
+        for (size_t r = 0; r < cfg.requests; r++) {
+            uint8_t out[SHA256_90R_DIGEST_SIZE];
+            expected_digest(&conns[i], r, out);
+        }
+    }
+    secs = (double)(now_ns() - t0) / 1e9;
+    printf("  in-process, one at a time: %.0f req/s\n", (double)total / secs);
+
+    for (int i = 0; i < cfg.connections; i++) {
+        free(conns[i].payload);
+        free(conns[i].send_buf);
+        free(conns[i].sent_at);
+        free(conns[i].latency);
+        free(conns[i].digests);
+        free(conns[i].status);
+    }
+    free(all);
+    free(conns);
+    free(threads);
+    return failed || mismatches || errors ? 1 : 0;
+}